@@ -0,0 +1,196 @@
+/*
+ * bitplanes.cc - Conversion of Amiga bitplanes to pixels
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/bitplanes.h"
+
+#define MAX_PLANES  5
+
+// Eight pixels are kept in one uint64_t, one color index per byte, the
+// leftmost pixel in the lowest byte.
+#define LANES(value)  (0x0101010101010101ull * (value))
+
+namespace {
+
+// Source byte to eight lanes of 0 or 1, most significant bit first.
+class ExpandTable {
+ public:
+  uint64_t lanes[256];
+
+  ExpandTable() {
+    for (unsigned int value = 0; value < 256; value++) {
+      lanes[value] = 0;
+      for (unsigned int j = 0; j < 8; j++) {
+        if ((value >> (7 - j)) & 0x01) {
+          lanes[value] |= uint64_t(1) << (8 * j);
+        }
+      }
+    }
+  }
+};
+
+const uint64_t *
+get_expand_table() {
+  static const ExpandTable table;
+  return table.lanes;
+}
+
+// Color bit and source offset of every stored plane.
+class PlaneLayout {
+ public:
+  size_t count;
+  unsigned int shifts[MAX_PLANES];
+  size_t offsets[MAX_PLANES];
+  uint8_t constant;
+  uint8_t variable;
+
+  PlaneLayout(uint8_t compression, uint8_t filling, size_t plane_size,
+              bool invert)
+    : count(0)
+    , constant(0)
+    , variable(0) {
+    for (unsigned int b = 0; b < MAX_PLANES; b++) {
+      unsigned int shift = invert ? b : (MAX_PLANES - 1 - b);
+      if ((compression >> b) & 0x01) {
+        if ((filling >> b) & 0x01) {
+          constant |= 1 << shift;
+        }
+      } else {
+        shifts[count] = shift;
+        offsets[count] = count * plane_size;
+        variable |= 1 << shift;
+        count++;
+      }
+    }
+  }
+
+  uint64_t combine(const uint8_t *src, const uint64_t *expand) const {
+    uint64_t indices = LANES(constant);
+    for (size_t p = 0; p < count; p++) {
+      indices |= expand[src[offsets[p]]] << shifts[p];
+    }
+    return indices;
+  }
+};
+
+// Palette entries for all indices that planes can produce.
+class ColorTable {
+ public:
+  Bitplanes::Color colors[1 << MAX_PLANES];
+
+  ColorTable(const uint8_t *palette, uint8_t constant, uint8_t variable) {
+    for (unsigned int c = 0; c < (1 << MAX_PLANES); c++) {
+      if ((c & ~variable) == constant) {
+        colors[c] = { palette[c*3+2], palette[c*3+1], palette[c*3+0], 0xFF };
+      } else {
+        colors[c] = { 0, 0, 0, 0 };
+      }
+    }
+  }
+
+  Bitplanes::Color *emit(Bitplanes::Color *dst, uint64_t indices) const {
+    for (unsigned int j = 0; j < 8; j++) {
+      *dst++ = colors[(indices >> (8 * j)) & 0xFF];
+    }
+    return dst;
+  }
+};
+
+}  // namespace
+
+void
+Bitplanes::decode_planar(Color *dst, const uint8_t *src,
+                         size_t width, size_t height,
+                         uint8_t compression, uint8_t filling,
+                         const uint8_t *palette, bool invert) {
+  const uint64_t *expand = get_expand_table();
+  size_t bps = width * height;  // bitplane size in bytes
+  PlaneLayout layout(compression, filling, bps, invert);
+  ColorTable colors(palette, layout.constant, layout.variable);
+
+  for (size_t i = 0; i < bps; i++) {
+    dst = colors.emit(dst, layout.combine(src + i, expand));
+  }
+}
+
+void
+Bitplanes::decode_interlaced(Color *dst, const uint8_t *src,
+                             size_t width, size_t height,
+                             uint8_t compression, uint8_t filling,
+                             const uint8_t *palette, size_t skip_lines) {
+  const uint64_t *expand = get_expand_table();
+  PlaneLayout layout(compression, filling, width, true);
+  ColorTable colors(palette, layout.constant, layout.variable);
+  size_t line_size = get_plane_count(compression) * width;
+
+  for (size_t y = 0; y < height; y++) {
+    const uint8_t *line = src + y * (line_size + skip_lines * width);
+    for (size_t i = 0; i < width; i++) {
+      dst = colors.emit(dst, layout.combine(line + i, expand));
+    }
+  }
+}
+
+void
+Bitplanes::decode_sprite(Color *dst, const uint8_t *src,
+                         size_t width, size_t height,
+                         const uint8_t *palette) {
+  const uint64_t *expand = get_expand_table();
+  ColorTable colors(palette, 0x10, 0x0F);
+  const uint8_t *src_2 = src + width * 2 * height;
+
+  for (size_t y = 0; y < height; y++) {
+    const uint8_t *line_1 = src + y * 2 * width;
+    const uint8_t *line_2 = src_2 + y * 2 * width;
+    for (size_t i = 0; i < width; i++) {
+      uint64_t indices = LANES(0x10);
+      indices |= expand[line_1[i]];
+      indices |= expand[line_1[i + width]] << 1;
+      indices |= expand[line_2[i]] << 2;
+      indices |= expand[line_2[i + width]] << 3;
+      dst = colors.emit(dst, indices);
+    }
+  }
+}
+
+void
+Bitplanes::decode_mask(Color *dst, const uint8_t *src, size_t size) {
+  const uint64_t *expand = get_expand_table();
+  static const Color colors[2] = { { 0x00, 0x00, 0x00, 0x00 },
+                                   { 0xFF, 0xFF, 0xFF, 0xFF } };
+
+  for (size_t i = 0; i < size; i++) {
+    uint64_t indices = expand[src[i]];
+    for (unsigned int j = 0; j < 8; j++) {
+      *dst++ = colors[(indices >> (8 * j)) & 0x01];
+    }
+  }
+}
+
+unsigned int
+Bitplanes::get_plane_count(uint8_t compression) {
+  unsigned int count = MAX_PLANES;
+  for (unsigned int b = 0; b < MAX_PLANES; b++) {
+    if ((compression >> b) & 0x01) {
+      count--;
+    }
+  }
+  return count;
+}
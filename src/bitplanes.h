@@ -0,0 +1,66 @@
+/*
+ * bitplanes.h - Conversion of Amiga bitplanes to pixels
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_BITPLANES_H_
+#define SRC_BITPLANES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "src/data.h"
+
+// Planar to chunky conversion used by the Amiga data source. Every source
+// byte is expanded to eight pixels at once through a lookup table, instead
+// of testing one bit at a time. Width is given in bytes, i.e. 8 pixels.
+// Palettes hold 32 RGB triplets.
+class Bitplanes {
+ public:
+  typedef Data::Sprite::Color Color;
+
+  // Planes follow each other, each width * height bytes. Planes flagged in
+  // compression are not stored, their bit is taken from filling instead.
+  // Bit b of compression is the most significant color bit, unless invert
+  // is set.
+  static void decode_planar(Color *dst, const uint8_t *src,
+                            size_t width, size_t height,
+                            uint8_t compression, uint8_t filling,
+                            const uint8_t *palette, bool invert);
+
+  // Planes are interleaved per line. Color bits are always inverted. The
+  // planes of line y are additionally offset by skip_lines * width * y.
+  static void decode_interlaced(Color *dst, const uint8_t *src,
+                                size_t width, size_t height,
+                                uint8_t compression, uint8_t filling,
+                                const uint8_t *palette, size_t skip_lines);
+
+  // Hardware sprite: two pairs of interleaved planes, the upper half of the
+  // palette.
+  static void decode_sprite(Color *dst, const uint8_t *src,
+                            size_t width, size_t height,
+                            const uint8_t *palette);
+
+  // Single plane of size bytes, set bits become opaque white.
+  static void decode_mask(Color *dst, const uint8_t *src, size_t size);
+
+  static unsigned int get_plane_count(uint8_t compression);
+};
+
+#endif  // SRC_BITPLANES_H_
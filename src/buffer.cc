@@ -27,6 +27,13 @@
 
 #include "src/debug.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 Buffer::Buffer(EndianessMode _endianess)
   : data(nullptr)
   , size(0)
@@ -63,8 +70,26 @@ Buffer::Buffer(PBuffer _parent, size_t start, size_t length,
 }
 
 Buffer::Buffer(const std::string &path, EndianessMode _endianess)
-  : owned(true)
-  , endianess(_endianess) {
+  : Buffer(_endianess) {
+  load(path);
+}
+
+Buffer::~Buffer() {
+  if (owned && (data != nullptr)) {
+    ::free(data);
+  }
+}
+
+void *
+Buffer::unfix() {
+  void *result = data;
+  data = nullptr;
+  size = 0;
+  return result;
+}
+
+void
+Buffer::load(const std::string &path) {
   std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
   if (!file.good()) {
     throw ExceptionFreeserf("Failed to open file '" + path + "'");
@@ -85,20 +110,6 @@ Buffer::Buffer(const std::string &path, EndianessMode _endianess)
   read = reinterpret_cast<uint8_t*>(data);
 }
 
-Buffer::~Buffer() {
-  if (owned && (data != nullptr)) {
-    ::free(data);
-  }
-}
-
-void *
-Buffer::unfix() {
-  void *result = data;
-  data = nullptr;
-  size = 0;
-  return result;
-}
-
 bool
 Buffer::readable() {
   return (read - reinterpret_cast<uint8_t*>(data) != (ptrdiff_t)size);
@@ -212,8 +223,69 @@ MutableBuffer::push(const void *_data, size_t _size) {
   size += _size;
 }
 
+void *
+MutableBuffer::extend(size_t count) {
+  check_size(size + count);
+  void *result = offset(size);
+  size += count;
+  return result;
+}
+
 void
 MutableBuffer::push(const std::string &str) {
   push((const void*)str.c_str(), str.size());
 }
 
+
+// MappedBuffer
+
+bool MappedBuffer::mapping_enabled = true;
+
+MappedBuffer::MappedBuffer(const std::string &path,
+                           EndianessMode _endianess)
+  : Buffer(_endianess)
+  , mapped(false) {
+  if (!mapping_enabled || !map(path)) {
+    load(path);
+  }
+}
+
+MappedBuffer::~MappedBuffer() {
+#ifndef _WIN32
+  if (mapped && (data != nullptr)) {
+    munmap(data, size);
+  }
+#endif
+}
+
+bool
+MappedBuffer::map(const std::string &path) {
+#ifdef _WIN32
+  return false;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw ExceptionFreeserf("Failed to open file '" + path + "'");
+  }
+
+  struct stat info;
+  if ((fstat(fd, &info) != 0) || (info.st_size == 0)) {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, static_cast<size_t>(info.st_size),
+                   PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+
+  data = map;
+  size = static_cast<size_t>(info.st_size);
+  owned = false;
+  mapped = true;
+  read = reinterpret_cast<uint8_t*>(data);
+  return true;
+#endif
+}
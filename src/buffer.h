@@ -65,6 +65,9 @@ class Buffer : public std::enable_shared_from_this<Buffer> {
   void set_endianess(EndianessMode _endianess) { endianess = _endianess; }
 
   bool readable();
+  // Bytes left to read.
+  size_t get_readable_size() const {
+    return size - (read - reinterpret_cast<uint8_t*>(data)); }
   PBuffer pop(size_t size);
   PBuffer pop_tail();
   template<typename T> T pop() {
@@ -85,6 +88,7 @@ class Buffer : public std::enable_shared_from_this<Buffer> {
 
  protected:
   void *offset(size_t off) { return reinterpret_cast<char*>(data) + off; }
+  void load(const std::string &path);
 };
 
 class MutableBuffer : public Buffer {
@@ -106,6 +110,8 @@ class MutableBuffer : public Buffer {
   void push(void *buf, size_t len) { push((const void*)buf, len); }
   void push(const std::string &str);
   void push(const char *str) { push(std::string(str)); }
+  // Grow by count bytes and return them, uninitialized, to be filled.
+  void *extend(size_t count);
   template<typename T> void push(T value, size_t count = 1) {
     check_size(size + (sizeof(T) * count));
     for (size_t i = 0; i < count; i++) {
@@ -122,4 +128,28 @@ class MutableBuffer : public Buffer {
 
 typedef std::shared_ptr<MutableBuffer> PMutableBuffer;
 
+// Whole file mapped into memory, read into memory where mapping is not
+// available. Pages are private, so writes to the buffer never reach the
+// file. Sub-buffers are views that keep the mapping alive.
+class MappedBuffer : public Buffer {
+ protected:
+  static bool mapping_enabled;
+  bool mapped;
+
+ public:
+  explicit MappedBuffer(const std::string &path,
+                        EndianessMode endianess = is_big_endian() ?
+                                                    EndianessBig :
+                                                    EndianessLittle);
+  virtual ~MappedBuffer();
+
+  bool is_mapped() const { return mapped; }
+
+  // Read files instead of mapping them, to compare both.
+  static void set_mapping_enabled(bool enabled) { mapping_enabled = enabled; }
+
+ protected:
+  bool map(const std::string &path);
+};
+
 #endif  // SRC_BUFFER_H_
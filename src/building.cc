@@ -40,6 +40,7 @@ Building::Building(Game *game, unsigned int index)
   burning = false;
   active = false;
   holder = false;
+  asleep = false;
   pos = 0;
   progress = 0;
   u = { 0 };
@@ -95,6 +96,7 @@ const ConstructionInfo const_info[] = {
 
 Map::Object
 Building::start_building(Building::Type _type) {
+  wake_up();
   type = _type;
   Map::Object map_obj = const_info[type].map_obj;
   progress = (map_obj == Map::ObjectLargeBuilding) ? 0 : 1;
@@ -121,6 +123,7 @@ Building::start_building(Building::Type _type) {
 
 void
 Building::done_leveling() {
+  wake_up();
   progress = 1;
   holder = false;
   first_knight = 0;
@@ -128,6 +131,7 @@ Building::done_leveling() {
 
 bool
 Building::build_progress() {
+  wake_up();
   int frame_finished = !!BIT_TEST(progress, 15);
   progress += (frame_finished == 0) ? const_info[type].phase_1
                                     : const_info[type].phase_2;
@@ -166,6 +170,7 @@ Building::build_progress() {
 
 void
 Building::increase_mining(int res) {
+  wake_up();
   active = true;
 
   if (progress == 0x8000) {
@@ -224,6 +229,7 @@ Building::set_first_knight(unsigned int serf) {
 
 Serf*
 Building::call_defender_out() {
+  wake_up();
   /* Remove knight from stats of defending building */
   if (has_inventory()) { /* Castle */
     game->get_player(get_owner())->decrease_castle_knights();
@@ -245,6 +251,7 @@ Building::call_defender_out() {
 
 Serf*
 Building::call_attacker_out(int) {
+  wake_up();
   stock[0].available -= 1;
 
   /* Unlink knight from list. */
@@ -277,6 +284,7 @@ Building::military_gold_count() const {
 
 void
 Building::cancel_transported_resource(Resource::Type res) {
+  wake_up();
   if (res == Resource::TypeFish ||
       res == Resource::TypeMeat ||
       res == Resource::TypeBread) {
@@ -302,6 +310,7 @@ Building::cancel_transported_resource(Resource::Type res) {
 
 bool
 Building::add_requested_resource(Resource::Type res, bool fix_priority) {
+  wake_up();
   for (int j = 0; j < kMaxStock; j++) {
     if (stock[j].type == res) {
       if (fix_priority) {
@@ -322,6 +331,7 @@ Building::add_requested_resource(Resource::Type res, bool fix_priority) {
 void
 Building::stock_init(unsigned int stock_num, Resource::Type res_type,
                      unsigned int maximum) {
+  wake_up();
   stock[stock_num].type = res_type;
   stock[stock_num].prio = 0;
   stock[stock_num].maximum = maximum;
@@ -329,6 +339,7 @@ Building::stock_init(unsigned int stock_num, Resource::Type res_type,
 
 void
 Building::requested_resource_delivered(Resource::Type resource) {
+  wake_up();
   if (burning) {
     return;
   }
@@ -359,6 +370,7 @@ Building::requested_resource_delivered(Resource::Type resource) {
 
 void
 Building::requested_knight_arrived() {
+  wake_up();
   stock[0].available += 1;
   stock[0].requested -= 1;
 }
@@ -379,6 +391,7 @@ Building::is_enough_place_for_knight() const {
 
 bool
 Building::knight_come_back_from_fight(Serf *knight) {
+  wake_up();
   if (is_enough_place_for_knight()) {
     stock[0].available += 1;
     Serf *serf = game->get_serf(first_knight);
@@ -392,6 +405,7 @@ Building::knight_come_back_from_fight(Serf *knight) {
 
 void
 Building::knight_occupy() {
+  wake_up();
   if (!has_knight()) {
     stock[0].available = 0;
     stock[0].requested = 1;
@@ -402,6 +416,7 @@ Building::knight_occupy() {
 
 bool
 Building::burnup() {
+  wake_up();
   if (is_burning()) {
     return true;
   }
@@ -481,7 +496,7 @@ Building::burnup() {
     }
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos flag_pos = map->move_down_right(pos);
   if (map->paths(flag_pos) == 0 &&
     map->get_obj(flag_pos) == Map::ObjectFlag) {
@@ -512,7 +527,7 @@ Building::update_military_flag_state() {
   };
 
   int f, k;
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   for (f = 3, k = 0; f > 0; f--) {
     int offset;
     while ((offset = border_check_offsets[k++]) >= 0) {
@@ -537,11 +552,77 @@ Building::update(unsigned int tick) {
     }
   } else {
     update();
+    asleep = is_idle();
+  }
+}
+
+/* Whether update() would leave the building as it is until something
+   calls wake_up(). Only holds while update() depends on nothing but the
+   state of the building itself. */
+bool
+Building::is_idle() const {
+  if (burning) {
+    return false;
+  }
+
+  if (constructing) {
+    switch (type) {
+      case TypeNone:
+      case TypeCastle:
+        return true;
+      case TypeStock:
+      case TypeFarm:
+      case TypeButcher:
+      case TypePigFarm:
+      case TypeBaker:
+      case TypeSawmill:
+      case TypeSteelSmelter:
+      case TypeToolMaker:
+      case TypeWeaponSmith:
+      case TypeTower:
+      case TypeFortress:
+      case TypeGoldSmelter:
+        /* Waiting for the leveling digger. */
+        return (progress == 0) && (holder || serf_requested);
+      default:
+        return false;
+    }
+  }
+
+  bool serf_done = serf_request_failed || holder || serf_requested;
+  switch (type) {
+    case TypeFisher:
+    case TypeLumberjack:
+    case TypeStonecutter:
+    case TypeForester:
+    case TypeFarm:
+      return serf_done;
+    case TypeButcher:
+    case TypeBaker:
+    case TypeSawmill:
+      /* Priority only depends on the stock. */
+      return serf_done;
+    case TypeBoatbuilder:
+    case TypeStoneMine:
+    case TypeCoalMine:
+    case TypeIronMine:
+    case TypeGoldMine:
+    case TypePigFarm:
+    case TypeMill:
+    case TypeToolMaker:
+    case TypeWeaponSmith:
+    case TypeSteelSmelter:
+    case TypeGoldSmelter:
+      /* Priority also depends on the settings of the player. */
+      return serf_done && !holder;
+    default:
+      return false;
   }
 }
 
 void
 Building::requested_serf_lost() {
+  wake_up();
   if (serf_requested) {
     serf_requested = false;
   } else if (!has_inventory()) {
@@ -551,6 +632,7 @@ Building::requested_serf_lost() {
 
 void
 Building::requested_serf_reached(Serf *serf) {
+  wake_up();
   holder = true;
   if (serf_requested) {
     first_knight = serf->get_index();
@@ -560,12 +642,14 @@ Building::requested_serf_reached(Serf *serf) {
 
 void
 Building::knight_request_granted() {
+  wake_up();
   stock[0].requested += 1;
   serf_requested = false;
 }
 
 void
 Building::remove_stock() {
+  wake_up();
   stock[0].available = 0;
   stock[0].requested = 0;
   stock[1].available = 0;
@@ -590,6 +674,7 @@ Building::get_max_priority_for_resource(
 
 bool
 Building::use_resource_in_stock(int stock_num) {
+  wake_up();
   if (stock[stock_num].available > 0) {
     stock[stock_num].available -= 1;
     return true;
@@ -599,6 +684,7 @@ Building::use_resource_in_stock(int stock_num) {
 
 bool
 Building::use_resources_in_stocks() {
+  wake_up();
   if (stock[0].available > 0 && stock[1].available > 0) {
     stock[0].available -= 1;
     stock[1].available -= 1;
@@ -615,7 +701,7 @@ Building::request_serf_if_needed() {
     Resource::Type res_type_2;
   } Request;
 
-  Request requests[] = {
+  static const Request requests[] = {
     {Serf::TypeNone       , Resource::TypeNone   , Resource::TypeNone  },
     {Serf::TypeFisher     , Resource::TypeRod    , Resource::TypeNone  },
     {Serf::TypeLumberjack , Resource::TypeAxe    , Resource::TypeNone  },
@@ -752,7 +838,7 @@ Building::update() {
           }
 
           /* TODO Following code looks like a hack */
-          PMap map = game->get_map();
+          Map *map = game->get_map();
           MapPos flag_pos = map->move_down_right(pos);
           if (map->has_serf(flag_pos)) {
             Serf *serf = game->get_serf_at_pos(flag_pos);
@@ -1117,7 +1203,7 @@ Building::update_castle() {
     }
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos flag_pos = map->move_down_right(pos);
   if (map->has_serf(flag_pos)) {
     Serf *serf = game->get_serf_at_pos(flag_pos);
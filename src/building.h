@@ -94,6 +94,8 @@ class Building : public GameObject {
   bool burning;
   bool active;
   bool holder;
+  /* Update has nothing to do until something changes the building. */
+  bool asleep;
   /* Index of flag connected to this building */
   unsigned int flag;
   /* Stock of this building */
@@ -133,7 +135,7 @@ class Building : public GameObject {
                                     (type == TypeCastle); }
   /* Owning player of the building. */
   unsigned int get_owner() const { return owner; }
-  void set_owner(unsigned int new_owner) { owner = new_owner; }
+  void set_owner(unsigned int new_owner) { owner = new_owner; wake_up(); }
   /* Whether construction of the building is finished. */
   bool is_done() const { return !constructing; }
   bool is_leveling() const { return (!is_done() && progress == 0); }
@@ -142,7 +144,7 @@ class Building : public GameObject {
   int get_progress() const { return progress; }
   bool build_progress();
   void increase_mining(int res);
-  void set_under_attack() { progress |= BIT(0); }
+  void set_under_attack() { progress |= BIT(0); wake_up(); }
   bool is_under_attack() const { return BIT_TEST(progress, 0); }
 
   /* The threat level of the building. Higher values mean that
@@ -162,11 +164,16 @@ class Building : public GameObject {
   /* Building has an associated serf. */
   bool has_serf() const { return holder; }
   /* Building has succesfully requested a serf. */
-  void serf_request_granted() { serf_requested = true; }
+  void serf_request_granted() { serf_requested = true; wake_up(); }
   void requested_serf_lost();
   void requested_serf_reached(Serf *serf);
   /* Building has requested a serf but none was available. */
-  void clear_serf_request_failure() { serf_request_failed = false; }
+  void clear_serf_request_failure() {
+    if (serf_request_failed) {
+      serf_request_failed = false;
+      wake_up();
+    }
+  }
   void knight_request_granted();
 
   /* Building has inventory and the inventory pointer is valid. */
@@ -210,30 +217,35 @@ class Building : public GameObject {
   int get_requested_in_stock(int stock_num) const {
     return stock[stock_num].requested; }
   void set_priority_in_stock(int stock_num, int priority) {
-    stock[stock_num].prio = priority; }
+    stock[stock_num].prio = priority; wake_up(); }
   void set_initial_res_in_stock(int stock_num, int count) {
-    stock[stock_num].available = count; }
+    stock[stock_num].available = count; wake_up(); }
   void requested_resource_delivered(Resource::Type resource);
   void plank_used_for_build() {
-    stock[0].available -= 1; stock[0].maximum -= 1; }
+    stock[0].available -= 1; stock[0].maximum -= 1; wake_up(); }
   void stone_used_for_build() {
-    stock[1].available -= 1; stock[1].maximum -= 1; }
+    stock[1].available -= 1; stock[1].maximum -= 1; wake_up(); }
   bool use_resource_in_stock(int stock_num);
   bool use_resources_in_stocks();
   void decrease_requested_for_stock(int stock_num) {
-    stock[stock_num].requested -= 1; }
+    stock[stock_num].requested -= 1; wake_up(); }
 
   int pigs_count() const { return stock[1].available; }
-  void send_pig_to_butcher() { stock[1].available -= 1; }
-  void place_new_pig() { stock[1].available += 1; }
+  void send_pig_to_butcher() { stock[1].available -= 1; wake_up(); }
+  void place_new_pig() { stock[1].available += 1; wake_up(); }
 
-  void boat_clear() { stock[1].available = 0; }
-  void boat_do() { stock[1].available++; }
+  void boat_clear() { stock[1].available = 0; wake_up(); }
+  void boat_do() { stock[1].available++; wake_up(); }
 
   void requested_knight_arrived();
-  void requested_knight_attacking_on_walk() { stock[0].requested -= 1; }
+  void requested_knight_attacking_on_walk() {
+    stock[0].requested -= 1; wake_up(); }
   void requested_knight_defeat_on_walk() {
-    if (!has_inventory()) stock[0].requested -= 1; }
+    if (!has_inventory()) {
+      stock[0].requested -= 1;
+      wake_up();
+    }
+  }
   bool is_enough_place_for_knight() const;
   bool knight_come_back_from_fight(Serf *knight);
   void knight_occupy();
@@ -241,6 +253,8 @@ class Building : public GameObject {
   void update_military_flag_state();
 
   void update(unsigned int tick);
+  /* Whether update() can be skipped, see is_idle(). */
+  bool is_asleep() const { return asleep; }
 
   friend SaveReaderBinary&
     operator >> (SaveReaderBinary &reader, Building &building);
@@ -250,6 +264,10 @@ class Building : public GameObject {
     operator << (SaveWriterText &writer, Building &building);
 
  private:
+  /* Called by everything that changes what update() depends on. */
+  void wake_up() { asleep = false; }
+  bool is_idle() const;
+
   void update();
   void update_unfinished();
   void update_unfinished_adv();
@@ -0,0 +1,448 @@
+/*
+ * data-profiler.cc - Data decoding profiling tool.
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "src/command_line.h"
+#include "src/log.h"
+#include "src/version.h"
+#include "src/buffer.h"
+#include "src/data.h"
+#include "src/debug.h"
+#include "src/pixel-kernels.h"
+#include "src/bitplanes.h"
+#include "src/tpwm.h"
+
+typedef std::vector<uint32_t> Pixels;
+
+static double
+measure(std::function<void()> func) {
+  auto start = std::chrono::steady_clock::now();
+  func();
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> elapsed = end - start;
+  return elapsed.count();
+}
+
+static void
+report(const std::string &name, double ms, const std::string &extra = "") {
+  std::stringstream line;
+  line << std::setw(24) << std::left << name << std::right
+       << std::fixed << std::setprecision(3) << std::setw(10) << ms << " ms"
+       << extra;
+  Log::Info["profiler"] << line.str();
+}
+
+// Run every pixel kernel on sprite sized buffers for each implementation
+// level supported by this CPU.
+static void
+profile_kernels(unsigned int iterations) {
+  const size_t count = 64 * 64;
+  std::mt19937 rng(1);
+  Pixels a(count);
+  Pixels b(count);
+  for (size_t i = 0; i < count; i++) {
+    a[i] = rng();
+    b[i] = ((i / 16) % 2 == 0) ? (rng() | 0xFF000000) : (rng() & 0x00FFFFFF);
+  }
+  Pixels dst(count);
+
+  for (int level = PixelKernels::LevelScalar;
+       level <= PixelKernels::get_supported_level(); level++) {
+    PixelKernels::set_level(static_cast<PixelKernels::Level>(level));
+    const PixelKernels::Table &k = PixelKernels::get();
+    std::string name = PixelKernels::get_level_name(
+                                      static_cast<PixelKernels::Level>(level));
+
+    std::vector<std::pair<std::string, std::function<void()>>> kernels = {
+      { "mask", [&]() { k.mask(dst.data(), a.data(), b.data(), count); } },
+      { "create_mask",
+        [&]() { k.create_mask(dst.data(), a.data(), b.data(), count); } },
+      { "fill_masked",
+        [&]() { dst = b; k.fill_masked(dst.data(), 0xFF102030, count); } },
+      { "add", [&]() { dst = a; k.add(dst.data(), b.data(), count); } },
+      { "del", [&]() { dst = a; k.del(dst.data(), b.data(), count); } },
+      { "blend", [&]() { dst = a; k.blend(dst.data(), b.data(), count); } },
+      { "make_alpha_mask", [&]() {
+          dst = b;
+          uint8_t min = k.alpha_from_luminance(dst.data(), count);
+          k.sub_alpha(dst.data(), min, count);
+        } },
+      { "stick", [&]() { dst = a; k.stick(dst.data(), b.data(), count); } },
+    };
+
+    for (auto &kernel : kernels) {
+      double ms = measure([&]() {
+        for (unsigned int i = 0; i < iterations; i++) {
+          kernel.second();
+        }
+      });
+      report(name + " " + kernel.first, ms);
+    }
+  }
+
+  PixelKernels::set_level(PixelKernels::get_supported_level());
+}
+
+// Convert Amiga style bitplanes of a full screen picture.
+static void
+profile_bitplanes(unsigned int iterations) {
+  const size_t width = 40;  // in bytes, 8 pixels each
+  const size_t height = 200;
+  std::mt19937 rng(1);
+  std::vector<uint8_t> src(width * height * 5);
+  for (uint8_t &value : src) {
+    value = static_cast<uint8_t>(rng());
+  }
+  std::vector<uint8_t> palette(32 * 3);
+  for (uint8_t &value : palette) {
+    value = static_cast<uint8_t>(rng());
+  }
+  std::vector<Bitplanes::Color> dst(width * 8 * height);
+
+  std::vector<std::pair<std::string, std::function<void()>>> converters = {
+    { "planar", [&]() {
+        Bitplanes::decode_planar(dst.data(), src.data(), width, height,
+                                 0, 0, palette.data(), false);
+      } },
+    { "compressed", [&]() {
+        Bitplanes::decode_planar(dst.data(), src.data(), width, height,
+                                 24, 24, palette.data(), true);
+      } },
+    { "interlaced", [&]() {
+        Bitplanes::decode_interlaced(dst.data(), src.data(), width, height,
+                                     0, 0, palette.data(), 0);
+      } },
+    { "sprite", [&]() {
+        Bitplanes::decode_sprite(dst.data(), src.data(), width, height,
+                                 palette.data());
+      } },
+    { "mask", [&]() {
+        Bitplanes::decode_mask(dst.data(), src.data(), width * height);
+      } },
+  };
+
+  for (auto &converter : converters) {
+    double ms = measure([&]() {
+      for (unsigned int i = 0; i < iterations / 10; i++) {
+        converter.second();
+      }
+    });
+    double pixels = static_cast<double>(dst.size()) * (iterations / 10);
+    std::stringstream extra;
+    extra << " (" << std::setprecision(1) << std::fixed
+          << (ms > 0. ? pixels / ms / 1000. : 0.) << " Mpixel/s)";
+    report("bitplanes " + converter.first, ms, extra.str());
+  }
+}
+
+static std::string
+throughput(double bytes, double ms) {
+  std::stringstream extra;
+  extra << " (" << std::setprecision(1) << std::fixed
+        << (ms > 0. ? bytes / ms / 1000. : 0.) << " MB/s)";
+  return extra.str();
+}
+
+// Unpack a TPWM archive iterations times into the same memory.
+static double
+unpack_tpwm(PBuffer archive, unsigned int iterations, size_t *size) {
+  UnpackerTPWM unpacker(archive);
+  std::vector<uint8_t> dst(unpacker.get_unpacked_size());
+  *size = dst.size() * iterations;
+  return measure([&]() {
+    for (unsigned int i = 0; i < iterations; i++) {
+      unpacker.unpack(dst.data(), dst.size());
+    }
+  });
+}
+
+// Unpack a generated TPWM archive of 64 KB with a mix of literals and
+// short, often overlapping, stamps.
+static void
+profile_tpwm(unsigned int iterations) {
+  std::mt19937 rng(1);
+  std::vector<uint8_t> tokens;
+  size_t size = 0;
+  while (size < 0xFFF0) {
+    uint8_t flag = 0;
+    size_t flag_pos = tokens.size();
+    tokens.push_back(0);
+    for (int i = 0; i < 8; i++) {
+      if (size > 0 && rng() % 2) {
+        size_t offset = 1 + rng() % std::min<size_t>(size, 0x100);
+        size_t stamp_size = 3 + rng() % 16;
+        flag |= 0x80 >> i;
+        tokens.push_back(static_cast<uint8_t>(((offset >> 4) & 0xF0) |
+                                              (stamp_size - 3)));
+        tokens.push_back(static_cast<uint8_t>(offset & 0xFF));
+        size += stamp_size;
+      } else {
+        tokens.push_back(static_cast<uint8_t>(rng() % 32));
+        size++;
+      }
+    }
+    tokens[flag_pos] = flag;
+  }
+
+  std::vector<uint8_t> archive = { 'T', 'P', 'W', 'M',
+                                   static_cast<uint8_t>(size & 0xFF),
+                                   static_cast<uint8_t>(size >> 8) };
+  archive.insert(archive.end(), tokens.begin(), tokens.end());
+  PBuffer buffer = std::make_shared<Buffer>(archive.data(), archive.size(),
+                                            Buffer::EndianessLittle);
+  size_t total = 0;
+  double ms = unpack_tpwm(buffer, iterations / 10, &total);
+  report("tpwm generated", ms, throughput(static_cast<double>(total), ms));
+}
+
+// Unpack every data file of the data source that is a TPWM archive.
+static void
+profile_data_files(unsigned int iterations) {
+  Data::PSource source = Data::get_instance().get_data_source();
+
+  for (const std::string &path : source->get_files()) {
+    PBuffer file = std::make_shared<MappedBuffer>(path);
+    size_t total = 0;
+    double ms = 0;
+    try {
+      ms = unpack_tpwm(file, std::max(1u, iterations / 100), &total);
+    } catch (ExceptionFreeserf &) {
+      Log::Info["profiler"] << path << " is not a TPWM archive";
+      continue;
+    }
+    report("tpwm " + path.substr(path.find_last_of("/\\") + 1), ms,
+           throughput(static_cast<double>(total), ms));
+  }
+}
+
+// Decode every sprite of the data source, once without and once with a
+// player color. Return the number of sprites.
+static size_t
+decode_sprites(Data::PSource source) {
+  size_t sprites = 0;
+  for (int r = Data::AssetNone; r <= Data::AssetCursor; r++) {
+    Data::Resource res = static_cast<Data::Resource>(r);
+    if (Data::get_resource_type(res) != Data::TypeSprite) {
+      continue;
+    }
+    for (unsigned int i = 0; i < Data::get_resource_count(res); i++) {
+      if (source->get_sprite(res, i, {0, 0, 0, 0})) sprites++;
+      if (source->get_sprite(res, i, {0x00, 0xe3, 0xe3, 0xff})) sprites++;
+    }
+  }
+  return sprites;
+}
+
+static void
+profile_sprites() {
+  Data::PSource source = Data::get_instance().get_data_source();
+
+  for (int level = PixelKernels::LevelScalar;
+       level <= PixelKernels::get_supported_level(); level++) {
+    PixelKernels::set_level(static_cast<PixelKernels::Level>(level));
+    std::string name = PixelKernels::get_level_name(
+                                      static_cast<PixelKernels::Level>(level));
+
+    size_t sprites = 0;
+    double ms = measure([&]() { sprites = decode_sprites(source); });
+
+    std::stringstream extra;
+    extra << " (" << sprites << " sprites)";
+    report(name + " sprite decoding", ms, extra.str());
+  }
+
+  PixelKernels::set_level(PixelKernels::get_supported_level());
+}
+
+// Resident memory of this process in KB that is not shared with other
+// processes, such as mapped files; 0 where it is unknown.
+static size_t
+get_private_kb() {
+  std::ifstream statm("/proc/self/statm");
+  size_t total = 0;
+  size_t resident = 0;
+  size_t shared = 0;
+  if (!(statm >> total >> resident >> shared)) {
+    return 0;
+  }
+  return (resident - shared) * 4;
+}
+
+// Load the data files once read into memory and once mapped, each time in
+// a fresh data source, and report time and private memory after loading.
+static bool
+profile_mapping(const std::string &data_dir) {
+  Data &data = Data::get_instance();
+  data.set_cache_enabled(false);
+
+  for (int mapped = 0; mapped < 2; mapped++) {
+    MappedBuffer::set_mapping_enabled(mapped != 0);
+    size_t before = get_private_kb();
+    bool result = true;
+    double ms = measure([&]() { result = data.load(data_dir); });
+    if (!result) {
+      return false;
+    }
+    std::stringstream extra;
+    extra << " (" << get_private_kb() << " KB private, "
+          << before << " KB before)";
+    report(mapped ? "mapped load" : "read load", ms, extra.str());
+  }
+
+  MappedBuffer::set_mapping_enabled(true);
+  return true;
+}
+
+// Compare startup from the original data files with startup from the cache
+// of decoded data. Startup is loading plus first use of every sprite.
+static bool
+profile_startup(const std::string &data_dir) {
+  Data &data = Data::get_instance();
+  bool result = true;
+
+  data.set_cache_enabled(false);
+  double cold_load = measure([&]() { result = data.load(data_dir); });
+  if (!result) {
+    return false;
+  }
+  double cold_sprites = measure([&]() {
+    decode_sprites(data.get_data_source());
+  });
+
+  double build = measure([&]() { result = data.build_cache(); });
+  if (!result) {
+    Log::Error["profiler"] << "Data source can not be cached.";
+    return false;
+  }
+
+  data.set_cache_enabled(true);
+  double warm_load = measure([&]() { result = data.load(data_dir); });
+  if (!result) {
+    return false;
+  }
+  double warm_sprites = measure([&]() {
+    decode_sprites(data.get_data_source());
+  });
+
+  report("cold load", cold_load);
+  report("cold sprites", cold_sprites);
+  report("cold startup", cold_load + cold_sprites);
+  report("cache build", build);
+  report("warm load", warm_load);
+  report("warm sprites", warm_sprites);
+  report("warm startup", warm_load + warm_sprites);
+
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  std::string data_dir;
+  bool kernels = false;
+  bool sprites = false;
+  bool startup = false;
+  bool unpack = false;
+  bool mapping = false;
+  unsigned int iterations = 10000;
+
+  CommandLine command_line;
+  command_line.add_option('g', "Use specified data directory")
+                .add_parameter("DATA-PATH", [&data_dir](std::istream& s) {
+                  s >> data_dir;
+                  return true;
+                });
+  command_line.add_option('h', "Show this help text", [&command_line](){
+                  command_line.show_help();
+                  exit(EXIT_SUCCESS);
+                });
+  command_line.add_option('k', "Profile pixel kernels and bitplanes",
+                          [&kernels](){ kernels = true; });
+  command_line.add_option('m', "Profile loading of read and mapped files",
+                          [&mapping](){ mapping = true; });
+  command_line.add_option('n', "Number of iterations for kernels")
+                .add_parameter("NUM", [&iterations](std::istream& s) {
+                  s >> iterations;
+                  return true;
+                });
+  command_line.add_option('s', "Profile decoding of all sprites",
+                          [&sprites](){ sprites = true; });
+  command_line.add_option('t', "Profile cold and warm startup",
+                          [&startup](){ startup = true; });
+  command_line.add_option('u', "Profile unpacking of compressed data files",
+                          [&unpack](){ unpack = true; });
+  command_line.set_comment("Please report bugs to <" PACKAGE_BUGREPORT ">");
+  if (!command_line.process(argc, argv) ||
+      (!kernels && !sprites && !startup && !unpack && !mapping)) {
+    return EXIT_FAILURE;
+  }
+
+  Log::Info["profiler"] << "starts " << FREESERF_VERSION;
+
+  if (kernels) {
+    profile_kernels(iterations);
+    profile_bitplanes(iterations);
+    profile_tpwm(iterations);
+  }
+
+  if (unpack) {
+    Data &data = Data::get_instance();
+    data.set_cache_enabled(false);
+    if (!data.load(data_dir)) {
+      Log::Error["profiler"] << "Could not load game data.";
+      return EXIT_FAILURE;
+    }
+    profile_data_files(iterations);
+  }
+
+  if (sprites) {
+    // Measure decoding from the original files, not copying from the cache.
+    Data &data = Data::get_instance();
+    data.set_cache_enabled(false);
+    if (!data.load(data_dir)) {
+      Log::Error["profiler"] << "Could not load game data.";
+      return EXIT_FAILURE;
+    }
+    profile_sprites();
+  }
+
+  if (mapping && !profile_mapping(data_dir)) {
+    Log::Error["profiler"] << "Could not load game data.";
+    return EXIT_FAILURE;
+  }
+
+  if (startup && !profile_startup(data_dir)) {
+    Log::Error["profiler"] << "Could not load game data.";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -21,6 +21,7 @@
 
 #include "src/data-source-amiga.h"
 
+#include <fstream>
 #include <vector>
 #include <sstream>
 #include <string>
@@ -29,6 +30,7 @@
 #include <algorithm>
 
 #include "src/data.h"
+#include "src/bitplanes.h"
 #include "src/freeserf_endian.h"
 #include "src/sfx2wav.h"
 #include "src/log.h"
@@ -272,7 +274,8 @@ DataSourceAmiga::check() {
 bool
 DataSourceAmiga::load() {
   try {
-    gfxfast = std::make_shared<Buffer>(path + "/gfxfast", Buffer::EndianessBig);
+    gfxfast = std::make_shared<MappedBuffer>(path + "/gfxfast",
+                                             Buffer::EndianessBig);
     gfxfast = decode(gfxfast);
     gfxfast = unpack(gfxfast);
     Log::Debug["data"] << "Data file 'gfxfast' loaded (size = "
@@ -283,7 +286,8 @@ DataSourceAmiga::load() {
   }
 
   try {
-    gfxchip = std::make_shared<Buffer>(path + "/gfxchip", Buffer::EndianessBig);
+    gfxchip = std::make_shared<MappedBuffer>(path + "/gfxchip",
+                                             Buffer::EndianessBig);
     gfxchip = decode(gfxchip);
     gfxchip = unpack(gfxchip);
     Log::Debug["data"] << "Data file 'gfxchip' loaded (size = "
@@ -295,8 +299,8 @@ DataSourceAmiga::load() {
 
   PBuffer gfxheader;
   try {
-    gfxheader = std::make_shared<Buffer>(path + "/gfxheader",
-                                         Buffer::EndianessBig);
+    gfxheader = std::make_shared<MappedBuffer>(path + "/gfxheader",
+                                               Buffer::EndianessBig);
   } catch (...) {
     Log::Error["data"] << "Failed to load 'gfxheader'";
     return false;
@@ -344,7 +348,7 @@ DataSourceAmiga::load() {
   }
 
   try {
-    sound = std::make_shared<Buffer>(path + "/sounds");
+    sound = std::make_shared<MappedBuffer>(path + "/sounds");
     sound = decode(sound);
   } catch (...) {
     Log::Warn["data"] << "Failed to load 'sounds'";
@@ -352,8 +356,8 @@ DataSourceAmiga::load() {
   }
 
   try {
-    PBuffer gfxpics = std::make_shared<Buffer>(path + "/gfxpics",
-                                               Buffer::EndianessBig);
+    PBuffer gfxpics = std::make_shared<MappedBuffer>(path + "/gfxpics",
+                                                     Buffer::EndianessBig);
     for (size_t i = 0; i < 14; i++) {
       uint32_t offset = gfxpics->pop<uint32_t>();
       uint32_t size = gfxpics->pop<uint32_t>();
@@ -733,7 +737,7 @@ DataSourceAmiga::get_music(size_t /*index*/) {
 
   PBuffer data;
   try {
-    data = std::make_shared<Buffer>(path + "/music");
+    data = std::make_shared<MappedBuffer>(path + "/music");
     data = decode(data);
     data = unpack(data);
   } catch (...) {
@@ -755,6 +759,20 @@ DataSourceAmiga::get_music(size_t /*index*/) {
   return music;
 }
 
+std::list<std::string>
+DataSourceAmiga::get_files() const {
+  std::list<std::string> files;
+  for (const char *name : { "gfxheader", "gfxfast", "gfxchip", "gfxpics",
+                            "sounds", "music" }) {
+    std::string file_path = path + '/' + name;
+    std::ifstream file(file_path.c_str(), std::ios::binary);
+    if (file.good()) {
+      files.push_back(file_path);
+    }
+  }
+  return files;
+}
+
 PBuffer
 DataSourceAmiga::decode(PBuffer data) {
   PMutableBuffer result = std::make_shared<MutableBuffer>(data->get_size(),
@@ -789,16 +807,7 @@ DataSourceAmiga::unpack(PBuffer data) {
 
 unsigned int
 DataSourceAmiga::bitplane_count_from_compression(unsigned char compression) {
-  unsigned int bpp = 5;
-
-  for (int i = 0 ; i < 5 ; i++) {
-    if (compression & 0x01) {
-      bpp--;
-    }
-    compression = compression >> 1;
-  }
-
-  return bpp;
+  return Bitplanes::get_plane_count(compression);
 }
 
 DataSourceAmiga::PSpriteAmiga
@@ -826,19 +835,6 @@ DataSourceAmiga::get_icon_sprite(size_t index) {
                                filling, palette);
 }
 
-static uint8_t
-invert5bit(uint8_t src) {
-  uint8_t res = 0;
-
-  for (int i = 0; i < 5; i++) {
-    res <<= 1;
-    res |= (src & 0x01);
-    src >>= 1;
-  }
-
-  return res;
-}
-
 PBuffer
 DataSourceAmiga::get_data_from_catalog(size_t catalog_index, size_t index,
                                        PBuffer base) {
@@ -956,19 +952,15 @@ DataSourceAmiga::decode_mask_sprite(PBuffer data, size_t width, size_t height) {
 
   size_t size = width/8 * height;
 
-  uint32_t *pixel = reinterpret_cast<uint32_t*>(sprite->get_data());
-  for (unsigned int i = 0 ; i < size ; i++) {
-    uint8_t byte = data->pop<uint8_t>();
-    for (unsigned int j = 0 ; j < 8; j++) {
-      if (((byte >> (7-j)) & 0x01) == 0x01) {
-        *pixel = 0xFFFFFFFF;
-      } else {
-        *pixel = 0x00000000;
-      }
-      pixel++;
-    }
+  if (data->get_readable_size() < size) {
+    throw ExceptionFreeserf("Sprite mask exceeds its data");
   }
 
+  // Callers continue reading after the mask.
+  PBuffer mask = data->pop(size);
+  Bitplanes::decode_mask(sprite->get_writable_data(),
+                         reinterpret_cast<uint8_t*>(mask->get_data()), size);
+
   return sprite;
 }
 
@@ -1161,37 +1153,10 @@ DataSourceAmiga::decode_planned_sprite(PBuffer data, size_t width,
                                        uint8_t *palette, bool invert) {
   PSpriteAmiga sprite = std::make_shared<SpriteAmiga>(width*8, height);
 
-  uint8_t *src = reinterpret_cast<uint8_t*>(data->get_data());
-  Data::Sprite::Color *res = sprite->get_writable_data();
-
-  size_t bps = width * height;  // bitplane size in bytes
-
-  for (size_t i = 0; i < bps; i++) {
-    for (int k = 7; k >= 0; k--) {
-      uint8_t color = 0;
-      int n = 0;
-      for (size_t b = 0; b < 5; b++) {
-        color = color << 1;
-        if ((compression >> b) & 0x01) {
-          if ((filling >> b) & 0x01) {
-            color |= 0x01;
-          }
-        } else {
-          color |= ((*(src+(n*bps)) >> k) & 0x01);
-          n++;
-        }
-      }
-      if (invert) {
-        color = invert5bit(color);
-      }
-      res->red = palette[color*3+0];    // R
-      res->green = palette[color*3+1];  // G
-      res->blue = palette[color*3+2];   // B
-      res->alpha = 0xFF;                // A
-      res++;
-    }
-    src++;
-  }
+  Bitplanes::decode_planar(sprite->get_writable_data(),
+                           reinterpret_cast<uint8_t*>(data->get_data()),
+                           width, height, compression, filling, palette,
+                           invert);
 
   return sprite;
 }
@@ -1205,38 +1170,10 @@ DataSourceAmiga::decode_interlased_sprite(PBuffer data, size_t width,
                                           size_t skip_lines) {
   PSpriteAmiga sprite = std::make_shared<SpriteAmiga>(width*8, height);
 
-  uint8_t *src = reinterpret_cast<uint8_t*>(data->get_data());
-  Data::Sprite::Color *res = sprite->get_writable_data();
-
-  size_t bpp = bitplane_count_from_compression(compression);
-
-  for (size_t y = 0; y < height; y++) {
-    for (size_t i = 0; i < width; i++) {
-      for (int k = 7; k >= 0; k--) {
-        uint8_t color = 0;
-        int n = 0;
-        for (size_t b = 0; b < 5; b++) {
-          color = color << 1;
-          if ((compression >> b) & 0x01) {
-            if ((filling >> b) & 0x01) {
-              color |= 0x01;
-            }
-          } else {
-            color |= ((*(src+(n*width)+((skip_lines*width*y))) >> k) & 0x01);
-            n++;
-          }
-        }
-        color = invert5bit(color);
-        res->red = palette[color*3+0];    // R
-        res->green = palette[color*3+1];  // G
-        res->blue = palette[color*3+2];   // B
-        res->alpha = 0xFF;                // A
-        res++;
-      }
-      src++;
-    }
-    src += (bpp-1) * width;
-  }
+  Bitplanes::decode_interlaced(sprite->get_writable_data(),
+                               reinterpret_cast<uint8_t*>(data->get_data()),
+                               width, height, compression, filling, palette,
+                               skip_lines);
 
   return sprite;
 }
@@ -1246,32 +1183,9 @@ DataSourceAmiga::decode_amiga_sprite(PBuffer data, size_t width, size_t height,
                                      uint8_t *palette) {
   PSpriteAmiga sprite = std::make_shared<SpriteAmiga>(width*8, height);
 
-  uint8_t *src_1 = reinterpret_cast<uint8_t*>(data->get_data());
-  size_t bp2s = width * 2 * height;
-  uint8_t *src_2 = src_1 + bp2s;
-  Data::Sprite::Color *res = sprite->get_writable_data();
-
-  for (size_t y = 0; y < height; y++) {
-    for (size_t i = 0; i < width; i++) {
-      for (int k = 7; k >= 0; k--) {
-        uint8_t color = 0;
-        color |= (((*src_1) >> k) & 0x01) << 0;
-        color |= (((*(src_1 + width)) >> k) & 0x01) << 1;
-        color |= (((*src_2) >> k) & 0x01) << 2;
-        color |= (((*(src_2 + width)) >> k) & 0x01) << 3;
-        color |= 0x10;
-        res->red = palette[color*3+0];    // R
-        res->green = palette[color*3+1];  // G
-        res->blue = palette[color*3+2];   // B
-        res->alpha = 0xFF;                // A
-        res++;
-      }
-      src_1++;
-      src_2++;
-    }
-    src_1 += width;
-    src_2 += width;
-  }
+  Bitplanes::decode_sprite(sprite->get_writable_data(),
+                           reinterpret_cast<uint8_t*>(data->get_data()),
+                           width, height, palette);
 
   return sprite;
 }
@@ -22,6 +22,7 @@
 #ifndef SRC_DATA_SOURCE_AMIGA_H_
 #define SRC_DATA_SOURCE_AMIGA_H_
 
+#include <list>
 #include <string>
 #include <map>
 #include <array>
@@ -70,6 +71,8 @@ class DataSourceAmiga : public DataSourceLegacy {
   virtual Data::MusicFormat get_music_format() { return Data::MusicFormatMod; }
   virtual PBuffer get_music(size_t index);
 
+  virtual std::list<std::string> get_files() const;
+
  private:
   PBuffer gfxfast;
   PBuffer gfxchip;
@@ -0,0 +1,453 @@
+/*
+ * data-source-cache.cc - Cache of decoded game resources
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/data-source-cache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "src/buffer.h"
+#include "src/log.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// Bump whenever the layout of the cache or the output of any decoder
+// changes.
+#define CACHE_VERSION  2
+
+static const char cache_magic[8] = { 'F', 'S', 'C', 'A', 'C', 'H', 'E', 0 };
+
+// Sprite with its own copy of the cached pixels, callers are free to modify
+// it.
+class SpriteCached : public SpriteBase {
+ public:
+  SpriteCached(const DataSourceCache::Entry *entry, const void *pixels) {
+    delta_x = entry->delta_x;
+    delta_y = entry->delta_y;
+    offset_x = entry->offset_x;
+    offset_y = entry->offset_y;
+    create(entry->width, entry->height);
+    memcpy(data, pixels, width * height * 4);
+  }
+};
+
+DataSourceCache::DataSourceCache(Data::PSource _source,
+                                 const std::string &_cache_path)
+  : DataSourceBase(_source->get_path())
+  , source(_source)
+  , cache_path(_cache_path) {
+}
+
+DataSourceCache::~DataSourceCache() {
+}
+
+bool
+DataSourceCache::check() {
+  std::ifstream file(cache_path.c_str(), std::ios::binary);
+  if (!file.good()) {
+    return false;
+  }
+
+  Header header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file.good() ||
+      (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0) ||
+      (header.version != CACHE_VERSION)) {
+    Log::Info["data"] << "Cache '" << cache_path << "' has unknown format";
+    return false;
+  }
+
+  uint64_t checksum = get_checksum(source);
+  if ((checksum == 0) || (checksum != header.checksum)) {
+    Log::Info["data"] << "Cache '" << cache_path << "' is outdated";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+DataSourceCache::load() {
+  try {
+    cache = std::make_shared<MappedBuffer>(cache_path);
+  } catch (...) {
+    return false;
+  }
+
+  const uint8_t *begin = reinterpret_cast<const uint8_t*>(cache->get_data());
+  size_t size = cache->get_size();
+  if (size < sizeof(Header)) {
+    return false;
+  }
+
+  const Header *header = reinterpret_cast<const Header*>(begin);
+  size_t count = header->entry_count;
+  if ((size - sizeof(Header)) / sizeof(Entry) < count) {
+    return false;
+  }
+
+  const Entry *table = reinterpret_cast<const Entry*>(begin + sizeof(Header));
+  entries.clear();
+  entries.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    const Entry *entry = &table[i];
+    if ((entry->offset > size) || (entry->size > size - entry->offset)) {
+      Log::Warn["data"] << "Cache '" << cache_path << "' is damaged";
+      return false;
+    }
+    if (((entry->kind == KindSpriteMask) || (entry->kind == KindSpriteImage))
+        && (entry->size != uint64_t(entry->width) * entry->height * 4)) {
+      Log::Warn["data"] << "Cache '" << cache_path << "' is damaged";
+      return false;
+    }
+    entries[make_key(static_cast<Kind>(entry->kind), entry->resource,
+                     entry->index)] = entry;
+  }
+
+  animation_table.clear();
+  for (unsigned int i = 0;
+       i < Data::get_resource_count(Data::AssetAnimation); i++) {
+    std::vector<Data::Animation> animations;
+    const Entry *entry = find(KindAnimation, Data::AssetAnimation, i);
+    if (entry != nullptr) {
+      const AnimationPhase *phases =
+                 reinterpret_cast<const AnimationPhase*>(begin + entry->offset);
+      for (size_t j = 0; j < entry->size / sizeof(AnimationPhase); j++) {
+        animations.push_back({static_cast<uint8_t>(phases[j].sprite),
+                              phases[j].x, phases[j].y});
+      }
+    }
+    animation_table.push_back(animations);
+  }
+
+  loaded = true;
+  Log::Verbose["data"] << "Cache '" << cache_path << "' loaded ("
+                       << count << " entries, size = " << size << ")";
+
+  return true;
+}
+
+Data::MaskImage
+DataSourceCache::get_sprite_parts(Data::Resource res, size_t index) {
+  return std::make_tuple(make_sprite(find(KindSpriteMask, res, index)),
+                         make_sprite(find(KindSpriteImage, res, index)));
+}
+
+PBuffer
+DataSourceCache::get_sound(size_t index) {
+  const Entry *entry = find(KindSound, Data::AssetSound, index);
+  if (entry == nullptr) {
+    Log::Error["data"] << "Could not find cached sound: #" << index;
+    return nullptr;
+  }
+
+  return cache->get_subbuffer(entry->offset, entry->size);
+}
+
+PBuffer
+DataSourceCache::get_music(size_t index) {
+  const Entry *entry = find(KindMusic, Data::AssetMusic, index);
+  if (entry == nullptr) {
+    Log::Error["data"] << "Could not find cached music: #" << index;
+    return nullptr;
+  }
+
+  return cache->get_subbuffer(entry->offset, entry->size);
+}
+
+bool
+DataSourceCache::build(Data::PSource source, const std::string &cache_path) {
+  uint64_t checksum = get_checksum(source);
+  if (checksum == 0) {
+    return false;
+  }
+
+  // Write to a temporary file first, so that an interrupted build never
+  // leaves a truncated cache behind. It is created before decoding, which
+  // is wasted when the cache can not be written.
+  std::string tmp_path = cache_path + ".tmp";
+  std::ofstream file(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!file.good()) {
+    Log::Warn["data"] << "Failed to create cache '" << tmp_path << "'";
+    set_build_failed(cache_path, checksum);
+    return false;
+  }
+
+  std::vector<Entry> table;
+  PMutableBuffer blob = std::make_shared<MutableBuffer>(
+                                                      Buffer::EndianessLittle);
+
+  // Offsets are relative to the blob until the size of the table is known.
+  auto add = [&table, &blob](Kind kind, unsigned int res, unsigned int index,
+                             const void *data, size_t size) -> Entry & {
+    Entry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.kind = kind;
+    entry.resource = res;
+    entry.index = index;
+    entry.offset = blob->get_size();
+    entry.size = size;
+    blob->push(data, size);
+    // Keep pixel data aligned for vector loads.
+    size_t padding = (16 - (blob->get_size() % 16)) % 16;
+    blob->push<uint8_t>(0, padding);
+    table.push_back(entry);
+    return table.back();
+  };
+
+  auto add_sprite = [&add](Kind kind, unsigned int res, unsigned int index,
+                           Data::PSprite sprite) {
+    if (!sprite) {
+      return;
+    }
+    Entry &entry = add(kind, res, index, sprite->get_data(),
+                       sprite->get_width() * sprite->get_height() * 4);
+    entry.delta_x = sprite->get_delta_x();
+    entry.delta_y = sprite->get_delta_y();
+    entry.offset_x = sprite->get_offset_x();
+    entry.offset_y = sprite->get_offset_y();
+    entry.width = static_cast<uint32_t>(sprite->get_width());
+    entry.height = static_cast<uint32_t>(sprite->get_height());
+  };
+
+  try {
+    for (int r = Data::AssetNone; r <= Data::AssetCursor; r++) {
+      Data::Resource res = static_cast<Data::Resource>(r);
+      unsigned int count = Data::get_resource_count(res);
+      switch (Data::get_resource_type(res)) {
+        case Data::TypeSprite:
+          for (unsigned int i = 0; i < count; i++) {
+            Data::MaskImage parts = source->get_sprite_parts(res, i);
+            add_sprite(KindSpriteMask, res, i, std::get<0>(parts));
+            add_sprite(KindSpriteImage, res, i, std::get<1>(parts));
+          }
+          break;
+        case Data::TypeAnimation:
+          for (unsigned int i = 0; i < count; i++) {
+            std::vector<AnimationPhase> phases;
+            size_t phase_count = source->get_animation_phase_count(i);
+            for (size_t j = 0; j < phase_count; j++) {
+              Data::Animation a = source->get_animation(i, j << 3);
+              phases.push_back({a.sprite, a.x, a.y});
+            }
+            add(KindAnimation, res, i, phases.data(),
+                phases.size() * sizeof(AnimationPhase));
+          }
+          break;
+        case Data::TypeSound:
+          for (unsigned int i = 0; i < count; i++) {
+            PBuffer sound = source->get_sound(i);
+            if (sound) {
+              add(KindSound, res, i, sound->get_data(), sound->get_size());
+            }
+          }
+          break;
+        case Data::TypeMusic: {
+          // Some sources return the same track for every index.
+          PBuffer previous;
+          for (unsigned int i = 0; i < count; i++) {
+            PBuffer music = source->get_music(i);
+            if (!music) {
+              continue;
+            }
+            if (previous && (previous->get_data() == music->get_data())) {
+              Entry entry = table.back();
+              entry.index = i;
+              table.push_back(entry);
+            } else {
+              add(KindMusic, res, i, music->get_data(), music->get_size());
+            }
+            previous = music;
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  } catch (ExceptionFreeserf &e) {
+    Log::Warn["data"] << "Failed to build cache: " << e.what();
+    file.close();
+    std::remove(tmp_path.c_str());
+    set_build_failed(cache_path, checksum);
+    return false;
+  }
+
+  Header header;
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version = CACHE_VERSION;
+  header.entry_count = static_cast<uint32_t>(table.size());
+  header.checksum = checksum;
+
+  uint64_t data_start = sizeof(Header) + table.size() * sizeof(Entry);
+  data_start = (data_start + 15) & ~uint64_t(15);
+  for (Entry &entry : table) {
+    entry.offset += data_start;
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(table.data()),
+             table.size() * sizeof(Entry));
+  std::vector<char> padding(data_start - sizeof(Header) -
+                            table.size() * sizeof(Entry), 0);
+  file.write(padding.data(), padding.size());
+  file.write(reinterpret_cast<const char*>(blob->get_data()),
+             blob->get_size());
+  file.close();
+  if (!file.good()) {
+    Log::Warn["data"] << "Failed to write cache '" << tmp_path << "'";
+    std::remove(tmp_path.c_str());
+    set_build_failed(cache_path, checksum);
+    return false;
+  }
+
+  std::remove(cache_path.c_str());
+  if (std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+    Log::Warn["data"] << "Failed to replace cache '" << cache_path << "'";
+    std::remove(tmp_path.c_str());
+    set_build_failed(cache_path, checksum);
+    return false;
+  }
+  std::remove(get_failed_path(cache_path).c_str());
+
+  Log::Info["data"] << "Cache '" << cache_path << "' written ("
+                    << table.size() << " entries, size = "
+                    << data_start + blob->get_size() << ")";
+
+  return true;
+}
+
+// Marker left by a failed build, holding the checksum of the source.
+std::string
+DataSourceCache::get_failed_path(const std::string &cache_path) {
+  return cache_path + ".failed";
+}
+
+void
+DataSourceCache::set_build_failed(const std::string &cache_path,
+                                  uint64_t checksum) {
+  std::ofstream marker(get_failed_path(cache_path).c_str(), std::ios::trunc);
+  marker << checksum;
+}
+
+bool
+DataSourceCache::is_build_failed(Data::PSource source,
+                                 const std::string &cache_path) {
+  std::ifstream marker(get_failed_path(cache_path).c_str());
+  uint64_t checksum = 0;
+  if (!(marker >> checksum)) {
+    return false;
+  }
+  return (checksum == get_checksum(source));
+}
+
+std::string
+DataSourceCache::get_default_path(Data::PSource source) {
+  std::string folder;
+#ifdef _WIN32
+  const char *base = std::getenv("LOCALAPPDATA");
+  folder = (base != nullptr) ? base : ".";
+  folder += "/freeserf";
+  _mkdir(folder.c_str());
+#else
+  const char *base = std::getenv("XDG_CACHE_HOME");
+  if ((base != nullptr) && (base[0] != 0)) {
+    folder = base;
+  } else {
+    base = std::getenv("HOME");
+    folder = (base != nullptr) ? base : ".";
+    folder += "/.cache";
+    mkdir(folder.c_str(), S_IRWXU);
+  }
+  folder += "/freeserf";
+  mkdir(folder.c_str(), S_IRWXU);
+#endif
+
+  std::string name = source->get_name();
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+  return folder + "/data-" + name + ".cache";
+}
+
+// FNV-1a over names, sizes and modification times of all files of the
+// source.
+uint64_t
+DataSourceCache::get_checksum(Data::PSource source) {
+  const uint64_t prime = 0x100000001b3ull;
+  uint64_t hash = 0xcbf29ce484222325ull;
+
+  std::list<std::string> files = source->get_files();
+  if (files.empty()) {
+    return 0;
+  }
+
+  for (const std::string &file : files) {
+    struct stat info;
+    if (stat(file.c_str(), &info) != 0) {
+      return 0;
+    }
+
+    for (char c : file) {
+      hash = (hash ^ static_cast<uint8_t>(c)) * prime;
+    }
+    hash = (hash ^ static_cast<uint64_t>(info.st_size)) * prime;
+    hash = (hash ^ static_cast<uint64_t>(info.st_mtime)) * prime;
+  }
+
+  return (hash != 0) ? hash : 1;
+}
+
+uint64_t
+DataSourceCache::make_key(Kind kind, unsigned int resource,
+                          unsigned int index) {
+  return (uint64_t(kind) << 48) | (uint64_t(resource) << 32) | index;
+}
+
+const DataSourceCache::Entry *
+DataSourceCache::find(Kind kind, unsigned int resource,
+                      unsigned int index) const {
+  auto it = entries.find(make_key(kind, resource, index));
+  if (it == entries.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+Data::PSprite
+DataSourceCache::make_sprite(const Entry *entry) const {
+  if (entry == nullptr) {
+    return nullptr;
+  }
+
+  const uint8_t *begin = reinterpret_cast<const uint8_t*>(cache->get_data());
+  return std::make_shared<SpriteCached>(entry, begin + entry->offset);
+}
@@ -0,0 +1,129 @@
+/*
+ * data-source-cache.h - Cache of decoded game resources
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_DATA_SOURCE_CACHE_H_
+#define SRC_DATA_SOURCE_CACHE_H_
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "src/data-source.h"
+
+// Serves sprites, animations, sounds and music of another data source from
+// a file holding all of them already decoded. The file is memory-mapped, so
+// neither the original data files nor the cache are decoded on start. The
+// cache is tied to the sizes and modification times of the files of the
+// original source and is rejected by check() as soon as they change. A build
+// that failed is not repeated for the same files until requested.
+class DataSourceCache : public DataSourceBase {
+ public:
+  typedef enum Kind {
+    KindSpriteMask = 0,
+    KindSpriteImage,
+    KindAnimation,
+    KindSound,
+    KindMusic,
+  } Kind;
+
+  typedef struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint64_t checksum;
+  } Header;
+
+  typedef struct Entry {
+    uint32_t kind;
+    uint32_t resource;
+    uint32_t index;
+    int32_t delta_x;
+    int32_t delta_y;
+    int32_t offset_x;
+    int32_t offset_y;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+  } Entry;
+
+  typedef struct AnimationPhase {
+    int32_t sprite;
+    int32_t x;
+    int32_t y;
+  } AnimationPhase;
+
+ protected:
+  Data::PSource source;
+  std::string cache_path;
+  PBuffer cache;
+  std::unordered_map<uint64_t, const Entry*> entries;
+
+ public:
+  DataSourceCache(Data::PSource source, const std::string &cache_path);
+  virtual ~DataSourceCache();
+
+  virtual std::string get_name() const { return source->get_name(); }
+  virtual std::string get_path() const { return source->get_path(); }
+  virtual unsigned int get_scale() const { return source->get_scale(); }
+  virtual unsigned int get_bpp() const { return source->get_bpp(); }
+
+  // Source must have been checked already, it is never loaded.
+  virtual bool check();
+  virtual bool load();
+
+  virtual Data::MaskImage get_sprite_parts(Data::Resource res, size_t index);
+
+  virtual PBuffer get_sound(size_t index);
+  virtual Data::MusicFormat get_music_format() {
+    return source->get_music_format();
+  }
+  virtual PBuffer get_music(size_t index);
+
+  virtual std::list<std::string> get_files() const {
+    return source->get_files();
+  }
+
+  virtual bool is_thread_safe() const { return true; }
+
+  // Decode every resource of the loaded source and write it to cache_path.
+  static bool build(Data::PSource source, const std::string &cache_path);
+  // Whether the last build for the current files of source failed.
+  static bool is_build_failed(Data::PSource source,
+                              const std::string &cache_path);
+  // Default location of the cache for source in the user cache folder.
+  static std::string get_default_path(Data::PSource source);
+  // Checksum of the sizes and modification times of the files of source,
+  // 0 if it can not be cached. Cheap enough to run on every start.
+  static uint64_t get_checksum(Data::PSource source);
+
+ protected:
+  static uint64_t make_key(Kind kind, unsigned int resource,
+                           unsigned int index);
+  static std::string get_failed_path(const std::string &cache_path);
+  static void set_build_failed(const std::string &cache_path,
+                               uint64_t checksum);
+  const Entry *find(Kind kind, unsigned int resource, unsigned int index) const;
+  Data::PSprite make_sprite(const Entry *entry) const;
+};
+
+#endif  // SRC_DATA_SOURCE_CACHE_H_
@@ -125,7 +125,7 @@ DataSourceDOS::load() {
   }
 
   try {
-    spae = std::make_shared<Buffer>(path);
+    spae = std::make_shared<MappedBuffer>(path);
   } catch (...) {
     return false;
   }
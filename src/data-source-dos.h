@@ -22,6 +22,7 @@
 #ifndef SRC_DATA_SOURCE_DOS_H_
 #define SRC_DATA_SOURCE_DOS_H_
 
+#include <list>
 #include <string>
 #include <vector>
 #include <memory>
@@ -116,6 +117,11 @@ class DataSourceDOS : public DataSourceLegacy {
   virtual Data::MusicFormat get_music_format() { return Data::MusicFormatMidi; }
   virtual PBuffer get_music(size_t index);
 
+  virtual std::list<std::string> get_files() const { return { path }; }
+
+  // Every sprite is decoded from its own view of the data file.
+  virtual bool is_thread_safe() const { return true; }
+
  protected:
   PBuffer get_object(size_t index);
   void fixup();
@@ -25,6 +25,7 @@
 #include <sys/stat.h>
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 
 #include "src/freeserf_endian.h"
@@ -33,6 +34,7 @@
 #include "src/data.h"
 #include "src/sfx2wav.h"
 #include "src/xmi2mid.h"
+#include "src/pixel-kernels.h"
 
 DataSourceBase::DataSourceBase(const std::string &_path)
   : path(_path)
@@ -118,18 +120,21 @@ SpriteBase::get_masked(Data::PSprite mask) {
   uint32_t *s_beg = reinterpret_cast<uint32_t*>(data);
   uint32_t *s_pos = s_beg;
   uint32_t *s_end = s_beg + (width * height);
-  size_t s_delta = width - masked->get_width();
 
   uint32_t *m_pos = reinterpret_cast<uint32_t*>(mask->get_data());
 
+  // Lines of the sprite are repeated from the top when the mask is higher.
+  // Wrapping only ever happens at the start of a line.
+  size_t m_width = masked->get_width();
+  const PixelKernels::Table &kernels = PixelKernels::get();
   for (size_t y = 0; y < masked->get_height(); y++) {
-    for (size_t x = 0; x < masked->get_width(); x++) {
-      if (s_pos >= s_end) {
-        s_pos = s_beg;
-      }
-      *pos++ = *s_pos++ & *m_pos++;
+    if (s_pos >= s_end) {
+      s_pos = s_beg;
     }
-    s_pos += s_delta;
+    kernels.mask(pos, s_pos, m_pos, m_width);
+    pos += m_width;
+    m_pos += m_width;
+    s_pos += width;
   }
 
   return masked;
@@ -147,13 +152,7 @@ SpriteBase::create_mask(Data::PSprite other) {
   uint32_t *src2 = reinterpret_cast<uint32_t*>(other->get_data());
   uint32_t *res = reinterpret_cast<uint32_t*>(result->get_data());
 
-  for (unsigned int i = 0; i < width * height; i++) {
-    if (*src1++ == *src2++) {
-      *res++ = 0x00000000;
-    } else {
-      *res++ = 0xFFFFFFFF;
-    }
-  }
+  PixelKernels::get().create_mask(res, src1, src2, width * height);
 
   return result;
 }
@@ -168,14 +167,10 @@ SpriteBase::fill(Data::Sprite::Color color) {
 
 void
 SpriteBase::fill_masked(Data::Sprite::Color color) {
-  Data::Sprite::Color *res = reinterpret_cast<Data::Sprite::Color*>(data);
-
-  for (unsigned int i = 0; i < width * height; i++) {
-    if ((res->alpha & 0xFF) != 0x00) {
-      *res = color;
-    }
-    res++;
-  }
+  uint32_t value;
+  memcpy(&value, &color, sizeof(value));
+  PixelKernels::get().fill_masked(reinterpret_cast<uint32_t*>(data), value,
+                                  width * height);
 }
 
 void
@@ -187,11 +182,7 @@ SpriteBase::add(Data::PSprite other) {
   uint32_t *src = reinterpret_cast<uint32_t*>(other->get_data());
   uint32_t *res = reinterpret_cast<uint32_t*>(data);
 
-  for (unsigned int i = 0; i < width * height; i++) {
-    *res++ += *src++;
-  }
-
-  return;
+  PixelKernels::get().add(res, src, width * height);
 }
 
 void
@@ -203,14 +194,7 @@ SpriteBase::del(Data::PSprite other) {
   uint32_t *src = reinterpret_cast<uint32_t*>(other->get_data());
   uint32_t *res = reinterpret_cast<uint32_t*>(data);
 
-  for (unsigned int i = 0; i < width * height; i++) {
-    if (*src++ == 0xFFFFFFFF) {
-      *res = 0x00000000;
-    }
-    res++;
-  }
-
-  return;
+  PixelKernels::get().del(res, src, width * height);
 }
 
 void
@@ -219,40 +203,9 @@ SpriteBase::blend(Data::PSprite other) {
     return;
   }
 
-#define UNMULTIPLY(color, a) ((0xFF * (color)) / (a))
-#define BLEND(back, front, a) (((front) * (a)) + ((back) * (0xFF - (a)))) / 0xFF
-
-  Color *c = reinterpret_cast<Color*>(data);
-  Color *o = reinterpret_cast<Color*>(other->get_data());
-  for (unsigned int i = 0; i < width * height; i++) {
-    const uint32_t alpha = o->alpha;
-
-    if (alpha == 0x00) {
-      c++;
-      o++;
-      continue;
-    }
-
-    if (alpha == 0xFF) {
-      *c++ = *o++;
-      continue;
-    }
-
-    const uint8_t backR = c->red;
-    const uint8_t backG = c->green;
-    const uint8_t backB = c->blue;
-
-    const uint8_t frontR = UNMULTIPLY(o->red, alpha);
-    const uint8_t frontG = UNMULTIPLY(o->green, alpha);
-    const uint8_t frontB = UNMULTIPLY(o->blue, alpha);
-
-    const uint32_t R = BLEND(backR, frontR, alpha);
-    const uint32_t G = BLEND(backG, frontG, alpha);
-    const uint32_t B = BLEND(backB, frontB, alpha);
-
-    *c++ = {(uint8_t)B, (uint8_t)G, (uint8_t)R, 0xFF};
-    o++;
-  }
+  PixelKernels::get().blend(reinterpret_cast<uint32_t*>(data),
+                            reinterpret_cast<uint32_t*>(other->get_data()),
+                            width * height);
 
   delta_x = other->get_delta_x();
   delta_y = other->get_delta_y();
@@ -260,47 +213,26 @@ SpriteBase::blend(Data::PSprite other) {
 
 void
 SpriteBase::make_alpha_mask() {
-  Color *c = reinterpret_cast<Color*>(data);
-  uint8_t min = 0xFF;
-  for (unsigned int i = 0; i < width * height; i++) {
-    if (c->alpha != 0x00) {
-      c->alpha = 0xff - static_cast<uint8_t>((0.21 * c->red) +
-                                             (0.72 * c->green) +
-                                             (0.07 * c->blue));
-      c->red = 0;
-      c->green = 0;
-      c->blue = 0;
-      min = std::min(min, c->alpha);
-    }
-    c++;
-  }
-
-  c = reinterpret_cast<Color*>(data);
-  for (unsigned int i = 0; i < width * height; i++) {
-    if (c->alpha != 0x00) {
-      c->alpha = c->alpha - min;
-    }
-    c++;
-  }
+  const PixelKernels::Table &kernels = PixelKernels::get();
+  uint32_t *pixels = reinterpret_cast<uint32_t*>(data);
+  uint8_t min = kernels.alpha_from_luminance(pixels, width * height);
+  kernels.sub_alpha(pixels, min, width * height);
 }
 
 void
 SpriteBase::stick(Data::PSprite sticker, unsigned int dx, unsigned int dy) {
-  Color *base = reinterpret_cast<Color*>(data);
-  Color *stkr = reinterpret_cast<Color*>(sticker->get_data());
+  uint32_t *base = reinterpret_cast<uint32_t*>(data);
+  uint32_t *stkr = reinterpret_cast<uint32_t*>(sticker->get_data());
   size_t w = std::min(width, sticker->get_width());
   size_t h = std::min(height, sticker->get_height());
 
+  const PixelKernels::Table &kernels = PixelKernels::get();
   base += dy * width;
   for (size_t y = 0; y < w; y++) {
     base += dx;
-    for (size_t x = 0; x < h; x++) {
-      Color pixel = *stkr++;
-      if ((pixel.alpha & 0xFF) != 0x00) {
-        *base = pixel;
-      }
-      base++;
-    }
+    kernels.stick(base, stkr, h);
+    base += h;
+    stkr += h;
   }
 
   delta_x = sticker->get_delta_x();
@@ -23,6 +23,7 @@
 #define SRC_DATA_SOURCE_H_
 
 #include <string>
+#include <list>
 #include <memory>
 #include <tuple>
 #include <vector>
@@ -111,6 +112,12 @@ class DataSourceBase : public Data::Source {
 
   bool check_file(const std::string &path);
 
+  virtual std::list<std::string> get_files() const {
+    return std::list<std::string>();
+  }
+
+  virtual bool is_thread_safe() const { return false; }
+
  protected:
   Data::MaskImage separate_sprites(Data::PSprite s1, Data::PSprite s2);
 };
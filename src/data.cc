@@ -21,6 +21,7 @@
 
 #include "src/data.h"
 
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <utility>
@@ -31,6 +32,7 @@
 #include "src/data-source-dos.h"
 #include "src/data-source-amiga.h"
 #include "src/data-source-custom.h"
+#include "src/data-source-cache.h"
 
 #ifdef _WIN32
 // need for GetModuleFileName
@@ -81,7 +83,10 @@ DataResource data_resources[] = {
   { Data::AssetCursor,       Data::TypeSprite,    1,   "cursor"        },
 };
 
-Data::Data() : data_source(nullptr) {}
+Data::Data()
+  : data_source(nullptr)
+  , cache_enabled(true) {
+}
 
 Data &
 Data::get_instance() {
@@ -98,6 +103,9 @@ Data::~Data() {
 // given path is empty string.
 bool
 Data::load(const std::string &path) {
+  auto start = std::chrono::steady_clock::now();
+  data_source = nullptr;
+
   // If it is possible, prefer DOS game data.
   typedef std::function<Data::PSource(const std::string &)> SourceFactory;
   std::vector<SourceFactory> sources_factories;
@@ -122,8 +130,19 @@ Data::load(const std::string &path) {
       if (source->check()) {
         Log::Info["data"] << "Game data found in '" << source->get_path()
                           << "'...";
+        if (cache_enabled && !source->get_files().empty()) {
+          Data::PSource cache = std::make_shared<DataSourceCache>(source,
+                                   DataSourceCache::get_default_path(source));
+          if (cache->check() && cache->load()) {
+            data_source = std::move(cache);
+            break;
+          }
+        }
         if (source->load()) {
           data_source = std::move(source);
+          if (cache_enabled) {
+            build_cache_once();
+          }
           break;
         }
       }
@@ -133,7 +152,45 @@ Data::load(const std::string &path) {
     }
   }
 
-  return data_source.get() != nullptr;
+  if (!data_source) {
+    return false;
+  }
+
+  std::chrono::duration<double, std::milli> elapsed =
+                                      std::chrono::steady_clock::now() - start;
+  Log::Info["data"] << "Game data loaded in "
+                    << static_cast<int>(elapsed.count()) << " ms";
+
+  return true;
+}
+
+// Decode all resources of the current data source and store them in the
+// cache, so that the next load() can skip decoding.
+bool
+Data::build_cache() {
+  if (!data_source || data_source->get_files().empty()) {
+    return false;
+  }
+
+  return DataSourceCache::build(data_source,
+                                DataSourceCache::get_default_path(data_source));
+}
+
+// Build the cache after the first load, unless building it failed for the
+// same files before. Run with -c to try again.
+void
+Data::build_cache_once() {
+  if (data_source->get_files().empty()) {
+    return;
+  }
+
+  std::string cache_path = DataSourceCache::get_default_path(data_source);
+  if (DataSourceCache::is_build_failed(data_source, cache_path)) {
+    Log::Info["data"] << "Building the cache failed before, "
+                      << "run with -c to try again";
+    return;
+  }
+  DataSourceCache::build(data_source, cache_path);
 }
 
 // Return standard game data search paths for current platform.
@@ -152,12 +152,20 @@ class Data {
     virtual PBuffer get_music(size_t index) = 0;
 
     virtual bool check_file(const std::string &path) = 0;
+
+    // Whether sprites may be requested from several threads at once.
+    virtual bool is_thread_safe() const = 0;
+
+    // Files the decoded assets are derived from, empty if the source can
+    // not be cached.
+    virtual std::list<std::string> get_files() const = 0;
   };
 
   typedef std::shared_ptr<Source> PSource;
 
  protected:
   PSource data_source;
+  bool cache_enabled;
 
   Data();
 
@@ -171,6 +179,11 @@ class Data {
 
   bool load(const std::string &path);
 
+  // Cache of decoded assets, see DataSourceCache.
+  void set_cache_enabled(bool enabled) { cache_enabled = enabled; }
+  bool is_cache_enabled() const { return cache_enabled; }
+  bool build_cache();
+
   PSource get_data_source() const { return data_source; }
 
   static Type get_resource_type(Resource resource);
@@ -179,6 +192,7 @@ class Data {
 
  protected:
   std::list<std::string> get_standard_search_paths() const;
+  void build_cache_once();
 };
 
 #endif  // SRC_DATA_H_
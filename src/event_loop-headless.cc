@@ -0,0 +1,71 @@
+/*
+ * event_loop-headless.cc - Event loop without any input devices
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/event_loop-headless.h"
+
+#include "src/gfx.h"
+
+EventLoop &
+EventLoop::get_instance() {
+  static EventLoopHeadless event_loop;
+  return event_loop;
+}
+
+void
+EventLoopHeadless::deferred_call(DeferredCall call, void *data) {
+  deferred_calls.push_back(call);
+}
+
+void
+EventLoopHeadless::run() {
+  Graphics &gfx = Graphics::get_instance();
+  Frame *screen = gfx.get_screen_frame();
+
+  quit_requested = false;
+  while (!quit_requested) {
+    while (!deferred_calls.empty()) {
+      deferred_calls.front()(nullptr);
+      deferred_calls.pop_front();
+    }
+
+    notify_update();
+    notify_draw(screen);
+    gfx.swap_buffers();
+  }
+
+  delete screen;
+}
+
+class TimerHeadless : public Timer {
+ public:
+  TimerHeadless(unsigned int _id, unsigned int _interval,
+                Timer::Handler *_handler)
+    : Timer(_id, _interval, _handler) {}
+
+  virtual void run() {}
+  virtual void stop() {}
+};
+
+Timer *
+Timer::create(unsigned int _id, unsigned int _interval,
+              Timer::Handler *_handler) {
+  return new TimerHeadless(_id, _interval, _handler);
+}
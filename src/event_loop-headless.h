@@ -0,0 +1,44 @@
+/*
+ * event_loop-headless.h - Event loop without any input devices
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_EVENT_LOOP_HEADLESS_H_
+#define SRC_EVENT_LOOP_HEADLESS_H_
+
+#include <list>
+
+#include "src/event_loop.h"
+
+/* Runs update/draw steps back to back until quit() is called. There is no
+   input and timers never fire. */
+class EventLoopHeadless : public EventLoop {
+ protected:
+  std::list<DeferredCall> deferred_calls;
+  bool quit_requested;
+
+ public:
+  EventLoopHeadless() : quit_requested(false) {}
+
+  virtual void quit() { quit_requested = true; }
+  virtual void run();
+  virtual void deferred_call(DeferredCall call, void *data);
+};
+
+#endif  // SRC_EVENT_LOOP_HEADLESS_H_
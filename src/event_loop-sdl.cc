@@ -41,10 +41,19 @@ EventLoop::get_instance() {
  considered as a double click. */
 #define MOUSE_MOVE_SENSITIVITY  8
 
+/* Game updates run per frame at most, to catch up with wall clock time. */
+#define MAX_STEPS_PER_FRAME  5
+/* Backlog of game updates beyond which time is given up, one second. */
+#define MAX_STEPS_BEHIND  TICKS_PER_SEC
+/* Frames in a row that may be skipped while catching up. */
+#define MAX_SKIPPED_FRAMES  4
+
 EventLoopSDL::EventLoopSDL()
   : zoom_factor(1.f)
   , screen_factor_x(1.f)
-  , screen_factor_y(1.f) {
+  , screen_factor_y(1.f)
+  , step_clock(TICK_LENGTH, MAX_STEPS_PER_FRAME, MAX_STEPS_BEHIND,
+               MAX_SKIPPED_FRAMES) {
   SDL_InitSubSystem(SDL_INIT_EVENTS | SDL_INIT_TIMER);
 
   eventUserTypeStep = SDL_RegisterEvents(2);
@@ -57,15 +66,20 @@ EventLoopSDL::EventLoopSDL()
 Uint32
 EventLoopSDL::timer_callback(Uint32 interval, void *param) {
   EventLoopSDL *eventLoop = static_cast<EventLoopSDL*>(param);
+  eventLoop->push_step();
+
+  return interval;
+}
+
+void
+EventLoopSDL::push_step() {
   SDL_Event event;
-  event.type = eventLoop->eventUserTypeStep;
-  event.user.type = eventLoop->eventUserTypeStep;
+  event.type = eventUserTypeStep;
+  event.user.type = eventUserTypeStep;
   event.user.code = 0;
   event.user.data1 = 0;
   event.user.data2 = 0;
   SDL_PushEvent(&event);
-
-  return interval;
 }
 
 void
@@ -111,6 +125,7 @@ EventLoopSDL::run() {
 
   Graphics &gfx = Graphics::get_instance();
   Frame *screen = nullptr;
+  step_clock.reset();
   gfx.get_screen_factor(&screen_factor_x, &screen_factor_y);
 
   while (SDL_WaitEvent(&event)) {
@@ -293,18 +308,29 @@ EventLoopSDL::run() {
         break;
       default:
         if (event.type == eventUserTypeStep) {
-          // Update and draw interface
-          notify_update();
-
-          if (screen == nullptr) {
-            screen = gfx.get_screen_frame();
+          // Update as often as the time passed since the last frame requires
+          unsigned int steps = step_clock.advance(SDL_GetTicks());
+          for (unsigned int i = 0; i < steps; i++) {
+            notify_update();
           }
-          notify_draw(screen);
 
-          // Swap video buffers
-          gfx.swap_buffers();
+          // Draw interface, unless catching up with the game
+          if (step_clock.frame_ready()) {
+            if (screen == nullptr) {
+              screen = gfx.get_screen_frame();
+            }
+            notify_draw(screen);
+
+            // Swap video buffers
+            gfx.swap_buffers();
+          }
 
           SDL_FlushEvent(eventUserTypeStep);
+
+          // Continue catching up after pending input is handled
+          if (step_clock.get_ticks_behind() > 0) {
+            push_step();
+          }
         }
     }
   }
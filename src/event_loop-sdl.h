@@ -41,6 +41,7 @@ class EventLoopSDL : public EventLoop {
   float screen_factor_x;
   float screen_factor_y;
   Uint32 eventUserTypeStep;
+  StepClock step_clock;
 
  public:
   EventLoopSDL();
@@ -48,8 +49,10 @@ class EventLoopSDL : public EventLoop {
   virtual void quit();
   virtual void run();
   virtual void deferred_call(DeferredCall call, void *data);
+  virtual const StepClock *get_step_clock() const { return &step_clock; }
 
  protected:
+  void push_step();
   void zoom(float delta);
   static Uint32 timer_callback(Uint32 interval, void *param);
 };
@@ -23,6 +23,67 @@
 
 #include <algorithm>
 
+StepClock::StepClock(unsigned int _step_length, unsigned int _max_steps,
+                     unsigned int _max_backlog,
+                     unsigned int _max_skipped_frames)
+  : step_length(_step_length)
+  , max_steps(_max_steps)
+  , max_backlog(_max_backlog)
+  , max_skipped_frames(_max_skipped_frames)
+  , max_ticks_behind(0)
+  , dropped_ticks(0)
+  , dropped_frames(0) {
+  reset();
+}
+
+void
+StepClock::reset() {
+  started = false;
+  last_time = 0;
+  accumulated = 0;
+  skipped_in_row = 0;
+  ticks_behind = 0;
+}
+
+unsigned int
+StepClock::advance(uint32_t now) {
+  if (!started) {
+    // The first frame runs one step, there is no time to measure yet.
+    started = true;
+    last_time = now;
+    accumulated = step_length;
+  } else {
+    accumulated += now - last_time;
+    last_time = now;
+  }
+
+  unsigned int due = accumulated / step_length;
+  if (due > max_backlog) {
+    dropped_ticks += due - max_backlog;
+    accumulated -= (due - max_backlog) * step_length;
+    due = max_backlog;
+  }
+
+  unsigned int steps = std::min(due, max_steps);
+  accumulated -= steps * step_length;
+  ticks_behind = due - steps;
+  max_ticks_behind = std::max(max_ticks_behind, ticks_behind);
+
+  return steps;
+}
+
+bool
+StepClock::frame_ready() {
+  if ((ticks_behind > 0) && (skipped_in_row < max_skipped_frames)) {
+    skipped_in_row++;
+    dropped_frames++;
+    return false;
+  }
+
+  skipped_in_row = 0;
+  return true;
+}
+
 EventLoop *
 EventLoop::instance = nullptr;
 
@@ -22,6 +22,7 @@
 #ifndef SRC_EVENT_LOOP_H_
 #define SRC_EVENT_LOOP_H_
 
+#include <cstdint>
 #include <list>
 #include <functional>
 
@@ -79,6 +80,47 @@ class Timer {
                        Handler *_handler);
 };
 
+// Fixed timestep accumulator. Elapsed wall clock time is turned into whole
+// simulation steps, at most max_steps per frame. Time that can not be caught
+// up within max_backlog steps is dropped.
+class StepClock {
+ protected:
+  unsigned int step_length;
+  unsigned int max_steps;
+  unsigned int max_backlog;
+  unsigned int max_skipped_frames;
+
+  bool started;
+  uint32_t last_time;
+  uint32_t accumulated;
+  unsigned int skipped_in_row;
+
+  unsigned int ticks_behind;
+  unsigned int max_ticks_behind;
+  uint64_t dropped_ticks;
+  uint64_t dropped_frames;
+
+ public:
+  StepClock(unsigned int step_length, unsigned int max_steps,
+            unsigned int max_backlog, unsigned int max_skipped_frames);
+
+  void reset();
+
+  // Number of steps to run for wall clock time now, in ms.
+  unsigned int advance(uint32_t now);
+  // Whether the frame should be drawn after running the steps. Frames are
+  // skipped while behind, but not more than max_skipped_frames in a row.
+  bool frame_ready();
+
+  // Steps still owed to the simulation after the last advance().
+  unsigned int get_ticks_behind() const { return ticks_behind; }
+  unsigned int get_max_ticks_behind() const { return max_ticks_behind; }
+  // Steps given up because the backlog grew too large.
+  uint64_t get_dropped_ticks() const { return dropped_ticks; }
+  // Frames not drawn to catch up with the simulation.
+  uint64_t get_dropped_frames() const { return dropped_frames; }
+};
+
 class EventLoop {
  public:
   class Handler {
@@ -107,6 +149,9 @@ class EventLoop {
   void add_handler(Handler *handler);
   void del_handler(Handler *handler);
 
+  // Timing of the update steps, for loops that follow wall clock time.
+  virtual const StepClock *get_step_clock() const { return nullptr; }
+
  protected:
   EventLoop();
 
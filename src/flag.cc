@@ -104,6 +104,7 @@ Flag::Flag(Game *game, unsigned int index)
 
 void
 Flag::add_path(Direction dir, bool water) {
+  game->get_serf_search_cache()->network_changed();
   path_con |= BIT(dir);
   if (water) {
     endpoint &= ~BIT(dir);
@@ -299,8 +300,8 @@ Flag::schedule_slot_to_unknown_dest(int slot_num) {
 
     search.execute(schedule_unknown_dest_cb, false, true, &data);
     if (data.flag != nullptr) {
-      Log::Verbose["game"] << "dest for flag " << index << " res " << slot
-                           << " found: flag " << data.flag->get_index();
+      LOG_VERBOSE(log_game) << "dest for flag " << index << " res " << slot
+                            << " found: flag " << data.flag->get_index();
       Building *dest_bld = data.flag->other_endpoint.b[DirectionUpLeft];
 
       if (!dest_bld->add_requested_resource(res, true)) {
@@ -560,6 +561,7 @@ Flag::get_road_length_value(size_t length) {
 void
 Flag::link_with_flag(Flag *dest_flag, bool water_path, size_t length_,
                      Direction in_dir, Direction out_dir) {
+  game->get_serf_search_cache()->network_changed();
   dest_flag->add_path(in_dir, water_path);
   add_path(out_dir, water_path);
 
@@ -578,6 +580,7 @@ Flag::link_with_flag(Flag *dest_flag, bool water_path, size_t length_,
 
 void
 Flag::restore_path_serf_info(Direction dir, SerfPathInfo *data) {
+  game->get_serf_search_cache()->network_changed();
   const int max_path_serfs[] = { 1, 2, 3, 4, 6, 8, 11, 15 };
 
   Flag *other_flag = game->get_flag(data->flag_index);
@@ -675,7 +678,7 @@ wake_transporter_on_path(Game *game, MapPos pos) {
 void
 Flag::fill_path_serf_info(Game *game, MapPos pos, Direction dir,
                           SerfPathInfo *data) {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (map->get_idle_serf(pos)) wake_transporter_at_flag(game, pos);
 
   int serf_count = 0;
@@ -756,9 +759,10 @@ Flag::fill_path_serf_info(Game *game, MapPos pos, Direction dir,
 
 void
 Flag::merge_paths(MapPos pos_) {
+  game->get_serf_search_cache()->network_changed();
   const int max_transporters[] = { 1, 2, 3, 4, 6, 8, 11, 15 };
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (!map->paths(pos_)) {
     return;
   }
@@ -1011,8 +1015,15 @@ Flag::reset_destination_of_stolen_resources() {
   }
 }
 
+void
+Flag::set_has_inventory() {
+  bld_flags |= BIT(6);
+  game->get_serf_search_cache()->network_changed();
+}
+
 void
 Flag::link_building(Building *building) {
+  game->get_serf_search_cache()->network_changed();
   other_endpoint.b[DirectionUpLeft] = building;
   endpoint |= BIT(6);
 }
@@ -158,7 +158,7 @@ class Flag : public GameObject {
   /* Whether this inventory accepts serfs. */
   bool accepts_serfs() const { return ((bld_flags >> 7) & 1); }
 
-  void set_has_inventory() { bld_flags |= BIT(6); }
+  void set_has_inventory();
   void set_accepts_resources(bool accepts) { accepts ? bld2_flags |= BIT(7) :
                                                        bld2_flags &= ~BIT(7); }
   void set_accepts_serfs(bool accepts) { accepts ? bld_flags |= BIT(7) :
@@ -31,6 +31,7 @@
 #include "src/gfx.h"
 #include "src/interface.h"
 #include "src/game-manager.h"
+#include "src/map-cache.h"
 #include "src/command_line.h"
 
 #ifdef WIN32
@@ -45,8 +46,12 @@ main(int argc, char *argv[]) {
   unsigned int screen_width = 0;
   unsigned int screen_height = 0;
   bool fullscreen = false;
+  bool build_cache = false;
+  bool threaded = false;
 
   CommandLine command_line;
+  command_line.add_option('c', "Build cache of decoded game data and exit",
+                          [&build_cache](){ build_cache = true; });
   command_line.add_option('d', "Set Debug output level")
                 .add_parameter("NUM", [](std::istream& s) {
                   int d;
@@ -67,6 +72,8 @@ main(int argc, char *argv[]) {
                   command_line.show_help();
                   exit(EXIT_SUCCESS);
                 });
+  command_line.add_option('k', "Keep generated maps in a cache on disk",
+                          [](){ MapCache::get_instance().set_enabled(true); });
   command_line.add_option('l', "Load saved game")
                 .add_parameter("FILE", [&save_file](std::istream& s) {
                   std::getline(s, save_file);
@@ -80,19 +87,35 @@ main(int argc, char *argv[]) {
                   s >> screen_height;
                   return true;
                 });
+  command_line.add_option('t', "Run game simulation on a separate thread",
+                          [&threaded](){ threaded = true; });
   command_line.set_comment("Please report bugs to <" PACKAGE_BUGREPORT ">");
   if (!command_line.process(argc, argv)) {
     return EXIT_FAILURE;
   }
 
+  // Keep the game and render threads from waiting on console output.
+  Log::set_async(true);
+
   Log::Info["main"] << "freeserf " << FREESERF_VERSION;
 
   Data &data = Data::get_instance();
+  if (build_cache) {
+    // Decode from the original files, an existing cache may be outdated.
+    data.set_cache_enabled(false);
+  }
   if (!data.load(data_dir)) {
     Log::Error["main"] << "Could not load game data.";
+    Log::set_async(false);
     return EXIT_FAILURE;
   }
 
+  if (build_cache) {
+    bool built = data.build_cache();
+    Log::set_async(false);
+    return built ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   Log::Info["main"] << "Initialize graphics...";
 
   Graphics &gfx = Graphics::get_instance();
@@ -110,10 +133,12 @@ main(int argc, char *argv[]) {
      start a new game. */
   if (!save_file.empty()) {
     if (!game_manager.load_game(save_file)) {
+      Log::set_async(false);
       return EXIT_FAILURE;
     }
   } else {
     if (!game_manager.start_random_game()) {
+      Log::set_async(false);
       return EXIT_FAILURE;
     }
   }
@@ -125,6 +150,7 @@ main(int argc, char *argv[]) {
   }
   interface.set_size(screen_width, screen_height);
   interface.set_displayed(true);
+  interface.set_threaded(threaded);
 
   if (save_file.empty()) {
     interface.open_game_init();
@@ -139,7 +165,23 @@ main(int argc, char *argv[]) {
 
   event_loop.del_handler(&interface);
 
+  const Graphics::HitchStats &hitches = gfx.get_hitch_stats();
+  Log::Info["main"] << "Sprites decoded while drawing: " << hitches.count
+                    << " (" << static_cast<int>(hitches.total) << " ms, max "
+                    << static_cast<int>(hitches.max) << " ms), prefetched: "
+                    << hitches.prefetched;
+
+  const StepClock *clock = event_loop.get_step_clock();
+  if (clock != nullptr) {
+    Log::Info["main"] << "Frames skipped to catch up: "
+                      << clock->get_dropped_frames() << ", game updates "
+                      << "dropped: " << clock->get_dropped_ticks()
+                      << ", max updates behind: "
+                      << clock->get_max_ticks_behind();
+  }
+
   Log::Info["main"] << "Cleaning up...";
+  Log::set_async(false);
 
   return EXIT_SUCCESS;
 }
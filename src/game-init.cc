@@ -32,8 +32,7 @@
 #include "src/version.h"
 #include "src/text-input.h"
 #include "src/minimap.h"
-#include "src/map-generator.h"
-#include "src/map-geometry.h"
+#include "src/map-preview.h"
 #include "src/list.h"
 #include "src/game-manager.h"
 #include "src/popup.h"
@@ -91,6 +90,7 @@ class RandomInput : public TextInput {
 GameInitBox::GameInitBox(Interface *interface)
   : random_input(new RandomInput())
   , minimap(new Minimap(nullptr))
+  , preview(new MapPreview())
   , file_list(new ListSavedFiles()) {
   this->interface = interface;
 
@@ -118,9 +118,10 @@ GameInitBox::GameInitBox(Interface *interface)
   file_list->set_size(160, 160);
   file_list->set_displayed(false);
   file_list->set_selection_handler([this](const std::string &item) {
+    preview->cancel();
     Game game;
     if (GameStore::get_instance().load(item, &game)) {
-      this->map = game.get_map();
+      this->map = game.get_shared_map();
       this->minimap->set_map(map);
     }
   });
@@ -330,6 +331,7 @@ GameInitBox::handle_action(int action) {
           break;
         }
         case GameLoad: {
+          preview->cancel();
           random_input->set_displayed(false);
           file_list->set_displayed(true);
           break;
@@ -546,22 +548,21 @@ GameInitBox::handle_player_click(unsigned int player_index, int cx, int cy) {
   return true;
 }
 
+// Generate the map of the selected mission in the background, the minimap
+// keeps showing the previous map until update() picks up the new one.
 void
 GameInitBox::generate_map_preview() {
-  map.reset(new Map(MapGeometry(mission->get_map_size())));
-  if (game_type == GameMission) {
-    ClassicMissionMapGenerator generator(*map, mission->get_random_base());
-    generator.init();
-    generator.generate();
-    map->init_tiles(generator);
-  } else {
-    ClassicMapGenerator generator(*map, mission->get_random_base());
-    generator.init(MapGenerator::HeightGeneratorMidpoints, true);
-    generator.generate();
-    map->init_tiles(generator);
-  }
-
-  minimap->set_map(map);
+  preview->generate(mission->get_map_size(), mission->get_random_base(),
+                    game_type == GameMission);
+}
 
-  set_redraw();
+/* Called periodically while the box is open. */
+void
+GameInitBox::update() {
+  PMap new_map = preview->take_map();
+  if (new_map) {
+    map = new_map;
+    minimap->set_map(map);
+    set_redraw();
+  }
 }
@@ -32,6 +32,7 @@
 class Interface;
 class RandomInput;
 class Minimap;
+class MapPreview;
 class ListSavedFiles;
 
 class GameInitBox : public GuiObject {
@@ -65,12 +66,15 @@ class GameInitBox : public GuiObject {
   std::unique_ptr<RandomInput> random_input;
   PMap map;
   std::unique_ptr<Minimap> minimap;
+  std::unique_ptr<MapPreview> preview;
   std::unique_ptr<ListSavedFiles> file_list;
 
  public:
   explicit GameInitBox(Interface *interface);
   virtual ~GameInitBox();
 
+  void update();
+
  protected:
   void draw_box_icon(int x, int y, int sprite);
   void draw_box_string(int x, int y, const std::string &str);
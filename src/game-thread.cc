@@ -0,0 +1,179 @@
+/*
+ * game-thread.cc - Game simulation on a dedicated thread
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/game-thread.h"
+
+#include <chrono>
+#include <utility>
+
+#include "src/freeserf.h"
+#include "src/event_loop.h"
+#include "src/render-snapshot.h"
+
+/* Game updates run in one go at most, to catch up with wall clock time. */
+#define MAX_STEPS_PER_BATCH  5
+
+GameThread::GameThread(PGame _game, SnapshotPublisher *_snapshots)
+  : game(std::move(_game))
+  , snapshots(_snapshots)
+  , quit(false)
+  , state_locked(false)
+  , simulation_waiting(false) {
+}
+
+GameThread::~GameThread() {
+  stop();
+}
+
+void
+GameThread::start() {
+  if (thread.joinable()) {
+    return;
+  }
+
+  quit = false;
+  thread = std::thread(&GameThread::run, this);
+}
+
+void
+GameThread::stop() {
+  if (!thread.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    quit = true;
+  }
+  wakeup.notify_all();
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+  }
+  state_released.notify_all();
+  thread.join();
+}
+
+void
+GameThread::post(Command command) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    commands.push_back(std::move(command));
+  }
+  wakeup.notify_all();
+}
+
+void
+GameThread::lock() {
+  std::unique_lock<std::mutex> lock(state_mutex);
+  state_released.wait(lock, [this]() {
+    return !state_locked && !simulation_waiting;
+  });
+  state_locked = true;
+}
+
+void
+GameThread::unlock() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    state_locked = false;
+  }
+  state_released.notify_all();
+}
+
+bool
+GameThread::lock_for_update() {
+  std::unique_lock<std::mutex> lock(state_mutex);
+  simulation_waiting = true;
+  state_released.wait(lock, [this]() { return quit || !state_locked; });
+  simulation_waiting = false;
+  if (quit) {
+    lock.unlock();
+    state_released.notify_all();
+    return false;
+  }
+  state_locked = true;
+  return true;
+}
+
+void
+GameThread::run() {
+  typedef std::chrono::steady_clock Clock;
+
+  StepClock clock(TICK_LENGTH, MAX_STEPS_PER_BATCH, TICKS_PER_SEC, 0);
+  Clock::time_point start = Clock::now();
+
+  while (!quit) {
+    Clock::time_point batch_start = Clock::now();
+    uint32_t now = static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        batch_start - start).count());
+    unsigned int steps = clock.advance(now);
+
+    if (!run_commands(clock.get_ticks_behind())) {
+      return;
+    }
+
+    for (unsigned int i = 0; i < steps; i++) {
+      if (!lock_for_update()) {
+        return;
+      }
+      game->update();
+      if (i + 1 == steps) {
+        snapshots->publish(clock.get_ticks_behind());
+      }
+      unlock();
+    }
+
+    if (clock.get_ticks_behind() > 0) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    wakeup.wait_until(lock, batch_start +
+                            std::chrono::milliseconds(TICK_LENGTH),
+                      [this]() { return quit || !commands.empty(); });
+  }
+}
+
+bool
+GameThread::run_commands(unsigned int ticks_behind) {
+  std::deque<Command> pending;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    pending.swap(commands);
+  }
+
+  if (pending.empty()) {
+    return true;
+  }
+
+  if (!lock_for_update()) {
+    return false;
+  }
+  for (Command &command : pending) {
+    command(game.get());
+  }
+  // Show the result without waiting for the next tick.
+  snapshots->publish(ticks_behind);
+  unlock();
+
+  return true;
+}
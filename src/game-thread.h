@@ -0,0 +1,83 @@
+/*
+ * game-thread.h - Game simulation on a dedicated thread
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_GAME_THREAD_H_
+#define SRC_GAME_THREAD_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "src/game.h"
+
+class SnapshotPublisher;
+
+// Runs Game::update() on its own thread at the rate of TICK_LENGTH, catching
+// up after slow ticks like the event loop does. After every batch of ticks
+// the game is copied into a RenderSnapshot that frames are drawn from
+// without the lock. The user interface changes the game only by posting
+// commands, which run on the simulation thread between ticks; it holds the
+// lock, through lock() and unlock(), while handling input and to read state
+// the snapshot leaves out. A waiting simulation goes first, so ticks are not
+// starved by the interface.
+class GameThread {
+ public:
+  typedef std::function<void(Game *game)> Command;
+
+ protected:
+  PGame game;
+  SnapshotPublisher *snapshots;
+  std::thread thread;
+  std::atomic<bool> quit;
+
+  std::mutex state_mutex;
+  std::condition_variable state_released;
+  bool state_locked;
+  bool simulation_waiting;
+
+  std::mutex queue_mutex;
+  std::condition_variable wakeup;
+  std::deque<Command> commands;
+
+ public:
+  GameThread(PGame game, SnapshotPublisher *snapshots);
+  virtual ~GameThread();
+
+  void start();
+  void stop();
+
+  // Run command on the simulation thread before the next tick.
+  void post(Command command);
+  // Exclusive access to the game state from other threads.
+  void lock();
+  void unlock();
+
+ protected:
+  // Wait for the game state on the simulation thread, false on stop().
+  bool lock_for_update();
+  void run();
+  bool run_commands(unsigned int ticks_behind);
+};
+
+#endif  // SRC_GAME_THREAD_H_
@@ -30,6 +30,7 @@
 #include <map>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "src/savegame.h"
 #include "src/debug.h"
@@ -37,9 +38,12 @@
 #include "src/misc.h"
 #include "src/inventory.h"
 #include "src/map.h"
+#include "src/map-cache.h"
 #include "src/map-generator.h"
 #include "src/map-geometry.h"
 
+const Log::Subsystem log_game("game");
+
 #define GROUND_ANALYSIS_RADIUS  25
 
 Game::Game()
@@ -77,6 +81,8 @@ Game::Game()
   update_map_initial_pos = 0;
   next_index = 0;
 
+  std::fill(std::begin(building_updates), std::end(building_updates),
+            BuildingUpdates{0, 0});
   std::fill(std::begin(player_history_index),
             std::end(player_history_index), 0);
   std::fill(std::begin(player_history_counter),
@@ -128,24 +134,25 @@ Game::update_knight_morale() {
   }
 }
 
-typedef struct UpdateInventoriesData {
-  Resource::Type resource;
-  int *max_prio;
-  Flag **flags;
-} UpdateInventoriesData;
+/* Building flag reached by a search from the inventories, and the index of
+   the inventory that reached it first. */
+typedef struct UpdateInventoriesVisit {
+  Flag *flag;
+  int inventory;
+} UpdateInventoriesVisit;
+
+typedef struct UpdateInventoriesSearch {
+  unsigned int player;
+  std::vector<unsigned int> sources;  // flags of the inventories
+  std::vector<UpdateInventoriesVisit> visits;
+} UpdateInventoriesSearch;
 
 bool
 Game::update_inventories_cb(Flag *flag, void *d) {
-  UpdateInventoriesData *data = reinterpret_cast<UpdateInventoriesData*>(d);
-  int inv = flag->get_search_dir();
-  if (data->max_prio[inv] < 255 && flag->has_building()) {
-    Building *building = flag->get_building();
-
-    int bld_prio = building->get_max_priority_for_resource(data->resource, 16);
-    if (bld_prio > data->max_prio[inv]) {
-      data->max_prio[inv] = bld_prio;
-      data->flags[inv] = flag;
-    }
+  std::vector<UpdateInventoriesVisit> *visits =
+    reinterpret_cast<std::vector<UpdateInventoriesVisit>*>(d);
+  if (flag->has_building()) {
+    visits->push_back({flag, flag->get_search_dir()});
   }
 
   return false;
@@ -212,6 +219,14 @@ Game::update_inventories() {
     default: arr = arr_1; break;
   }
 
+  /* The search for destinations of a resource never stops early and the
+     roads don't change until all resources are done, so searches from the
+     same inventories reach the same buildings in the same order. Each
+     search is done once and its buildings are checked for every resource.
+     Requesting a resource doesn't change the priorities of other resources
+     in buildings, so the result is the same as with separate searches. */
+  std::vector<UpdateInventoriesSearch> searches;
+
   while (arr[0] != Resource::TypeNone) {
     for (Player *player : players) {
       Inventory *invs[256];
@@ -250,28 +265,55 @@ Game::update_inventories() {
 
       if (n == 0) continue;
 
-      FlagSearch search(this);
+      std::vector<unsigned int> sources(n);
+      for (int i = 0; i < n; i++) {
+        sources[i] = invs[i]->get_flag_index();
+      }
+
+      UpdateInventoriesSearch *found = nullptr;
+      for (UpdateInventoriesSearch &search : searches) {
+        if (search.player == player->get_index() &&
+            search.sources == sources) {
+          found = &search;
+          break;
+        }
+      }
+
+      if (found == nullptr) {
+        searches.push_back({player->get_index(), sources, {}});
+        found = &searches.back();
+
+        FlagSearch search(this);
+        for (int i = 0; i < n; i++) {
+          Flag *flag = flags[sources[i]];
+          flag->set_search_dir((Direction)i);
+          search.add_source(flag);
+        }
+        search.execute(update_inventories_cb, false, true, &found->visits);
+      }
 
       int max_prio[256];
       Flag *flags_[256];
-
       for (int i = 0; i < n; i++) {
         max_prio[i] = 0;
         flags_[i] = NULL;
-        Flag *flag = flags[invs[i]->get_flag_index()];
-        flag->set_search_dir((Direction)i);
-        search.add_source(flag);
       }
 
-      UpdateInventoriesData data;
-      data.resource = arr[0];
-      data.max_prio = max_prio;
-      data.flags = flags_;
-      search.execute(update_inventories_cb, false, true, &data);
+      for (const UpdateInventoriesVisit &visit : found->visits) {
+        int inv = visit.inventory;
+        if (max_prio[inv] < 255) {
+          Building *building = visit.flag->get_building();
+          int bld_prio = building->get_max_priority_for_resource(arr[0], 16);
+          if (bld_prio > max_prio[inv]) {
+            max_prio[inv] = bld_prio;
+            flags_[inv] = visit.flag;
+          }
+        }
+      }
 
       for (int i = 0; i < n; i++) {
         if (max_prio[i] > 0) {
-          Log::Verbose["game"] << " dest for inventory " << i << "found";
+          LOG_VERBOSE(log_game) << " dest for inventory " << i << "found";
           Resource::Type res = (Resource::Type)arr[0];
 
           Building *dest_bld = flags_[i]->get_building();
@@ -409,9 +451,14 @@ Game::send_serf_to_flag(Flag *dest, Serf::Type type, Resource::Type res1,
   data.res1 = res1;
   data.res2 = res2;
 
+  if (serf_searches.is_futile(dest->get_index(), type, res1, res2)) {
+    return false;
+  }
+
   bool r = FlagSearch::single(dest, send_serf_to_flag_search_cb, true, false,
                               &data);
   if (!r) {
+    serf_searches.add_failure(dest->get_index(), type, res1, res2);
     return false;
   } else if (data.inventory != NULL) {
     Inventory *inventory = data.inventory;
@@ -465,25 +512,43 @@ Game::send_geologist(Flag *dest) {
 /* Update buildings as part of the game progression. */
 void
 Game::update_buildings() {
-  Buildings blds(buildings);
-  Buildings::Iterator i = blds.begin();
-  while (i != blds.end()) {
-    Building *building = *i;
-    ++i;
-    building->update(tick);
+  // Look buildings up by index, as a burned down building deletes itself.
+  // Buildings built meanwhile are not updated before the next tick.
+  size_t limit = buildings.get_index_limit();
+  for (unsigned int i = 0; i < limit; i++) {
+    Building *building = buildings[i];
+    if (building == nullptr) {
+      continue;
+    }
+
+    BuildingUpdates &updates = building_updates[building->get_type()];
+    if (building->is_asleep()) {
+      updates.skipped++;
+    } else {
+      updates.executed++;
+      building->update(tick);
+    }
   }
 }
 
 /* Update serfs as part of the game progression. */
 void
 Game::update_serfs() {
-  Serfs::Iterator i = serfs.begin();
-  while (i != serfs.end()) {
-    Serf *serf = *i;
-    ++i;
-    if (serf->get_index() != 0) {
+  /* Serfs that only wait for their counter are not visited. Serfs added
+     by an update are updated in the same tick. */
+  unsigned int index = 1;
+  while (true) {
+    unsigned int limit = static_cast<unsigned int>(serfs.get_index_limit());
+    index = serf_fields.count_down(index, limit, tick);
+    if (index >= limit) {
+      break;
+    }
+
+    Serf *serf = serfs[index];
+    if (serf != nullptr) {
       serf->update();
     }
+    index++;
   }
 }
 
@@ -493,18 +558,18 @@ Game::record_player_history(int max_level, int aspect,
                             const int history_index[],
                             const Values &values) {
   unsigned int total = 0;
-  for (auto value : values) {
-    total += value.second;
+  for (Player *player : players) {
+    total += values[player->get_index()];
   }
   total = std::max(1u, total);
 
   for (int i = 0; i < max_level+1; i++) {
     int mode = (aspect << 2) | i;
     int index = history_index[i];
-    for (auto value : values) {
-      uint64_t val = value.second;
-      players[value.first]->set_player_stat_history(mode, index,
-                                           static_cast<int>((100*val)/total));
+    for (Player *player : players) {
+      uint64_t val = values[player->get_index()];
+      player->set_player_stat_history(mode, index,
+                                      static_cast<int>((100*val)/total));
     }
   }
 }
@@ -515,14 +580,14 @@ Game::record_player_history(int max_level, int aspect,
 int
 Game::calculate_clear_winner(const Values &values) {
   int total = 0;
-  for (auto value : values) {
-    total += value.second;
+  for (Player *player : players) {
+    total += values[player->get_index()];
   }
   total = std::max(1, total);
 
-  for (auto value : values) {
-    uint64_t val = value.second;
-    if ((100*val)/total >= 75) return value.first;
+  for (Player *player : players) {
+    uint64_t val = values[player->get_index()];
+    if ((100*val)/total >= 75) return player->get_index();
   }
 
   return -1;
@@ -575,7 +640,7 @@ Game::update_game_stats() {
       }
     }
 
-    std::map<unsigned int, unsigned int> values;
+    Values values = {};
 
     /* Store land area stats in history. */
     for (Player *player : players) {
@@ -1113,6 +1178,7 @@ Game::build_flag(MapPos pos, Player *player) {
   flag->set_owner(player->get_index());
   flag->set_position(pos);
   map->set_object(pos, Map::ObjectFlag, flag->get_index());
+  flag_positions.update(flag->get_index(), flag->get_owner(), pos);
 
   if (map->paths(pos) != 0) {
     build_flag_split_path(pos);
@@ -1185,56 +1251,16 @@ Game::get_leveling_height(MapPos pos) const {
   return h_new;
 }
 
-bool
-Game::map_types_within(MapPos pos, Map::Terrain low, Map::Terrain high) const {
-  if ((map->type_up(pos) >= low &&
-       map->type_up(pos) <= high) &&
-      (map->type_down(pos) >= low &&
-       map->type_down(pos) <= high) &&
-      (map->type_down(map->move_left(pos)) >= low &&
-       map->type_down(map->move_left(pos)) <= high) &&
-      (map->type_up(map->move_up_left(pos)) >= low &&
-       map->type_up(map->move_up_left(pos)) <= high) &&
-      (map->type_down(map->move_up_left(pos)) >= low &&
-       map->type_down(map->move_up_left(pos)) <= high) &&
-      (map->type_up(map->move_up(pos)) >= low &&
-       map->type_up(map->move_up(pos)) <= high)) {
-    return true;
-  }
-
-  return false;
-}
-
 /* Checks whether a small building is possible at position.*/
 bool
 Game::can_build_small(MapPos pos) const {
-  return map_types_within(pos, Map::TerrainGrass0, Map::TerrainGrass3);
+  return map->has_attribute(pos, Map::AttributeGrass);
 }
 
 /* Checks whether a mine is possible at position. */
 bool
 Game::can_build_mine(MapPos pos) const {
-  bool can_build = false;
-
-  Map::Terrain types[] = {
-    map->type_down(pos),
-    map->type_up(pos),
-    map->type_down(map->move_left(pos)),
-    map->type_up(map->move_up_left(pos)),
-    map->type_down(map->move_up_left(pos)),
-    map->type_up(map->move_up(pos))
-  };
-
-  for (int i = 0; i < 6; i++) {
-    if (types[i] >= Map::TerrainTundra0 && types[i] <= Map::TerrainSnow0) {
-      can_build = true;
-    } else if (!(types[i] >= Map::TerrainGrass0 &&
-                 types[i] <= Map::TerrainGrass3)) {
-      return false;
-    }
-  }
-
-  return can_build;
+  return map->has_attribute(pos, Map::AttributeMine);
 }
 
 /* Checks whether a large building is possible at position. */
@@ -1449,6 +1475,8 @@ Game::build_building(MapPos pos, Building::Type type, Player *player) {
 
   bld->link_flag(flg_index);
   flag->link_building(bld);
+  flag_positions.update(flg_index, flag->get_owner(), flag->get_position());
+  building_positions.update(bld->get_index(), bld->get_owner(), pos);
 
   flag->clear_flags();
 
@@ -1515,6 +1543,9 @@ Game::build_castle(MapPos pos, Player *player) {
   flag->set_accepts_resources(true);
   castle->link_flag(flag->get_index());
   flag->link_building(castle);
+  flag_positions.update(flag->get_index(), flag->get_owner(),
+                        flag->get_position());
+  building_positions.update(castle->get_index(), castle->get_owner(), pos);
 
   map->set_object(pos, Map::ObjectCastle, castle->get_index());
   map->add_path(pos, DirectionDownRight);
@@ -1610,6 +1641,7 @@ Game::demolish_flag_(MapPos pos) {
   /* Remove resources from flag. */
   flag->remove_all_resources();
 
+  flag_positions.remove(flag->get_index());
   flags.erase(flag->get_index());
 
   return true;
@@ -1695,6 +1727,51 @@ Game::surrender_land(MapPos pos) {
   }
 }
 
+/* Index flags and buildings of a new or loaded game. */
+void
+Game::init_spatial_index() {
+  /* Index 0 of both is undefined and never placed on the map. */
+  flag_positions.reset(map.get());
+  for (Flag *flag : flags) {
+    MapPos pos = flag->get_position();
+    if (map->has_flag(pos) && map->get_obj_index(pos) == flag->get_index()) {
+      flag_positions.update(flag->get_index(), flag->get_owner(), pos);
+    }
+  }
+
+  building_positions.reset(map.get());
+  for (Building *building : buildings) {
+    MapPos pos = building->get_position();
+    if (map->has_building(pos) &&
+        map->get_obj_index(pos) == building->get_index()) {
+      building_positions.update(building->get_index(), building->get_owner(),
+                                pos);
+    }
+  }
+}
+
+/* Count resources and serfs in the statistics of the players of a loaded
+   game. From then on the counts are updated as they change. */
+void
+Game::init_player_stats() {
+  for (Player *player : players) {
+    player->clear_stats();
+  }
+
+  for (Inventory *inventory : inventories) {
+    inventory->count_in_stats(1);
+  }
+
+  for (Serf *serf : serfs) {
+    if (serf->get_state() == Serf::StateIdleInStock) {
+      Player *player = players[serf->get_owner()];
+      if (player != nullptr) {
+        player->add_stats_serf_idle(serf->get_type(), 1);
+      }
+    }
+  }
+}
+
 /* Initialize land ownership for whole map. */
 void
 Game::init_land_ownership() {
@@ -1883,6 +1960,8 @@ Game::occupy_enemy_building(Building *building, int player_num) {
   Player *player = players[player_num];
 
   player->building_captured(building);
+  building_positions.update(building->get_index(), building->get_owner(),
+                            building->get_position());
 
   if (building->get_type() == Building::TypeCastle) {
     demolish_building_(building->get_position());
@@ -1913,6 +1992,8 @@ Game::occupy_enemy_building(Building *building, int player_num) {
 
     /* Change owner of flag. */
     flag->set_owner(player_num);
+    flag_positions.update(flag->get_index(), player_num,
+                          flag->get_position());
 
     /* Reset destination of stolen resources. */
     flag->reset_destination_of_stolen_resources();
@@ -2006,9 +2087,10 @@ Game::init(unsigned int map_size, const Random &random) {
   map.reset(new Map(MapGeometry(map_size)));
   ClassicMissionMapGenerator generator(*map, init_map_rnd);
   generator.init();
-  generator.generate();
+  MapCache::get_instance().generate(&generator);
   map->init_tiles(generator);
   gold_total = map->get_gold_deposit();
+  init_spatial_index();
 
   return true;
 }
@@ -2082,6 +2164,7 @@ Game::create_flag(int index) {
 
 Inventory *
 Game::create_inventory(int index) {
+  serf_searches.network_changed();
   if (index == -1) {
     return inventories.allocate();
   } else {
@@ -2091,6 +2174,7 @@ Game::create_inventory(int index) {
 
 void
 Game::delete_inventory(Inventory *inventory) {
+  inventory->count_in_stats(-1);
   inventories.erase(inventory->get_index());
 }
 
@@ -2106,6 +2190,7 @@ Game::create_building(int index) {
 void
 Game::delete_building(Building *building) {
   map->set_object(building->get_position(), Map::ObjectNone, 0);
+  building_positions.remove(building->get_index());
   buildings.erase(building->get_index());
 }
 
@@ -2360,6 +2445,10 @@ operator >> (SaveReaderBinary &reader, Game &game) {
   game.game_speed = 0;
   game.game_speed_save = DEFAULT_GAME_SPEED;
 
+  game.map->init_object_classes();
+  game.map->init_attributes();
+  game.init_spatial_index();
+  game.init_player_stats();
   game.init_land_ownership();
 
   game.gold_total = game.map->get_gold_deposit();
@@ -2633,6 +2722,10 @@ operator >> (SaveReaderText &reader, Game &game) {
   game.game_speed = 0;
   game.game_speed_save = DEFAULT_GAME_SPEED;
 
+  game.map->init_object_classes();
+  game.map->init_attributes();
+  game.init_spatial_index();
+  game.init_player_stats();
   game.init_land_ownership();
 
   return reader;
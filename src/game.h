@@ -35,11 +35,17 @@
 #include "src/map.h"
 #include "src/random.h"
 #include "src/objects.h"
+#include "src/spatial-index.h"
+#include "src/serf-search-cache.h"
+#include "src/log.h"
 
 #define DEFAULT_GAME_SPEED  2
 
 #define GAME_MAX_PLAYER_COUNT  4
 
+// Log subsystem of the game and the objects it owns.
+extern const Log::Subsystem log_game;
+
 class SaveReaderBinary;
 class SaveReaderText;
 class SaveWriterText;
@@ -50,6 +56,13 @@ class Game {
   typedef std::list<Building*> ListBuildings;
   typedef std::list<Inventory*> ListInventories;
 
+  // Number of updates of buildings of a type that were run, and that were
+  // skipped because the building was asleep.
+  typedef struct BuildingUpdates {
+    uint64_t executed;
+    uint64_t skipped;
+  } BuildingUpdates;
+
  protected:
   typedef Collection<Flag, 5000> Flags;
   typedef Collection<Inventory, 100> Inventories;
@@ -59,7 +72,15 @@ class Game {
 
   PMap map;
 
-  typedef std::map<unsigned int, unsigned int> Values;
+  // Flags and buildings by owner. Flags stand on land of their owner, so
+  // owned land and owner of the flag agree.
+  SpatialIndex flag_positions;
+  SpatialIndex building_positions;
+  SerfSearchCache serf_searches;
+  // Declared before the serfs, which refer to it.
+  SerfFields serf_fields;
+
+  typedef unsigned int Values[GAME_MAX_PLAYER_COUNT];
   int map_gold_morale_factor;
   unsigned int gold_total;
 
@@ -102,17 +123,28 @@ class Game {
   int knight_morale_counter;
   int inventory_schedule_counter;
 
+  BuildingUpdates building_updates[Building::TypeCastle + 1];
+
  public:
   Game();
   virtual ~Game();
 
-  PMap get_map() { return map; }
+  // The map is created when a game is set up or loaded, before any game
+  // object, and lives as long as the game. Game objects and other code
+  // that runs within a tick use the plain pointer; holders that may
+  // outlive the game, like viewports, share ownership.
+  Map *get_map() { return map.get(); }
+  PMap get_shared_map() { return map; }
+  SerfSearchCache *get_serf_search_cache() { return &serf_searches; }
+  SerfFields *get_serf_fields() { return &serf_fields; }
 
   unsigned int get_tick() const { return tick; }
   unsigned int get_const_tick() const { return const_tick; }
   unsigned int get_gold_morale_factor() const { return map_gold_morale_factor; }
   unsigned int get_gold_total() const { return gold_total; }
   void add_gold_total(int delta);
+  const BuildingUpdates &get_building_updates(Building::Type type) const {
+    return building_updates[type]; }
 
   Building *get_building_at_pos(MapPos pos);
   Flag *get_flag_at_pos(MapPos pos);
@@ -165,6 +197,10 @@ class Game {
 
 
   /* Internal interface */
+  void init_spatial_index();
+  void init_player_stats();
+  SpatialIndex &get_flag_positions() { return flag_positions; }
+  SpatialIndex &get_building_positions() { return building_positions; }
   void init_land_ownership();
   void update_land_ownership(MapPos pos);
   void occupy_enemy_building(Building *building, int player);
@@ -231,7 +267,6 @@ class Game {
   void remove_road_forwards(MapPos pos, Direction dir);
   bool demolish_road_(MapPos pos);
   void build_flag_split_path(MapPos pos);
-  bool map_types_within(MapPos pos, Map::Terrain low, Map::Terrain high) const;
   void flag_remove_player_refs(Flag *flag);
   bool demolish_flag_(MapPos pos);
   bool demolish_building_(MapPos pos);
@@ -21,8 +21,10 @@
 
 #include "src/gfx.h"
 
-#include <utility>
 #include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
 
 #include "src/log.h"
 #include "src/data.h"
@@ -113,7 +115,20 @@ Image::clear_cache() {
 
 Graphics *Graphics::instance = nullptr;
 
-Graphics::Graphics() {
+// Images created from prefetched sprites per frame, the rest waits for the
+// following frames.
+#define PREFETCH_UPLOAD_BATCH  64
+
+static double
+elapsed_ms(std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double, std::milli> elapsed =
+                                      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+Graphics::Graphics()
+  : prefetcher(nullptr)
+  , hitch_stats({0, 0., 0., 0}) {
   if (instance != nullptr) {
     throw ExceptionGFX("Unable to create second instance.");
   }
@@ -132,10 +147,27 @@ Graphics::Graphics() {
                     static_cast<unsigned int>(sprite->get_width()),
                     static_cast<unsigned int>(sprite->get_height()));
 
+  // Warm up sprites used by every game, sprites in player colors are
+  // requested once the players are known.
+  if (data_source->is_thread_safe()) {
+    unsigned int threads = std::thread::hardware_concurrency();
+    threads = (threads > 1) ? std::min(4u, threads - 1) : 1u;
+    prefetcher = new SpritePrefetcher(data_source, threads);
+
+    const Data::Sprite::Color none = {0, 0, 0, 0};
+    prefetch_sprites(Data::AssetMapObject, none);
+    prefetch_sprites(Data::AssetMapShadow, none);
+    prefetch_sprites(Data::AssetGameObject, none);
+    prefetch_sprites(Data::AssetSerfTorso, none);
+    prefetch_sprites(Data::AssetSerfHead, none);
+  }
+
   Graphics::instance = this;
 }
 
 Graphics::~Graphics() {
+  delete prefetcher;
+  prefetcher = nullptr;
   Image::clear_cache();
 }
 
@@ -159,18 +191,9 @@ Frame::draw_sprite(int x, int y, Data::Resource res, unsigned int index,
                             color.get_green(),
                             color.get_red(),
                             color.get_alpha()};
-  uint64_t id = Data::Sprite::create_id(res, index, 0, 0, pc);
-  Image *image = Image::get_cached_image(id);
+  Image *image = get_sprite_image(res, index, pc);
   if (image == nullptr) {
-    Data::PSprite s = data_source->get_sprite(res, index, pc);
-    if (!s) {
-      Log::Warn["graphics"] << "Failed to decode sprite #"
-                            << Data::get_resource_name(res) << ":" << index;
-      return;
-    }
-
-    image = new Image(video, s);
-    Image::cache_image(id, image);
+    return;
   }
 
   if (use_off) {
@@ -182,6 +205,36 @@ Frame::draw_sprite(int x, int y, Data::Resource res, unsigned int index,
   video->draw_image(image->get_video_image(), x, y, y_off, video_frame);
 }
 
+/* Return cached image of sprite, decode it if it was not prefetched. */
+Image *
+Frame::get_sprite_image(Data::Resource res, unsigned int index,
+                        const Data::Sprite::Color &color) {
+  uint64_t id = Data::Sprite::create_id(res, index, 0, 0, color);
+  Image *image = Image::get_cached_image(id);
+  if (image != nullptr) {
+    return image;
+  }
+
+  Graphics &gfx = Graphics::get_instance();
+  image = gfx.take_prefetched_image(id);
+  if (image != nullptr) {
+    return image;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Data::PSprite s = data_source->get_sprite(res, index, color);
+  if (!s) {
+    Log::Warn["graphics"] << "Failed to decode sprite #"
+                          << Data::get_resource_name(res) << ":" << index;
+    return nullptr;
+  }
+
+  image = new Image(video, s);
+  Image::cache_image(id, image);
+  gfx.add_hitch(elapsed_ms(start));
+
+  return image;
+}
 
 void
 Frame::draw_sprite(int x, int y, Data::Resource res, unsigned int index,
@@ -206,16 +259,14 @@ Frame::draw_sprite_relatively(int x, int y, Data::Resource res,
                               unsigned int index,
                               Data::Resource relative_to_res,
                               unsigned int relative_to_index) {
-  Data::PSprite s = data_source->get_sprite(relative_to_res, relative_to_index,
-                                            {0, 0, 0, 0});
-  if (s == nullptr) {
-    Log::Warn["graphics"] << "Failed to decode sprite #"
-                          << Data::get_resource_name(res) << ":" << index;
+  Image *relative_to = get_sprite_image(relative_to_res, relative_to_index,
+                                        {0, 0, 0, 0});
+  if (relative_to == nullptr) {
     return;
   }
 
-  x += s->get_delta_x();
-  y += s->get_delta_y();
+  x += relative_to->get_delta_x();
+  y += relative_to->get_delta_y();
 
   draw_sprite(x, y, res, index, true, Color::transparent, 1.f);
 }
@@ -230,6 +281,7 @@ Frame::draw_masked_sprite(int x, int y, Data::Resource mask_res,
                                         {0, 0, 0, 0});
   Image *image = Image::get_cached_image(id);
   if (image == nullptr) {
+    auto start = std::chrono::steady_clock::now();
     Data::PSprite s = data_source->get_sprite(res, index, {0, 0, 0, 0});
     if (!s) {
       Log::Warn["graphics"] << "Failed to decode sprite #"
@@ -260,6 +312,7 @@ Frame::draw_masked_sprite(int x, int y, Data::Resource mask_res,
 
     image = new Image(video, s);
     Image::cache_image(id, image);
+    Graphics::get_instance().add_hitch(elapsed_ms(start));
   }
 
   x += image->get_offset_x();
@@ -277,6 +330,7 @@ Frame::draw_waves_sprite(int x, int y, Data::Resource mask_res,
                                         {0, 0, 0, 0});
   Image *image = Image::get_cached_image(id);
   if (image == nullptr) {
+    auto start = std::chrono::steady_clock::now();
     Data::PSprite s = data_source->get_sprite(res, index, {0, 0, 0, 0});
     if (!s) {
       Log::Warn["graphics"] << "Failed to decode sprite #"
@@ -309,6 +363,7 @@ Frame::draw_waves_sprite(int x, int y, Data::Resource mask_res,
 
     image = new Image(video, s);
     Image::cache_image(id, image);
+    Graphics::get_instance().add_hitch(elapsed_ms(start));
   }
 
   x += image->get_offset_x();
@@ -505,6 +560,75 @@ Graphics::get_resolution(unsigned int *width, unsigned int *height) {
 void
 Graphics::swap_buffers() {
   video->swap_buffers();
+  upload_prefetched_images(PREFETCH_UPLOAD_BATCH);
+}
+
+void
+Graphics::prefetch_sprites(
+                      const std::vector<SpritePrefetcher::Request> &requests) {
+  if (prefetcher == nullptr) {
+    return;
+  }
+
+  std::vector<SpritePrefetcher::Request> missing;
+  for (const SpritePrefetcher::Request &request : requests) {
+    if (Image::get_cached_image(SpritePrefetcher::get_id(request)) == nullptr) {
+      missing.push_back(request);
+    }
+  }
+  prefetcher->request(missing);
+}
+
+void
+Graphics::prefetch_sprites(Data::Resource res,
+                           const Data::Sprite::Color &color) {
+  std::vector<SpritePrefetcher::Request> requests;
+  for (unsigned int i = 0; i < Data::get_resource_count(res); i++) {
+    requests.push_back({res, i, color});
+  }
+  prefetch_sprites(requests);
+}
+
+Image *
+Graphics::take_prefetched_image(uint64_t id) {
+  if (prefetcher == nullptr) {
+    return nullptr;
+  }
+
+  Data::PSprite sprite = prefetcher->take(id);
+  if (!sprite) {
+    return nullptr;
+  }
+
+  Image *image = new Image(video, sprite);
+  Image::cache_image(id, image);
+  hitch_stats.prefetched++;
+  return image;
+}
+
+/* Create images of up to count prefetched sprites. Must be called from the
+   render thread. */
+void
+Graphics::upload_prefetched_images(size_t count) {
+  if (prefetcher == nullptr) {
+    return;
+  }
+
+  for (SpritePrefetcher::Decoded &decoded : prefetcher->take_batch(count)) {
+    if (Image::get_cached_image(decoded.first) == nullptr) {
+      Image::cache_image(decoded.first, new Image(video, decoded.second));
+      hitch_stats.prefetched++;
+    }
+  }
+}
+
+void
+Graphics::add_hitch(double ms) {
+  hitch_stats.count++;
+  hitch_stats.total += ms;
+  hitch_stats.max = std::max(hitch_stats.max, ms);
+  Log::Verbose["graphics"] << "Sprite decoded while drawing ("
+                           << static_cast<int>(ms * 1000.) << " us)";
 }
 
 float
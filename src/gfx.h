@@ -25,10 +25,12 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "src/data.h"
 #include "src/debug.h"
 #include "src/video.h"
+#include "src/sprite-prefetcher.h"
 
 class ExceptionGFX : public ExceptionFreeserf {
  public:
@@ -165,12 +167,26 @@ class Frame {
                         const Color &shadow);
   void draw_sprite(int x, int y, Data::Resource res, unsigned int index,
                    bool use_off, const Color &color, float progress);
+  Image *get_sprite_image(Data::Resource res, unsigned int index,
+                          const Data::Sprite::Color &color);
 };
 
 class Graphics {
+ public:
+  // Sprites that had to be decoded while drawing a frame, because they
+  // were neither cached nor prefetched.
+  typedef struct HitchStats {
+    unsigned int count;
+    double total;  // ms
+    double max;  // ms
+    unsigned int prefetched;
+  } HitchStats;
+
  protected:
   static Graphics *instance;
   Video *video;
+  SpritePrefetcher *prefetcher;
+  HitchStats hitch_stats;
 
   Graphics();
 
@@ -191,6 +207,14 @@ class Graphics {
 
   void swap_buffers();
 
+  /* Sprite warm-up */
+  void prefetch_sprites(const std::vector<SpritePrefetcher::Request> &requests);
+  void prefetch_sprites(Data::Resource res, const Data::Sprite::Color &color);
+  Image *take_prefetched_image(uint64_t id);
+  void upload_prefetched_images(size_t count);
+  void add_hitch(double ms);
+  const HitchStats &get_hitch_stats() const { return hitch_stats; }
+
   float get_zoom_factor();
   bool set_zoom_factor(float factor);
   void get_screen_factor(float *fx, float *fy);
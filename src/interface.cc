@@ -24,6 +24,7 @@
 #include <iostream>
 #include <fstream>
 #include <utility>
+#include <vector>
 
 #include "src/misc.h"
 #include "src/debug.h"
@@ -37,12 +38,17 @@
 #include "src/notification.h"
 #include "src/panel.h"
 #include "src/savegame.h"
+#include "src/game-thread.h"
+#include "src/render-snapshot.h"
 
 // Interval between automatic save games
 #define AUTOSAVE_INTERVAL  (10*60*TICKS_PER_SEC)
 
 Interface::Interface()
-  : building_road_valid_dir(0)
+  : threaded(false)
+  , handling_event(false)
+  , snapshot(nullptr)
+  , building_road_valid_dir(0)
   , sfx_queue{0}
   , water_in_view(false)
   , trees_in_view(false)
@@ -136,6 +142,9 @@ Interface::close_popup() {
   del_float(popup);
   delete popup;
   popup = nullptr;
+  if (snapshots) {
+    snapshots->set_view(SnapshotPublisher::ViewPopup, 0, 0, 0);
+  }
   update_map_cursor_pos(map_cursor_pos);
   if (panel != nullptr) {
     panel->update();
@@ -179,7 +188,19 @@ Interface::close_game_init() {
 /* Open box for next message in the message queue */
 void
 Interface::open_message() {
-  if (!player->has_notification()) {
+  unsigned int index = player->get_index();
+  run_on_game([index](Game *target) {
+    Player *owner = target->get_player(index);
+    if (!owner->has_notification()) {
+      return Message();
+    }
+    return owner->pop_notification();
+  }, [this](const Message &message) { show_message(message); });
+}
+
+void
+Interface::show_message(const Message &message) {
+  if (message.type == Message::TypeNone) {
     play_sound(Audio::TypeSfxClick);
     return;
   } else if (!BIT_TEST(msg_flags, 3)) {
@@ -189,8 +210,6 @@ Interface::open_message() {
     return_pos = pos;
   }
 
-  Message message = player->pop_notification();
-
   if (message.type == Message::TypeCallToMenu) {
     /* TODO */
   }
@@ -247,7 +266,7 @@ void
 Interface::get_map_cursor_type(const Player *player_, MapPos pos,
                                BuildPossibility *bld_possibility,
                                CursorType *cursor_type) {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (player_ == nullptr) {
     *bld_possibility = BuildPossibilityNone;
     *cursor_type = CursorTypeClear;
@@ -329,7 +348,7 @@ Interface::determine_map_cursor_type() {
    when the player interface is in road construction mode. */
 void
 Interface::determine_map_cursor_type_road() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos pos = map_cursor_pos;
   int h = map->get_height(pos);
   int valid_dir = 0;
@@ -341,7 +360,7 @@ Interface::determine_map_cursor_type_road() {
       sprite = 45; /* undo */
       valid_dir |= BIT(d);
     } else if (map->is_road_segment_valid(pos, d)) {
-      if (building_road.is_valid_extension(map.get(), d)) {
+      if (building_road.is_valid_extension(map, d)) {
         int h_diff = map->get_height(map->move(pos, d)) - h;
         sprite = 39 + h_diff; /* height indicators */
         valid_dir |= BIT(d);
@@ -437,23 +456,185 @@ Interface::update_interface() {
 
 void
 Interface::set_game(PGame new_game) {
+  stop_game_thread();
+
   if (viewport != nullptr) {
     del_float(viewport);
     delete viewport;
     viewport = nullptr;
   }
 
+  {
+    std::lock_guard<std::mutex> lock(reply_mutex);
+    replies.clear();
+  }
+  snapshot = nullptr;
+  snapshots.reset();
+
   game = std::move(new_game);
 
   if (game) {
-    viewport = new Viewport(this, game->get_map());
+    snapshots.reset(new SnapshotPublisher(game));
+    snapshot = snapshots->get_snapshot();
+    viewport = new Viewport(this);
     viewport->set_displayed(true);
     add_float(viewport, 0, 0);
+    prefetch_player_sprites();
   }
 
   layout();
 
   set_player(0);
+
+  start_game_thread();
+}
+
+void
+Interface::set_threaded(bool _threaded) {
+  if (threaded == _threaded) {
+    return;
+  }
+
+  threaded = _threaded;
+  stop_game_thread();
+  start_game_thread();
+}
+
+void
+Interface::start_game_thread() {
+  if (!game || !threaded) {
+    return;
+  }
+
+  game_thread.reset(new GameThread(game, snapshots.get()));
+  last_const_tick = snapshot->get_const_tick();
+  if (handling_event) {
+    // The rest of the event works on the new game.
+    event_lock = std::unique_lock<GameThread>(*game_thread);
+  }
+  game_thread->start();
+}
+
+void
+Interface::stop_game_thread() {
+  // An event replacing the game holds the lock of the old thread.
+  if (event_lock.owns_lock()) {
+    event_lock.unlock();
+  }
+  event_lock = std::unique_lock<GameThread>();
+  game_thread.reset();
+}
+
+void
+Interface::run_on_game(std::function<void(Game *target)> command) {
+  if (game_thread) {
+    game_thread->post(command);
+  } else if (game) {
+    command(game.get());
+  }
+}
+
+// Called from a command, on the simulation thread when running threaded.
+void
+Interface::post_reply(std::function<void()> reply) {
+  if (!game_thread) {
+    reply();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(reply_mutex);
+  replies.push_back(std::move(reply));
+}
+
+void
+Interface::run_replies() {
+  std::deque<std::function<void()>> pending;
+  {
+    std::lock_guard<std::mutex> lock(reply_mutex);
+    pending.swap(replies);
+  }
+
+  if (pending.empty()) {
+    return;
+  }
+
+  // Held in event_lock, so lock_game() in a reply does not wait for itself.
+  bool locked = game_thread && !event_lock.owns_lock();
+  if (locked) {
+    event_lock = std::unique_lock<GameThread>(*game_thread);
+  }
+  for (std::function<void()> &reply : pending) {
+    reply();
+  }
+  if (locked && event_lock.owns_lock()) {
+    event_lock.unlock();
+  }
+}
+
+std::unique_lock<GameThread>
+Interface::lock_game() {
+  if (!game_thread || event_lock.owns_lock()) {
+    return std::unique_lock<GameThread>();
+  }
+  return std::unique_lock<GameThread>(*game_thread);
+}
+
+bool
+Interface::update_snapshot() {
+  if (!game) {
+    return false;
+  }
+
+  if (!game_thread) {
+    snapshots->publish(0);
+  }
+  // A new snapshot never comes in the buffer of the current one.
+  const RenderSnapshot *next = snapshots->get_snapshot();
+  if (next == snapshot) {
+    return false;
+  }
+  snapshot = next;
+
+  bool cursor_changed = snapshot->are_changes_lost();
+  for (const RenderSnapshot::Change &change : snapshot->get_changes()) {
+    if (!change.height && change.pos == map_cursor_pos) {
+      cursor_changed = true;
+    }
+  }
+  if (cursor_changed) {
+    std::unique_lock<GameThread> lock = lock_game();
+    update_map_cursor_pos(map_cursor_pos);
+  }
+
+  viewport->update();
+  return true;
+}
+
+bool
+Interface::has_notification() const {
+  return (player != nullptr) && (snapshot != nullptr) &&
+         snapshot->player_has_notification(player->get_index());
+}
+
+// Warm up serfs and flags in the colors of all players of the game.
+void
+Interface::prefetch_player_sprites() {
+  Graphics &gfx = Graphics::get_instance();
+  for (unsigned int i = 0; i < GAME_MAX_PLAYER_COUNT; i++) {
+    if (game->get_player(i) == nullptr) {
+      continue;
+    }
+    Color color = get_player_color(i);
+    Data::Sprite::Color pc = {color.get_blue(), color.get_green(),
+                              color.get_red(), color.get_alpha()};
+    gfx.prefetch_sprites(Data::AssetSerfTorso, pc);
+
+    std::vector<SpritePrefetcher::Request> flags;
+    for (unsigned int j = 128; j < 144; j++) {
+      flags.push_back({Data::AssetMapObject, j, pc});
+    }
+    gfx.prefetch_sprites(flags);
+  }
 }
 
 void
@@ -548,7 +729,8 @@ Interface::build_road_end() {
 }
 
 /* Build a single road segment. Return -1 on fail, 0 on successful
-   construction, and 1 if this segment completed the path. */
+   construction, and 1 if this segment completed the path. The road is then
+   built by the game, which sounds whether that worked. */
 int
 Interface::build_road_segment(Direction dir) {
   if (!building_road.is_extendable()) {
@@ -567,14 +749,20 @@ Interface::build_road_segment(Direction dir) {
 
   if (game->get_map()->get_obj(dest) == Map::ObjectFlag) {
     /* Existing flag at destination, try to connect. */
-    if (!game->build_road(building_road, player)) {
-      build_road_end();
-      return -1;
-    } else {
-      build_road_end();
+    Road road = building_road;
+    unsigned int index = player->get_index();
+    build_road_end();
+    run_on_game([road, index](Game *target) {
+      return target->build_road(road, target->get_player(index));
+    }, [this, dest](bool built) {
+      if (!built) {
+        play_sound(Audio::TypeSfxNotAccepted);
+        return;
+      }
+      play_sound(Audio::TypeSfxAccepted);
       update_map_cursor_pos(dest);
-      return 1;
-    }
+    });
+    return 1;
   } else if (game->get_map()->paths(dest) == 0) {
     /* No existing paths at destination, build segment. */
     update_map_cursor_pos(dest);
@@ -629,9 +817,13 @@ void
 Interface::demolish_object() {
   determine_map_cursor_type();
 
+  MapPos pos = map_cursor_pos;
+  unsigned int index = player->get_index();
   if (map_cursor_type == CursorTypeRemovableFlag) {
     play_sound(Audio::TypeSfxClick);
-    game->demolish_flag(map_cursor_pos, player);
+    run_on_game([pos, index](Game *target) {
+      target->demolish_flag(pos, target->get_player(index));
+    });
   } else if (map_cursor_type == CursorTypeBuilding) {
     Building *building = game->get_building_at_pos(map_cursor_pos);
 
@@ -643,7 +835,9 @@ Interface::demolish_object() {
     }
 
     play_sound(Audio::TypeSfxAhhh);
-    game->demolish_building(map_cursor_pos, player);
+    run_on_game([pos, index](Game *target) {
+      target->demolish_building(pos, target->get_player(index));
+    });
   } else {
     play_sound(Audio::TypeSfxNotAccepted);
     update_interface();
@@ -653,52 +847,86 @@ Interface::demolish_object() {
 /* Build new flag. */
 void
 Interface::build_flag() {
-  if (!game->build_flag(map_cursor_pos, player)) {
-    play_sound(Audio::TypeSfxNotAccepted);
-    return;
-  }
+  MapPos pos = map_cursor_pos;
+  unsigned int index = player->get_index();
+  run_on_game([pos, index](Game *target) {
+    return target->build_flag(pos, target->get_player(index));
+  }, [this](bool built) {
+    if (!built) {
+      play_sound(Audio::TypeSfxNotAccepted);
+      return;
+    }
 
-  update_map_cursor_pos(map_cursor_pos);
+    update_map_cursor_pos(map_cursor_pos);
+  });
 }
 
 /* Build a new building. */
 void
 Interface::build_building(Building::Type type) {
-  if (!game->build_building(map_cursor_pos, type, player)) {
-    play_sound(Audio::TypeSfxNotAccepted);
-    return;
-  }
+  MapPos pos = map_cursor_pos;
+  unsigned int index = player->get_index();
+  run_on_game([pos, type, index](Game *target) {
+    return target->build_building(pos, type, target->get_player(index));
+  }, [this, pos](bool built) {
+    if (!built) {
+      play_sound(Audio::TypeSfxNotAccepted);
+      return;
+    }
 
-  play_sound(Audio::TypeSfxAccepted);
-  close_popup();
+    play_sound(Audio::TypeSfxAccepted);
+    close_popup();
 
-  /* Move cursor to flag. */
-  MapPos flag_pos = game->get_map()->move_down_right(map_cursor_pos);
-  update_map_cursor_pos(flag_pos);
+    /* Move cursor to flag. */
+    MapPos flag_pos = game->get_map()->move_down_right(pos);
+    update_map_cursor_pos(flag_pos);
+  });
 }
 
 /* Build castle. */
 void
 Interface::build_castle() {
-  if (!game->build_castle(map_cursor_pos, player)) {
-    play_sound(Audio::TypeSfxNotAccepted);
-    return;
-  }
+  MapPos pos = map_cursor_pos;
+  unsigned int index = player->get_index();
+  run_on_game([pos, index](Game *target) {
+    return target->build_castle(pos, target->get_player(index));
+  }, [this](bool built) {
+    if (!built) {
+      play_sound(Audio::TypeSfxNotAccepted);
+      return;
+    }
 
-  play_sound(Audio::TypeSfxAccepted);
-  update_map_cursor_pos(map_cursor_pos);
+    play_sound(Audio::TypeSfxAccepted);
+    update_map_cursor_pos(map_cursor_pos);
+  });
 }
 
+/* Place a flag at the cursor and connect the road under construction
+   to it. */
 void
 Interface::build_road() {
-  bool r = game->build_road(building_road, player);
-  if (!r) {
-    play_sound(Audio::TypeSfxNotAccepted);
-    game->demolish_flag(map_cursor_pos, player);
-  } else {
+  Road road = building_road;
+  MapPos pos = map_cursor_pos;
+  unsigned int index = player->get_index();
+  run_on_game([road, pos, index](Game *target) {
+    Player *owner = target->get_player(index);
+    if (!target->build_flag(pos, owner)) {
+      return false;
+    }
+    if (!target->build_road(road, owner)) {
+      target->demolish_flag(pos, owner);
+      return false;
+    }
+    return true;
+  }, [this](bool built) {
+    if (!built) {
+      play_sound(Audio::TypeSfxNotAccepted);
+      return;
+    }
+
     play_sound(Audio::TypeSfxAccepted);
     build_road_end();
-  }
+  });
 }
 
 void
@@ -759,17 +987,45 @@ Interface::layout() {
   set_redraw();
 }
 
+static const int msg_category[] = {
+  -1, 5, 5, 5, 4, 0, 4, 3, 4, 5,
+  5, 5, 4, 4, 4, 4, 0, 0, 0, 0
+};
+
+/* Drop the notifications of player in categories that config leaves out.
+   Return whether one of the others is waiting. */
+static bool
+skip_notifications(Player *player, int config) {
+  while (player->has_notification()) {
+    Message message = player->peek_notification();
+    if (BIT_TEST(config, msg_category[message.type])) {
+      return true;
+    }
+    player->pop_notification();
+  }
+  return false;
+}
+
 /* Called periodically when the game progresses. */
 void
 Interface::update() {
+  if (init_box != nullptr) {
+    init_box->update();
+  }
+
   if (!game) {
     return;
   }
 
-  game->update();
+  if (!game_thread) {
+    game->update();
+  }
+  bool fresh = update_snapshot();
+  run_replies();
 
-  int tick_diff = game->get_const_tick() - last_const_tick;
-  last_const_tick = game->get_const_tick();
+  unsigned int const_tick = snapshot->get_const_tick();
+  int tick_diff = const_tick - last_const_tick;
+  last_const_tick = const_tick;
 
   /* Clear return arrow after a timeout */
   if (return_timeout < tick_diff) {
@@ -780,40 +1036,38 @@ Interface::update() {
     return_timeout -= tick_diff;
   }
 
-  const int msg_category[] = {
-    -1, 5, 5, 5, 4, 0, 4, 3, 4, 5,
-    5, 5, 4, 4, 4, 4, 0, 0, 0, 0
-  };
-
   /* Handle newly enqueued messages */
-  if ((player != nullptr) && player->has_message()) {
-    player->drop_message();
-    while (player->has_notification()) {
-      Message message = player->peek_notification();
-      if (BIT_TEST(config, msg_category[message.type])) {
+  int filter = config;
+  if ((player != nullptr) && fresh &&
+      snapshot->player_has_message(player->get_index())) {
+    unsigned int index = player->get_index();
+    run_on_game([index, filter](Game *target) {
+      Player *owner = target->get_player(index);
+      if (!owner->has_message()) {
+        return false;
+      }
+      owner->drop_message();
+      return skip_notifications(owner, filter);
+    }, [this](bool waiting) {
+      if (waiting) {
         play_sound(Audio::TypeSfxMessage);
         msg_flags |= BIT(0);
-        break;
       }
-      player->pop_notification();
-    }
+    });
   }
 
   if ((player != nullptr) && BIT_TEST(msg_flags, 1)) {
     msg_flags &= ~BIT(1);
-    while (1) {
-      if (!player->has_notification()) {
+    unsigned int index = player->get_index();
+    run_on_game([index, filter](Game *target) {
+      return skip_notifications(target->get_player(index), filter);
+    }, [this](bool waiting) {
+      if (!waiting) {
         msg_flags &= ~BIT(0);
-        break;
       }
-
-      Message message = player->peek_notification();
-      if (BIT_TEST(config, msg_category[message.type])) break;
-      player->pop_notification();
-    }
+    });
   }
 
-  viewport->update();
   set_redraw();
 }
 
@@ -842,19 +1096,19 @@ Interface::handle_key_pressed(char key, int modifier) {
 
     /* Game speed */
     case '+': {
-      game->speed_increase();
+      run_on_game([](Game *target) { target->speed_increase(); });
       break;
     }
     case '-': {
-      game->speed_decrease();
+      run_on_game([](Game *target) { target->speed_decrease(); });
       break;
     }
     case '0': {
-      game->speed_reset();
+      run_on_game([](Game *target) { target->speed_reset(); });
       break;
     }
     case 'p': {
-      game->pause();
+      run_on_game([](Game *target) { target->pause(); });
       break;
     }
 
@@ -918,6 +1172,15 @@ Interface::handle_key_pressed(char key, int modifier) {
 
 bool
 Interface::handle_event(const Event *event) {
+  // Keep the simulation out while input looks at the game. Frames are drawn
+  // from the snapshot, and input changes the game through run_on_game().
+  if (game_thread && (event->type != Event::TypeUpdate) &&
+      (event->type != Event::TypeDraw)) {
+    event_lock = std::unique_lock<GameThread>(*game_thread);
+  }
+  handling_event = true;
+
+  bool handled = true;
   switch (event->type) {
     case Event::TypeResize:
       set_size(event->dx, event->dy);
@@ -930,11 +1193,15 @@ Interface::handle_event(const Event *event) {
       break;
 
     default:
-      return GuiObject::handle_event(event);
+      handled = GuiObject::handle_event(event);
       break;
   }
 
-  return true;
+  handling_event = false;
+  if (event_lock.owns_lock()) {
+    event_lock.unlock();
+  }
+  return handled;
 }
 
 void
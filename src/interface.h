@@ -22,6 +22,12 @@
 #ifndef SRC_INTERFACE_H_
 #define SRC_INTERFACE_H_
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
 #include "src/misc.h"
 #include "src/random.h"
 #include "src/map.h"
@@ -42,6 +48,9 @@ class PanelBar;
 class PopupBox;
 class GameInitBox;
 class NotificationBox;
+class GameThread;
+class RenderSnapshot;
+class SnapshotPublisher;
 
 class Interface : public GuiObject, public GameManager::Handler {
  public:
@@ -87,6 +96,16 @@ class Interface : public GuiObject, public GameManager::Handler {
 
  protected:
   PGame game;
+  bool threaded;
+  std::unique_ptr<GameThread> game_thread;
+  // Held on game_thread while input is handled or replies run.
+  std::unique_lock<GameThread> event_lock;
+  bool handling_event;
+  std::unique_ptr<SnapshotPublisher> snapshots;
+  const RenderSnapshot *snapshot;
+  // Results of posted commands, waiting for the interface thread.
+  std::mutex reply_mutex;
+  std::deque<std::function<void()>> replies;
 
   Random random;
 
@@ -130,6 +149,34 @@ class Interface : public GuiObject, public GameManager::Handler {
   PGame get_game() { return game; }
   void set_game(PGame game);
 
+  // Run the game simulation on its own thread, see GameThread.
+  void set_threaded(bool threaded);
+  bool is_threaded() const { return threaded; }
+  GameThread *get_game_thread() { return game_thread.get(); }
+  // Apply command to the game, between ticks when running threaded.
+  void run_on_game(std::function<void(Game *target)> command);
+  // Same, then pass what command returns to reply on the interface thread,
+  // with the game locked.
+  template<typename Command, typename Reply>
+  void run_on_game(Command command, Reply reply) {
+    typedef typename std::result_of<Command(Game*)>::type Result;
+    run_on_game([this, command, reply](Game *target) {
+      Result result = command(target);
+      post_reply([reply, result]() { reply(result); });
+    });
+  }
+  // Exclusive access to state the snapshot leaves out, like while drawing
+  // popups. Empty when not threaded or already held for an event.
+  std::unique_lock<GameThread> lock_game();
+
+  // The game as last published, which the viewport draws.
+  const RenderSnapshot *get_snapshot() const { return snapshot; }
+  SnapshotPublisher *get_snapshots() { return snapshots.get(); }
+  // Take the latest snapshot, publishing one first when not threaded.
+  // Returns whether it is new. update() does this after every tick.
+  bool update_snapshot();
+  bool has_notification() const;
+
   Color get_player_color(unsigned int player_index);
 
   Viewport *get_viewport();
@@ -212,6 +259,12 @@ class Interface : public GuiObject, public GameManager::Handler {
   void determine_map_cursor_type_road();
   void update_interface();
   static void update_map_height(MapPos pos, void *data);
+  void show_message(const Message &message);
+  void post_reply(std::function<void()> reply);
+  void run_replies();
+  void prefetch_player_sprites();
+  void start_game_thread();
+  void stop_game_thread();
 
   virtual void internal_draw();
   virtual void layout();
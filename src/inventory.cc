@@ -56,9 +56,24 @@ Inventory::~Inventory() {
   game->add_gold_total(-static_cast<int>(resources[Resource::TypeGoldOre]));
 }
 
+void
+Inventory::set_owner(unsigned int owner) {
+  count_in_stats(-1);
+  this->owner = owner;
+  count_in_stats(1);
+}
+
 void
 Inventory::push_resource(Resource::Type resource) {
-  resources[resource] += (resources[resource] < 50000) ? 1 : 0;
+  if (resources[resource] < 50000) {
+    add_resource_count(resource, 1);
+  }
+  game->get_serf_search_cache()->resource_added(resource);
+}
+
+void
+Inventory::pop_resource(Resource::Type resource) {
+  add_resource_count(resource, -1);
 }
 
 void
@@ -94,7 +109,7 @@ Inventory::add_to_queue(Resource::Type type, unsigned int dest) {
     throw ExceptionFreeserf("No resource with type.");
   }
 
-  resources[type] -= 1;
+  add_resource_count(type, -1);
   if (out_queue[0].type == Resource::TypeNone) {
     out_queue[0].type = type;
     out_queue[0].dest = dest;
@@ -162,7 +177,10 @@ Inventory::apply_supplies_preset(unsigned int supplies) {
     int t1 = template_1[i];
     unsigned int n = (template_2[i] - template_1[i]) * (supplies * 6554);
     if (n >= 0x8000) t1 += 1;
-    resources[(Resource::Type)i] = t1 + (n >> 16);
+    Resource::Type type = (Resource::Type)i;
+    add_resource_count(type, static_cast<int>(t1 + (n >> 16)) -
+                             static_cast<int>(resources[type]));
+    game->get_serf_search_cache()->resource_added((Resource::Type)i);
   }
 }
 
@@ -179,9 +197,9 @@ Inventory::call_transporter(bool water) {
           (resources[Resource::TypeBoat] > 0)) {
         serf = game->get_serf(serfs[Serf::TypeGeneric]);
         serfs[Serf::TypeGeneric] = 0;
-        resources[Resource::TypeBoat]--;
+        add_resource_count(Resource::TypeBoat, -1);
         serf->set_type(Serf::TypeSailor);
-        generic_count -= 1;
+        add_generic_count(-1);
       } else {
         return NULL;
       }
@@ -195,7 +213,7 @@ Inventory::call_transporter(bool water) {
         serf = game->get_serf(serfs[Serf::TypeGeneric]);
         serfs[Serf::TypeGeneric] = 0;
         serf->set_type(Serf::TypeTransporter);
-        generic_count -= 1;
+        add_generic_count(-1);
       } else {
         return NULL;
       }
@@ -215,7 +233,7 @@ Inventory::call_out_serf(Serf *serf) {
 
   serfs[serf->get_type()] = 0;
   if (serf->get_type() == Serf::TypeGeneric) {
-    generic_count--;
+    add_generic_count(-1);
   }
   serfs_out++;
   return true;
@@ -271,7 +289,7 @@ Inventory::promote_serf_to_knight(Serf *serf) {
 
   pop_resource(Resource::TypeSword);
   pop_resource(Resource::TypeShield);
-  generic_count--;
+  add_generic_count(-1);
   serfs[Serf::TypeGeneric] = 0;
 
   serf->set_type(Serf::TypeKnight0);
@@ -286,10 +304,11 @@ Inventory::spawn_serf_generic() {
   if (serf != NULL) {
     serf->init_generic(this);
 
-    generic_count++;
+    add_generic_count(1);
     if (serfs[Serf::TypeGeneric] == 0) {
       serfs[Serf::TypeGeneric] = serf->get_index();
     }
+    game->get_serf_search_cache()->serf_added(Serf::TypeGeneric);
   }
 
   return serf;
@@ -348,18 +367,19 @@ Inventory::specialize_serf(Serf *serf, Serf::Type type) {
   if (serfs[Serf::TypeGeneric] == serf->get_index()) {
     serfs[Serf::TypeGeneric] = 0;
   }
-  generic_count--;
+  add_generic_count(-1);
 
   if (res_needed[type*2] != Resource::TypeNone) {
-    resources[res_needed[type*2]]--;
+    add_resource_count(res_needed[type*2], -1);
   }
   if (res_needed[type*2+1] != Resource::TypeNone) {
-    resources[res_needed[type*2+1]]--;
+    add_resource_count(res_needed[type*2+1], -1);
   }
 
   serf->set_type(type);
 
   serfs[type] = serf->get_index();
+  game->get_serf_search_cache()->serf_added(type);
 
   return true;
 }
@@ -396,6 +416,13 @@ Inventory::serf_potential_count(Serf::Type type) {
 void
 Inventory::serf_idle_in_stock(Serf *serf) {
   serfs[serf->get_type()] = serf->get_index();
+  game->get_serf_search_cache()->serf_added(serf->get_type());
+}
+
+void
+Inventory::serf_come_back() {
+  add_generic_count(1);
+  game->get_serf_search_cache()->serf_added(Serf::TypeGeneric);
 }
 
 void
@@ -407,6 +434,57 @@ Inventory::knight_training(Serf *serf, int p) {
   serf_idle_in_stock(serf);
 }
 
+void
+Inventory::count_in_stats(int sign) {
+  Player *player = game->get_player(owner);
+  if (player == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < Resource::GroupFood; i++) {
+    Resource::Type type = (Resource::Type)i;
+    player->add_stats_resource(type, sign * get_count_of(type));
+  }
+  count_potential_serfs(sign);
+}
+
+void
+Inventory::add_resource_count(Resource::Type resource, int delta) {
+  /* Potential serfs only change with the tools needed to make them. */
+  bool tool = false;
+  for (Resource::Type needed : res_needed) {
+    tool = tool || (needed == resource);
+  }
+
+  if (tool) count_potential_serfs(-1);
+  resources[resource] += delta;
+  Player *player = game->get_player(owner);
+  if (player != nullptr) {
+    player->add_stats_resource(resource, delta);
+  }
+  if (tool) count_potential_serfs(1);
+}
+
+void
+Inventory::add_generic_count(int delta) {
+  count_potential_serfs(-1);
+  generic_count += delta;
+  count_potential_serfs(1);
+}
+
+void
+Inventory::count_potential_serfs(int sign) {
+  Player *player = game->get_player(owner);
+  if (player == nullptr || generic_count <= 0) {
+    return;
+  }
+
+  for (int i = 0; i < Serf::TypeDead; i++) {
+    Serf::Type type = (Serf::Type)i;
+    player->add_stats_serf_potential(type, sign * serf_potential_count(type));
+  }
+}
+
 SaveReaderBinary&
 operator >> (SaveReaderBinary &reader, Inventory &inventory) {
   uint8_t byte;
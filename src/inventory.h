@@ -65,7 +65,7 @@ class Inventory : public GameObject {
   virtual ~Inventory();
 
   unsigned int get_owner() { return owner; }
-  void set_owner(unsigned int owner) { this->owner = owner; }
+  void set_owner(unsigned int owner);
 
   int get_flag_index() { return flag; }
   void set_flag_index(int flag_index) { flag = flag_index; }
@@ -87,14 +87,14 @@ class Inventory : public GameObject {
   Serf *call_out_serf(Serf::Type type);
   bool call_internal(Serf *serf);
   Serf *call_internal(Serf::Type type);
-  void serf_come_back() { generic_count++; }
+  void serf_come_back();
   size_t free_serf_count() { return generic_count; }
   bool have_serf(Serf::Type type) { return (serfs[type] != 0); }
 
   unsigned int get_count_of(Resource::Type resource) {
     return resources[resource]; }
   ResourceMap get_all_resources() { return resources; }
-  void pop_resource(Resource::Type resource) { resources[resource]--; }
+  void pop_resource(Resource::Type resource);
   void push_resource(Resource::Type resource);
 
   bool has_resource_in_queue() {
@@ -126,12 +126,22 @@ class Inventory : public GameObject {
   void serf_idle_in_stock(Serf *serf);
   void knight_training(Serf *serf, int p);
 
+  /* Add resources and potential serfs to the statistics of the owner, or
+     remove them for a negative sign. */
+  void count_in_stats(int sign);
+
   friend SaveReaderBinary&
     operator >> (SaveReaderBinary &reader, Inventory &inventory);
   friend SaveReaderText&
     operator >> (SaveReaderText &reader, Inventory &inventory);
   friend SaveWriterText&
     operator << (SaveWriterText &writer, Inventory &inventory);
+
+ protected:
+  /* Change counts and the statistics of the owner. */
+  void add_resource_count(Resource::Type resource, int delta);
+  void add_generic_count(int delta);
+  void count_potential_serfs(int sign);
 };
 
 #endif  // SRC_INVENTORY_H_
@@ -21,7 +21,15 @@
 
 #include "src/log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -35,13 +43,245 @@ Log::Level Log::level = Log::LevelInfo;
 
 std::ostream *Log::stream = &std::cout;
 
-std::ostream Log::Logger::dummy(0);
 Log::Logger Log::Verbose(Log::LevelVerbose, "Verbose");
 Log::Logger Log::Debug(Log::LevelDebug, "Debug");
 Log::Logger Log::Info(Log::LevelInfo, "Info");
 Log::Logger Log::Warn(Log::LevelWarn, "Warning");
 Log::Logger Log::Error(Log::LevelError, "Error");
 
+namespace {
+
+// Bounded multi producer ring buffer, after Dmitry Vyukov's MPMC queue.
+// Producers claim a cell with one compare and swap; the only consumer is
+// the writer thread.
+class LogRing {
+ public:
+  static const size_t cell_count = 1024;
+  static const size_t subsystem_size = 24;
+  static const size_t text_size = 480;
+
+  typedef struct Cell {
+    std::atomic<size_t> sequence;
+    Log::Level level;
+    char subsystem[subsystem_size];
+    size_t length;
+    char text[text_size];
+  } Cell;
+
+ protected:
+  std::unique_ptr<Cell[]> cells;
+  std::atomic<size_t> enqueue_pos;
+  size_t dequeue_pos;
+
+ public:
+  LogRing()
+    : cells(new Cell[cell_count])
+    , enqueue_pos(0)
+    , dequeue_pos(0) {
+    for (size_t i = 0; i < cell_count; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // False if the ring buffer is full or text does not fit a cell.
+  bool push(Log::Level level, const std::string &subsystem,
+            const std::string &text) {
+    if (text.size() > text_size) {
+      return false;
+    }
+
+    Cell *cell = nullptr;
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells[pos % cell_count];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(sequence) -
+                      static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // Full
+      } else {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->level = level;
+    size_t size = std::min(subsystem.size(), subsystem_size - 1);
+    memcpy(cell->subsystem, subsystem.data(), size);
+    cell->subsystem[size] = 0;
+    cell->length = text.size();
+    memcpy(cell->text, text.data(), cell->length);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Calls func for the oldest message, false if empty.
+  template <typename F>
+  bool pop(F func) {
+    Cell *cell = &cells[dequeue_pos % cell_count];
+    size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (sequence != dequeue_pos + 1) {
+      return false;
+    }
+
+    func(*cell);
+    cell->sequence.store(dequeue_pos + cell_count, std::memory_order_release);
+    dequeue_pos++;
+    return true;
+  }
+};
+
+const size_t LogRing::cell_count;
+const size_t LogRing::subsystem_size;
+const size_t LogRing::text_size;
+
+const Log::Logger *
+get_logger(Log::Level level) {
+  switch (level) {
+    case Log::LevelVerbose: return &Log::Verbose;
+    case Log::LevelDebug: return &Log::Debug;
+    case Log::LevelInfo: return &Log::Info;
+    case Log::LevelWarn: return &Log::Warn;
+    default: return &Log::Error;
+  }
+}
+
+class AsyncWriter;
+
+// Set while the async writer runs, checked without taking the mutex.
+std::atomic<AsyncWriter*> async_writer(nullptr);
+
+// Writes messages of the ring buffer on its own thread. Once created it is
+// kept until exit, producers may still hold on to it after stop().
+class AsyncWriter {
+ protected:
+  LogRing ring;
+  std::atomic<bool> quit;
+  std::atomic<uint64_t> dropped;
+  std::ostream *stream;
+  std::mutex stream_mutex;  // Taken by the consumer of the ring buffer
+  std::thread thread;
+
+ public:
+  AsyncWriter()
+    : quit(false)
+    , dropped(0)
+    , stream(nullptr) {
+  }
+
+  ~AsyncWriter() {
+    async_writer = nullptr;
+    stop();
+  }
+
+  void start(std::ostream *_stream) {
+    stream = _stream;
+    quit = false;
+    thread = std::thread(&AsyncWriter::run, this);
+  }
+
+  void stop() {
+    if (thread.joinable()) {
+      quit = true;
+      thread.join();
+    }
+  }
+
+  void push(Log::Level level, const std::string &subsystem,
+            const std::string &text) {
+    if (!ring.push(level, subsystem, text)) {
+      dropped++;
+    }
+  }
+
+  // Write line on the calling thread, after the messages already queued.
+  void write_now(const std::string &line) {
+    std::lock_guard<std::mutex> lock(stream_mutex);
+    write_queued();
+    stream->write(line.data(), line.size());
+    stream->flush();
+  }
+
+ protected:
+  void run() {
+    while (true) {
+      // Read quit first, messages pushed before stopping are still written.
+      bool stopping = quit;
+      bool written = false;
+      {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        written = write_queued();
+        if (written) {
+          stream->flush();
+        }
+      }
+
+      if (!written) {
+        if (stopping) {
+          return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+  }
+
+  // Called with stream_mutex held, false if nothing was written.
+  bool write_queued() {
+    bool written = false;
+    std::string line;
+    while (ring.pop([&](const LogRing::Cell &cell) {
+             line = get_logger(cell.level)->get_prefix();
+             line += ": [";
+             line += cell.subsystem;
+             line += "] ";
+             line.append(cell.text, cell.length);
+             line += '\n';
+             stream->write(line.data(), line.size());
+           })) {
+      written = true;
+    }
+
+    uint64_t lost = dropped.exchange(0);
+    if (lost > 0) {
+      *stream << "Warning: [log] " << lost << " messages dropped\n";
+      written = true;
+    }
+    return written;
+  }
+};
+
+std::mutex &
+get_write_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+AsyncWriter &
+get_async_writer() {
+  static AsyncWriter writer;
+  return writer;
+}
+}  // namespace
+
+Log::Stream::Stream(const Logger *_logger, const std::string &_subsystem)
+  : logger(_logger) {
+  if (logger->is_enabled()) {
+    subsystem = _subsystem;
+    buffer.reset(new std::ostringstream());
+  }
+}
+
+Log::Stream::~Stream() {
+  if (buffer) {
+    Log::write(logger->get_level(), logger->get_prefix(), subsystem,
+               buffer->str());
+  }
+}
+
 Log::Log() {
 #ifdef WIN32
   if (::AttachConsole(ATTACH_PARENT_PROCESS)) {
@@ -59,7 +299,10 @@ Log::~Log() {
 
 void
 Log::set_file(std::ostream *_stream) {
+  bool async = is_async();
+  set_async(false);
   stream = _stream;
+  set_async(async);
 }
 
 void
@@ -71,3 +314,51 @@ Log::set_level(Log::Level _level) {
   Warn.apply_level();
   Error.apply_level();
 }
+
+void
+Log::set_async(bool async) {
+  std::lock_guard<std::mutex> lock(get_write_mutex());
+  if (async == is_async()) {
+    return;
+  }
+
+  AsyncWriter &writer = get_async_writer();
+  if (async) {
+    writer.start(stream);
+    async_writer = &writer;
+  } else {
+    async_writer = nullptr;
+    writer.stop();
+  }
+}
+
+bool
+Log::is_async() {
+  return (async_writer != nullptr);
+}
+
+void
+Log::write(Level level, const std::string &prefix,
+           const std::string &subsystem, const std::string &text) {
+  std::string line;
+  AsyncWriter *writer = async_writer;
+  if (writer != nullptr) {
+    // Warnings and errors are kept even if the program does not exit
+    // cleanly, messages too long for the ring buffer are not cut off.
+    if ((level < LevelWarn) && (text.size() <= LogRing::text_size)) {
+      writer->push(level, subsystem, text);
+      return;
+    }
+    line = prefix + ": [" + subsystem + "] " + text + "\n";
+    writer->write_now(line);
+    return;
+  }
+
+  line = prefix + ": [" + subsystem + "] " + text + "\n";
+  std::lock_guard<std::mutex> lock(get_write_mutex());
+  stream->write(line.data(), line.size());
+  // Keep warnings and errors even if the program does not exit cleanly.
+  if (level >= LevelWarn) {
+    stream->flush();
+  }
+}
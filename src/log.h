@@ -35,9 +35,18 @@
 #ifndef SRC_LOG_H_
 #define SRC_LOG_H_
 
+#include <atomic>
+#include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
 
+/* Lowest level that is compiled in. Messages of lower levels written with
+   the LOG_* macros below are removed by the compiler. */
+#ifndef FREESERF_LOG_MIN_LEVEL
+# define FREESERF_LOG_MIN_LEVEL  0
+#endif
+
 class Log {
  public:
   /* Log levels */
@@ -51,26 +60,44 @@ class Log {
     LevelMax
   } Level;
 
-  class Stream {
+  /* Name of a subsystem, defined once instead of building a string for
+     every message. */
+  class Subsystem {
    protected:
-    std::ostream *stream;
+    const char *name;
 
    public:
-    explicit Stream(std::ostream *_stream) : stream(_stream) {}
-    ~Stream() {
-      *stream << std::endl;
-      stream->flush();
-    }
+    constexpr explicit Subsystem(const char *_name) : name(_name) {}
+
+    const char *get_name() const { return name; }
+  };
 
-    std::ostream *get_stream() { return stream; }
+  class Logger;
+
+  /* Collects one message, which is written when the stream is destroyed.
+     Streams of disabled loggers ignore their arguments. */
+  class Stream {
+   protected:
+    const Logger *logger;
+    std::string subsystem;
+    std::unique_ptr<std::ostringstream> buffer;
+
+   public:
+    Stream(const Logger *logger, const std::string &subsystem);
+    Stream(Stream &&other) = default;
+    ~Stream();
 
     template <class T> Stream & operator << (const T &val) {
-      *stream << val;
+      if (buffer) {
+        *buffer << val;
+      }
       return *this;
     }
 
     Stream & operator << (const char val[]) {
-      *stream << std::string(val);
+      if (buffer) {
+        *buffer << val;
+      }
       return *this;
     }
   };
@@ -79,26 +106,29 @@ class Log {
    protected:
     Level level;
     std::string prefix;
-    std::ostream *stream;
-    static std::ostream dummy;
+    std::atomic<bool> enabled;  // Read by every thread that logs
 
    public:
     explicit Logger(Level _level, std::string _prefix)
-      : level(_level), prefix(_prefix), stream(nullptr) {
+      : level(_level), prefix(_prefix), enabled(false) {
       apply_level();
     }
 
     virtual Stream operator[](std::string subsystem) {
-      *stream << prefix << ": [" << subsystem << "] ";
-      return Stream(stream);
+      return Stream(this, subsystem);
     }
 
+    Stream operator[](const Subsystem &subsystem) {
+      return Stream(this, subsystem.get_name());
+    }
+
+    Level get_level() const { return level; }
+    const std::string &get_prefix() const { return prefix; }
+    bool is_enabled() const {
+      return enabled.load(std::memory_order_relaxed); }
+
     void apply_level() {
-      if (level < Log::level) {
-        stream = &dummy;
-      } else {
-        stream = Log::stream;
-      }
+      enabled.store(level >= Log::level, std::memory_order_relaxed);
     }
   };
 
@@ -108,6 +138,16 @@ class Log {
   static void set_file(std::ostream *stream);
   static void set_level(Log::Level level);
 
+  /* Hand messages to a background thread through a lock free ring buffer,
+     instead of writing them on the calling thread. Messages are dropped
+     while the ring buffer is full. Warnings, errors and long messages are
+     still written on the calling thread, after the queued messages. Turn
+     it off before exit to write the remaining messages. */
+  static void set_async(bool async);
+  static bool is_async();
+  static void write(Level level, const std::string &prefix,
+                    const std::string &subsystem, const std::string &text);
+
   static Logger Verbose;
   static Logger Debug;
   static Logger Info;
@@ -119,4 +159,19 @@ class Log {
   static Level level;
 };
 
+/* Write a message only if its level is compiled in and enabled. Arguments
+   are not evaluated otherwise:
+
+     LOG_VERBOSE(log_serf) << "expensive " << describe(serf); */
+#define LOG_AT(lvl, logger, subsystem) \
+  if (((lvl) < FREESERF_LOG_MIN_LEVEL) || !(logger).is_enabled()) {} \
+  else (logger)[subsystem]  // NOLINT(readability/braces)
+
+#define LOG_VERBOSE(subsystem) \
+  LOG_AT(Log::LevelVerbose, Log::Verbose, subsystem)
+#define LOG_DEBUG(subsystem)  LOG_AT(Log::LevelDebug, Log::Debug, subsystem)
+#define LOG_INFO(subsystem)  LOG_AT(Log::LevelInfo, Log::Info, subsystem)
+#define LOG_WARN(subsystem)  LOG_AT(Log::LevelWarn, Log::Warn, subsystem)
+#define LOG_ERROR(subsystem)  LOG_AT(Log::LevelError, Log::Error, subsystem)
+
 #endif  // SRC_LOG_H_
@@ -0,0 +1,283 @@
+/*
+ * map-cache.cc - Cache of generated maps on disk
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/map-cache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "src/buffer.h"
+#include "src/log.h"
+#include "src/map-generator.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// Bump whenever the layout of the cache changes.
+#define CACHE_VERSION  1
+
+static const char cache_magic[8] = { 'F', 'S', 'M', 'A', 'P', 'C', 'A', 0 };
+
+static_assert(sizeof(MapCache::PackedTile) == 5, "PackedTile is padded");
+
+// Tiles start after the header and the key, aligned to 8 bytes.
+static size_t
+get_tiles_offset(size_t key_size) {
+  return (sizeof(MapCache::Header) + key_size + 7) & ~size_t(7);
+}
+
+MapCache::MapCache()
+  : enabled(false) {
+}
+
+MapCache &
+MapCache::get_instance() {
+  static MapCache instance;
+  return instance;
+}
+
+void
+MapCache::set_folder(const std::string &folder) {
+  std::lock_guard<std::mutex> lock(folder_mutex);
+  this->folder = folder;
+}
+
+std::string
+MapCache::get_folder() {
+  std::lock_guard<std::mutex> lock(folder_mutex);
+  if (folder.empty()) {
+    folder = get_default_folder();
+  }
+  return folder;
+}
+
+void
+MapCache::generate(ClassicMapGenerator *generator) {
+  if (!enabled) {
+    generator->generate();
+    return;
+  }
+
+  std::string key = generator->get_key();
+  std::vector<Map::LandscapeTile> landscape;
+  if (load(key, generator->get_landscape().size(), &landscape)) {
+    generator->set_landscape(std::move(landscape));
+    return;
+  }
+
+  generator->generate();
+  store(key, generator->get_landscape());
+}
+
+bool
+MapCache::load(const std::string &key, size_t tile_count,
+               std::vector<Map::LandscapeTile> *landscape) {
+  std::string path = get_path(key);
+
+  PBuffer file;
+  try {
+    file = std::make_shared<MappedBuffer>(path);
+  } catch (...) {
+    return false;
+  }
+
+  const uint8_t *begin = reinterpret_cast<const uint8_t*>(file->get_data());
+  size_t size = file->get_size();
+  if (size < sizeof(Header)) {
+    return false;
+  }
+
+  Header header;
+  memcpy(&header, begin, sizeof(header));
+  if ((memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0) ||
+      (header.version != CACHE_VERSION)) {
+    Log::Info["map"] << "Cache '" << path << "' has unknown format";
+    return false;
+  }
+
+  // A different key only means that the hashes of both keys collide.
+  if ((header.key_size != key.size()) ||
+      (size < sizeof(Header) + key.size()) ||
+      (memcmp(begin + sizeof(Header), key.data(), key.size()) != 0)) {
+    return false;
+  }
+
+  size_t offset = get_tiles_offset(key.size());
+  if ((header.tile_count != tile_count) ||
+      (size < offset) ||
+      ((size - offset) / sizeof(PackedTile) < tile_count)) {
+    Log::Warn["map"] << "Cache '" << path << "' is damaged";
+    return false;
+  }
+
+  const PackedTile *tiles = reinterpret_cast<const PackedTile*>(begin +
+                                                                offset);
+  if (get_checksum(tiles, tile_count) != header.checksum) {
+    Log::Warn["map"] << "Cache '" << path << "' is damaged";
+    return false;
+  }
+
+  landscape->resize(tile_count);
+  for (size_t i = 0; i < tile_count; i++) {
+    Map::LandscapeTile &tile = (*landscape)[i];
+    tile.height = tiles[i].height;
+    tile.type_up = static_cast<Map::Terrain>(tiles[i].types >> 4);
+    tile.type_down = static_cast<Map::Terrain>(tiles[i].types & 0x0f);
+    tile.mineral = static_cast<Map::Minerals>(tiles[i].mineral);
+    tile.resource_amount = tiles[i].resource_amount;
+    tile.obj = static_cast<Map::Object>(tiles[i].obj);
+  }
+
+  return true;
+}
+
+bool
+MapCache::store(const std::string &key,
+                const std::vector<Map::LandscapeTile> &landscape) {
+  std::vector<PackedTile> tiles(landscape.size());
+  for (size_t i = 0; i < landscape.size(); i++) {
+    const Map::LandscapeTile &tile = landscape[i];
+    if ((tile.height > 0xff) ||
+        (tile.type_up > 0x0f) || (tile.type_down > 0x0f) ||
+        (tile.mineral > 0xff) ||
+        (tile.resource_amount < 0) || (tile.resource_amount > 0xff) ||
+        (tile.obj > 0xff)) {
+      Log::Warn["map"] << "Map '" << key << "' can not be cached";
+      return false;
+    }
+    tiles[i].height = static_cast<uint8_t>(tile.height);
+    tiles[i].types = static_cast<uint8_t>((tile.type_up << 4) |
+                                          tile.type_down);
+    tiles[i].mineral = static_cast<uint8_t>(tile.mineral);
+    tiles[i].resource_amount = static_cast<uint8_t>(tile.resource_amount);
+    tiles[i].obj = static_cast<uint8_t>(tile.obj);
+  }
+
+  Header header;
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version = CACHE_VERSION;
+  header.key_size = static_cast<uint32_t>(key.size());
+  header.tile_count = tiles.size();
+  header.checksum = get_checksum(tiles.data(), tiles.size());
+
+  // Write to a temporary file first, so that an interrupted write never
+  // leaves a truncated map behind. Maps may be stored from more than one
+  // thread.
+  std::string path = get_path(key);
+  std::stringstream tmp_path;
+  tmp_path << path << "." << std::hash<std::thread::id>()(
+                                         std::this_thread::get_id()) << ".tmp";
+  {
+    std::ofstream file(tmp_path.str().c_str(),
+                       std::ios::binary | std::ios::trunc);
+    if (!file.good()) {
+      Log::Warn["map"] << "Failed to create cache '" << tmp_path.str() << "'";
+      return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(key.data(), key.size());
+    std::vector<char> padding(get_tiles_offset(key.size()) - sizeof(header) -
+                              key.size(), 0);
+    file.write(padding.data(), padding.size());
+    file.write(reinterpret_cast<const char*>(tiles.data()),
+               tiles.size() * sizeof(PackedTile));
+    if (!file.good()) {
+      Log::Warn["map"] << "Failed to write cache '" << tmp_path.str() << "'";
+      file.close();
+      std::remove(tmp_path.str().c_str());
+      return false;
+    }
+  }
+
+  std::remove(path.c_str());
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.str().c_str());
+    return false;
+  }
+
+  return true;
+}
+
+// The file name is the FNV-1a hash of the key.
+std::string
+MapCache::get_path(const std::string &key) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : key) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+  }
+
+  std::stringstream path;
+  path << get_folder() << "/map-" << std::hex << std::setw(16)
+       << std::setfill('0') << hash << ".cache";
+  return path.str();
+}
+
+std::string
+MapCache::get_default_folder() {
+  std::string folder;
+#ifdef _WIN32
+  const char *base = std::getenv("LOCALAPPDATA");
+  folder = (base != nullptr) ? base : ".";
+  folder += "/freeserf";
+  _mkdir(folder.c_str());
+  folder += "/maps";
+  _mkdir(folder.c_str());
+#else
+  const char *base = std::getenv("XDG_CACHE_HOME");
+  if ((base != nullptr) && (base[0] != 0)) {
+    folder = base;
+  } else {
+    base = std::getenv("HOME");
+    folder = (base != nullptr) ? base : ".";
+    folder += "/.cache";
+    mkdir(folder.c_str(), S_IRWXU);
+  }
+  folder += "/freeserf";
+  mkdir(folder.c_str(), S_IRWXU);
+  folder += "/maps";
+  mkdir(folder.c_str(), S_IRWXU);
+#endif
+
+  return folder;
+}
+
+// FNV-1a over the packed tiles.
+uint64_t
+MapCache::get_checksum(const PackedTile *tiles, size_t count) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t*>(tiles);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < count * sizeof(PackedTile); i++) {
+    hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
@@ -0,0 +1,89 @@
+/*
+ * map-cache.h - Cache of generated maps on disk
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_MAP_CACHE_H_
+#define SRC_MAP_CACHE_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "src/map.h"
+
+class ClassicMapGenerator;
+
+// Keeps landscapes made by the map generator in files named after the hash
+// of the generator key, so maps generated before are memory-mapped instead
+// of generated again. Each file holds the full key and a checksum of the
+// tiles, and is rejected when either doesn't match. Disabled by default.
+class MapCache {
+ public:
+  typedef struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t key_size;
+    uint64_t tile_count;
+    uint64_t checksum;
+  } Header;
+
+  // Landscape tile in the cache, all values fit in a byte.
+  typedef struct PackedTile {
+    uint8_t height;
+    uint8_t types;  // Up triangle in the high nibble.
+    uint8_t mineral;
+    uint8_t resource_amount;
+    uint8_t obj;
+  } PackedTile;
+
+ protected:
+  std::atomic<bool> enabled;
+  std::mutex folder_mutex;
+  std::string folder;
+
+  MapCache();
+
+ public:
+  static MapCache &get_instance();
+
+  void set_enabled(bool enabled) { this->enabled = enabled; }
+  bool is_enabled() const { return enabled; }
+  // Use folder instead of the one in the user cache folder.
+  void set_folder(const std::string &folder);
+  std::string get_folder();
+
+  // Run generator, which must have been initialized, or take its landscape
+  // from the cache when enabled. New landscapes are added to the cache.
+  void generate(ClassicMapGenerator *generator);
+
+  bool load(const std::string &key, size_t tile_count,
+            std::vector<Map::LandscapeTile> *landscape);
+  bool store(const std::string &key,
+             const std::vector<Map::LandscapeTile> &landscape);
+  // File of the landscape for key.
+  std::string get_path(const std::string &key);
+
+ protected:
+  static std::string get_default_folder();
+  static uint64_t get_checksum(const PackedTile *tiles, size_t count);
+};
+
+#endif  // SRC_MAP_CACHE_H_
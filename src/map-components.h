@@ -0,0 +1,77 @@
+/*
+ * map-components.h - Connected components of map positions
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_MAP_COMPONENTS_H_
+#define SRC_MAP_COMPONENTS_H_
+
+#include <vector>
+
+#include "src/map-geometry.h"
+
+// Labels connected components of map positions. The links function returns
+// for a position the bit mask of directions in which it connects to its
+// neighbours. Each fill() visits the positions reachable from a start
+// position through a worklist, so every position is expanded once.
+class MapComponents {
+ public:
+  // Label of positions that belong to no component yet.
+  enum { no_label = 0 };
+
+ protected:
+  const MapGeometry &geom;
+  std::vector<unsigned int> labels;
+  std::vector<MapPos> worklist;
+
+ public:
+  explicit MapComponents(const MapGeometry &geom_)
+    : geom(geom_)
+    , labels(geom_.tile_count(), no_label) {}
+
+  unsigned int get_label(MapPos pos) const { return labels[pos]; }
+  bool is_labelled(MapPos pos) const { return labels[pos] != no_label; }
+
+  // Label start, which must be unlabelled, and every unlabelled position
+  // reachable from it with label. Returns the number of positions labelled.
+  template<typename Links>
+  unsigned int fill(MapPos start, unsigned int label, Links links) {
+    unsigned int count = 0;
+    labels[start] = label;
+    worklist.push_back(start);
+    while (!worklist.empty()) {
+      MapPos pos = worklist.back();
+      worklist.pop_back();
+      count += 1;
+
+      int dirs = links(pos);
+      for (Direction d : cycle_directions_cw()) {
+        MapPos other_pos = geom.move(pos, d);
+        if (((dirs >> d) & 1) && labels[other_pos] == no_label) {
+          labels[other_pos] = label;
+          worklist.push_back(other_pos);
+        }
+      }
+    }
+
+    return count;
+  }
+};
+
+#endif  // SRC_MAP_COMPONENTS_H_
@@ -23,12 +23,23 @@
 
 #include <algorithm>
 #include <array>
+#include <sstream>
+#include <utility>
 
 #include "src/debug.h"
+#include "src/map-components.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# define MAP_GENERATOR_SSE2
+# include <emmintrin.h>
+#endif
 
 const int ClassicMapGenerator::default_max_lake_area = 14;
 const int ClassicMapGenerator::default_water_level = 20;
 const int ClassicMapGenerator::default_terrain_spikyness = 0x9999;
+const int ClassicMapGenerator::version = 1;
 
 ClassicMapGenerator::ClassicMapGenerator(const Map& map, const Random& random)
   : map(map)
@@ -39,7 +50,6 @@ ClassicMapGenerator::ClassicMapGenerator(const Map& map, const Random& random)
   , max_lake_area(default_max_lake_area)
   , terrain_spikyness(default_terrain_spikyness) {
   tiles.resize(map.geom().tile_count());
-  tags.resize(map.geom().tile_count());
 }
 
 void ClassicMapGenerator::init(
@@ -52,6 +62,25 @@ void ClassicMapGenerator::init(
   this->terrain_spikyness = terrain_spikyness;
 }
 
+std::string
+ClassicMapGenerator::get_key() const {
+  std::stringstream key;
+  key << "classic-" << version << "-" << map.geom().size() << "-"
+      << static_cast<std::string>(rnd) << "-" << height_generator << "-"
+      << preserve_bugs << "-" << max_lake_area << "-" << water_level << "-"
+      << terrain_spikyness;
+  return key.str();
+}
+
+void
+ClassicMapGenerator::set_landscape(
+                             std::vector<Map::LandscapeTile> &&landscape) {
+  if (landscape.size() != tiles.size()) {
+    throw ExceptionFreeserf("Landscape does not match map size");
+  }
+  tiles = std::move(landscape);
+}
+
 /* Whether any of the two up/down tiles at this pos are water. */
 bool ClassicMapGenerator::is_water_tile(MapPos pos) const {
   return tiles[pos].type_down <= Map::TerrainWater3 &&
@@ -401,10 +430,37 @@ ClassicMapGenerator::expand_water_body(MapPos pos) {
 // shore).
 void
 ClassicMapGenerator::create_water_bodies() {
+  // Sort positions by height, keeping map order within each height, so
+  // they are visited in the same order as scanning the map once per height.
+  const unsigned int height_count = 256;
+  std::vector<unsigned int> first(height_count + 1, 0);
+  for (MapPos pos_ : map.geom()) {
+    first[std::min(tiles[pos_].height, height_count - 1) + 1] += 1;
+  }
+  for (unsigned int h = 0; h < height_count; h++) {
+    first[h + 1] += first[h];
+  }
+  std::vector<MapPos> by_height(map.geom().tile_count());
+  std::vector<unsigned int> next(first.begin(), first.end() - 1);
+  for (MapPos pos_ : map.geom()) {
+    by_height[next[std::min(tiles[pos_].height, height_count - 1)]++] = pos_;
+  }
+
+  // Expanding only sets the current position to 0 and others to the marks
+  // 252-255, so positions can't reach a later height other than their own.
+  // Heights that collide with the marks are scanned as before.
   for (unsigned int h = 0; h <= water_level; h++) {
-    for (MapPos pos_ : map.geom()) {
-      if (tiles[pos_].height == h) {
-        expand_water_body(pos_);
+    if (h < 252) {
+      for (unsigned int i = first[h]; i < first[h + 1]; i++) {
+        if (tiles[by_height[i]].height == h) {
+          expand_water_body(by_height[i]);
+        }
+      }
+    } else {
+      for (MapPos pos_ : map.geom()) {
+        if (tiles[pos_].height == h) {
+          expand_water_body(pos_);
+        }
       }
     }
   }
@@ -466,11 +522,30 @@ ClassicMapGenerator::init_types() {
   }
 }
 
-void
-ClassicMapGenerator::clear_all_tags() {
-  for (MapPos pos : map.geom()) {
-    tags[pos] = 0;
+// The i'th bit of the result indicates whether a path on land from pos in
+// direction i is possible.
+int
+ClassicMapGenerator::get_land_directions(MapPos pos) const {
+  int flags = 0;
+  if (tiles[pos].type_down >= Map::TerrainGrass0) {
+    flags |= 3;
+  }
+  if (tiles[pos].type_up >= Map::TerrainGrass0) {
+    flags |= 6;
+  }
+  if (tiles[map.move_left(pos)].type_down >= Map::TerrainGrass0) {
+    flags |= 0xc;
+  }
+  if (tiles[map.move_up_left(pos)].type_up >= Map::TerrainGrass0) {
+    flags |= 0x18;
+  }
+  if (tiles[map.move_up_left(pos)].type_down >= Map::TerrainGrass0) {
+    flags |= 0x30;
+  }
+  if (tiles[map.move_up(pos)].type_up >= Map::TerrainGrass0) {
+    flags |= 0x21;
   }
+  return flags;
 }
 
 // Remove islands.
@@ -488,70 +563,21 @@ ClassicMapGenerator::clear_all_tags() {
 // first initial positions are chosen (around 0, 0).
 void
 ClassicMapGenerator::remove_islands() {
-  // Initially all positions are tagged with 0. When reached from another
-  // position the tag is changed to 1, and later when that position is
-  // itself expanded the tag is changed to 2.
-  clear_all_tags();
+  MapComponents components(map.geom());
+  auto on_land = [this](MapPos pos) { return get_land_directions(pos); };
 
   for (MapPos pos_ : map.geom()) {
-    if (tiles[pos_].height > 0 && tags[pos_] == 0) {
-      tags[pos_] = 1;
-
-      unsigned int num = 0;
-      bool changed = true;
-      while (changed) {
-        changed = false;
-        for (MapPos pos_ : map.geom()) {
-          if (tags[pos_] == 1) {
-            num += 1;
-            tags[pos_] = 2;
-
-            // The i'th flag will indicate whether a path on land from
-            // pos_in direction i is possible.
-            int flags = 0;
-            if (tiles[pos_].type_down >= Map::TerrainGrass0) {
-              flags |= 3;
-            }
-            if (tiles[pos_].type_up >= Map::TerrainGrass0) {
-              flags |= 6;
-            }
-            if (tiles[map.move_left(pos_)].type_down >=
-                Map::TerrainGrass0) {
-              flags |= 0xc;
-            }
-            if (tiles[map.move_up_left(pos_)].type_up >=
-                Map::TerrainGrass0) {
-              flags |= 0x18;
-            }
-            if (tiles[map.move_up_left(pos_)].type_down >=
-                Map::TerrainGrass0) {
-              flags |= 0x30;
-            }
-            if (tiles[map.move_up(pos_)].type_up >= Map::TerrainGrass0) {
-              flags |= 0x21;
-            }
-
-            // Mark positions following any valid direction on land.
-            for (Direction d : cycle_directions_cw()) {
-              if (BIT_TEST(flags, d)) {
-                if (tags[map.move(pos_, d)] == 0) {
-                  tags[map.move(pos_, d)] = 1;
-                  changed = true;
-                }
-              }
-            }
-          }
-        }
+    if (tiles[pos_].height > 0 && !components.is_labelled(pos_)) {
+      unsigned int num = components.fill(pos_, 1, on_land);
+      if (4*num >= map.geom().tile_count()) {
+        break;
       }
-
-      if (4*num >= map.geom().tile_count())
-          break;
     }
   }
 
-  // Change every position that was not tagged (i.e. tag is 0) to water.
+  // Change every position that was not reached to water.
   for (MapPos pos_ : map.geom()) {
-    if (tiles[pos_].height > 0 && tags[pos_] == 0) {
+    if (tiles[pos_].height > 0 && !components.is_labelled(pos_)) {
       tiles[pos_].height = 0;
       tiles[pos_].type_up = Map::TerrainWater0;
       tiles[pos_].type_up = Map::TerrainWater0;
@@ -572,13 +598,165 @@ ClassicMapGenerator::heights_rescale() {
   }
 }
 
+// Find the triangles of type old in a row that are adjacent to a triangle of
+// type seed. The up and down pointers point to the first position of the row
+// in the padded type planes, change_up and change_down receive 0xff for the
+// triangles to change and 0 otherwise. See seed_terrain_type_sequential()
+// for the adjacent triangles of up and down triangles.
+static void
+seed_terrain_row_scalar(const uint8_t *up, const uint8_t *down, int stride,
+                        int begin, int end, uint8_t old, uint8_t seed,
+                        uint8_t *change_up, uint8_t *change_down) {
+  const uint8_t *up_above = up - stride;
+  const uint8_t *down_above = down - stride;
+  const uint8_t *up_below = up + stride;
+  const uint8_t *down_below = down + stride;
+
+  for (int x = begin; x < end; x++) {
+    bool common = down_above[x-1] == seed || up_above[x-1] == seed ||
+                  up_above[x] == seed || down[x-1] == seed ||
+                  up[x+1] == seed || down_below[x] == seed ||
+                  down_below[x+1] == seed || up_below[x+1] == seed;
+    bool seed_up = common || up[x-1] == seed || down[x] == seed ||
+                   down_below[x-1] == seed || up_below[x] == seed;
+    bool seed_down = common || down_above[x] == seed ||
+                     up_above[x+1] == seed || up[x] == seed ||
+                     down[x+1] == seed;
+    change_up[x] = (up[x] == old && seed_up) ? 0xff : 0;
+    change_down[x] = (down[x] == old && seed_down) ? 0xff : 0;
+  }
+}
+
+#ifdef MAP_GENERATOR_SSE2
+static inline __m128i
+seed_terrain_match(const uint8_t *types, __m128i seed) {
+  return _mm_cmpeq_epi8(
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(types)), seed);
+}
+
+// Same as seed_terrain_row_scalar() for 16 positions at a time, starting at
+// the beginning of the row. Returns the number of positions done.
+static int
+seed_terrain_row_sse2(const uint8_t *up, const uint8_t *down, int stride,
+                      int end, uint8_t old, uint8_t seed,
+                      uint8_t *change_up, uint8_t *change_down) {
+  const uint8_t *up_above = up - stride;
+  const uint8_t *down_above = down - stride;
+  const uint8_t *up_below = up + stride;
+  const uint8_t *down_below = down + stride;
+  const __m128i old_ = _mm_set1_epi8(static_cast<char>(old));
+  const __m128i seed_ = _mm_set1_epi8(static_cast<char>(seed));
+
+  int x = 0;
+  for (; x + 16 <= end; x += 16) {
+    __m128i common = _mm_or_si128(
+      _mm_or_si128(
+        _mm_or_si128(seed_terrain_match(down_above + x - 1, seed_),
+                     seed_terrain_match(up_above + x - 1, seed_)),
+        _mm_or_si128(seed_terrain_match(up_above + x, seed_),
+                     seed_terrain_match(down + x - 1, seed_))),
+      _mm_or_si128(
+        _mm_or_si128(seed_terrain_match(up + x + 1, seed_),
+                     seed_terrain_match(down_below + x, seed_)),
+        _mm_or_si128(seed_terrain_match(down_below + x + 1, seed_),
+                     seed_terrain_match(up_below + x + 1, seed_))));
+    __m128i seed_up = _mm_or_si128(
+      _mm_or_si128(common,
+        _mm_or_si128(seed_terrain_match(up + x - 1, seed_),
+                     seed_terrain_match(down + x, seed_))),
+      _mm_or_si128(seed_terrain_match(down_below + x - 1, seed_),
+                   seed_terrain_match(up_below + x, seed_)));
+    __m128i seed_down = _mm_or_si128(
+      _mm_or_si128(common,
+        _mm_or_si128(seed_terrain_match(down_above + x, seed_),
+                     seed_terrain_match(up_above + x + 1, seed_))),
+      _mm_or_si128(seed_terrain_match(up + x, seed_),
+                   seed_terrain_match(down + x + 1, seed_)));
+
+    __m128i old_up = seed_terrain_match(up + x, old_);
+    __m128i old_down = seed_terrain_match(down + x, old_);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(change_up + x),
+                     _mm_and_si128(old_up, seed_up));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(change_down + x),
+                     _mm_and_si128(old_down, seed_down));
+  }
+
+  return x;
+}
+#endif
+
 // Change terrain types based on a seed type in adjacent tiles.
 //
 // For every triangle, if the current type is old and any adjacent triangle
 // has type seed, then the triangle is changed into the new_ terrain type.
+//
+// The positions are updated in place in map order, so a changed triangle is
+// seen by the positions after it. That only makes a difference when old or
+// new_ is the seed type, otherwise every row is evaluated at once from byte
+// planes of the types. The planes are padded by one wrapped position on
+// every side, so all adjacent triangles are at fixed offsets.
 void
 ClassicMapGenerator::seed_terrain_type(Map::Terrain old, Map::Terrain seed,
                                        Map::Terrain new_) {
+  if (old == seed || new_ == seed) {
+    seed_terrain_type_sequential(old, seed, new_);
+    return;
+  }
+
+  const int cols = map.geom().cols();
+  const int rows = map.geom().rows();
+  const int stride = cols + 2;
+  std::vector<uint8_t> up((rows + 2) * stride);
+  std::vector<uint8_t> down((rows + 2) * stride);
+  for (int y = 0; y < rows; y++) {
+    uint8_t *up_row = &up[(y + 1) * stride];
+    uint8_t *down_row = &down[(y + 1) * stride];
+    for (int x = 0; x < cols; x++) {
+      const Map::LandscapeTile &tile = tiles[map.geom().pos(x, y)];
+      up_row[x + 1] = tile.type_up;
+      down_row[x + 1] = tile.type_down;
+    }
+    up_row[0] = up_row[cols];
+    down_row[0] = down_row[cols];
+    up_row[cols + 1] = up_row[1];
+    down_row[cols + 1] = down_row[1];
+  }
+  std::copy(up.begin() + rows * stride, up.begin() + (rows + 1) * stride,
+            up.begin());
+  std::copy(down.begin() + rows * stride, down.begin() + (rows + 1) * stride,
+            down.begin());
+  std::copy(up.begin() + stride, up.begin() + 2 * stride,
+            up.begin() + (rows + 1) * stride);
+  std::copy(down.begin() + stride, down.begin() + 2 * stride,
+            down.begin() + (rows + 1) * stride);
+
+  std::vector<uint8_t> change_up(cols);
+  std::vector<uint8_t> change_down(cols);
+  for (int y = 0; y < rows; y++) {
+    const uint8_t *up_row = &up[(y + 1) * stride + 1];
+    const uint8_t *down_row = &down[(y + 1) * stride + 1];
+    int x = 0;
+#ifdef MAP_GENERATOR_SSE2
+    x = seed_terrain_row_sse2(up_row, down_row, stride, cols, old, seed,
+                              change_up.data(), change_down.data());
+#endif
+    seed_terrain_row_scalar(up_row, down_row, stride, x, cols, old, seed,
+                            change_up.data(), change_down.data());
+
+    for (x = 0; x < cols; x++) {
+      Map::LandscapeTile &tile = tiles[map.geom().pos(x, y)];
+      if (change_up[x] != 0) tile.type_up = new_;
+      if (change_down[x] != 0) tile.type_down = new_;
+    }
+  }
+}
+
+// Reference implementation of seed_terrain_type() that visits one position
+// at a time.
+void
+ClassicMapGenerator::seed_terrain_type_sequential(Map::Terrain old,
+                                                  Map::Terrain seed,
+                                                  Map::Terrain new_) {
   for (MapPos pos_ : map.geom()) {
     // Check that the central triangle is of type old (*), and that any
     // adjacent triangle is of type seed:
@@ -23,6 +23,7 @@
 #define SRC_MAP_GENERATOR_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "src/map.h"
@@ -55,6 +56,8 @@ class ClassicMapGenerator : public MapGenerator {
   static const int default_max_lake_area;
   static const int default_water_level;
   static const int default_terrain_spikyness;
+  // Bump whenever the output of generate() changes.
+  static const int version;
 
   ClassicMapGenerator(const Map &map, const Random &random);
   void init(HeightGenerator height_generator, bool preserve_bugs,
@@ -63,6 +66,12 @@ class ClassicMapGenerator : public MapGenerator {
             int terrain_spikyness = default_terrain_spikyness);
   void generate();
 
+  // Identifies the landscape that generate() makes after init(): version
+  // of the generator, map size, random seed and parameters.
+  std::string get_key() const;
+  // Take the landscape that generate() made for the same key before.
+  void set_landscape(std::vector<Map::LandscapeTile> &&landscape);
+
   int get_height(MapPos pos) const { return tiles[pos].height; }
   Map::Terrain get_type_up(MapPos pos) const {
     return tiles[pos].type_up; }
@@ -81,7 +90,6 @@ class ClassicMapGenerator : public MapGenerator {
   Random rnd;
 
   std::vector<Map::LandscapeTile> tiles;
-  std::vector<int> tags;
   HeightGenerator height_generator;
   bool preserve_bugs;
 
@@ -108,12 +116,14 @@ class ClassicMapGenerator : public MapGenerator {
 
   void heights_rebase();
   void init_types();
-  void clear_all_tags();
+  int get_land_directions(MapPos pos) const;
   void remove_islands();
   void heights_rescale();
 
   void seed_terrain_type(Map::Terrain old, Map::Terrain seed,
                          Map::Terrain new_);
+  void seed_terrain_type_sequential(Map::Terrain old, Map::Terrain seed,
+                                    Map::Terrain new_);
   void change_shore_water_type();
   void change_shore_grass_type();
 
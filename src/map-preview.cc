@@ -0,0 +1,115 @@
+/*
+ * map-preview.cc - Map generation for previews on a worker thread
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/map-preview.h"
+
+#include <utility>
+
+#include "src/map-cache.h"
+#include "src/map-generator.h"
+#include "src/map-geometry.h"
+
+MapPreview::MapPreview()
+  : quit(false)
+  , requested(0)
+  , generating(0)
+  , pending(false)
+  , request({0, Random(), false}) {
+  thread = std::thread(&MapPreview::run, this);
+}
+
+MapPreview::~MapPreview() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  wakeup.notify_one();
+  thread.join();
+}
+
+void
+MapPreview::generate(unsigned int map_size, const Random &random,
+                     bool mission) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requested++;
+    pending = true;
+    request = {map_size, random, mission};
+    result.reset();
+  }
+  wakeup.notify_one();
+}
+
+void
+MapPreview::cancel() {
+  std::lock_guard<std::mutex> lock(mutex);
+  requested++;
+  pending = false;
+  result.reset();
+}
+
+PMap
+MapPreview::take_map() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return std::move(result);
+}
+
+void
+MapPreview::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeup.wait(lock, [this]() { return quit || pending; });
+    if (quit) {
+      break;
+    }
+
+    Request current = request;
+    generating = requested;
+    pending = false;
+
+    lock.unlock();
+    PMap map = generate_map(current);
+    lock.lock();
+
+    // Keep the map only if no other request came in meanwhile.
+    if (generating == requested) {
+      result = std::move(map);
+    }
+    generating = 0;
+  }
+}
+
+PMap
+MapPreview::generate_map(const Request &request) {
+  PMap map = std::make_shared<Map>(MapGeometry(request.map_size));
+  if (request.mission) {
+    ClassicMissionMapGenerator generator(*map, request.random);
+    generator.init();
+    MapCache::get_instance().generate(&generator);
+    map->init_tiles(generator);
+  } else {
+    ClassicMapGenerator generator(*map, request.random);
+    generator.init(MapGenerator::HeightGeneratorMidpoints, true);
+    MapCache::get_instance().generate(&generator);
+    map->init_tiles(generator);
+  }
+  return map;
+}
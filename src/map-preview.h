@@ -0,0 +1,74 @@
+/*
+ * map-preview.h - Map generation for previews on a worker thread
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_MAP_PREVIEW_H_
+#define SRC_MAP_PREVIEW_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "src/map.h"
+#include "src/random.h"
+
+// Generates maps for previews on a worker thread, so the user interface
+// doesn't wait for the generator. Only the latest request counts: it
+// replaces a request that hasn't started yet, and a map still being
+// generated for an older request is dropped when it is done.
+class MapPreview {
+ protected:
+  typedef struct Request {
+    unsigned int map_size;
+    Random random;
+    bool mission;
+  } Request;
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool quit;
+
+  // Serial of the latest request and of the request being generated.
+  unsigned int requested;
+  unsigned int generating;
+  bool pending;
+  Request request;
+  PMap result;
+
+ public:
+  MapPreview();
+  virtual ~MapPreview();
+
+  // Generate a map of map_size from random, with the generator of the
+  // mission maps or with the one of custom games.
+  void generate(unsigned int map_size, const Random &random, bool mission);
+  // Drop the pending request and any map not taken yet.
+  void cancel();
+  // The map of the latest request once it is done, nullptr before that and
+  // after it was taken.
+  PMap take_map();
+
+ protected:
+  void run();
+  static PMap generate_map(const Request &request);
+};
+
+#endif  // SRC_MAP_PREVIEW_H_
@@ -0,0 +1,129 @@
+/*
+ * map-profiler.cc - Map generation profiling tool.
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <istream>
+#include <sstream>
+#include <string>
+
+#include "src/command_line.h"
+#include "src/log.h"
+#include "src/version.h"
+#include "src/map.h"
+#include "src/map-generator.h"
+#include "src/random.h"
+
+/* Smallest and largest map size selectable in the game. */
+#define MIN_MAP_SIZE  3
+#define MAX_MAP_SIZE  10
+
+// FNV-1a over the generated tiles, to compare output between builds.
+static uint64_t
+checksum(const std::vector<Map::LandscapeTile> &tiles, uint64_t hash) {
+  for (const Map::LandscapeTile &tile : tiles) {
+    const unsigned int values[] = {
+      tile.height, tile.type_up, tile.type_down, tile.mineral,
+      static_cast<unsigned int>(tile.resource_amount), tile.obj
+    };
+    for (unsigned int value : values) {
+      hash = (hash ^ value) * UINT64_C(1099511628211);
+    }
+  }
+  return hash;
+}
+
+static void
+profile_generator(unsigned int size, MapGenerator::HeightGenerator heights,
+                  const Random &seed, unsigned int iterations) {
+  double total = 0;
+  uint64_t hash = UINT64_C(14695981039346656037);
+  for (unsigned int i = 0; i < iterations; i++) {
+    Map map(MapGeometry{size});
+    Random random(seed);
+    for (unsigned int j = 0; j < i; j++) {
+      random.random();
+    }
+    ClassicMapGenerator generator(map, random);
+    generator.init(heights, false);
+
+    auto start = std::chrono::steady_clock::now();
+    generator.generate();
+    auto end = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::milli>(end - start).count();
+
+    hash = checksum(generator.get_landscape(), hash);
+  }
+
+  std::stringstream line;
+  line << "size " << std::setw(2) << size << ", "
+       << std::setw(13) << std::left
+       << (heights == MapGenerator::HeightGeneratorMidpoints ?
+           "midpoints" : "diamond-square") << std::right
+       << std::fixed << std::setprecision(3) << std::setw(10)
+       << total / iterations << " ms, checksum "
+       << std::hex << std::setw(16) << std::setfill('0') << hash;
+  Log::Info["profiler"] << line.str();
+}
+
+int
+main(int argc, char *argv[]) {
+  unsigned int iterations = 5;
+  unsigned int max_size = MAX_MAP_SIZE;
+  std::string seed = "8667715887436237";
+
+  CommandLine command_line;
+  command_line.add_option('h', "Show this help text", [&command_line](){
+                  command_line.show_help();
+                  exit(EXIT_SUCCESS);
+                });
+  command_line.add_option('n', "Number of maps generated per size")
+                .add_parameter("NUM", [&iterations](std::istream& s) {
+                  s >> iterations;
+                  return true;
+                });
+  command_line.add_option('r', "Random seed of the first map")
+                .add_parameter("SEED", [&seed](std::istream& s) {
+                  s >> seed;
+                  return true;
+                });
+  command_line.add_option('s', "Largest map size to generate")
+                .add_parameter("SIZE", [&max_size](std::istream& s) {
+                  s >> max_size;
+                  return true;
+                });
+  command_line.set_comment("Please report bugs to <" PACKAGE_BUGREPORT ">");
+  if (!command_line.process(argc, argv) || iterations == 0) {
+    return EXIT_FAILURE;
+  }
+
+  Log::Info["profiler"] << "starts " << FREESERF_VERSION;
+
+  Random random(seed);
+  for (unsigned int size = MIN_MAP_SIZE; size <= max_size; size++) {
+    profile_generator(size, MapGenerator::HeightGeneratorMidpoints, random,
+                      iterations);
+    profile_generator(size, MapGenerator::HeightGeneratorDiamondSquare,
+                      random, iterations);
+  }
+
+  return EXIT_SUCCESS;
+}
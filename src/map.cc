@@ -66,6 +66,8 @@
 #include "src/map.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <mutex>
 #include <utility>
 
 #include "src/debug.h"
@@ -128,15 +130,13 @@ static int spiral_pattern[] = {
   24, 16, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
-static int spiral_pattern_initialized = 0;
+/* Maps are also created on worker threads, e.g. for previews. */
+static std::once_flag spiral_pattern_initialized;
+static int spiral_radius[295];
 
 /* Initialize the global spiral_pattern. */
 static void
 init_spiral_pattern() {
-  if (spiral_pattern_initialized) {
-    return;
-  }
-
   static const int spiral_matrix[] = {
     1,  0,  0,  1,
     1,  1, -1,  0,
@@ -158,7 +158,12 @@ init_spiral_pattern() {
     }
   }
 
-  spiral_pattern_initialized = 1;
+  int radius = 0;
+  for (int i = 0; i < 295; i++) {
+    radius = std::max(radius, std::abs(spiral_pattern[2*i]));
+    radius = std::max(radius, std::abs(spiral_pattern[2*i+1]));
+    spiral_radius[i] = radius;
+  }
 }
 
 int *
@@ -166,6 +171,11 @@ Map::get_spiral_pattern() {
   return spiral_pattern;
 }
 
+int
+Map::get_spiral_radius(unsigned int last) {
+  return spiral_radius[last];
+}
+
 /* Map Object to Space. */
 const Map::Space
 Map::map_space_from_obj[] = {
@@ -336,7 +346,16 @@ Map::Map(const MapGeometry& geom)
 
   regions = (geom.cols() >> 5) * (geom.rows() >> 5);
 
-  init_spiral_pattern();
+  block_cols = geom.cols() >> 3;
+  class_counts.resize(block_cols * (geom.rows() >> 3) * ObjectClassCount);
+  init_object_classes();
+  // All positions of the empty landscape have the same attributes.
+  attributes.resize(geom_.tile_count());
+  update_attributes(0);
+  update_height_diffs(0);
+  std::fill(attributes.begin() + 1, attributes.end(), attributes[0]);
+
+  std::call_once(spiral_pattern_initialized, init_spiral_pattern);
   init_spiral_pos_pattern();
 }
 
@@ -381,12 +400,154 @@ Map::init_spiral_pos_pattern() {
 void
 Map::init_tiles(const MapGenerator &generator) {
   landscape_tiles = generator.get_landscape();
+  init_object_classes();
+  init_attributes();
+}
+
+void
+Map::init_attributes() {
+  for (MapPos pos_ : geom_) {
+    update_attributes(pos_);
+    update_height_diffs(pos_);
+  }
+}
+
+void
+Map::copy_tiles(const Map &map, MapPos pos, unsigned int cols,
+                unsigned int rows) {
+  if (map.get_size() != get_size()) {
+    throw ExceptionFreeserf("Failed to copy tiles between maps of different "
+                            "size.");
+  }
+
+  cols = std::min(cols, get_cols());
+  rows = std::min(rows, get_rows());
+  for (unsigned int r = 0; r < rows; r++) {
+    MapPos p = pos_add(pos, 0, r);
+    for (unsigned int c = 0; c < cols; c++, p = move_right(p)) {
+      landscape_tiles[p] = map.landscape_tiles[p];
+      game_tiles[p] = map.game_tiles[p];
+      attributes[p] = map.attributes[p];
+    }
+  }
+}
+
+/* Derive the attribute flags of a position from the six triangles
+   around it and the object. */
+void
+Map::update_attributes(MapPos pos) {
+  Terrain types[] = {
+    type_up(pos),
+    type_down(pos),
+    type_down(move_left(pos)),
+    type_up(move_up_left(pos)),
+    type_down(move_up_left(pos)),
+    type_up(move_up(pos))
+  };
+
+  bool water = true;
+  bool grass = true;
+  bool mine = true;
+  bool mountain = false;
+  for (Terrain type : types) {
+    water = water && type <= TerrainWater3;
+    grass = grass && type >= TerrainGrass0 && type <= TerrainGrass3;
+    if (type >= TerrainTundra0 && type <= TerrainSnow0) {
+      mountain = true;
+    } else if (!(type >= TerrainGrass0 && type <= TerrainGrass3)) {
+      mine = false;
+    }
+  }
+
+  uint8_t flags = 0;
+  if (types[0] <= TerrainWater3 && types[1] <= TerrainWater3) {
+    flags |= AttributeWaterTile;
+  }
+  if (water) flags |= AttributeInWater;
+  if ((types[1] <= TerrainWater3 && types[3] >= TerrainGrass0) ||
+      (types[2] <= TerrainWater3 && types[5] >= TerrainGrass0)) {
+    flags |= AttributeShore;
+  }
+  if (grass) flags |= AttributeGrass;
+  if (mine && mountain) flags |= AttributeMine;
+  if (map_space_from_obj[get_obj(pos)] <= SpaceSemipassable) {
+    flags |= AttributePassable;
+  }
+
+  attributes[pos].flags = flags;
+}
+
+/* Update the height differences between a position and its neighbours,
+   in both directions. */
+void
+Map::update_height_diffs(MapPos pos) {
+  for (Direction d : cycle_directions_cw()) {
+    MapPos other_pos = move(pos, d);
+    uint8_t diff = std::abs(static_cast<int>(get_height(pos)) -
+                            static_cast<int>(get_height(other_pos)));
+    attributes[pos].height_diff[d] = diff;
+    attributes[other_pos].height_diff[reverse_direction(d)] = diff;
+  }
+}
+
+void
+Map::init_object_classes() {
+  std::fill(class_counts.begin(), class_counts.end(), 0);
+  for (MapPos pos_ : geom_) {
+    ObjectClass cls = get_object_class(get_obj(pos_));
+    if (cls != ObjectClassCount) {
+      get_class_counts(pos_)[cls] += 1;
+    }
+  }
+}
+
+Map::ObjectClass
+Map::get_object_class(Object obj) {
+  if (obj == ObjectNone) {
+    return ObjectClassFree;
+  } else if (obj >= ObjectTree0 && obj <= ObjectTree7) {
+    return ObjectClassTree;
+  } else if (obj >= ObjectPine0 && obj <= ObjectPine7) {
+    return ObjectClassPine;
+  } else if (obj >= ObjectStone0 && obj <= ObjectStone7) {
+    return ObjectClassStone;
+  } else if (obj == ObjectSeeds5 ||
+             (obj >= ObjectField0 && obj <= ObjectField5)) {
+    return ObjectClassField;
+  }
+  return ObjectClassCount;
+}
+
+bool
+Map::has_object_class(MapPos pos, int radius, ObjectClass cls) const {
+  unsigned int block_rows = geom_.rows() >> 3;
+  // Blocks covering the columns and rows within radius, with wrapping.
+  int col = pos_col(pos) + geom_.cols() - radius;
+  int row = pos_row(pos) + geom_.rows() - radius;
+  unsigned int cols = std::min((col + 2*radius) / 8 - col / 8 + 1,
+                               static_cast<int>(block_cols));
+  unsigned int rows = std::min((row + 2*radius) / 8 - row / 8 + 1,
+                               static_cast<int>(block_rows));
+
+  for (unsigned int r = 0; r < rows; r++) {
+    unsigned int block_row = (row / 8 + r) & (block_rows - 1);
+    for (unsigned int c = 0; c < cols; c++) {
+      unsigned int block_col = (col / 8 + c) & (block_cols - 1);
+      if (class_counts[(block_row * block_cols + block_col) *
+                       ObjectClassCount + cls] != 0) {
+        return true;
+      }
+    }
+  }
+
+  return false;
 }
 
 /* Change the height of a map position. */
 void
 Map::set_height(MapPos pos, int height) {
   landscape_tiles[pos].height = height;
+  update_height_diffs(pos);
 
   /* Mark landscape dirty */
   for (Direction d : cycle_directions_cw()) {
@@ -401,8 +562,19 @@ Map::set_height(MapPos pos, int height) {
    building is removed. */
 void
 Map::set_object(MapPos pos, Object obj, int index) {
+  uint16_t *counts = get_class_counts(pos);
+  ObjectClass cls = get_object_class(landscape_tiles[pos].obj);
+  if (cls != ObjectClassCount) counts[cls] -= 1;
+  cls = get_object_class(obj);
+  if (cls != ObjectClassCount) counts[cls] += 1;
+
   landscape_tiles[pos].obj = obj;
   if (index >= 0) game_tiles[pos].obj_index = index;
+  if (map_space_from_obj[obj] <= SpaceSemipassable) {
+    attributes[pos].flags |= AttributePassable;
+  } else {
+    attributes[pos].flags &= ~AttributePassable;
+  }
 
   /* Notify about object change */
   for (Direction d : cycle_directions_cw()) {
@@ -950,25 +1122,140 @@ operator << (SaveWriterText &writer, Map &map) {
   return writer;
 }
 
-MapPos
-Road::get_end(Map *map) const {
-  MapPos result = begin;
-  for (const Direction dir : dirs) {
-    result = map->move(result, dir);
+/* Column and row offsets of a move in each direction. */
+static const int road_dir_col[] = { 1, 1, 0, -1, -1, 0 };
+static const int road_dir_row[] = { 0, 1, 1, 0, -1, -1 };
+
+void
+Road::Dirs::push_back(Direction dir) {
+  size_t word = count / per_word;
+  size_t shift = 3 * (count % per_word);
+  if (word == words.size()) {
+    words.push_back(0);
+  }
+  words[word] = (words[word] & ~(UINT64_C(7) << shift)) |
+                (static_cast<uint64_t>(dir) << shift);
+  count++;
+}
+
+void
+Road::clear_positions() {
+  positions.clear();
+  position_count = 0;
+  end_col = end_row = 0;
+  min_col = max_col = min_row = max_row = 0;
+}
+
+/* First slot of the probe sequence of key. */
+static size_t
+road_key_slot(uint32_t key, size_t mask) {
+  return (key * 2654435761u) & mask;
+}
+
+/* Index of the slot holding key, or of the empty slot to put it in. */
+size_t
+Road::find_position(uint32_t key) const {
+  size_t mask = positions.size() - 1;
+  size_t i = road_key_slot(key, mask);
+  while (positions[i].key != 0 && positions[i].key != key) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+static uint32_t
+road_offset_key(int col, int row) {
+  /* Never zero, which marks empty slots. */
+  return (static_cast<uint32_t>(col + 0x8000) << 16) |
+         static_cast<uint32_t>(row + 0x8000);
+}
+
+void
+Road::add_position(int col, int row) {
+  if (2 * (position_count + 1) > positions.size()) {
+    std::vector<Position> old;
+    old.swap(positions);
+    positions.resize(std::max(static_cast<size_t>(64), 2 * old.size()));
+    for (const Position &position : old) {
+      if (position.key != 0) {
+        positions[find_position(position.key)] = position;
+      }
+    }
+  }
+
+  Position &position = positions[find_position(road_offset_key(col, row))];
+  if (position.key == 0) {
+    position.key = road_offset_key(col, row);
+    position.count = 0;
+    position_count++;
+  }
+  position.count++;
+
+  min_col = std::min(min_col, col);
+  max_col = std::max(max_col, col);
+  min_row = std::min(min_row, row);
+  max_row = std::max(max_row, row);
+}
+
+void
+Road::remove_position(int col, int row) {
+  size_t i = find_position(road_offset_key(col, row));
+  if (positions[i].key == 0 || --positions[i].count > 0) {
+    return;
+  }
+  position_count--;
+
+  /* Move later keys of the run back into the emptied slot when their
+     probe sequence passes it, so that no key becomes unreachable. */
+  size_t mask = positions.size() - 1;
+  size_t j = i;
+  while (true) {
+    j = (j + 1) & mask;
+    if (positions[j].key == 0) {
+      break;
+    }
+    size_t slot = road_key_slot(positions[j].key, mask);
+    if (((j - slot) & mask) >= ((j - i) & mask)) {
+      positions[i] = positions[j];
+      i = j;
+    }
   }
-  return result;
+  positions[i].key = 0;
 }
 
 bool
-Road::has_pos(Map *map, MapPos pos) const {
-  MapPos result = begin;
-  for (const Direction dir : dirs) {
-    if (result == pos) {
-      return true;
+Road::passes_pos(Map *map, MapPos pos) const {
+  if (position_count == 0) {
+    return false;
+  }
+
+  /* Check every offset that wraps around to pos and lies within the
+     bounds of the road. Usually this is a single one. */
+  int cols = map->get_cols();
+  int rows = map->get_rows();
+  int col = map->pos_col(pos) - map->pos_col(begin) - min_col;
+  int row = map->pos_row(pos) - map->pos_row(begin) - min_row;
+  col = min_col + ((col % cols) + cols) % cols;
+  row = min_row + ((row % rows) + rows) % rows;
+  for (int c = col; c <= max_col; c += cols) {
+    for (int r = row; r <= max_row; r += rows) {
+      if (positions[find_position(road_offset_key(c, r))].key != 0) {
+        return true;
+      }
     }
-    result = map->move(result, dir);
   }
-  return (result == pos);
+
+  return false;
+}
+
+MapPos
+Road::get_end(Map *map) const {
+  return map->pos_add(begin, end_col, end_row);
+}
+
+bool
+Road::has_pos(Map *map, MapPos pos) const {
+  return (pos == begin) || passes_pos(map, pos);
 }
 
 bool
@@ -979,17 +1266,7 @@ Road::is_valid_extension(Map *map, Direction dir) const {
 
   /* Check that road does not cross itself. */
   MapPos extended_end = map->move(get_end(map), dir);
-  MapPos pos = begin;
-  bool valid = true;
-  for (const Direction _dir : dirs) {
-    pos = map->move(pos, _dir);
-    if (pos == extended_end) {
-      valid = false;
-      break;
-    }
-  }
-
-  return valid;
+  return !passes_pos(map, extended_end);
 }
 
 bool
@@ -1004,19 +1281,27 @@ Road::extend(Direction dir) {
   }
 
   dirs.push_back(dir);
+  end_col += road_dir_col[dir];
+  end_row += road_dir_row[dir];
+  add_position(end_col, end_row);
 
   return true;
 }
 
 bool
 Road::undo() {
-  if (begin == bad_map_pos) {
+  if (begin == bad_map_pos || dirs.empty()) {
     return false;
   }
 
+  Direction dir = dirs.back();
+  remove_position(end_col, end_row);
+  end_col -= road_dir_col[dir];
+  end_row -= road_dir_row[dir];
   dirs.pop_back();
   if (dirs.size() == 0) {
     begin = bad_map_pos;
+    clear_positions();
   }
 
   return true;
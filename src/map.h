@@ -22,6 +22,9 @@
 #ifndef SRC_MAP_H_
 #define SRC_MAP_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <list>
 #include <memory>
 #include <utility>
@@ -35,19 +38,86 @@ class Map;
 
 class Road {
  public:
-  typedef std::list<Direction> Dirs;
+  // Directions of a road, packed in three bits each.
+  class Dirs {
+   protected:
+    static const size_t per_word = 21;
+
+    std::vector<uint64_t> words;
+    size_t count;
+
+   public:
+    class const_iterator {
+     protected:
+      const Dirs *dirs;
+      size_t index;
+
+     public:
+      typedef std::bidirectional_iterator_tag iterator_category;
+      typedef Direction value_type;
+      typedef ptrdiff_t difference_type;
+      typedef const Direction *pointer;
+      typedef Direction reference;
+
+      const_iterator(const Dirs *dirs_, size_t index_)
+        : dirs(dirs_), index(index_) {}
+
+      Direction operator*() const { return (*dirs)[index]; }
+      const_iterator &operator++() { index++; return *this; }
+      const_iterator operator++(int) {
+        const_iterator it = *this; index++; return it; }
+      const_iterator &operator--() { index--; return *this; }
+      const_iterator operator--(int) {
+        const_iterator it = *this; index--; return it; }
+      bool operator == (const const_iterator &rhs) const {
+        return index == rhs.index; }
+      bool operator != (const const_iterator &rhs) const {
+        return index != rhs.index; }
+    };
+    typedef const_iterator iterator;
+
+    Dirs() : count(0) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return (count == 0); }
+    Direction operator[](size_t i) const {
+      return static_cast<Direction>((words[i / per_word] >>
+                                     (3 * (i % per_word))) & 7); }
+    Direction front() const { return (*this)[0]; }
+    Direction back() const { return (*this)[count - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    void push_back(Direction dir);
+    void pop_back() { count--; }
+    void clear() { words.clear(); count = 0; }
+  };
 
  protected:
+  // A position of the road as column and row offset from its source,
+  // with the number of times the road passes it.
+  typedef struct Position {
+    uint32_t key;
+    unsigned int count;
+  } Position;
+
   MapPos begin;
   Dirs dirs;
 
+  // Open addressing table of the positions after the source. Offsets
+  // don't depend on the map, so extend() can maintain it.
+  std::vector<Position> positions;
+  size_t position_count;
+  int end_col, end_row;
+  int min_col, max_col, min_row, max_row;
+
   static const size_t max_length = 256;
 
  public:
-  Road() { begin = bad_map_pos; }
+  Road() { begin = bad_map_pos; clear_positions(); }
 
   bool is_valid() const { return (begin != bad_map_pos); }
-  void invalidate() { begin = bad_map_pos; dirs.clear(); }
+  void invalidate() { begin = bad_map_pos; dirs.clear(); clear_positions(); }
   void start(MapPos start) { begin = start; }
   MapPos get_source() const { return begin; }
   Dirs get_dirs() const { return dirs; }
@@ -60,6 +130,14 @@ class Road {
   bool undo();
   MapPos get_end(Map *map) const;
   bool has_pos(Map *map, MapPos pos) const;
+
+ protected:
+  void clear_positions();
+  size_t find_position(uint32_t key) const;
+  void add_position(int col, int row);
+  void remove_position(int col, int row);
+  // Whether the road passes pos after leaving the source.
+  bool passes_pos(Map *map, MapPos pos) const;
 };
 
 class SaveReaderBinary;
@@ -186,6 +264,16 @@ class Map {
     Object127
   } Object;
 
+  // Classes of objects that serfs search for, counted per block of tiles.
+  typedef enum ObjectClass {
+    ObjectClassFree = 0,  // ObjectNone
+    ObjectClassTree,      // ObjectTree0-7
+    ObjectClassPine,      // ObjectPine0-7
+    ObjectClassStone,     // ObjectStone0-7
+    ObjectClassField,     // ObjectSeeds5 and ObjectField0-5
+    ObjectClassCount
+  } ObjectClass;
+
   typedef enum Minerals {
     MineralsNone = 0,
     MineralsGold,
@@ -227,6 +315,17 @@ class Map {
     TerrainSnow1
   } Terrain;
 
+  // Facts derived from the terrain and object around a position, kept up to
+  // date with the tiles.
+  typedef enum Attribute {
+    AttributeWaterTile = 1 << 0,  // Both up and down triangles are water.
+    AttributeInWater = 1 << 1,    // All six triangles are water.
+    AttributeShore = 1 << 2,      // Fishing spot: water next to land.
+    AttributeGrass = 1 << 3,      // All six triangles are grass.
+    AttributeMine = 1 << 4,       // Mountain terrain suited for a mine.
+    AttributePassable = 1 << 5,   // The object can be passed by serfs.
+  } Attribute;
+
   class Handler {
    public:
     virtual ~Handler() {}
@@ -306,6 +405,17 @@ class Map {
 
   std::unique_ptr<MapPos[]> spiral_pos_pattern;
 
+  typedef struct TileAttributes {
+    uint8_t flags;
+    uint8_t height_diff[6];
+  } TileAttributes;
+
+  std::vector<TileAttributes> attributes;
+
+  // Count of each object class per block of 8x8 tiles.
+  unsigned int block_cols;
+  std::vector<uint16_t> class_counts;
+
  public:
   explicit Map(const MapGeometry& geom);
 
@@ -407,17 +517,19 @@ class Map {
                                                    get_obj(pos) <=
                                                    ObjectCastle); }
 
+  bool has_attribute(MapPos pos, Attribute attribute) const {
+    return (attributes[pos].flags & attribute) != 0; }
+  // Absolute height difference to the neighbour in direction.
+  unsigned int get_height_diff(MapPos pos, Direction dir) const {
+    return attributes[pos].height_diff[dir]; }
+
   /* Whether any of the two up/down tiles at this pos are water. */
   bool is_water_tile(MapPos pos) const {
-    return (type_down(pos) <= TerrainWater3 &&
-            type_up(pos) <= TerrainWater3); }
+    return has_attribute(pos, AttributeWaterTile); }
 
   /* Whether the position is completely surrounded by water. */
   bool is_in_water(MapPos pos) const {
-    return (is_water_tile(pos) &&
-            is_water_tile(move_up_left(pos)) &&
-            type_down(move_left(pos)) <= TerrainWater3 &&
-            type_up(move_up(pos)) <= TerrainWater3); }
+    return has_attribute(pos, AttributeInWater); }
 
   /* Mapping from Object to Space. */
   static const Space map_space_from_obj[128];
@@ -431,6 +543,19 @@ class Map {
   unsigned int get_gold_deposit() const;
 
   void init_tiles(const MapGenerator &generator);
+  // Recount object classes after tiles were written directly, e.g. loaded.
+  void init_object_classes();
+  // Recompute tile attributes after tiles were written directly.
+  void init_attributes();
+  // Copy the tiles of an area of cols by rows starting at pos, wrapping at
+  // the edges, from a map of the same geometry. Object classes are left as
+  // they were.
+  void copy_tiles(const Map &map, MapPos pos, unsigned int cols,
+                  unsigned int rows);
+
+  static ObjectClass get_object_class(Object obj);
+  // Whether an object of class exists within radius columns and rows of pos.
+  bool has_object_class(MapPos pos, int radius, ObjectClass cls) const;
 
   void update(unsigned int tick, Random *rnd);
   const UpdateState& get_update_state() const { return update_state; }
@@ -442,6 +567,8 @@ class Map {
   void del_change_handler(Handler *handler);
 
   static int *get_spiral_pattern();
+  // Largest column or row distance of the spiral offsets up to last.
+  static int get_spiral_radius(unsigned int last);
 
   /* Actually place road segments */
   bool place_road_segments(const Road &road);
@@ -465,6 +592,11 @@ class Map {
 
  protected:
   void init_spiral_pos_pattern();
+  void update_attributes(MapPos pos);
+  void update_height_diffs(MapPos pos);
+  uint16_t *get_class_counts(MapPos pos) {
+    return &class_counts[((pos_row(pos) >> 3) * block_cols +
+                          (pos_col(pos) >> 3)) * ObjectClassCount]; }
 
   void update_public(MapPos pos, Random *rnd);
   void update_hidden(MapPos pos, Random *rnd);
@@ -27,6 +27,7 @@
 #include "src/game.h"
 #include "src/interface.h"
 #include "src/viewport.h"
+#include "src/game-thread.h"
 
 const int
 Minimap::max_scale = 8;
@@ -415,7 +416,7 @@ Minimap::move_by_pixels(int dx, int dy) {
 }
 
 MinimapGame::MinimapGame(Interface *_interface, PGame _game)
-  : Minimap(_game->get_map())
+  : Minimap(_game->get_shared_map())
   , interface(_interface)
   , game(_game)
   , advanced(-1)
@@ -444,6 +445,9 @@ MinimapGame::set_draw_buildings(bool _draw_buildings) {
 
 void
 MinimapGame::internal_draw() {
+  // Drawn from the game itself rather than from the snapshot.
+  std::unique_lock<GameThread> lock = interface->lock_game();
+
   switch (ownership_mode) {
     case OwnershipModeNone:
       draw_minimap_map();
@@ -258,6 +258,9 @@ class Collection {
 
   size_t
   size() const { return objects.size() - free_object_indexes.size(); }
+  // One past the largest index of an object.
+  size_t
+  get_index_limit() const { return objects.size(); }
 };
 
 #endif  // SRC_OBJECTS_H_
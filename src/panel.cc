@@ -115,9 +115,8 @@ PanelBar::draw_return_arrow() {
 void
 PanelBar::draw_panel_buttons() {
   if (enabled) {
-    Player *player = interface->get_player();
     /* Blinking message icon. */
-    if ((player != NULL) && player->has_notification()) {
+    if (interface->has_notification()) {
       if (blink_trigger) {
         draw_message_notify();
       }
@@ -283,15 +282,19 @@ PanelBar::button_click(int button) {
       interface->build_castle();
       break;
     case ButtonDestroyRoad: {
-      bool r = interface->get_player()->get_game()->demolish_road(
-                                                interface->get_map_cursor_pos(),
-                                                       interface->get_player());
-      if (!r) {
-        play_sound(Audio::TypeSfxNotAccepted);
-        interface->update_map_cursor_pos(interface->get_map_cursor_pos());
-      } else {
-        play_sound(Audio::TypeSfxAccepted);
-      }
+      unsigned int index = interface->get_player()->get_index();
+      MapPos pos = interface->get_map_cursor_pos();
+      Interface *owner = interface;
+      interface->run_on_game([index, pos](Game *target) {
+        return target->demolish_road(pos, target->get_player(index));
+      }, [owner](bool demolished) {
+        if (!demolished) {
+          owner->play_sound(Audio::TypeSfxNotAccepted);
+          owner->update_map_cursor_pos(owner->get_map_cursor_pos());
+        } else {
+          owner->play_sound(Audio::TypeSfxAccepted);
+        }
+      });
     }
       break;
     case ButtonGroundAnalysis:
@@ -341,8 +344,12 @@ PanelBar::handle_click_left(int cx, int cy) {
       timer_length = 60*60;
     }
 
-    interface->get_player()->add_timer(timer_length * TICKS_PER_SEC,
-                                       interface->get_map_cursor_pos());
+    unsigned int index = interface->get_player()->get_index();
+    MapPos pos = interface->get_map_cursor_pos();
+    int length = timer_length * TICKS_PER_SEC;
+    interface->run_on_game([index, length, pos](Game *target) {
+      target->get_player(index)->add_timer(length, pos);
+    });
 
     play_sound(Audio::TypeSfxAccepted);
   } else if (cy >= 4 && cy < 36 && cx >= 64) {
@@ -78,10 +78,7 @@ heuristic_cost(Map *map, MapPos start, MapPos end) {
 
 static unsigned int
 actual_cost(Map *map, MapPos pos, Direction dir) {
-  MapPos other_pos = map->move(pos, dir);
-  int h_diff = abs(static_cast<int>(map->get_height(pos)) -
-                   static_cast<int>(map->get_height(other_pos)));
-  return walk_cost[h_diff];
+  return walk_cost[map->get_height_diff(pos, dir)];
 }
 
 /* Find the shortest path from start to end (using A*) considering that
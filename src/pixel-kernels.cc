@@ -0,0 +1,548 @@
+/*
+ * pixel-kernels.cc - Pixel loops used for sprite compositing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/pixel-kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "src/data.h"
+#include "src/log.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+# define PIXEL_KERNELS_SSE2
+# include <emmintrin.h>
+# if defined(__GNUC__) || defined(_MSC_VER)
+#  define PIXEL_KERNELS_AVX2
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#   include <intrin.h>
+#   define TARGET_AVX2
+#  else
+#   define TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+# endif
+#endif
+
+typedef Data::Sprite::Color Color;
+
+// Scalar implementation, these are the reference for all other levels.
+
+static void
+mask_scalar(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+            size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = src[i] & mask[i];
+  }
+}
+
+static void
+create_mask_scalar(uint32_t *dst, const uint32_t *a, const uint32_t *b,
+                   size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] = (a[i] == b[i]) ? 0x00000000 : 0xFFFFFFFF;
+  }
+}
+
+static void
+fill_masked_scalar(uint32_t *dst, uint32_t color, size_t count) {
+  Color *res = reinterpret_cast<Color*>(dst);
+  Color c;
+  memcpy(&c, &color, sizeof(c));
+  for (size_t i = 0; i < count; i++) {
+    if (res->alpha != 0x00) {
+      *res = c;
+    }
+    res++;
+  }
+}
+
+static void
+add_scalar(uint32_t *dst, const uint32_t *src, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    dst[i] += src[i];
+  }
+}
+
+static void
+del_scalar(uint32_t *dst, const uint32_t *mask, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (mask[i] == 0xFFFFFFFF) {
+      dst[i] = 0x00000000;
+    }
+  }
+}
+
+#define UNMULTIPLY(color, a) ((0xFF * (color)) / (a))
+#define BLEND(back, front, a) (((front) * (a)) + ((back) * (0xFF - (a)))) / 0xFF
+
+static void
+blend_scalar(uint32_t *dst, const uint32_t *src, size_t count) {
+  Color *c = reinterpret_cast<Color*>(dst);
+  const Color *o = reinterpret_cast<const Color*>(src);
+  for (size_t i = 0; i < count; i++, c++, o++) {
+    const uint32_t alpha = o->alpha;
+
+    if (alpha == 0x00) {
+      continue;
+    }
+
+    if (alpha == 0xFF) {
+      *c = *o;
+      continue;
+    }
+
+    const uint8_t backR = c->red;
+    const uint8_t backG = c->green;
+    const uint8_t backB = c->blue;
+
+    const uint8_t frontR = UNMULTIPLY(o->red, alpha);
+    const uint8_t frontG = UNMULTIPLY(o->green, alpha);
+    const uint8_t frontB = UNMULTIPLY(o->blue, alpha);
+
+    const uint32_t R = BLEND(backR, frontR, alpha);
+    const uint32_t G = BLEND(backG, frontG, alpha);
+    const uint32_t B = BLEND(backB, frontB, alpha);
+
+    *c = {(uint8_t)B, (uint8_t)G, (uint8_t)R, 0xFF};
+  }
+}
+
+static uint8_t
+alpha_from_luminance_scalar(uint32_t *dst, size_t count) {
+  Color *c = reinterpret_cast<Color*>(dst);
+  uint8_t min = 0xFF;
+  for (size_t i = 0; i < count; i++) {
+    if (c->alpha != 0x00) {
+      c->alpha = 0xff - static_cast<uint8_t>((0.21 * c->red) +
+                                             (0.72 * c->green) +
+                                             (0.07 * c->blue));
+      c->red = 0;
+      c->green = 0;
+      c->blue = 0;
+      min = std::min(min, c->alpha);
+    }
+    c++;
+  }
+  return min;
+}
+
+static void
+sub_alpha_scalar(uint32_t *dst, uint8_t value, size_t count) {
+  Color *c = reinterpret_cast<Color*>(dst);
+  for (size_t i = 0; i < count; i++) {
+    if (c->alpha != 0x00) {
+      c->alpha = c->alpha - value;
+    }
+    c++;
+  }
+}
+
+static void
+stick_scalar(uint32_t *dst, const uint32_t *src, size_t count) {
+  Color *base = reinterpret_cast<Color*>(dst);
+  const Color *stkr = reinterpret_cast<const Color*>(src);
+  for (size_t i = 0; i < count; i++) {
+    if (stkr[i].alpha != 0x00) {
+      base[i] = stkr[i];
+    }
+  }
+}
+
+static const PixelKernels::Table table_scalar = {
+  mask_scalar,
+  create_mask_scalar,
+  fill_masked_scalar,
+  add_scalar,
+  del_scalar,
+  blend_scalar,
+  alpha_from_luminance_scalar,
+  sub_alpha_scalar,
+  stick_scalar
+};
+
+#ifdef PIXEL_KERNELS_SSE2
+
+// SSE2 implementation, four pixels per step. The vector code assumes little
+// endian BGRA, so alpha is the most significant byte of each pixel.
+
+#define LOAD4(p) _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))
+#define STORE4(p, v) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), (v))
+
+static void
+mask_sse2(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+          size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    STORE4(dst + i, _mm_and_si128(LOAD4(src + i), LOAD4(mask + i)));
+  }
+  mask_scalar(dst + i, src + i, mask + i, count - i);
+}
+
+static void
+create_mask_sse2(uint32_t *dst, const uint32_t *a, const uint32_t *b,
+                 size_t count) {
+  const __m128i ones = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i eq = _mm_cmpeq_epi32(LOAD4(a + i), LOAD4(b + i));
+    STORE4(dst + i, _mm_xor_si128(eq, ones));
+  }
+  create_mask_scalar(dst + i, a + i, b + i, count - i);
+}
+
+static void
+fill_masked_sse2(uint32_t *dst, uint32_t color, size_t count) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c = _mm_set1_epi32(color);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = LOAD4(dst + i);
+    __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(v, alpha_mask), zero);
+    STORE4(dst + i, _mm_or_si128(_mm_and_si128(clear, v),
+                                 _mm_andnot_si128(clear, c)));
+  }
+  fill_masked_scalar(dst + i, color, count - i);
+}
+
+static void
+add_sse2(uint32_t *dst, const uint32_t *src, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    STORE4(dst + i, _mm_add_epi32(LOAD4(dst + i), LOAD4(src + i)));
+  }
+  add_scalar(dst + i, src + i, count - i);
+}
+
+static void
+del_sse2(uint32_t *dst, const uint32_t *mask, size_t count) {
+  const __m128i ones = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i m = _mm_cmpeq_epi32(LOAD4(mask + i), ones);
+    STORE4(dst + i, _mm_andnot_si128(m, LOAD4(dst + i)));
+  }
+  del_scalar(dst + i, mask + i, count - i);
+}
+
+// Translucent pixels need an exact integer division, so only runs of fully
+// transparent or fully opaque pixels are handled in vector registers.
+static void
+blend_sse2(uint32_t *dst, const uint32_t *src, size_t count) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i o = LOAD4(src + i);
+    __m128i a = _mm_and_si128(o, alpha_mask);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xFFFF) {
+      continue;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, alpha_mask)) == 0xFFFF) {
+      STORE4(dst + i, o);
+      continue;
+    }
+    blend_scalar(dst + i, src + i, 4);
+  }
+  blend_scalar(dst + i, src + i, count - i);
+}
+
+static uint8_t
+alpha_from_luminance_sse2(uint32_t *dst, size_t count) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i byte_mask = _mm_set1_epi32(0xFF);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128d kr = _mm_set1_pd(0.21);
+  const __m128d kg = _mm_set1_pd(0.72);
+  const __m128d kb = _mm_set1_pd(0.07);
+  __m128i min = _mm_set1_epi32(0xFF);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = LOAD4(dst + i);
+    __m128i visible = _mm_cmpeq_epi32(_mm_and_si128(v, alpha_mask), zero);
+    visible = _mm_xor_si128(visible, _mm_set1_epi32(-1));
+    if (_mm_movemask_epi8(visible) == 0) {
+      continue;
+    }
+
+    __m128i r = _mm_and_si128(_mm_srli_epi32(v, 16), byte_mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(v, 8), byte_mask);
+    __m128i b = _mm_and_si128(v, byte_mask);
+
+    // Same operations in the same order as the scalar code, so the rounding
+    // is identical.
+    __m128d lum_lo = _mm_add_pd(_mm_add_pd(_mm_mul_pd(kr, _mm_cvtepi32_pd(r)),
+                                           _mm_mul_pd(kg, _mm_cvtepi32_pd(g))),
+                                _mm_mul_pd(kb, _mm_cvtepi32_pd(b)));
+    r = _mm_shuffle_epi32(r, 0xEE);
+    g = _mm_shuffle_epi32(g, 0xEE);
+    b = _mm_shuffle_epi32(b, 0xEE);
+    __m128d lum_hi = _mm_add_pd(_mm_add_pd(_mm_mul_pd(kr, _mm_cvtepi32_pd(r)),
+                                           _mm_mul_pd(kg, _mm_cvtepi32_pd(g))),
+                                _mm_mul_pd(kb, _mm_cvtepi32_pd(b)));
+    __m128i lum = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lum_lo),
+                                     _mm_cvttpd_epi32(lum_hi));
+    __m128i alpha = _mm_sub_epi32(byte_mask, _mm_and_si128(lum, byte_mask));
+
+    STORE4(dst + i, _mm_or_si128(_mm_andnot_si128(visible, v),
+                                 _mm_and_si128(visible,
+                                               _mm_slli_epi32(alpha, 24))));
+    alpha = _mm_or_si128(_mm_and_si128(visible, alpha),
+                         _mm_andnot_si128(visible, byte_mask));
+    min = _mm_min_epi16(min, alpha);
+  }
+
+  min = _mm_min_epi16(min, _mm_shuffle_epi32(min, 0x4E));
+  min = _mm_min_epi16(min, _mm_shuffle_epi32(min, 0xB1));
+  uint8_t result = static_cast<uint8_t>(_mm_cvtsi128_si32(min));
+  return std::min(result, alpha_from_luminance_scalar(dst + i, count - i));
+}
+
+static void
+sub_alpha_sse2(uint32_t *dst, uint8_t value, size_t count) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i sub = _mm_set1_epi32(static_cast<uint32_t>(value) << 24);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = LOAD4(dst + i);
+    __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(v, alpha_mask), zero);
+    STORE4(dst + i, _mm_sub_epi32(v, _mm_andnot_si128(clear, sub)));
+  }
+  sub_alpha_scalar(dst + i, value, count - i);
+}
+
+static void
+stick_sse2(uint32_t *dst, const uint32_t *src, size_t count) {
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i s = LOAD4(src + i);
+    __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alpha_mask), zero);
+    STORE4(dst + i, _mm_or_si128(_mm_and_si128(clear, LOAD4(dst + i)),
+                                 _mm_andnot_si128(clear, s)));
+  }
+  stick_scalar(dst + i, src + i, count - i);
+}
+
+static const PixelKernels::Table table_sse2 = {
+  mask_sse2,
+  create_mask_sse2,
+  fill_masked_sse2,
+  add_sse2,
+  del_sse2,
+  blend_sse2,
+  alpha_from_luminance_sse2,
+  sub_alpha_sse2,
+  stick_sse2
+};
+
+#endif  // PIXEL_KERNELS_SSE2
+
+#ifdef PIXEL_KERNELS_AVX2
+
+// AVX2 implementation, eight pixels per step. Kernels that are bound by the
+// scalar fallback for translucent pixels reuse the SSE2 versions.
+
+#define LOAD8(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+#define STORE8(p, v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), (v))
+
+TARGET_AVX2 static void
+mask_avx2(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+          size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    STORE8(dst + i, _mm256_and_si256(LOAD8(src + i), LOAD8(mask + i)));
+  }
+  mask_sse2(dst + i, src + i, mask + i, count - i);
+}
+
+TARGET_AVX2 static void
+create_mask_avx2(uint32_t *dst, const uint32_t *a, const uint32_t *b,
+                 size_t count) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i eq = _mm256_cmpeq_epi32(LOAD8(a + i), LOAD8(b + i));
+    STORE8(dst + i, _mm256_xor_si256(eq, ones));
+  }
+  create_mask_sse2(dst + i, a + i, b + i, count - i);
+}
+
+TARGET_AVX2 static void
+fill_masked_avx2(uint32_t *dst, uint32_t color, size_t count) {
+  const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i c = _mm256_set1_epi32(color);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i v = LOAD8(dst + i);
+    __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(v, alpha_mask), zero);
+    STORE8(dst + i, _mm256_blendv_epi8(c, v, clear));
+  }
+  fill_masked_sse2(dst + i, color, count - i);
+}
+
+TARGET_AVX2 static void
+add_avx2(uint32_t *dst, const uint32_t *src, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    STORE8(dst + i, _mm256_add_epi32(LOAD8(dst + i), LOAD8(src + i)));
+  }
+  add_sse2(dst + i, src + i, count - i);
+}
+
+TARGET_AVX2 static void
+del_avx2(uint32_t *dst, const uint32_t *mask, size_t count) {
+  const __m256i ones = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i m = _mm256_cmpeq_epi32(LOAD8(mask + i), ones);
+    STORE8(dst + i, _mm256_andnot_si256(m, LOAD8(dst + i)));
+  }
+  del_sse2(dst + i, mask + i, count - i);
+}
+
+TARGET_AVX2 static void
+sub_alpha_avx2(uint32_t *dst, uint8_t value, size_t count) {
+  const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i sub = _mm256_set1_epi32(static_cast<uint32_t>(value) << 24);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i v = LOAD8(dst + i);
+    __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(v, alpha_mask), zero);
+    STORE8(dst + i, _mm256_sub_epi32(v, _mm256_andnot_si256(clear, sub)));
+  }
+  sub_alpha_sse2(dst + i, value, count - i);
+}
+
+TARGET_AVX2 static void
+stick_avx2(uint32_t *dst, const uint32_t *src, size_t count) {
+  const __m256i alpha_mask = _mm256_set1_epi32(0xFF000000);
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i s = LOAD8(src + i);
+    __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha_mask), zero);
+    STORE8(dst + i, _mm256_blendv_epi8(s, LOAD8(dst + i), clear));
+  }
+  stick_sse2(dst + i, src + i, count - i);
+}
+
+static const PixelKernels::Table table_avx2 = {
+  mask_avx2,
+  create_mask_avx2,
+  fill_masked_avx2,
+  add_avx2,
+  del_avx2,
+  blend_sse2,
+  alpha_from_luminance_sse2,
+  sub_alpha_avx2,
+  stick_avx2
+};
+
+#endif  // PIXEL_KERNELS_AVX2
+
+const PixelKernels::Table *PixelKernels::table = nullptr;
+PixelKernels::Level PixelKernels::level = PixelKernels::LevelScalar;
+std::once_flag PixelKernels::init_once;
+
+// Keeps a level selected by set_level() before the first use.
+void
+PixelKernels::init() {
+  if (table == nullptr) {
+    set_level(get_supported_level());
+  }
+}
+
+PixelKernels::Level
+PixelKernels::get_level() {
+  get();
+  return level;
+}
+
+PixelKernels::Level
+PixelKernels::get_supported_level() {
+#ifdef PIXEL_KERNELS_AVX2
+# ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] >= 7) {
+    __cpuid(info, 1);
+    bool os_saves_ymm = ((info[2] & (1 << 27)) != 0) &&
+                        ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    if (os_saves_ymm && ((info[1] & (1 << 5)) != 0)) {
+      return LevelAVX2;
+    }
+  }
+# else
+  if (__builtin_cpu_supports("avx2")) {
+    return LevelAVX2;
+  }
+# endif
+#endif
+#ifdef PIXEL_KERNELS_SSE2
+  return LevelSSE2;
+#else
+  return LevelScalar;
+#endif
+}
+
+PixelKernels::Level
+PixelKernels::set_level(Level _level) {
+  level = std::min(_level, get_supported_level());
+  switch (level) {
+#ifdef PIXEL_KERNELS_AVX2
+    case LevelAVX2:
+      table = &table_avx2;
+      break;
+#endif
+#ifdef PIXEL_KERNELS_SSE2
+    case LevelSSE2:
+      table = &table_sse2;
+      break;
+#endif
+    default:
+      level = LevelScalar;
+      table = &table_scalar;
+      break;
+  }
+
+  Log::Debug["pixel"] << "Using " << get_level_name(level) << " pixel kernels";
+
+  return level;
+}
+
+const char *
+PixelKernels::get_level_name(Level _level) {
+  switch (_level) {
+    case LevelScalar: return "scalar";
+    case LevelSSE2: return "SSE2";
+    case LevelAVX2: return "AVX2";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,89 @@
+/*
+ * pixel-kernels.h - Pixel loops used for sprite compositing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_PIXEL_KERNELS_H_
+#define SRC_PIXEL_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Inner loops of SpriteBase operations. All kernels work on arrays of BGRA
+// pixels (Data::Sprite::Color) and produce bit-identical results for every
+// implementation level. The best level supported by the CPU is selected on
+// first use, which is safe from any thread.
+class PixelKernels {
+ public:
+  typedef enum Level {
+    LevelScalar = 0,
+    LevelSSE2,
+    LevelAVX2,
+
+    LevelMax
+  } Level;
+
+  typedef struct Table {
+    // dst[i] = src[i] & mask[i]
+    void (*mask)(uint32_t *dst, const uint32_t *src, const uint32_t *mask,
+                 size_t count);
+    // dst[i] = (a[i] == b[i]) ? 0x00000000 : 0xFFFFFFFF
+    void (*create_mask)(uint32_t *dst, const uint32_t *a, const uint32_t *b,
+                        size_t count);
+    // dst[i] = color where dst[i] is not fully transparent
+    void (*fill_masked)(uint32_t *dst, uint32_t color, size_t count);
+    // dst[i] += src[i]
+    void (*add)(uint32_t *dst, const uint32_t *src, size_t count);
+    // dst[i] = 0x00000000 where mask[i] == 0xFFFFFFFF
+    void (*del)(uint32_t *dst, const uint32_t *mask, size_t count);
+    // Blend src over dst, src is premultiplied by its alpha
+    void (*blend)(uint32_t *dst, const uint32_t *src, size_t count);
+    // Replace color by alpha derived from luminance, return minimal alpha
+    uint8_t (*alpha_from_luminance)(uint32_t *dst, size_t count);
+    // Subtract value from alpha where dst[i] is not fully transparent
+    void (*sub_alpha)(uint32_t *dst, uint8_t value, size_t count);
+    // dst[i] = src[i] where src[i] is not fully transparent
+    void (*stick)(uint32_t *dst, const uint32_t *src, size_t count);
+  } Table;
+
+ protected:
+  static const Table *table;
+  static Level level;
+  static std::once_flag init_once;
+
+ public:
+  static Level get_level();
+  static Level get_supported_level();
+  // Select implementation, limited to what the CPU supports. Used by tests
+  // and benchmarks to compare implementations, not while other threads use
+  // the kernels.
+  static Level set_level(Level level);
+  static const char *get_level_name(Level level);
+
+  static const Table &get() {
+    std::call_once(init_once, init);
+    return *table;
+  }
+
+ protected:
+  static void init();
+};
+
+#endif  // SRC_PIXEL_KERNELS_H_
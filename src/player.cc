@@ -22,6 +22,8 @@
 #include "src/player.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <vector>
 
 #include "src/game.h"
 #include "src/log.h"
@@ -39,6 +41,9 @@ Player::Player(Game* game, unsigned int index)
   , incomplete_building_count{}
   , inventory_prio{}
   , attacking_buildings{}
+  , stats_resources{}
+  , stats_serfs_idle{}
+  , stats_serfs_potential{}
   , food_stonemine(0)
   , food_coalmine(0)
   , food_ironmine(0)
@@ -400,6 +405,9 @@ Player::change_knight_occupation(int index_, int adjust_max, int delta) {
 int
 Player::promote_serfs_to_knights(int number) {
   int promoted = 0;
+  if (stats_serfs_idle[Serf::TypeGeneric] == 0) {
+    return promoted;
+  }
 
   for (Serf *serf : game->get_player_serfs(this)) {
     if (serf->get_state() == Serf::StateIdleInStock &&
@@ -421,7 +429,7 @@ Player::available_knights_at_pos(MapPos pos, int index_, int dist) {
   const int min_level_tower[] = { 1, 2, 3, 4, 6 };
   const int min_level_fortress[] = { 1, 3, 6, 9, 12 };
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (map->get_owner(pos) != index ||
       map->type_up(pos) <= Map::TerrainWater3 ||
       map->type_down(pos) <= Map::TerrainWater3 ||
@@ -463,6 +471,36 @@ Player::available_knights_at_pos(MapPos pos, int index_, int dist) {
   return index_ + 1;
 }
 
+/* Order in which the shells around a position reach the column and row
+   offset. Shell k holds the 6k positions at distance k, walked from k
+   positions right of the center, downwards first. Returns -1 beyond the
+   last shell. */
+static int
+attack_shell_order(int col, int row, int *shell) {
+  int k = std::max(std::max(abs(col), abs(row)), abs(col - row));
+  if (k < 1 || k > 32) {
+    return -1;
+  }
+
+  int side;
+  if (col == k && row < k) {
+    side = row;
+  } else if (row == k && col > 0) {
+    side = k + (k - col);
+  } else if (col - row == -k && col <= 0 && col > -k) {
+    side = 2*k - col;
+  } else if (col == -k && row <= 0 && row > -k) {
+    side = 3*k - row;
+  } else if (row == -k && col < 0) {
+    side = 4*k + (col + k);
+  } else {
+    side = 5*k + col;
+  }
+
+  *shell = k - 1;
+  return 3*k*(k - 1) + side;
+}
+
 int
 Player::knights_available_for_attack(MapPos pos) {
   /* Reset counters. */
@@ -470,37 +508,49 @@ Player::knights_available_for_attack(MapPos pos) {
     attacking_knights[i] = 0;
   }
 
-  int count = 0;
-  PMap map = game->get_map();
-
-  /* Iterate each shell around the position.*/
-  for (int i = 0; i < 32; i++) {
-    pos = map->move_right(pos);
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_down(pos);
-    }
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_left(pos);
-    }
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_up_left(pos);
-    }
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_up(pos);
-    }
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_right(pos);
+  Map *map = game->get_map();
+  int cols = map->get_cols();
+  int rows = map->get_rows();
+
+  /* Own buildings in the order of a walk over 32 shells around the
+     position. Shells can wrap around small maps, then a building is
+     reached first at the smallest of its offsets. */
+  typedef struct Reached {
+    int order;
+    int shell;
+    MapPos pos;
+  } Reached;
+  std::vector<SpatialIndex::Entry> near;
+  game->get_building_positions().find_near(pos, index, 32, &near);
+  std::vector<Reached> reached;
+  for (const SpatialIndex::Entry &entry : near) {
+    int col = map->dist_x(entry.pos, pos);
+    int row = map->dist_y(entry.pos, pos);
+    Reached first = { -1, 0, entry.pos };
+    for (int c = ((col + 32) % cols + cols) % cols - 32; c <= 32; c += cols) {
+      for (int r = ((row + 32) % rows + rows) % rows - 32; r <= 32;
+           r += rows) {
+        int shell;
+        int order = attack_shell_order(c, r, &shell);
+        if (order >= 0 && (first.order < 0 || order < first.order)) {
+          first.order = order;
+          first.shell = shell;
+        }
+      }
     }
-    for (int j = 0; j < i+1; j++) {
-      count = available_knights_at_pos(pos, count, i >> 3);
-      pos = map->move_down_right(pos);
+    if (first.order >= 0) {
+      reached.push_back(first);
     }
   }
+  std::sort(reached.begin(), reached.end(),
+            [](const Reached &a, const Reached &b) {
+              return a.order < b.order;
+            });
+
+  int count = 0;
+  for (const Reached &building : reached) {
+    count = available_knights_at_pos(building.pos, count, building.shell >> 3);
+  }
 
   attacking_building_count = count;
 
@@ -524,7 +574,7 @@ Player::start_attack() {
     return;
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   for (int i = 0; i < attacking_building_count; i++) {
     /* TODO building index may not be valid any more(?). */
     Building *b = game->get_building(attacking_buildings[i]);
@@ -1022,49 +1072,19 @@ Player::get_score() const {
   return total_building_score + ((total_land_area + mil_score) >> 4);
 }
 
-ResourceMap
-Player::get_stats_resources() {
-  ResourceMap resources;
-
-  /* Sum up resources of all inventories. */
-  for (Inventory *inventory : game->get_player_inventories(this)) {
-    for (int j = 0; j < 26; j++) {
-      resources[(Resource::Type)j] +=
-                                     inventory->get_count_of((Resource::Type)j);
-    }
-  }
-
-  return resources;
-}
-
-Serf::SerfMap
-Player::get_stats_serfs_idle() {
-  Serf::SerfMap res;
-
-  /* Sum up all existing serfs. */
-  for (Serf *serf : game->get_player_serfs(this)) {
-    if (serf->get_state() == Serf::StateIdleInStock) {
-      res[serf->get_type()] += 1;
-    }
+void
+Player::add_stats_serf_idle(Serf::Type type, int delta) {
+  /* Dead serfs are idle until they are deleted. */
+  if (type >= 0 && type < Serf::TypeDead) {
+    stats_serfs_idle[type] += delta;
   }
-
-  return res;
 }
 
-Serf::SerfMap
-Player::get_stats_serfs_potential() {
-  Serf::SerfMap res;
-
-  /* Sum up potential serfs of all inventories. */
-  for (Inventory *inventory : game->get_player_inventories(this)) {
-    if (inventory->free_serf_count() > 0) {
-      for (int i = 0; i < 27; i++) {
-        res[(Serf::Type)i] += inventory->serf_potential_count((Serf::Type)i);
-      }
-    }
-  }
-
-  return res;
+void
+Player::clear_stats() {
+  stats_resources.fill(0);
+  stats_serfs_idle.fill(0);
+  stats_serfs_potential.fill(0);
 }
 
 unsigned int
@@ -114,6 +114,12 @@ class Player : public GameObject {
   unsigned int total_military_score;
   uint16_t last_tick;
 
+  // Resources in inventories, serfs idle in inventories and serfs that
+  // inventories can make. Kept up to date by inventories and serfs.
+  ResourceCounts stats_resources;
+  Serf::SerfCounts stats_serfs_idle;
+  Serf::SerfCounts stats_serfs_potential;
+
   int reproduction_counter;
   size_t reproduction_reset;
   int serf_to_knight_rate;
@@ -298,9 +304,18 @@ class Player : public GameObject {
     player_stat_history[mode][ind] = val; }
   int *get_player_stat_history(int mode) { return player_stat_history[mode]; }
 
-  ResourceMap get_stats_resources();
-  Serf::SerfMap get_stats_serfs_idle();
-  Serf::SerfMap get_stats_serfs_potential();
+  const ResourceCounts &get_stats_resources() const {
+    return stats_resources; }
+  const Serf::SerfCounts &get_stats_serfs_idle() const {
+    return stats_serfs_idle; }
+  const Serf::SerfCounts &get_stats_serfs_potential() const {
+    return stats_serfs_potential; }
+  void add_stats_resource(Resource::Type type, int delta) {
+    stats_resources[type] += delta; }
+  void add_stats_serf_idle(Serf::Type type, int delta);
+  void add_stats_serf_potential(Serf::Type type, int delta) {
+    stats_serfs_potential[type] += delta; }
+  void clear_stats();
 
   // Settings
   int get_serf_to_knight_rate() const { return serf_to_knight_rate; }
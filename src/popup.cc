@@ -37,6 +37,7 @@
 #include "src/inventory.h"
 #include "src/list.h"
 #include "src/text-input.h"
+#include "src/game-thread.h"
 
 /* Action types that can be fired from
    clicks in the popup window. */
@@ -566,7 +567,7 @@ PopupBox::draw_adv_2_building_box() {
 
 /* Draw generic popup box of resources. */
 void
-PopupBox::draw_resources_box(const ResourceMap &resources) {
+PopupBox::draw_resources_box(const ResourceCounts &resources) {
   const int layout[] = {
     0x28, 1, 0, /* resources */
     0x29, 1, 16,
@@ -630,12 +631,8 @@ PopupBox::draw_resources_box(const ResourceMap &resources) {
 
   for (size_t i = 0; i < sizeof(layout_res)/sizeof(layout_res[0])/3; i++) {
     Resource::Type res_type = (Resource::Type)layout_res[i*3+2];
-    ResourceMap::const_iterator it = resources.find(res_type);
-    int value = 0;
-    if (it != resources.end()) {
-      value = static_cast<int>(it->second);
-    }
-    draw_green_number(layout_res[i*3], layout_res[i*3+1], value);
+    draw_green_number(layout_res[i*3], layout_res[i*3+1],
+                      static_cast<int>(resources[res_type]));
   }
 }
 
@@ -735,10 +732,7 @@ void
 PopupBox::draw_stat_4_box() {
   draw_box_background(PatternStripedGreen);
 
-  /* Sum up resources of all inventories. */
-  ResourceMap resources = interface->get_player()->get_stats_resources();
-
-  draw_resources_box(resources);
+  draw_resources_box(interface->get_player()->get_stats_resources());
 
   draw_popup_icon(14, 128, 60); /* exit */
 }
@@ -1401,11 +1395,11 @@ void
 PopupBox::draw_stat_3_box() {
   draw_box_background(PatternStripedGreen);
 
-  Serf::SerfMap serfs = interface->get_player()->get_stats_serfs_idle();
-  Serf::SerfMap serfs_potential =
+  Serf::SerfCounts serfs = interface->get_player()->get_stats_serfs_idle();
+  const Serf::SerfCounts &serfs_potential =
                            interface->get_player()->get_stats_serfs_potential();
-  for (int i = 0; i < 27; ++i) {
-    serfs[(Serf::Type)i] += serfs_potential[(Serf::Type)i];
+  for (int i = 0; i < Serf::TypeDead; ++i) {
+    serfs[i] += serfs_potential[i];
   }
 
   const int layout[] = {
@@ -1953,7 +1947,10 @@ PopupBox::draw_castle_res_box() {
   }
 
   Inventory *inventory = building->get_inventory();
-  ResourceMap resources = inventory->get_all_resources();
+  ResourceCounts resources;
+  for (int i = 0; i < Resource::GroupFood; i++) {
+    resources[i] = inventory->get_count_of((Resource::Type)i);
+  }
   draw_resources_box(resources);
 }
 
@@ -2177,7 +2174,7 @@ PopupBox::draw_transport_info_box() {
 
 #if 1
   /* Draw viewport of flag */
-  Viewport flag_view(interface, interface->get_game()->get_map());
+  Viewport flag_view(interface, SnapshotPublisher::ViewPopup);
   flag_view.switch_layer(Viewport::LayerLandscape);
   flag_view.switch_layer(Viewport::LayerSerfs);
   flag_view.switch_layer(Viewport::LayerCursor);
@@ -2605,6 +2602,9 @@ PopupBox::draw_save_box() {
 
 void
 PopupBox::internal_draw() {
+  // Popups show more of the game than the snapshot has.
+  std::unique_lock<GameThread> lock = interface->lock_game();
+
   draw_popup_box_frame();
 
   /* Dispatch to one of the popup box functions above. */
@@ -2778,82 +2778,111 @@ PopupBox::activate_sett_5_6_item(int index) {
 
 void
 PopupBox::move_sett_5_6_item(int up, int to_end) {
-  int *prio = nullptr;
+  bool flags = (interface->get_popup_box()->get_box() == TypeSett5);
   int cur = -1;
 
-  if (interface->get_popup_box()->get_box() == TypeSett5) {
-    prio = interface->get_player()->get_flag_prio();
+  if (flags) {
     cur = current_sett_5_item-1;
   } else {
-    prio = interface->get_player()->get_inventory_prio();
     cur = current_sett_6_item-1;
   }
 
-  int cur_value = prio[cur];
-  int next_value = -1;
-  if (up) {
-    if (to_end) {
-      next_value = 26;
-    } else {
-      next_value = cur_value + 1;
-    }
-  } else {
-    if (to_end) {
-      next_value = 1;
+  run_on_player([flags, cur, up, to_end](Player *target) {
+    int *prio = flags ? target->get_flag_prio() :
+                        target->get_inventory_prio();
+
+    int cur_value = prio[cur];
+    int next_value = -1;
+    if (up) {
+      if (to_end) {
+        next_value = 26;
+      } else {
+        next_value = cur_value + 1;
+      }
     } else {
-      next_value = cur_value - 1;
+      if (to_end) {
+        next_value = 1;
+      } else {
+        next_value = cur_value - 1;
+      }
     }
-  }
 
-  if (next_value >= 1 && next_value < 27) {
-    int delta = next_value > cur_value ? -1 : 1;
-    int min = next_value > cur_value ? cur_value+1 : next_value;
-    int max = next_value > cur_value ? next_value : cur_value-1;
-    for (int i = 0; i < 26; i++) {
-      if (prio[i] >= min && prio[i] <= max) prio[i] += delta;
+    if (next_value >= 1 && next_value < 27) {
+      int delta = next_value > cur_value ? -1 : 1;
+      int min = next_value > cur_value ? cur_value+1 : next_value;
+      int max = next_value > cur_value ? next_value : cur_value-1;
+      for (int i = 0; i < 26; i++) {
+        if (prio[i] >= min && prio[i] <= max) prio[i] += delta;
+      }
+      prio[cur] = next_value;
     }
-    prio[cur] = next_value;
-  }
+  });
 }
 
 void
 PopupBox::handle_send_geologist() {
   MapPos pos = interface->get_map_cursor_pos();
-  Flag *flag = interface->get_game()->get_flag_at_pos(pos);
-
-  if (!interface->get_game()->send_geologist(flag)) {
-    play_sound(Audio::TypeSfxNotAccepted);
-  } else {
-    play_sound(Audio::TypeSfxAccepted);
-    interface->close_popup();
-  }
+  Interface *owner = interface;
+  interface->run_on_game([pos](Game *target) {
+    Flag *flag = target->get_flag_at_pos(pos);
+    return (flag != nullptr) && target->send_geologist(flag);
+  }, [owner](bool sent) {
+    if (!sent) {
+      owner->play_sound(Audio::TypeSfxNotAccepted);
+    } else {
+      owner->play_sound(Audio::TypeSfxAccepted);
+      owner->close_popup();
+    }
+  });
 }
 
 void
 PopupBox::sett_8_train(int number) {
-  int r = interface->get_player()->promote_serfs_to_knights(number);
-
-  if (r == 0) {
-    play_sound(Audio::TypeSfxNotAccepted);
-  } else {
-    play_sound(Audio::TypeSfxAccepted);
-  }
+  unsigned int index = interface->get_player()->get_index();
+  Interface *owner = interface;
+  interface->run_on_game([index, number](Game *target) {
+    return target->get_player(index)->promote_serfs_to_knights(number);
+  }, [owner](int r) {
+    if (r == 0) {
+      owner->play_sound(Audio::TypeSfxNotAccepted);
+    } else {
+      owner->play_sound(Audio::TypeSfxAccepted);
+    }
+  });
 }
 
 void
 PopupBox::set_inventory_resource_mode(int mode) {
-  Building *building = interface->get_game()->get_building(
-                                           interface->get_player()->temp_index);
-  Inventory *inventory = building->get_inventory();
-  interface->get_game()->set_inventory_resource_mode(inventory, mode);
+  unsigned int index = interface->get_player()->get_index();
+  interface->run_on_game([index, mode](Game *target) {
+    Building *building = target->get_building(
+                                       target->get_player(index)->temp_index);
+    if ((building == nullptr) || !building->has_inventory()) {
+      return;
+    }
+    target->set_inventory_resource_mode(building->get_inventory(), mode);
+  });
 }
 
 void
 PopupBox::set_inventory_serf_mode(int mode) {
-  Building *building = interface->get_game()->get_building(
-                                           interface->get_player()->temp_index);
-  Inventory *inventory = building->get_inventory();
-  interface->get_game()->set_inventory_serf_mode(inventory, mode);
+  unsigned int index = interface->get_player()->get_index();
+  interface->run_on_game([index, mode](Game *target) {
+    Building *building = target->get_building(
+                                       target->get_player(index)->temp_index);
+    if ((building == nullptr) || !building->has_inventory()) {
+      return;
+    }
+    target->set_inventory_serf_mode(building->get_inventory(), mode);
+  });
+}
+
+void
+PopupBox::run_on_player(std::function<void(Player *target)> command) {
+  unsigned int index = interface->get_player()->get_index();
+  interface->run_on_game([index, command](Game *target) {
+    command(target->get_player(index));
+  });
 }
 
 void
@@ -3066,23 +3095,38 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
   }
   case ACTION_ATTACKING_KNIGHTS_DEC:
-    player->knights_attacking = std::max(player->knights_attacking-1, 0);
+    run_on_player([](Player *target) {
+      target->knights_attacking = std::max(target->knights_attacking-1, 0);
+    });
     break;
   case ACTION_ATTACKING_KNIGHTS_INC:
-    player->knights_attacking = std::min(player->knights_attacking + 1,
-                                std::min(player->total_attacking_knights, 100));
-    break;
-  case ACTION_START_ATTACK:
-    if (player->knights_attacking > 0) {
-      if (player->attacking_building_count > 0) {
-        play_sound(Audio::TypeSfxAccepted);
-        player->start_attack();
+    run_on_player([](Player *target) {
+      target->knights_attacking = std::min(target->knights_attacking + 1,
+                                std::min(target->total_attacking_knights, 100));
+    });
+    break;
+  case ACTION_START_ATTACK: {
+    unsigned int index = player->get_index();
+    Interface *owner = interface;
+    interface->run_on_game([index](Game *target) {
+      Player *attacker = target->get_player(index);
+      if (attacker->knights_attacking <= 0) {
+        return false;
       }
-      interface->close_popup();
-    } else {
-      play_sound(Audio::TypeSfxNotAccepted);
-    }
+      if (attacker->attacking_building_count > 0) {
+        attacker->start_attack();
+      }
+      return true;
+    }, [owner](bool started) {
+      if (started) {
+        owner->play_sound(Audio::TypeSfxAccepted);
+        owner->close_popup();
+      } else {
+        owner->play_sound(Audio::TypeSfxNotAccepted);
+      }
+    });
     break;
+  }
   case ACTION_CLOSE_ATTACK_BOX:
     interface->close_popup();
     break;
@@ -3110,159 +3154,237 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
   case ACTION_SETT_1_ADJUST_STONEMINE:
     interface->open_popup(TypeSett1);
-    player->set_food_stonemine(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_food_stonemine(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_1_ADJUST_COALMINE:
     interface->open_popup(TypeSett1);
-    player->set_food_coalmine(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_food_coalmine(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_1_ADJUST_IRONMINE:
     interface->open_popup(TypeSett1);
-    player->set_food_ironmine(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_food_ironmine(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_1_ADJUST_GOLDMINE:
     interface->open_popup(TypeSett1);
-    player->set_food_goldmine(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_food_goldmine(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_2_ADJUST_CONSTRUCTION:
     interface->open_popup(TypeSett2);
-    player->set_planks_construction(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_planks_construction(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_2_ADJUST_BOATBUILDER:
     interface->open_popup(TypeSett2);
-    player->set_planks_boatbuilder(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_planks_boatbuilder(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_2_ADJUST_TOOLMAKER_PLANKS:
     interface->open_popup(TypeSett2);
-    player->set_planks_toolmaker(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_planks_toolmaker(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_2_ADJUST_TOOLMAKER_STEEL:
     interface->open_popup(TypeSett2);
-    player->set_steel_toolmaker(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_steel_toolmaker(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_2_ADJUST_WEAPONSMITH:
     interface->open_popup(TypeSett2);
-    player->set_steel_weaponsmith(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_steel_weaponsmith(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_3_ADJUST_STEELSMELTER:
     interface->open_popup(TypeSett3);
-    player->set_coal_steelsmelter(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_coal_steelsmelter(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_3_ADJUST_GOLDSMELTER:
     interface->open_popup(TypeSett3);
-    player->set_coal_goldsmelter(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_coal_goldsmelter(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_3_ADJUST_WEAPONSMITH:
     interface->open_popup(TypeSett3);
-    player->set_coal_weaponsmith(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_coal_weaponsmith(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_3_ADJUST_PIGFARM:
     interface->open_popup(TypeSett3);
-    player->set_wheat_pigfarm(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_wheat_pigfarm(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_3_ADJUST_MILL:
     interface->open_popup(TypeSett3);
-    player->set_wheat_mill(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_wheat_mill(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_KNIGHT_LEVEL_CLOSEST_MIN_DEC:
-    player->change_knight_occupation(3, 0, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(3, 0, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSEST_MIN_INC:
-    player->change_knight_occupation(3, 0, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(3, 0, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSEST_MAX_DEC:
-    player->change_knight_occupation(3, 1, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(3, 1, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSEST_MAX_INC:
-    player->change_knight_occupation(3, 1, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(3, 1, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSE_MIN_DEC:
-    player->change_knight_occupation(2, 0, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(2, 0, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSE_MIN_INC:
-    player->change_knight_occupation(2, 0, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(2, 0, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSE_MAX_DEC:
-    player->change_knight_occupation(2, 1, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(2, 1, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_CLOSE_MAX_INC:
-    player->change_knight_occupation(2, 1, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(2, 1, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FAR_MIN_DEC:
-    player->change_knight_occupation(1, 0, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(1, 0, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FAR_MIN_INC:
-    player->change_knight_occupation(1, 0, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(1, 0, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FAR_MAX_DEC:
-    player->change_knight_occupation(1, 1, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(1, 1, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FAR_MAX_INC:
-    player->change_knight_occupation(1, 1, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(1, 1, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FARTHEST_MIN_DEC:
-    player->change_knight_occupation(0, 0, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(0, 0, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FARTHEST_MIN_INC:
-    player->change_knight_occupation(0, 0, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(0, 0, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FARTHEST_MAX_DEC:
-    player->change_knight_occupation(0, 1, -1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(0, 1, -1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_KNIGHT_LEVEL_FARTHEST_MAX_INC:
-    player->change_knight_occupation(0, 1, 1);
+    run_on_player([](Player *target) {
+      target->change_knight_occupation(0, 1, 1);
+    });
     interface->open_popup(TypeKnightLevel);
     break;
   case ACTION_SETT_4_ADJUST_SHOVEL:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(0, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(0, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_HAMMER:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(1, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(1, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_AXE:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(5, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(5, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_SAW:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(6, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(6, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_SCYTHE:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(4, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(4, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_PICK:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(7, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(7, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_PINCER:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(8, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(8, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_CLEAVER:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(3, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(3, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_4_ADJUST_ROD:
     interface->open_popup(TypeSett4);
-    player->set_tool_prio(2, gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_tool_prio(2, gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_5_6_ITEM_1:
   case ACTION_SETT_5_6_ITEM_2:
@@ -3327,7 +3449,7 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
     /* TODO */
   case ACTION_SETT_8_CYCLE:
-    player->cycle_knights();
+    run_on_player([](Player *target) { target->cycle_knights(); });
     play_sound(Audio::TypeSfxAccepted);
     break;
   case ACTION_CLOSE_OPTIONS:
@@ -3350,20 +3472,24 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
   case ACTION_DEFAULT_SETT_1:
     interface->open_popup(TypeSett1);
-    player->reset_food_priority();
+    run_on_player([](Player *target) { target->reset_food_priority(); });
     break;
   case ACTION_DEFAULT_SETT_2:
     interface->open_popup(TypeSett2);
-    player->reset_planks_priority();
-    player->reset_steel_priority();
+    run_on_player([](Player *target) {
+      target->reset_planks_priority();
+      target->reset_steel_priority();
+    });
     break;
   case ACTION_DEFAULT_SETT_5_6:
     switch (box) {
       case TypeSett5:
-        player->reset_flag_priority();
+        run_on_player([](Player *target) { target->reset_flag_priority(); });
         break;
       case TypeSett6:
-        player->reset_inventory_priority();
+        run_on_player([](Player *target) {
+          target->reset_inventory_priority();
+        });
         break;
       default:
         NOT_REACHED();
@@ -3402,7 +3528,9 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     set_box(TypeSett6);
     break;
   case ACTION_SETT_8_ADJUST_RATE:
-    player->set_serf_to_knight_rate(gui_get_slider_click_value(x_));
+    run_on_player([x_](Player *target) {
+      target->set_serf_to_knight_rate(gui_get_slider_click_value(x_));
+    });
     break;
   case ACTION_SETT_8_TRAIN_1:
     sett_8_train(1);
@@ -3418,34 +3546,44 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
   case ACTION_DEFAULT_SETT_3:
     interface->open_popup(TypeSett3);
-    player->reset_coal_priority();
-    player->reset_wheat_priority();
+    run_on_player([](Player *target) {
+      target->reset_coal_priority();
+      target->reset_wheat_priority();
+    });
     break;
   case ACTION_SETT_8_SET_COMBAT_MODE_WEAK:
-    player->drop_send_strongest();
+    run_on_player([](Player *target) { target->drop_send_strongest(); });
     play_sound(Audio::TypeSfxAccepted);
     break;
   case ACTION_SETT_8_SET_COMBAT_MODE_STRONG:
-    player->set_send_strongest();
+    run_on_player([](Player *target) { target->set_send_strongest(); });
     play_sound(Audio::TypeSfxAccepted);
     break;
   case ACTION_ATTACKING_SELECT_ALL_1:
-    player->knights_attacking = player->attacking_knights[0];
+    run_on_player([](Player *target) {
+      target->knights_attacking = target->attacking_knights[0];
+    });
     break;
   case ACTION_ATTACKING_SELECT_ALL_2:
-    player->knights_attacking = player->attacking_knights[0]
-                                + player->attacking_knights[1];
+    run_on_player([](Player *target) {
+      target->knights_attacking = target->attacking_knights[0]
+                                  + target->attacking_knights[1];
+    });
     break;
   case ACTION_ATTACKING_SELECT_ALL_3:
-    player->knights_attacking = player->attacking_knights[0]
-                                + player->attacking_knights[1]
-                                + player->attacking_knights[2];
+    run_on_player([](Player *target) {
+      target->knights_attacking = target->attacking_knights[0]
+                                  + target->attacking_knights[1]
+                                  + target->attacking_knights[2];
+    });
     break;
   case ACTION_ATTACKING_SELECT_ALL_4:
-    player->knights_attacking = player->attacking_knights[0]
-                                + player->attacking_knights[1]
-                                + player->attacking_knights[2]
-                                + player->attacking_knights[3];
+    run_on_player([](Player *target) {
+      target->knights_attacking = target->attacking_knights[0]
+                                  + target->attacking_knights[1]
+                                  + target->attacking_knights[2]
+                                  + target->attacking_knights[3];
+    });
     break;
   case ACTION_MINIMAP_BLD_1:
   case ACTION_MINIMAP_BLD_2:
@@ -3489,7 +3627,7 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
   case ACTION_DEFAULT_SETT_4:
     interface->open_popup(TypeSett4);
-    player->reset_tool_priority();
+    run_on_player([](Player *target) { target->reset_tool_priority(); });
     break;
   case ACTION_SHOW_PLAYER_FACES:
     set_box(TypePlayerFaces);
@@ -3501,10 +3639,14 @@ PopupBox::handle_action(int action, int x_, int /*y_*/) {
     break;
     /* TODO */
   case ACTION_SETT_8_CASTLE_DEF_DEC:
-    player->decrease_castle_knights_wanted();
+    run_on_player([](Player *target) {
+      target->decrease_castle_knights_wanted();
+    });
     break;
   case ACTION_SETT_8_CASTLE_DEF_INC:
-    player->increase_castle_knights_wanted();
+    run_on_player([](Player *target) {
+      target->increase_castle_knights_wanted();
+    });
     break;
   case ACTION_OPTIONS_MUSIC: {
     Audio &audio = Audio::get_instance();
@@ -22,6 +22,7 @@
 #ifndef SRC_POPUP_H_
 #define SRC_POPUP_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
@@ -33,6 +34,7 @@ class Interface;
 class MinimapGame;
 class ListSavedFiles;
 class TextInput;
+class Player;
 
 class PopupBox : public GuiObject {
  public:
@@ -181,7 +183,7 @@ class PopupBox : public GuiObject {
   void draw_basic_building_box(int flip);
   void draw_adv_1_building_box();
   void draw_adv_2_building_box();
-  void draw_resources_box(const ResourceMap &resources);
+  void draw_resources_box(const ResourceCounts &resources);
   void draw_serfs_box(const int serfs[], int total);
   void draw_stat_select_box();
   void draw_stat_4_box();
@@ -238,6 +240,8 @@ class PopupBox : public GuiObject {
   void sett_8_train(int number);
   void set_inventory_resource_mode(int mode);
   void set_inventory_serf_mode(int mode);
+  // Apply command to the player of the interface, between ticks.
+  void run_on_player(std::function<void(Player *target)> command);
 
   void handle_action(int action, int x, int y);
   int handle_clickmap(int x, int y, const int clkmap[]);
@@ -21,30 +21,78 @@
 
 #include "src/profiler.h"
 
-#include <string>
+#include <chrono>
+#include <iomanip>
 #include <istream>
+#include <sstream>
+#include <string>
 
 #include "src/command_line.h"
 #include "src/log.h"
 #include "src/version.h"
 #include "src/game-manager.h"
+#include "src/map-cache.h"
+#include "src/mission.h"
+
+/* Number of ticks between two reports of the update rate. */
+#define TICKS_PER_REPORT  1000
+
+static void
+report(unsigned int ticks, double ms) {
+  std::stringstream line;
+  line << ticks << " ticks in " << std::fixed << std::setprecision(1) << ms
+       << " ms (" << (ms > 0. ? ticks * 1000. / ms : 0.) << " ticks/s)";
+  Log::Info["profiler"] << line.str();
+}
+
+static void
+report_building_updates(const Game &game) {
+  for (int type = Building::TypeFisher; type <= Building::TypeCastle;
+       type++) {
+    const Game::BuildingUpdates &updates =
+      game.get_building_updates(static_cast<Building::Type>(type));
+    if (updates.executed + updates.skipped == 0) {
+      continue;
+    }
+    std::stringstream line;
+    line << "building type " << std::setw(2) << type << ": "
+         << updates.executed << " updates run, " << updates.skipped
+         << " skipped";
+    Log::Info["profiler"] << line.str();
+  }
+}
 
 int
 main(int argc, char *argv[]) {
   std::string save_file;
+  int mission = -1;
+  unsigned int ticks = 0;
 
   CommandLine command_line;
   command_line.add_option('h', "Show this help text", [&command_line](){
                   command_line.show_help();
                   exit(EXIT_SUCCESS);
                 });
+  command_line.add_option('k', "Keep generated maps in a cache on disk",
+                          [](){ MapCache::get_instance().set_enabled(true); });
   command_line.add_option('l', "Load saved game")
                 .add_parameter("FILE", [&save_file](std::istream& s) {
                   std::getline(s, save_file);
                   return true;
                 });
+  command_line.add_option('m', "Start mission instead of loading a game")
+                .add_parameter("NUM", [&mission](std::istream& s) {
+                  s >> mission;
+                  return true;
+                });
+  command_line.add_option('n', "Stop after number of ticks")
+                .add_parameter("NUM", [&ticks](std::istream& s) {
+                  s >> ticks;
+                  return true;
+                });
   command_line.set_comment("Please report bugs to <" PACKAGE_BUGREPORT ">");
-  if (!command_line.process(argc, argv) || save_file.empty()) {
+  if (!command_line.process(argc, argv) ||
+      (save_file.empty() && mission < 0)) {
     return EXIT_FAILURE;
   }
 
@@ -52,15 +100,37 @@ main(int argc, char *argv[]) {
 
   GameManager &game_manager = GameManager::get_instance();
 
-  if (!game_manager.load_game(save_file)) {
-    return EXIT_FAILURE;
+  if (mission >= 0) {
+    if (static_cast<size_t>(mission) >= GameInfo::get_mission_count() ||
+        !game_manager.start_game(GameInfo::get_mission(mission))) {
+      return EXIT_FAILURE;
+    }
+    Log::Info["profiler"] << "started mission " << mission;
+  } else {
+    if (!game_manager.load_game(save_file)) {
+      return EXIT_FAILURE;
+    }
+    Log::Info["profiler"] << "loaded game '" << save_file << "'";
   }
-  Log::Info["profiler"] << "loaded game '" << save_file << "'";
+
+  typedef std::chrono::steady_clock Clock;
+  typedef std::chrono::duration<double, std::milli> Milliseconds;
 
   PGame game = game_manager.get_current_game();
-  while (true) {
+  Clock::time_point start = Clock::now();
+  Clock::time_point last = start;
+  for (unsigned int tick = 1; (ticks == 0) || (tick <= ticks); tick++) {
     game->update();
+    if (tick % TICKS_PER_REPORT == 0) {
+      Clock::time_point now = Clock::now();
+      report(TICKS_PER_REPORT, Milliseconds(now - last).count());
+      last = now;
+    }
   }
+  report(ticks, Milliseconds(Clock::now() - start).count());
+  report_building_updates(*game);
+  Log::Info["profiler"] << "serf searches avoided: "
+                        << game->get_serf_search_cache()->get_avoided_count();
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,209 @@
+/*
+ * render-profiler.cc - Rendering profiling tool.
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Renders a saved game with the headless video backend while the viewport
+   follows a fixed camera path, and reports frame times for each viewport
+   layer. Optionally every frame is written as PPM, so that the output of
+   two builds can be compared. */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "src/command_line.h"
+#include "src/log.h"
+#include "src/version.h"
+#include "src/data.h"
+#include "src/gfx.h"
+#include "src/interface.h"
+#include "src/viewport.h"
+#include "src/game-manager.h"
+#include "src/video-headless.h"
+
+typedef struct LayerStat {
+  const char *name;
+  unsigned int layers;
+  double total;
+  double min;
+  double max;
+} LayerStat;
+
+/* Camera path in pixels per frame: a square loop around the start
+   position. */
+static const int camera_path[][2] = {
+  { 16,  0 }, {  0, 16 }, { -16,  0 }, {  0, -16 }
+};
+
+int
+main(int argc, char *argv[]) {
+  std::string data_dir;
+  std::string save_file;
+  std::string dump_dir;
+  unsigned int screen_width = 800;
+  unsigned int screen_height = 600;
+  unsigned int frames = 400;
+
+  CommandLine command_line;
+  command_line.add_option('d', "Set Debug output level")
+                .add_parameter("NUM", [](std::istream& s) {
+                  int d;
+                  s >> d;
+                  if (d >= 0 && d < Log::LevelMax) {
+                    Log::set_level(static_cast<Log::Level>(d));
+                  }
+                  return true;
+                });
+  command_line.add_option('g', "Use specified data directory")
+                .add_parameter("DATA-PATH", [&data_dir](std::istream& s) {
+                  s >> data_dir;
+                  return true;
+                });
+  command_line.add_option('h', "Show this help text", [&command_line](){
+                  command_line.show_help();
+                  exit(EXIT_SUCCESS);
+                });
+  command_line.add_option('l', "Load saved game")
+                .add_parameter("FILE", [&save_file](std::istream& s) {
+                  std::getline(s, save_file);
+                  return true;
+                });
+  command_line.add_option('n', "Number of frames to render")
+                .add_parameter("NUM", [&frames](std::istream& s) {
+                  s >> frames;
+                  return true;
+                });
+  command_line.add_option('o', "Write every frame as PPM into directory")
+                .add_parameter("DIR", [&dump_dir](std::istream& s) {
+                  std::getline(s, dump_dir);
+                  return true;
+                });
+  command_line.add_option('r', "Set display resolution (e.g. 800x600)")
+                .add_parameter("RES",
+                              [&screen_width, &screen_height](std::istream& s) {
+                  s >> screen_width;
+                  char c; s >> c;
+                  s >> screen_height;
+                  return true;
+                });
+  command_line.set_comment("Please report bugs to <" PACKAGE_BUGREPORT ">");
+  if (!command_line.process(argc, argv) || save_file.empty() ||
+      frames == 0) {
+    return EXIT_FAILURE;
+  }
+
+  Log::Info["profiler"] << "starts " << FREESERF_VERSION;
+
+  Data &data = Data::get_instance();
+  if (!data.load(data_dir)) {
+    Log::Error["profiler"] << "Could not load game data.";
+    return EXIT_FAILURE;
+  }
+
+  Graphics &gfx = Graphics::get_instance();
+  gfx.set_resolution(screen_width, screen_height, false);
+
+  GameManager &game_manager = GameManager::get_instance();
+  if (!game_manager.load_game(save_file)) {
+    return EXIT_FAILURE;
+  }
+  Log::Info["profiler"] << "loaded game '" << save_file << "'";
+
+  Interface interface;
+  interface.set_size(screen_width, screen_height);
+  interface.set_displayed(true);
+
+  Viewport *viewport = interface.get_viewport();
+  VideoHeadless &video = static_cast<VideoHeadless&>(Video::get_instance());
+  Frame *screen = gfx.get_screen_frame();
+
+  std::vector<LayerStat> stats = {
+    { "landscape", Viewport::LayerLandscape, 0., 1e9, 0. },
+    { "paths",     Viewport::LayerPaths,     0., 1e9, 0. },
+    { "objects",   Viewport::LayerObjects,   0., 1e9, 0. },
+    { "serfs",     Viewport::LayerSerfs,     0., 1e9, 0. },
+    { "cursor",    Viewport::LayerCursor,    0., 1e9, 0. },
+    { "all",       Viewport::LayerAll,       0., 1e9, 0. },
+  };
+
+  const unsigned int leg_length = std::max(1u, frames / 4);
+  for (unsigned int i = 0; i < frames; i++) {
+    const int *step = camera_path[(i / leg_length) % 4];
+    viewport->move_by_pixels(step[0], step[1]);
+    // Copy the new view area, as the game does after every tick.
+    interface.update_snapshot();
+
+    for (LayerStat &stat : stats) {
+      viewport->set_layers(stat.layers);
+
+      auto start = std::chrono::steady_clock::now();
+      if (stat.layers == Viewport::LayerAll) {
+        interface.draw(screen);
+      } else {
+        viewport->draw(screen);
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      std::chrono::duration<double, std::milli> elapsed = end - start;
+      double ms = elapsed.count();
+      stat.total += ms;
+      stat.min = std::min(stat.min, ms);
+      stat.max = std::max(stat.max, ms);
+    }
+
+    gfx.swap_buffers();
+
+    if (!dump_dir.empty()) {
+      std::stringstream path;
+      path << dump_dir << "/frame-" << std::setw(5) << std::setfill('0')
+           << i << ".ppm";
+      video.write_ppm(video.get_screen_frame(), path.str());
+    }
+  }
+
+  delete screen;
+
+  Log::Info["profiler"] << "rendered " << frames << " frames at "
+                        << screen_width << "x" << screen_height;
+  for (const LayerStat &stat : stats) {
+    std::stringstream line;
+    line << std::fixed << std::setprecision(3)
+         << std::setw(10) << stat.name
+         << ": avg " << stat.total / frames << " ms"
+         << ", min " << stat.min << " ms"
+         << ", max " << stat.max << " ms";
+    Log::Info["profiler"] << line.str();
+  }
+
+  const Graphics::HitchStats &hitches = gfx.get_hitch_stats();
+  std::stringstream line;
+  line << std::fixed << std::setprecision(3)
+       << "sprites decoded while drawing: " << hitches.count
+       << ", total " << hitches.total << " ms"
+       << ", max " << hitches.max << " ms"
+       << ", prefetched " << hitches.prefetched;
+  Log::Info["profiler"] << line.str();
+
+  return EXIT_SUCCESS;
+}
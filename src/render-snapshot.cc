@@ -0,0 +1,338 @@
+/*
+ * render-snapshot.cc - Game state copied for drawing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/render-snapshot.h"
+
+#include <algorithm>
+#include <utility>
+
+RenderSnapshot::RenderSnapshot()
+  : tick(0)
+  , const_tick(0)
+  , ticks_behind(0)
+  , map_serial(0)
+  , has_message{false}
+  , has_notification{false}
+  , changes_lost(false) {
+}
+
+template<typename T>
+static const T *
+find_by_index(const std::vector<T> &states, unsigned int index) {
+  auto it = std::lower_bound(states.begin(), states.end(), index,
+                             [](const T &state, unsigned int i) {
+                               return state.index < i;
+                             });
+  if (it == states.end() || it->index != index) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+template<typename T>
+static void
+sort_by_index(std::vector<T> *states) {
+  std::sort(states->begin(), states->end(), [](const T &a, const T &b) {
+    return a.index < b.index;
+  });
+  states->erase(std::unique(states->begin(), states->end(),
+                            [](const T &a, const T &b) {
+                              return a.index == b.index;
+                            }),
+                states->end());
+}
+
+const RenderSnapshot::SerfState *
+RenderSnapshot::get_serf(unsigned int index) const {
+  return find_by_index(serfs, index);
+}
+
+const RenderSnapshot::BuildingState *
+RenderSnapshot::get_building(unsigned int index) const {
+  return find_by_index(buildings, index);
+}
+
+const RenderSnapshot::FlagState *
+RenderSnapshot::get_flag(unsigned int index) const {
+  return find_by_index(flags, index);
+}
+
+bool
+RenderSnapshot::player_has_message(unsigned int player) const {
+  return (player < GAME_MAX_PLAYER_COUNT) && has_message[player];
+}
+
+bool
+RenderSnapshot::player_has_notification(unsigned int player) const {
+  return (player < GAME_MAX_PLAYER_COUNT) && has_notification[player];
+}
+
+SnapshotPublisher::SnapshotPublisher(PGame _game)
+  : game(std::move(_game))
+  , back(1)
+  , front(0)
+  , middle(2)
+  , change_serial(0)
+  , consumed_serial(0)
+  , published_serial(0) {
+  for (int view = 0; view < ViewCount; view++) {
+    view_pos[view] = 0;
+    view_cols[view] = 0;
+    view_rows[view] = 0;
+  }
+
+  Map *live = game->get_map();
+  for (RenderSnapshot &snapshot : snapshots) {
+    snapshot.map.reset(new Map(live->geom()));
+    snapshot.map->copy_tiles(*live, 0, live->get_cols(), live->get_rows());
+  }
+  live->add_change_handler(this);
+
+  publish(0);
+  get_snapshot();
+}
+
+SnapshotPublisher::~SnapshotPublisher() {
+  game->get_map()->del_change_handler(this);
+}
+
+void
+SnapshotPublisher::publish(unsigned int ticks_behind) {
+  RenderSnapshot *snapshot = &snapshots[back];
+  snapshot->tick = game->get_tick();
+  snapshot->const_tick = game->get_const_tick();
+  snapshot->ticks_behind = ticks_behind;
+
+  update_map(snapshot);
+  capture_view(snapshot);
+
+  for (unsigned int i = 0; i < GAME_MAX_PLAYER_COUNT; i++) {
+    Player *player = game->get_player(i);
+    snapshot->has_message[i] = (player != nullptr) && player->has_message();
+    snapshot->has_notification[i] = (player != nullptr) &&
+                                     player->has_notification();
+  }
+
+  if ((middle.load() & kFresh) == 0) {
+    // The interface took the snapshot published before this one.
+    consumed_serial = published_serial;
+  }
+
+  // Everything the interface has not seen yet, also from snapshots that it
+  // skipped. One it takes while this is filled has its changes repeated.
+  uint64_t first = changes.empty() ? change_serial + 1 :
+                                     changes.front().serial;
+  snapshot->changes_lost = (consumed_serial + 1 < first);
+  snapshot->changes.clear();
+  for (const RenderSnapshot::Change &change : changes) {
+    if (change.serial > consumed_serial) {
+      snapshot->changes.push_back(change);
+    }
+  }
+
+  unsigned int previous = middle.exchange(back | kFresh);
+  if ((previous & kFresh) == 0) {
+    consumed_serial = published_serial;
+  }
+  published_serial = change_serial;
+  back = previous & ~kFresh;
+
+  trim_changes();
+}
+
+void
+SnapshotPublisher::set_view(View view, MapPos pos, unsigned int cols,
+                            unsigned int rows) {
+  view_pos[view] = pos;
+  view_cols[view] = cols;
+  view_rows[view] = rows;
+}
+
+const RenderSnapshot *
+SnapshotPublisher::get_snapshot() {
+  if ((middle.load() & kFresh) != 0) {
+    front = middle.exchange(front) & ~kFresh;
+  }
+  return &snapshots[front];
+}
+
+void
+SnapshotPublisher::on_height_changed(MapPos pos) {
+  add_change(pos, true);
+}
+
+void
+SnapshotPublisher::on_object_changed(MapPos pos) {
+  add_change(pos, false);
+}
+
+void
+SnapshotPublisher::add_change(MapPos pos, bool height) {
+  change_serial += 1;
+  changes.push_back({change_serial, pos, height});
+}
+
+// Bring the landscape outside the view up to date with the changes this
+// buffer missed, or copy all of it when the log no longer has them.
+void
+SnapshotPublisher::update_map(RenderSnapshot *snapshot) {
+  Map *live = game->get_map();
+  uint64_t first = changes.empty() ? change_serial + 1 :
+                                     changes.front().serial;
+  if (snapshot->map_serial + 1 < first) {
+    snapshot->map->copy_tiles(*live, 0, live->get_cols(), live->get_rows());
+  } else {
+    for (const RenderSnapshot::Change &change : changes) {
+      if (change.serial > snapshot->map_serial) {
+        // The handlers get the neighbours of the changed position.
+        snapshot->map->copy_tiles(*live, live->pos_add(change.pos, -1, -1),
+                                  3, 3);
+      }
+    }
+  }
+  snapshot->map_serial = change_serial;
+}
+
+void
+SnapshotPublisher::capture_view(RenderSnapshot *snapshot) {
+  snapshot->serfs.clear();
+  snapshot->buildings.clear();
+  snapshot->flags.clear();
+
+  for (int view = 0; view < ViewCount; view++) {
+    capture_area(snapshot, static_cast<View>(view));
+  }
+
+  // Views may overlap.
+  sort_by_index(&snapshot->serfs);
+  sort_by_index(&snapshot->buildings);
+  sort_by_index(&snapshot->flags);
+}
+
+void
+SnapshotPublisher::capture_area(RenderSnapshot *snapshot, View view) {
+  Map *live = game->get_map();
+  MapPos pos = view_pos[view];
+  unsigned int cols = std::min(view_cols[view].load(), live->get_cols());
+  unsigned int rows = std::min(view_rows[view].load(), live->get_rows());
+  if (pos >= live->geom().tile_count()) {
+    return;
+  }
+
+  snapshot->map->copy_tiles(*live, pos, cols, rows);
+
+  for (unsigned int r = 0; r < rows; r++) {
+    MapPos p = live->pos_add(pos, 0, r);
+    for (unsigned int c = 0; c < cols; c++, p = live->move_right(p)) {
+      if (live->has_serf(p)) {
+        Serf *serf = game->get_serf_at_pos(p);
+        if (serf != nullptr) {
+          capture_serf(snapshot, serf);
+        }
+      }
+
+      if (live->has_flag(p)) {
+        Flag *flag = game->get_flag_at_pos(p);
+        if (flag != nullptr) {
+          RenderSnapshot::FlagState state;
+          state.index = flag->get_index();
+          state.owner = flag->get_owner();
+          for (int i = 0; i < FLAG_MAX_RES_COUNT; i++) {
+            state.resources[i] = flag->get_resource_at_slot(i);
+          }
+          snapshot->flags.push_back(state);
+        }
+      } else if (live->has_building(p)) {
+        Building *building = game->get_building_at_pos(p);
+        if (building != nullptr) {
+          RenderSnapshot::BuildingState state;
+          state.index = building->get_index();
+          state.pos = building->get_position();
+          state.type = building->get_type();
+          state.done = building->is_done();
+          state.active = building->is_active();
+          state.burning = building->is_burning();
+          state.playing_sfx = building->is_playing_sfx();
+          state.has_knight = building->has_knight();
+          state.progress = building->get_progress();
+          state.burning_counter = building->get_burning_counter();
+          state.waiting_stone = building->waiting_stone();
+          state.waiting_planks = building->waiting_planks();
+          state.knight_count = building->get_knight_count();
+          state.threat_level = building->get_threat_level();
+          state.stock_1_count = building->get_res_count_in_stock(1);
+          snapshot->buildings.push_back(state);
+        }
+      }
+    }
+  }
+}
+
+static RenderSnapshot::SerfState
+serf_state(Serf *serf) {
+  RenderSnapshot::SerfState state;
+  state.index = serf->get_index();
+  state.owner = serf->get_owner();
+  state.type = serf->get_type();
+  state.state = serf->get_state();
+  state.animation = serf->get_animation();
+  state.counter = serf->get_counter();
+  state.delivery = serf->get_delivery();
+  state.free_walking_neg_dist1 = serf->get_free_walking_neg_dist1();
+  state.free_walking_neg_dist2 = serf->get_free_walking_neg_dist2();
+  state.leaving_building_next_state =
+    serf->get_leaving_building_next_state();
+  state.leaving_building_field_B = serf->get_leaving_building_field_B();
+  state.mining_res = serf->get_mining_res();
+  state.mining_substate = serf->get_mining_substate();
+  state.attacking_field_D = serf->get_attacking_field_D();
+  state.attacking_def_index = serf->get_attacking_def_index();
+  return state;
+}
+
+void
+SnapshotPublisher::capture_serf(RenderSnapshot *snapshot, Serf *serf) {
+  RenderSnapshot::SerfState state = serf_state(serf);
+  snapshot->serfs.push_back(state);
+
+  // Attacking knights draw their defender, which is not on the map.
+  if (state.type >= Serf::TypeKnight0 && state.type <= Serf::TypeKnight4 &&
+      state.attacking_def_index > 0) {
+    Serf *defender = game->get_serf(state.attacking_def_index);
+    if (defender != nullptr) {
+      snapshot->serfs.push_back(serf_state(defender));
+    }
+  }
+}
+
+// Forget the changes that every buffer and the interface have, and more if
+// the log grew too long; buffers and the interface catch up without them.
+void
+SnapshotPublisher::trim_changes() {
+  uint64_t seen = consumed_serial;
+  for (const RenderSnapshot &snapshot : snapshots) {
+    seen = std::min(seen, snapshot.map_serial);
+  }
+  while (!changes.empty() &&
+         (changes.front().serial <= seen || changes.size() > kMaxChanges)) {
+    changes.pop_front();
+  }
+}
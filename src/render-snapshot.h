@@ -0,0 +1,196 @@
+/*
+ * render-snapshot.h - Game state copied for drawing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_RENDER_SNAPSHOT_H_
+#define SRC_RENDER_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "src/game.h"
+
+// The state the viewport draws, copied from the game after a batch of ticks
+// so that frames can be drawn while the next ticks run. The landscape of the
+// whole map is kept current; tile contents, serfs, buildings and flags only
+// within the view areas that the interface last asked for.
+class RenderSnapshot {
+ public:
+  typedef struct SerfState {
+    unsigned int index;
+    unsigned int owner;
+    Serf::Type type;
+    Serf::State state;
+    int animation;
+    int counter;
+    int delivery;
+    int free_walking_neg_dist1;
+    int free_walking_neg_dist2;
+    int leaving_building_next_state;
+    int leaving_building_field_B;
+    int mining_res;
+    int mining_substate;
+    int attacking_field_D;
+    int attacking_def_index;
+  } SerfState;
+
+  typedef struct BuildingState {
+    unsigned int index;
+    MapPos pos;
+    Building::Type type;
+    bool done;
+    bool active;
+    bool burning;
+    bool playing_sfx;
+    bool has_knight;
+    int progress;
+    int burning_counter;
+    unsigned int waiting_stone;
+    unsigned int waiting_planks;
+    unsigned int knight_count;
+    size_t threat_level;
+    unsigned int stock_1_count;
+  } BuildingState;
+
+  typedef struct FlagState {
+    unsigned int index;
+    unsigned int owner;
+    Resource::Type resources[FLAG_MAX_RES_COUNT];
+  } FlagState;
+
+  // A position passed to Map::Handler since the previous snapshot.
+  typedef struct Change {
+    uint64_t serial;
+    MapPos pos;
+    bool height;
+  } Change;
+
+ protected:
+  unsigned int tick;
+  unsigned int const_tick;
+  unsigned int ticks_behind;
+
+  std::unique_ptr<Map> map;
+  uint64_t map_serial;  // last change applied to map
+
+  // Sorted by index.
+  std::vector<SerfState> serfs;
+  std::vector<BuildingState> buildings;
+  std::vector<FlagState> flags;
+
+  bool has_message[GAME_MAX_PLAYER_COUNT];
+  bool has_notification[GAME_MAX_PLAYER_COUNT];
+
+  std::vector<Change> changes;
+  bool changes_lost;
+
+ public:
+  RenderSnapshot();
+
+  unsigned int get_tick() const { return tick; }
+  unsigned int get_const_tick() const { return const_tick; }
+  unsigned int get_ticks_behind() const { return ticks_behind; }
+
+  const Map *get_map() const { return map.get(); }
+
+  // Objects by index, or nullptr when they were outside the view area.
+  const SerfState *get_serf(unsigned int index) const;
+  const BuildingState *get_building(unsigned int index) const;
+  const FlagState *get_flag(unsigned int index) const;
+  const SerfState *get_serf_at_pos(MapPos pos) const {
+    return get_serf(map->get_serf_index(pos)); }
+  const BuildingState *get_building_at_pos(MapPos pos) const {
+    return get_building(map->get_obj_index(pos)); }
+  const FlagState *get_flag_at_pos(MapPos pos) const {
+    return get_flag(map->get_obj_index(pos)); }
+
+  bool player_has_message(unsigned int player) const;
+  bool player_has_notification(unsigned int player) const;
+
+  // Changes since the snapshot the interface took before this one. When
+  // are_changes_lost() the list is incomplete and anything may have changed.
+  const std::vector<Change> &get_changes() const { return changes; }
+  bool are_changes_lost() const { return changes_lost; }
+
+  friend class SnapshotPublisher;
+};
+
+// Triple buffer of snapshots between the thread that updates the game and
+// the interface. publish() fills the back buffer with the game locked and
+// swaps it into the middle; get_snapshot() swaps a fresh middle buffer to
+// the front. Neither side waits for the other.
+class SnapshotPublisher : public Map::Handler {
+ public:
+  // Areas copied into the snapshots: the main viewport, and one shown in a
+  // popup.
+  typedef enum View {
+    ViewMain = 0,
+    ViewPopup,
+    ViewCount
+  } View;
+
+ protected:
+  static const unsigned int kFresh = 4;  // middle holds an unseen snapshot
+  static const size_t kMaxChanges = 4096;
+
+  PGame game;
+  RenderSnapshot snapshots[3];
+  unsigned int back;
+  unsigned int front;
+  std::atomic<unsigned int> middle;
+
+  std::atomic<MapPos> view_pos[ViewCount];
+  std::atomic<unsigned int> view_cols[ViewCount];
+  std::atomic<unsigned int> view_rows[ViewCount];
+
+  std::deque<RenderSnapshot::Change> changes;
+  uint64_t change_serial;
+  uint64_t consumed_serial;  // changes the interface has seen
+  uint64_t published_serial;
+
+ public:
+  explicit SnapshotPublisher(PGame game);
+  virtual ~SnapshotPublisher();
+
+  // Copy the game into a new snapshot, with the game locked.
+  void publish(unsigned int ticks_behind);
+
+  // Area of cols by rows from pos to copy into later snapshots.
+  void set_view(View view, MapPos pos, unsigned int cols, unsigned int rows);
+  // The latest snapshot, valid until the next call.
+  const RenderSnapshot *get_snapshot();
+
+  // Map::Handler implementation
+  virtual void on_height_changed(MapPos pos);
+  virtual void on_object_changed(MapPos pos);
+
+ protected:
+  void add_change(MapPos pos, bool height);
+  void update_map(RenderSnapshot *snapshot);
+  void capture_view(RenderSnapshot *snapshot);
+  void capture_area(RenderSnapshot *snapshot, View view);
+  void capture_serf(RenderSnapshot *snapshot, Serf *serf);
+  void trim_changes();
+};
+
+#endif  // SRC_RENDER_SNAPSHOT_H_
@@ -22,6 +22,7 @@
 #ifndef SRC_RESOURCE_H_
 #define SRC_RESOURCE_H_
 
+#include <array>
 #include <map>
 
 class Resource {
@@ -63,5 +64,7 @@ class Resource {
 };
 
 typedef std::map<Resource::Type, unsigned int> ResourceMap;
+/* Counts of all resource types but the food group. */
+typedef std::array<unsigned int, Resource::GroupFood> ResourceCounts;
 
 #endif  // SRC_RESOURCE_H_
@@ -32,6 +32,7 @@
 #include <algorithm>
 
 #include "src/game.h"
+#include "src/buffer.h"
 #include "src/log.h"
 #include "src/debug.h"
 #include "src/configfile.h"
@@ -744,11 +745,9 @@ GameStore::load(const std::string &path, Game *game) {
     file.close();
     Log::Warn["savegame"] << "Unable to load save game: " << e.what();
     Log::Warn["savegame"] << "Trying compatability mode...";
-    std::ifstream input(path.c_str(), std::ios::binary);
-    std::vector<char> buffer((std::istreambuf_iterator<char>(input)),
-                             (std::istreambuf_iterator<char>()));
-    SaveReaderBinary reader(&buffer[0], buffer.size());
     try {
+      MappedBuffer buffer(path);
+      SaveReaderBinary reader(buffer.get_data(), buffer.get_size());
       reader >> *game;
     } catch (ExceptionFreeserf& e) {
       Log::Error["savegame"] << "Failed to load save game: " << e.what();
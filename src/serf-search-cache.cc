@@ -0,0 +1,92 @@
+/*
+ * serf-search-cache.cc - Failed searches for serfs
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/serf-search-cache.h"
+
+#include <algorithm>
+
+SerfSearchCache::SerfSearchCache()
+  : now(0)
+  , network_changed_at(0)
+  , avoided(0) {
+  std::fill(std::begin(serf_added_at), std::end(serf_added_at), 0);
+  std::fill(std::begin(resource_added_at), std::end(resource_added_at), 0);
+}
+
+bool
+SerfSearchCache::is_futile(unsigned int flag, Serf::Type type,
+                           Resource::Type res1, Resource::Type res2) {
+  Failures::iterator it = failures.find(get_key(flag, type, res1, res2));
+  if (it == failures.end()) {
+    return false;
+  }
+
+  if (is_outdated(it->second, type, res1, res2)) {
+    failures.erase(it);
+    return false;
+  }
+
+  avoided++;
+  return true;
+}
+
+void
+SerfSearchCache::add_failure(unsigned int flag, Serf::Type type,
+                             Resource::Type res1, Resource::Type res2) {
+  failures[get_key(flag, type, res1, res2)] = now;
+}
+
+uint64_t
+SerfSearchCache::get_key(unsigned int flag, Serf::Type type,
+                         Resource::Type res1, Resource::Type res2) {
+  // Knight types go down to -5, resource types to -1.
+  return (static_cast<uint64_t>(flag) << 24) |
+         (static_cast<uint64_t>(type + 8) << 16) |
+         (static_cast<uint64_t>(res1 + 1) << 8) |
+         static_cast<uint64_t>(res2 + 1);
+}
+
+bool
+SerfSearchCache::is_outdated(uint64_t failed_at, Serf::Type type,
+                             Resource::Type res1,
+                             Resource::Type res2) const {
+  if (network_changed_at > failed_at ||
+      serf_added_at[Serf::TypeGeneric] > failed_at) {
+    return true;
+  }
+
+  if (type < 0) {
+    // Any knight will do, or a generic serf with sword and shield.
+    for (int t = Serf::TypeKnight0; t <= Serf::TypeKnight4; t++) {
+      if (serf_added_at[t] > failed_at) {
+        return true;
+      }
+    }
+    return (resource_added_at[Resource::TypeSword] > failed_at ||
+            resource_added_at[Resource::TypeShield] > failed_at);
+  }
+
+  return (serf_added_at[type] > failed_at ||
+          (res1 != Resource::TypeNone &&
+           resource_added_at[res1] > failed_at) ||
+          (res2 != Resource::TypeNone &&
+           resource_added_at[res2] > failed_at));
+}
@@ -0,0 +1,74 @@
+/*
+ * serf-search-cache.h - Failed searches for serfs
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_SERF_SEARCH_CACHE_H_
+#define SRC_SERF_SEARCH_CACHE_H_
+
+#include <unordered_map>
+
+#include "src/resource.h"
+#include "src/serf.h"
+
+// Searches from a flag for an inventory to send a serf from, that found
+// none. Such a search fails in the same way until an inventory gains the
+// serf or the resources to make one, or the roads reach further, so it is
+// answered from here until then. Time advances with each of these changes.
+class SerfSearchCache {
+ protected:
+  typedef std::unordered_map<uint64_t, uint64_t> Failures;
+
+  Failures failures;  // time of the failure by key
+  uint64_t now;
+  uint64_t network_changed_at;
+  uint64_t serf_added_at[Serf::TypeDead + 1];
+  uint64_t resource_added_at[Resource::TypesCount];
+  uint64_t avoided;
+
+ public:
+  SerfSearchCache();
+
+  // Whether a search from flag for a serf of type, or for a generic serf
+  // and the resources res1 and res2, would fail again. Negative types ask
+  // for knights like Game::send_serf_to_flag() does.
+  bool is_futile(unsigned int flag, Serf::Type type, Resource::Type res1,
+                 Resource::Type res2);
+  void add_failure(unsigned int flag, Serf::Type type, Resource::Type res1,
+                   Resource::Type res2);
+
+  // A road or an inventory was added to the flag network.
+  void network_changed() { network_changed_at = ++now; }
+  // An inventory gained a serf of type, or a generic serf.
+  void serf_added(Serf::Type type) { serf_added_at[type] = ++now; }
+  // An inventory gained resource.
+  void resource_added(Resource::Type resource) {
+    resource_added_at[resource] = ++now; }
+
+  // Number of searches answered by is_futile().
+  uint64_t get_avoided_count() const { return avoided; }
+
+ protected:
+  static uint64_t get_key(unsigned int flag, Serf::Type type,
+                          Resource::Type res1, Resource::Type res2);
+  bool is_outdated(uint64_t failed_at, Serf::Type type, Resource::Type res1,
+                   Resource::Type res2) const;
+};
+
+#endif  // SRC_SERF_SEARCH_CACHE_H_
@@ -33,22 +33,25 @@
 #include "src/inventory.h"
 #include "src/savegame.h"
 
+static const Log::Subsystem log_savegame("savegame");
+static const Log::Subsystem log_serf("serf");
+
 #define set_state(new_state)  \
-  Log::Verbose["serf"] << "serf " << index  \
-                       << " (" << Serf::get_type_name(get_type()) << "): " \
-                       << "state " << Serf::get_state_name(state) \
-                       << " -> " << Serf::get_state_name((new_state)) \
-                       << " (" << __FUNCTION__ << ":" << __LINE__ << ")"; \
-  state = new_state;
+  LOG_VERBOSE(log_serf) << "serf " << index  \
+                        << " (" << Serf::get_type_name(get_type()) << "): " \
+                        << "state " << Serf::get_state_name(state) \
+                        << " -> " << Serf::get_state_name((new_state)) \
+                        << " (" << __FUNCTION__ << ":" << __LINE__ << ")"; \
+  change_state(new_state);
 
 #define set_other_state(other_serf, new_state)  \
-  Log::Verbose["serf"] << "serf " << other_serf->index \
-                       << " (" << Serf::get_type_name(other_serf->get_type()) \
-                       << "): state " \
-                       << Serf::get_state_name(other_serf->state) \
-                       << " -> " << Serf::get_state_name((new_state)) \
-                       << "(" << __FUNCTION__ << ":" << __LINE__ << ")"; \
-  other_serf->state = new_state;
+  LOG_VERBOSE(log_serf) << "serf " << other_serf->index \
+                        << " (" << Serf::get_type_name(other_serf->get_type()) \
+                        << "): state " \
+                        << Serf::get_state_name(other_serf->state) \
+                        << " -> " << Serf::get_state_name((new_state)) \
+                        << "(" << __FUNCTION__ << ":" << __LINE__ << ")"; \
+  other_serf->change_state(new_state);
 
 
 static const int counter_from_animation[] = {
@@ -289,7 +292,13 @@ Serf::get_type_name(Serf::Type type) {
   return serf_type_name[type];
 }
 
-Serf::Serf(Game *game, unsigned int index) : GameObject(game, index) {
+Serf::Serf(Game *game, unsigned int index)
+  : GameObject(game, index)
+  , animation(game->get_serf_fields()->animation(index))
+  , counter(game->get_serf_fields()->counter(index))
+  , pos(game->get_serf_fields()->pos(index))
+  , tick(game->get_serf_fields()->tick(index))
+  , state(game->get_serf_fields()->state(index)) {
   state = StateNull;
   owner = -1;
   type = TypeNone;
@@ -301,6 +310,11 @@ Serf::Serf(Game *game, unsigned int index) : GameObject(game, index) {
   s = { { 0 } };
 }
 
+Serf::~Serf() {
+  /* The entries stay until the index is used again. */
+  state = StateNull;
+}
+
 /* Change type of serf and update all global tables
    tracking serf types. */
 void
@@ -312,11 +326,16 @@ Serf::set_type(Serf::Type new_type) {
   Serf::Type old_type = type;
   type = new_type;
 
+  Player *player = game->get_player(get_owner());
+  if (state == StateIdleInStock) {
+    player->add_stats_serf_idle(old_type, -1);
+    player->add_stats_serf_idle(new_type, 1);
+  }
+
   /* Register this type as transporter */
   if (new_type == TypeTransporterInventory) new_type = TypeTransporter;
   if (old_type == TypeTransporterInventory) old_type = TypeTransporter;
 
-  Player *player = game->get_player(get_owner());
   if (old_type != Serf::TypeNone && old_type != Serf::TypeDead) {
     player->decrease_serf_count(old_type);
   }
@@ -339,6 +358,20 @@ Serf::set_type(Serf::Type new_type) {
   }
 }
 
+/* Set state, keeping the count of idle serfs of the owner. */
+void
+Serf::change_state(State new_state) {
+  bool was_idle = (state == StateIdleInStock);
+  bool idle = (new_state == StateIdleInStock);
+  state = new_state;
+  if (was_idle != idle) {
+    Player *player = game->get_player(get_owner());
+    if (player != nullptr) {
+      player->add_stats_serf_idle(type, idle ? 1 : -1);
+    }
+  }
+}
+
 void
 Serf::add_to_defending_queue(unsigned int next_knight_index, bool pause) {
   set_state(StateDefendingCastle);
@@ -355,7 +388,7 @@ Serf::init_generic(Inventory *inventory) {
   Building *building = game->get_building(inventory->get_building_index());
   pos = building->get_position();
   tick = game->get_tick();
-  state = StateIdleInStock;
+  change_state(StateIdleInStock);
   s.idle_in_stock.inv_index = inventory->get_index();
 }
 
@@ -569,7 +602,7 @@ Serf::building_deleted(MapPos building_pos, bool escape) {
       (state == StateIdleInStock || state == StateReadyToLeaveInventory)) {
     if (escape) {
       /* Serf is escaping. */
-      state = StateEscapeBuilding;
+      change_state(StateEscapeBuilding);
     } else {
       /* Kill this serf. */
       set_type(TypeDead);
@@ -962,7 +995,7 @@ Serf::get_walking_animation(int h_diff, Direction dir, int switch_pos) {
 /* Preconditon: serf is in WALKING or TRANSPORTING state */
 void
 Serf::change_direction(Direction dir, int alt_end) {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos new_pos = map->move(pos, dir);
 
   if (!map->has_serf(new_pos)) {
@@ -1010,7 +1043,7 @@ Serf::change_direction(Direction dir, int alt_end) {
     if (map->has_flag(new_pos)) {
       counter = 0;
     } else {
-      Log::Debug["serf"] << "unhandled jump to 31B82.";
+      LOG_DEBUG(log_serf) << "unhandled jump to 31B82.";
     }
   }
 }
@@ -1057,7 +1090,7 @@ Serf::handle_serf_walking_state_search_cb(Flag *flag, void *data) {
   Serf *serf = static_cast<Serf*>(data);
   Flag *dest = flag->get_game()->get_flag(serf->s.walking.dest);
   if (flag == dest) {
-    Log::Verbose["serf"] << " dest found: " << dest->get_search_dir();
+    LOG_VERBOSE(log_serf) << " dest found: " << dest->get_search_dir();
     serf->change_direction(dest->get_search_dir(), 0);
     return true;
   }
@@ -1067,7 +1100,7 @@ Serf::handle_serf_walking_state_search_cb(Flag *flag, void *data) {
 
 void
 Serf::start_walking(Direction dir, int slope, int change_pos) {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos new_pos = map->move(pos, dir);
   animation = get_walking_animation(map->get_height(new_pos) -
                                     map->get_height(pos), dir, 0);
@@ -1125,7 +1158,7 @@ void
 Serf::handle_serf_walking_state_dest_reached() {
   /* Destination reached. */
   if (s.walking.dir1 < 0) {
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     Building *building = game->get_building_at_pos(map->move_up_left(pos));
     building->requested_serf_reached(this);
 
@@ -1169,7 +1202,7 @@ Serf::handle_serf_walking_state_waiting() {
   /* Waiting for other serf. */
   Direction dir = (Direction)(s.walking.dir + 6);
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   /* Only check for loops once in a while. */
   s.walking.wait_counter += 1;
   if ((!map->has_flag(pos) && s.walking.wait_counter >= 10) ||
@@ -1318,7 +1351,7 @@ Serf::handle_serf_transporting_state() {
   if (s.transporting.dir < 0) {
     change_direction((Direction)(s.transporting.dir + 6), 1);
   } else {
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     /* 31549 */
     if (map->has_flag(pos)) {
       /* Current position occupied by waiting transporter */
@@ -1439,7 +1472,7 @@ Serf::handle_serf_entering_building_state() {
     }
 
     counter = s.entering_building.slope_len;
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     switch (get_type()) {
       case TypeTransporter:
         if (s.entering_building.field_B == -2) {
@@ -1866,7 +1899,7 @@ Serf::handle_serf_leaving_building_state() {
     } else if (state == StateKnightPrepareDefending || state == StateScatter) {
       /* No state. */
     } else {
-      Log::Debug["serf"] << "unhandled next state when leaving building.";
+      LOG_DEBUG(log_serf) << "unhandled next state when leaving building.";
     }
   }
 }
@@ -1889,7 +1922,7 @@ Serf::handle_serf_ready_to_leave_state() {
   tick = game->get_tick();
   counter = 0;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos new_pos = map->move_down_right(pos);
 
   if ((map->get_serf_index(pos) != index && map->has_serf(pos))
@@ -1913,12 +1946,12 @@ Serf::handle_serf_digging_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
 
   while (counter < 0) {
     s.digging.substate -= 1;
     if (s.digging.substate < 0) {
-      Log::Verbose["serf"] << "substate -1: wait for serf.";
+      LOG_VERBOSE(log_serf) << "substate -1: wait for serf.";
       int d = s.digging.dig_pos;
       Direction dir = (Direction)((d == 0) ? DirectionUp : 6-d);
       MapPos new_pos = map->move(pos, dir);
@@ -1971,8 +2004,8 @@ Serf::handle_serf_digging_state() {
       /* 34CD6: Change height, head back to center */
       int h = map->get_height(pos);
       h += (s.digging.h_index & 1) ? -1 : 1;
-      Log::Verbose["serf"] << "substate 1: change height "
-                           << ((s.digging.h_index & 1) ? "down." : "up.");
+      LOG_VERBOSE(log_serf) << "substate 1: change height "
+                            << ((s.digging.h_index & 1) ? "down." : "up.");
       map->set_height(pos, h);
 
       if (s.digging.dig_pos == 0) {
@@ -1982,14 +2015,14 @@ Serf::handle_serf_digging_state() {
         start_walking(dir, 32, 1);
       }
     } else if (s.digging.substate > 1) {
-      Log::Verbose["serf"] << "substate 2: dig.";
+      LOG_VERBOSE(log_serf) << "substate 2: dig.";
       /* 34E89 */
       animation = 88 - (s.digging.h_index & 1);
       counter += 383;
     } else {
       /* 34CDC: Looking for a place to dig */
-      Log::Verbose["serf"] << "substate 0: looking for place to dig "
-                           << s.digging.dig_pos << ", " << s.digging.h_index;
+      LOG_VERBOSE(log_serf) << "substate 0: looking for place to dig "
+                            << s.digging.dig_pos << ", " << s.digging.h_index;
       do {
         int h = h_diff[s.digging.h_index] + s.digging.target_h;
         if (s.digging.dig_pos >= 0 && h >= 0 && h < 32) {
@@ -2015,7 +2048,7 @@ Serf::handle_serf_digging_state() {
               s.digging.dig_pos -= 1;
               continue;
             }
-            Log::Verbose["serf"] << "  found at: " << s.digging.dig_pos << ".";
+            LOG_VERBOSE(log_serf) << "  found at: " << s.digging.dig_pos << ".";
             /* Digging spot found */
             if (map->has_serf(new_pos)) {
               /* Occupied by other serf, wait */
@@ -2167,7 +2200,7 @@ Serf::handle_serf_move_resource_out_state() {
   tick = game->get_tick();
   counter = 0;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if ((map->get_serf_index(pos) != index && map->has_serf(pos)) ||
     map->has_serf(map->move_down_right(pos))) {
     /* Occupied by serf, wait */
@@ -2274,7 +2307,7 @@ Serf::handle_serf_ready_to_leave_inventory_state() {
   tick = game->get_tick();
   counter = 0;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (map->has_serf(pos) || map->has_serf(map->move_down_right(pos))) {
     animation = 82;
     counter = 0;
@@ -2329,7 +2362,7 @@ Serf::drop_resource(Resource::Type res) {
    to find a flag nearby. */
 void
 Serf::find_inventory() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (map->has_flag(pos)) {
     Flag *flag = game->get_flag(map->get_obj_index(pos));
     if ((flag->land_paths() != 0 ||
@@ -2357,7 +2390,7 @@ Serf::handle_serf_free_walking_state_dest_reached() {
     return;
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   switch (get_type()) {
     case TypeLumberjack:
       if (s.free_walking.neg_dist1 == -128) {
@@ -2579,10 +2612,10 @@ Serf::handle_serf_free_walking_switch_on_dir(Direction dir) {
   int dx = ((dir < 3) ? 1 : -1)*((dir % 3) < 2);
   int dy = ((dir < 3) ? 1 : -1)*((dir % 3) > 0);
 
-  Log::Verbose["serf"] << "serf " << index << ": free walking: dest "
-                       << s.free_walking.dist_col << ", "
-                       << s.free_walking.dist_row
-                       << ", move " << dx << ", " << dy;
+  LOG_VERBOSE(log_serf) << "serf " << index << ": free walking: dest "
+                        << s.free_walking.dist_col << ", "
+                        << s.free_walking.dist_row
+                        << ", move " << dx << ", " << dy;
 
   s.free_walking.dist_col -= dx;
   s.free_walking.dist_row -= dy;
@@ -2602,7 +2635,7 @@ Serf::handle_serf_free_walking_switch_with_other() {
   MapPos new_pos = 0;
   Direction dir = DirectionNone;
   Serf *other_serf = NULL;
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   for (Direction i : cycle_directions_cw()) {
     new_pos = map->move(pos, i);
     if (map->has_serf(new_pos)) {
@@ -2622,10 +2655,10 @@ Serf::handle_serf_free_walking_switch_with_other() {
     int dx = ((dir < 3) ? 1 : -1)*((dir % 3) < 2);
     int dy = ((dir < 3) ? 1 : -1)*((dir % 3) > 0);
 
-    Log::Verbose["serf"] << "free walking (switch): dest "
-                         << s.free_walking.dist_col << ", "
-                         << s.free_walking.dist_row << ", move "
-                         << dx << ", " << dy;
+    LOG_VERBOSE(log_serf) << "free walking (switch): dest "
+                          << s.free_walking.dist_col << ", "
+                          << s.free_walking.dist_row << ", move "
+                          << dx << ", " << dy;
 
     s.free_walking.dist_col -= dx;
     s.free_walking.dist_row -= dy;
@@ -2660,8 +2693,7 @@ Serf::handle_serf_free_walking_switch_with_other() {
 
 bool
 Serf::can_pass_map_pos(MapPos test_pos) {
-  return Map::map_space_from_obj[game->get_map()->get_obj(test_pos)] <=
-           Map::SpaceSemipassable;
+  return game->get_map()->has_attribute(test_pos, Map::AttributePassable);
 }
 
 int
@@ -2753,7 +2785,7 @@ Serf::handle_free_walking_follow_edge() {
   const Direction *a0 = &dir_arr[6*dir_index];
   Direction i0 = DirectionNone;
   Direction dir = DirectionNone;
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   for (Direction i : cycle_directions_cw()) {
     MapPos new_pos = map->move(pos, a0[i]);
     if (((water && map->get_obj(new_pos) == 0) ||
@@ -2906,7 +2938,7 @@ Serf::handle_free_walking_common() {
   /* Try to move directly in the preferred direction */
   const Direction *a0 = &dir_forward[6*dir_index];
   Direction dir = (Direction)a0[0];
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   MapPos new_pos = map->move(pos, dir);
   if (((water && map->get_obj(new_pos) == 0) ||
        (!water && !map->is_in_water(new_pos) &&
@@ -2976,8 +3008,8 @@ Serf::handle_free_walking_common() {
               if (other_serf->s.walking.wait_counter != -1) {
 //                int dir = other_serf->s.walking.dir;
 //                if (dir < 0) dir += 6;
-                Log::Debug["serf"] << "TODO remove " << other_serf->get_index()
-                                   << " from path";
+                LOG_DEBUG(log_serf) << "TODO remove " << other_serf->get_index()
+                                    << " from path";
               }
               other_serf->set_lost_state();
             }
@@ -3070,10 +3102,23 @@ Serf::handle_serf_planning_logging_state() {
   tick = game->get_tick();
   counter -= delta;
 
+  Map *map = game->get_map();
+  int radius = Map::get_spiral_radius(128);
+  if (counter < 0 &&
+      !map->has_object_class(pos, radius, Map::ObjectClassTree) &&
+      !map->has_object_class(pos, radius, Map::ObjectClassPine)) {
+    /* No tree in reach, only draw the random numbers of the samples. */
+    while (counter < 0) {
+      game->random_int();
+      counter += 400;
+    }
+    return;
+  }
+
   while (counter < 0) {
     int dist = (game->random_int() & 0x7f) + 1;
-    MapPos pos_ = game->get_map()->pos_add_spirally(pos, dist);
-    int obj = game->get_map()->get_obj(pos_);
+    MapPos pos_ = map->pos_add_spirally(pos, dist);
+    int obj = map->get_obj(pos_);
     if (obj >= Map::ObjectTree0 && obj <= Map::ObjectPine7) {
       set_state(StateReadyToLeave);
       s.leaving_building.field_B = Map::get_spiral_pattern()[2 * dist] - 1;
@@ -3081,9 +3126,9 @@ Serf::handle_serf_planning_logging_state() {
       s.leaving_building.dest2 = -Map::get_spiral_pattern()[2 * dist] + 1;
       s.leaving_building.dir = -Map::get_spiral_pattern()[2 * dist + 1] + 1;
       s.leaving_building.next_state = StateFreeWalking;
-      Log::Verbose["serf"] << "planning logging: tree found, dist "
-                           << s.leaving_building.field_B << ", "
-                           << s.leaving_building.dest << ".";
+      LOG_VERBOSE(log_serf) << "planning logging: tree found, dist "
+                            << s.leaving_building.field_B << ", "
+                            << s.leaving_building.dest << ".";
       return;
     }
 
@@ -3097,7 +3142,17 @@ Serf::handle_serf_planning_planting_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
+  if (counter < 0 && !map->has_object_class(pos, Map::get_spiral_radius(128),
+                                            Map::ObjectClassFree)) {
+    /* No free space in reach, only draw the random numbers. */
+    while (counter < 0) {
+      game->random_int();
+      counter += 700;
+    }
+    return;
+  }
+
   while (counter < 0) {
     int dist = (game->random_int() & 0x7f) + 1;
     MapPos pos_ = map->pos_add_spirally(pos, dist);
@@ -3113,9 +3168,9 @@ Serf::handle_serf_planning_planting_state() {
       s.leaving_building.dest2 = -Map::get_spiral_pattern()[2 * dist] + 1;
       s.leaving_building.dir = -Map::get_spiral_pattern()[2 * dist + 1] + 1;
       s.leaving_building.next_state = StateFreeWalking;
-      Log::Verbose["serf"] << "planning planting: free space found, dist "
-                           << s.leaving_building.field_B << ", "
-                           << s.leaving_building.dest << ".";
+      LOG_VERBOSE(log_serf) << "planning planting: free space found, dist "
+                            << s.leaving_building.field_B << ", "
+                            << s.leaving_building.dest << ".";
       return;
     }
 
@@ -3129,7 +3184,7 @@ Serf::handle_serf_planting_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     if (s.free_walking.neg_dist2 != 0) {
       set_state(StateFreeWalking);
@@ -3160,7 +3215,19 @@ Serf::handle_serf_planning_stonecutting() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
+  /* Stones are searched up-left of the spiral positions. */
+  if (counter < 0 &&
+      !map->has_object_class(pos, Map::get_spiral_radius(128) + 1,
+                             Map::ObjectClassStone)) {
+    /* No stone in reach, only draw the random numbers. */
+    while (counter < 0) {
+      game->random_int();
+      counter += 100;
+    }
+    return;
+  }
+
   while (counter < 0) {
     int dist = (game->random_int() & 0x7f) + 1;
     MapPos pos_ = map->pos_add_spirally(pos, dist);
@@ -3173,9 +3240,9 @@ Serf::handle_serf_planning_stonecutting() {
       s.leaving_building.dest2 = -Map::get_spiral_pattern()[2 * dist] + 1;
       s.leaving_building.dir = -Map::get_spiral_pattern()[2 * dist + 1] + 1;
       s.leaving_building.next_state = StateStoneCutterFreeWalking;
-      Log::Verbose["serf"] << "planning stonecutting: stone found, dist "
-                           << s.leaving_building.field_B << ", "
-                           << s.leaving_building.dest << ".";
+      LOG_VERBOSE(log_serf) << "planning stonecutting: stone found, dist "
+                            << s.leaving_building.field_B << ", "
+                            << s.leaving_building.dest << ".";
       return;
     }
 
@@ -3189,7 +3256,7 @@ Serf::handle_stonecutter_free_walking() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     MapPos pos_ = map->move_up_left(pos);
     if (!map->has_serf(pos) && map->get_obj(pos_) >= Map::ObjectStone0 &&
@@ -3229,7 +3296,7 @@ Serf::handle_serf_stonecutting_state() {
       return;
     }
 
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     if (map->has_serf(map->move_down_right(pos))) {
       counter = 0;
       return;
@@ -3289,35 +3356,34 @@ Serf::handle_serf_lost_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     /* Try to find a suitable destination. */
-    for (int i = 0; i < 258; i++) {
-      int dist = (s.lost.field_B == 0) ? 1+i : 258-i;
-      MapPos dest = map->pos_add_spirally(pos, dist);
-
-      if (map->has_flag(dest)) {
-        Flag *flag = game->get_flag(map->get_obj_index(dest));
-        if ((flag->land_paths() != 0 ||
-             (flag->has_inventory() && flag->accepts_serfs())) &&
-              map->has_owner(dest) &&
-              map->get_owner(dest) == get_owner()) {
-          if (get_type() >= TypeKnight0 &&
-              get_type() <= TypeKnight4) {
-            set_state(StateKnightFreeWalking);
-          } else {
-            set_state(StateFreeWalking);
-          }
-
-          s.free_walking.dist_col = Map::get_spiral_pattern()[2 * dist];
-          s.free_walking.dist_row = Map::get_spiral_pattern()[2 * dist +1];
-          s.free_walking.neg_dist1 = -128;
-          s.free_walking.neg_dist2 = -1;
-          s.free_walking.flags = 0;
-          counter = 0;
-          return;
-        }
+    int dist = game->get_flag_positions().find_spirally(
+      map, pos, get_owner(), 1, 258, s.lost.field_B != 0,
+      [this, map](unsigned int index) {
+        Flag *flag = game->get_flag(index);
+        MapPos dest = flag->get_position();
+        return (flag->land_paths() != 0 ||
+                (flag->has_inventory() && flag->accepts_serfs())) &&
+               map->has_owner(dest) &&
+               map->get_owner(dest) == get_owner();
+      });
+    if (dist >= 0) {
+      if (get_type() >= TypeKnight0 &&
+          get_type() <= TypeKnight4) {
+        set_state(StateKnightFreeWalking);
+      } else {
+        set_state(StateFreeWalking);
       }
+
+      s.free_walking.dist_col = Map::get_spiral_pattern()[2 * dist];
+      s.free_walking.dist_row = Map::get_spiral_pattern()[2 * dist +1];
+      s.free_walking.neg_dist1 = -128;
+      s.free_walking.neg_dist2 = -1;
+      s.free_walking.flags = 0;
+      counter = 0;
+      return;
     }
 
     /* Choose a random destination */
@@ -3369,28 +3435,28 @@ Serf::handle_lost_sailor() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     /* Try to find a suitable destination. */
-    for (int i = 0; i < 258; i++) {
-      MapPos dest = map->pos_add_spirally(pos, i);
-
-      if (map->has_flag(dest)) {
-        Flag *flag = game->get_flag(map->get_obj_index(dest));
-        if (flag->land_paths() != 0 &&
-            map->has_owner(dest) &&
-            map->get_owner(dest) == get_owner()) {
-          set_state(StateFreeSailing);
-
-          s.free_walking.dist_col = Map::get_spiral_pattern()[2*i];
-          s.free_walking.dist_row = Map::get_spiral_pattern()[2*i+1];
-          s.free_walking.neg_dist1 = -128;
-          s.free_walking.neg_dist2 = -1;
-          s.free_walking.flags = 0;
-          counter = 0;
-          return;
-        }
-      }
+    int i = game->get_flag_positions().find_spirally(
+      map, pos, get_owner(), 0, 257, false,
+      [this, map](unsigned int index) {
+        Flag *flag = game->get_flag(index);
+        MapPos dest = flag->get_position();
+        return flag->land_paths() != 0 &&
+               map->has_owner(dest) &&
+               map->get_owner(dest) == get_owner();
+      });
+    if (i >= 0) {
+      set_state(StateFreeSailing);
+
+      s.free_walking.dist_col = Map::get_spiral_pattern()[2*i];
+      s.free_walking.dist_row = Map::get_spiral_pattern()[2*i+1];
+      s.free_walking.neg_dist1 = -128;
+      s.free_walking.neg_dist2 = -1;
+      s.free_walking.flags = 0;
+      counter = 0;
+      return;
     }
 
     /* Choose a random, empty destination */
@@ -3451,11 +3517,11 @@ Serf::handle_serf_mining_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     Building *building = game->get_building(map->get_obj_index(pos));
 
-    Log::Verbose["serf"] << "mining substate: " << s.mining.substate << ".";
+    LOG_VERBOSE(log_serf) << "mining substate: " << s.mining.substate << ".";
     switch (s.mining.substate) {
       case 0: {
         /* There is a small chance that the miner will
@@ -3630,26 +3696,23 @@ Serf::handle_serf_planning_fishing_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     int dist = ((game->random_int() >> 2) & 0x3f) + 1;
     MapPos dest = map->pos_add_spirally(pos, dist);
 
     if (map->get_obj(dest) == Map::ObjectNone &&
         map->paths(dest) == 0 &&
-        ((map->type_down(dest) <= Map::TerrainWater3 &&
-          map->type_up(map->move_up_left(dest)) >= Map::TerrainGrass0) ||
-         (map->type_down(map->move_left(dest)) <= Map::TerrainWater3 &&
-          map->type_up(map->move_up(dest)) >= Map::TerrainGrass0))) {
+        map->has_attribute(dest, Map::AttributeShore)) {
       set_state(StateReadyToLeave);
       s.leaving_building.field_B = Map::get_spiral_pattern()[2 * dist] - 1;
       s.leaving_building.dest = Map::get_spiral_pattern()[2 * dist + 1] - 1;
       s.leaving_building.dest2 = -Map::get_spiral_pattern()[2 * dist] + 1;
       s.leaving_building.dir = -Map::get_spiral_pattern()[2 * dist +1] + 1;
       s.leaving_building.next_state = StateFreeWalking;
-      Log::Verbose["serf"] << "planning fishing: lake found, dist "
-                           << s.leaving_building.field_B << ","
-                           << s.leaving_building.dest;
+      LOG_VERBOSE(log_serf) << "planning fishing: lake found, dist "
+                            << s.leaving_building.field_B << ","
+                            << s.leaving_building.dest;
       return;
     }
 
@@ -3681,7 +3744,7 @@ Serf::handle_serf_fishing_state() {
       continue;
     }
 
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     Direction dir = DirectionNone;
     if (animation == 131) {
       if (map->is_in_water(map->move_left(pos))) {
@@ -3719,7 +3782,18 @@ Serf::handle_serf_planning_farming_state() {
     return;
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
+  int radius = Map::get_spiral_radius(38);
+  if (!map->has_object_class(pos, radius, Map::ObjectClassFree) &&
+      !map->has_object_class(pos, radius, Map::ObjectClassField)) {
+    /* No free space or field in reach, only draw the random numbers. */
+    do {
+      game->random_int();
+      counter += 500;
+    } while (counter < 65500);
+    return;
+  }
+
   while (true) {
     int dist = ((game->random_int() >> 2) & 0x1f) + 7;
     MapPos dest = map->pos_add_spirally(pos, dist);
@@ -3757,9 +3831,9 @@ Serf::handle_serf_planning_farming_state() {
       s.leaving_building.dest2 = -Map::get_spiral_pattern()[2 * dist] + 1;
       s.leaving_building.dir = -Map::get_spiral_pattern()[2 * dist + 1] + 1;
       s.leaving_building.next_state = StateFreeWalking;
-      Log::Verbose["serf"] << "planning farming: field spot found, dist "
-                           << s.leaving_building.field_B << ", "
-                           << s.leaving_building.dest << ".";
+      LOG_VERBOSE(log_serf) << "planning farming: field spot found, dist "
+                            << s.leaving_building.field_B << ", "
+                            << s.leaving_building.dest << ".";
       return;
     }
 
@@ -3778,7 +3852,7 @@ Serf::handle_serf_farming_state() {
 
   if (counter >= 0) return;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   Map::Object object = map->get_obj(pos);
   if (s.free_walking.neg_dist1 == 0) {
     // Sowing
@@ -4111,7 +4185,7 @@ Serf::handle_serf_making_tool_state() {
 
 void
 Serf::handle_serf_building_boat_state() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   Building *building = game->get_building(map->get_obj_index(pos));
 
   if (s.building_boat.mode == 0) {
@@ -4167,7 +4241,7 @@ Serf::handle_serf_building_boat_state() {
 void
 Serf::handle_serf_looking_for_geo_spot_state() {
   int tries = 2;
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   for (int i = 0; i < 8; i++) {
     int dist = ((game->random_int() >> 2) & 0x3f) + 1;
     MapPos dest = map->pos_add_spirally(pos, dist);
@@ -4189,9 +4263,9 @@ Serf::handle_serf_looking_for_geo_spot_state() {
         s.free_walking.neg_dist2 = -Map::get_spiral_pattern()[2 * dist + 1];
         s.free_walking.flags = 0;
         tick = game->get_tick();
-        Log::Verbose["serf"] << "looking for geo spot: found, dist "
-                             << s.free_walking.dist_col << ", "
-                             << s.free_walking.dist_row << ".";
+        LOG_VERBOSE(log_serf) << "looking for geo spot: found, dist "
+                              << s.free_walking.dist_col << ", "
+                              << s.free_walking.dist_row << ".";
         return;
       }
     } else if (obj >= Map::ObjectSignLargeGold &&
@@ -4215,7 +4289,7 @@ Serf::handle_serf_sampling_geo_spot_state() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     if (s.free_walking.neg_dist1 == 0 &&
       map->get_obj(pos) == Map::ObjectNone) {
@@ -4286,7 +4360,7 @@ Serf::handle_serf_knight_engaging_building_state() {
   counter -= delta;
 
   if (counter < 0) {
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     Map::Object obj = map->get_obj(map->move_up_left(pos));
     if (obj >= Map::ObjectSmallBuilding &&
         obj <= Map::ObjectCastle) {
@@ -4305,7 +4379,7 @@ Serf::handle_serf_knight_engaging_building_state() {
 
         /* Change state of attacking knight */
         counter = 0;
-        state = StateKnightPrepareAttacking;
+        change_state(StateKnightPrepareAttacking);
         animation = 168;
 
         Serf *def_serf = building->call_defender_out();
@@ -4358,15 +4432,15 @@ Serf::set_fight_outcome(Serf *attacker, Serf *defender) {
     value = def_exp_factor;
     ktype = defender->get_type();
     attacker->s.attacking.attacker_won = 1;
-    Log::Debug["serf"] << "Fight: " << morale << " vs " << def_morale
-    << " (" << r << "). Attacker winning.";
+    LOG_DEBUG(log_serf) << "Fight: " << morale << " vs " << def_morale
+     << " (" << r << "). Attacker winning.";
   } else {
     player = attacker->get_owner();
     value = exp_factor;
     ktype = attacker->get_type();
     attacker->s.attacking.attacker_won = 0;
-    Log::Debug["serf"] << "Fight: " << morale << " vs " << def_morale
-                       << " (" << r << "). Defender winning.";
+    LOG_DEBUG(log_serf) << "Fight: " << morale << " vs " << def_morale
+                        << " (" << r << "). Defender winning.";
   }
 
   game->get_player(player)->decrease_military_score(value);
@@ -4600,7 +4674,7 @@ Serf::handle_state_knight_free_walking() {
   tick = game->get_tick();
   counter -= delta;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   while (counter < 0) {
     /* Check for enemy knights nearby. */
     for (Direction d : cycle_directions_cw()) {
@@ -4839,7 +4913,7 @@ Serf::handle_serf_state_knight_leave_for_walk_to_fight() {
   tick = game->get_tick();
   counter = 0;
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (map->get_serf_index(pos) != index && map->has_serf(pos)) {
     animation = 82;
     counter = 0;
@@ -4918,7 +4992,7 @@ Serf::handle_serf_idle_on_path_state() {
     }
   }
 
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (!map->has_serf(pos)) {
     map->clear_idle_serf(pos);
     map->set_serf_index(pos, index);
@@ -4938,7 +5012,7 @@ Serf::handle_serf_idle_on_path_state() {
 
 void
 Serf::handle_serf_wait_idle_on_path_state() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (!map->has_serf(pos)) {
     /* Duplicate code from handle_serf_idle_on_path_state() */
     map->clear_idle_serf(pos);
@@ -4965,7 +5039,7 @@ Serf::handle_scatter_state() {
     int row = ((r >> 8) & 0xf);
     if (row < 8) row -= 16;
 
-    PMap map = game->get_map();
+    Map *map = game->get_map();
     MapPos dest = map->pos_add(pos, col, row);
     if (map->get_obj(dest) == 0 && map->get_height(dest) > 0) {
       if (get_type() >= TypeKnight0 && get_type() <= TypeKnight4) {
@@ -4987,7 +5061,7 @@ Serf::handle_scatter_state() {
 
 void
 Serf::handle_serf_finished_building_state() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (!map->has_serf(map->move_down_right(pos))) {
     set_state(StateReadyToLeave);
     s.leaving_building.dest = 0;
@@ -5003,7 +5077,7 @@ Serf::handle_serf_finished_building_state() {
 
 void
 Serf::handle_serf_wake_at_flag_state() {
-  PMap map = game->get_map();
+  Map *map = game->get_map();
   if (!map->has_serf(pos)) {
     map->clear_idle_serf(pos);
     map->set_serf_index(pos, index);
@@ -5301,8 +5375,8 @@ Serf::update() {
     handle_serf_defending_castle_state();
     break;
   default:
-    Log::Debug["serf"] << "Serf state " << state << " isn't processed";
-    state = StateNull;
+    LOG_DEBUG(log_serf) << "Serf state " << state << " isn't processed";
+    change_state(StateNull);
   }
 }
 
@@ -5329,8 +5403,8 @@ operator >> (SaveReaderBinary &reader, Serf &serf) {
   reader >> v8;  // 10
   serf.state = (Serf::State)v8;
 
-  Log::Verbose["savegame"] << "load serf " << serf.index << ": "
-                           << Serf::get_state_name(serf.state);
+  LOG_VERBOSE(log_savegame) << "load serf " << serf.index << ": "
+                            << Serf::get_state_name(serf.state);
 
   switch (serf.state) {
     case Serf::StateIdleInStock:
@@ -6255,3 +6329,94 @@ Serf::print_state() {
   }
   return res.str();
 }
+
+/* States whose handler does nothing but count down until the counter
+   turns negative. */
+static bool
+waits_for_counter(Serf::State state) {
+  switch (state) {
+    case Serf::StateWalking:
+    case Serf::StateTransporting:
+    case Serf::StateLeavingBuilding:
+    case Serf::StateDelivering:
+    case Serf::StateFreeWalking:
+    case Serf::StateLogging:
+    case Serf::StatePlanningLogging:
+    case Serf::StatePlanningPlanting:
+    case Serf::StatePlanting:
+    case Serf::StatePlanningStoneCutting:
+    case Serf::StateStoneCutterFreeWalking:
+    case Serf::StateLost:
+    case Serf::StateLostSailor:
+    case Serf::StateFreeSailing:
+    case Serf::StateMining:
+    case Serf::StatePlanningFishing:
+    case Serf::StateFishing:
+    case Serf::StateFarming:
+    case Serf::StateSamplingGeoSpot:
+    case Serf::StateKnightEngagingBuilding:
+    case Serf::StateKnightAttackingDefeat:
+    case Serf::StateKnightOccupyEnemyBuilding:
+    case Serf::StateKnightFreeWalking:
+    case Serf::StateKnightEngageDefendingFree:
+    case Serf::StateKnightEngageAttackingFree:
+    case Serf::StateKnightEngageAttackingFreeJoin:
+    case Serf::StateKnightPrepareDefendingFree:
+    case Serf::StateKnightAttackingDefeatFree:
+    case Serf::StateKnightAttackingFreeWait:
+      return true;
+    default:
+      return false;
+  }
+}
+
+unsigned int
+SerfFields::count_down(unsigned int first, unsigned int limit,
+                       unsigned int tick) {
+  unsigned int index = first;
+  while (index < limit) {
+    size_t block_index = index / block_size;
+    unsigned int end = std::min(limit, static_cast<unsigned int>(
+                                           (block_index + 1) * block_size));
+    if (block_index >= blocks.size() || !blocks[block_index]) {
+      index = end;
+      continue;
+    }
+
+    Block *block = blocks[block_index].get();
+    for (; index < end; index++) {
+      unsigned int i = index % block_size;
+      Serf::State state = block->state[i];
+      if (state == Serf::StateNull) {
+        continue;
+      }
+      if (!waits_for_counter(state)) {
+        return index;
+      }
+
+      /* Same as the handlers of these states, which then see no time
+         passed. */
+      uint16_t delta = tick - block->tick[i];
+      block->tick[i] = tick;
+      block->counter[i] -= delta;
+      if (block->counter[i] < 0) {
+        return index;
+      }
+    }
+  }
+
+  return limit;
+}
+
+SerfFields::Block *
+SerfFields::get_block(unsigned int index) {
+  size_t block_index = index / block_size;
+  if (block_index >= blocks.size()) {
+    blocks.resize(block_index + 1);
+  }
+  if (!blocks[block_index]) {
+    /* Value initialized, so unused entries are in StateNull. */
+    blocks[block_index].reset(new Block());
+  }
+  return blocks[block_index].get();
+}
@@ -22,8 +22,11 @@
 #ifndef SRC_SERF_H_
 #define SRC_SERF_H_
 
+#include <array>
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "src/map.h"
 #include "src/resource.h"
@@ -70,6 +73,7 @@ class Serf : public GameObject {
   } Type;
 
   typedef std::map<Type, unsigned int> SerfMap;
+  typedef std::array<unsigned int, TypeDead> SerfCounts;
 
   /* The term FREE is used loosely in the following
    names to denote a state where the serf is not
@@ -161,11 +165,12 @@ class Serf : public GameObject {
   unsigned int owner;
   Type type;
   bool sound;
-  int animation; /* Index to animation table in data file. */
-  int counter;
-  MapPos pos;
-  uint16_t tick;
-  State state;
+  /* Fields read on every tick live in the SerfFields of the game. */
+  int &animation; /* Index to animation table in data file. */
+  int &counter;
+  MapPos &pos;
+  uint16_t &tick;
+  State &state;
 
   union s {
     struct {
@@ -377,6 +382,7 @@ class Serf : public GameObject {
 
  public:
   Serf(Game *game, unsigned int index);
+  virtual ~Serf();
 
   unsigned int get_owner() const { return owner; }
   void set_owner(unsigned int player_num) { owner = player_num; }
@@ -463,6 +469,7 @@ class Serf : public GameObject {
   std::string print_state();
 
  protected:
+  void change_state(State new_state);
   bool is_waiting(Direction *dir);
   int switch_waiting(Direction dir);
   int get_walking_animation(int h_diff, Direction dir, int switch_pos);
@@ -561,4 +568,46 @@ class Serf : public GameObject {
   void handle_serf_defending_castle_state();
 };
 
+/* Fields of serfs that are read on every tick, stored field by field for
+   all serfs. The update loop walks these arrays and only visits serfs that
+   have more to do than counting down. Entries are allocated in blocks that
+   never move, so serfs can refer to their entries. */
+class SerfFields {
+ public:
+  static const unsigned int block_size = 1024;
+
+ protected:
+  typedef struct Block {
+    Serf::State state[block_size];
+    int counter[block_size];
+    uint16_t tick[block_size];
+    MapPos pos[block_size];
+    int animation[block_size];
+  } Block;
+
+  std::vector<std::unique_ptr<Block>> blocks;
+
+ public:
+  /* Entries of a serf, allocated on first use. */
+  Serf::State &state(unsigned int index) {
+    return get_block(index)->state[index % block_size]; }
+  int &counter(unsigned int index) {
+    return get_block(index)->counter[index % block_size]; }
+  uint16_t &tick(unsigned int index) {
+    return get_block(index)->tick[index % block_size]; }
+  MapPos &pos(unsigned int index) {
+    return get_block(index)->pos[index % block_size]; }
+  int &animation(unsigned int index) {
+    return get_block(index)->animation[index % block_size]; }
+
+  /* Count down the serfs from index first to tick, while their states only
+     wait for the counter. Return the index of the first serf that needs to
+     be updated, or limit if there is none. */
+  unsigned int count_down(unsigned int first, unsigned int limit,
+                          unsigned int tick);
+
+ protected:
+  Block *get_block(unsigned int index);
+};
+
 #endif  // SRC_SERF_H_
@@ -0,0 +1,242 @@
+/*
+ * spatial-index.cc - Positions of game objects by owner
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/spatial-index.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// Buckets are squares of 8 by 8 map positions.
+#define BUCKET_SHIFT  3
+
+// Number of offsets in the spiral pattern of the map.
+#define SPIRAL_SIZE  295
+
+// Largest column or row offset in the spiral pattern.
+#define SPIRAL_RADIUS  24
+#define SPIRAL_WIDTH  (2 * SPIRAL_RADIUS + 1)
+
+namespace {
+
+// Position of every column and row offset in the spiral pattern, and the
+// largest offset of the pattern up to each position.
+class SpiralTable {
+ public:
+  int offsets[SPIRAL_WIDTH * SPIRAL_WIDTH];
+  int radius[SPIRAL_SIZE];
+
+  SpiralTable() {
+    std::fill(offsets, offsets + SPIRAL_WIDTH * SPIRAL_WIDTH, -1);
+    const int *pattern = Map::get_spiral_pattern();
+    int max_radius = 0;
+    for (int i = 0; i < SPIRAL_SIZE; i++) {
+      int col = pattern[2*i];
+      int row = pattern[2*i+1];
+      max_radius = std::max(max_radius, std::max(abs(col), abs(row)));
+      radius[i] = max_radius;
+      int &offset = offsets[(row + SPIRAL_RADIUS) * SPIRAL_WIDTH +
+                            col + SPIRAL_RADIUS];
+      if (offset < 0) {
+        offset = i;
+      }
+    }
+  }
+};
+
+// The spiral pattern is complete once a map has been created.
+const SpiralTable &
+get_spiral_table() {
+  static const SpiralTable table;
+  return table;
+}
+
+}  // namespace
+
+SpatialIndex::SpatialIndex()
+  : geom(3)
+  , bucket_cols(0)
+  , bucket_rows(0)
+  , count(0) {
+}
+
+void
+SpatialIndex::reset(const Map *map) {
+  geom = map->geom();
+  bucket_cols = std::max(1u, geom.cols() >> BUCKET_SHIFT);
+  bucket_rows = std::max(1u, geom.rows() >> BUCKET_SHIFT);
+  buckets.clear();
+  locations.clear();
+  count = 0;
+  get_spiral_table();
+}
+
+size_t
+SpatialIndex::get_bucket_index(MapPos pos) const {
+  return (geom.pos_row(pos) >> BUCKET_SHIFT) * bucket_cols +
+         (geom.pos_col(pos) >> BUCKET_SHIFT);
+}
+
+const SpatialIndex::Bucket *
+SpatialIndex::get_bucket(unsigned int owner, MapPos pos) const {
+  if (owner >= buckets.size()) {
+    return nullptr;
+  }
+  return &buckets[owner][get_bucket_index(pos)];
+}
+
+void
+SpatialIndex::update(unsigned int index, unsigned int owner, MapPos pos) {
+  if (index < locations.size() && locations[index].present) {
+    if (locations[index].owner == owner && locations[index].pos == pos) {
+      return;
+    }
+    remove(index);
+  }
+
+  if (index >= locations.size()) {
+    locations.resize(index + 1, { false, 0, 0 });
+  }
+  if (owner >= buckets.size()) {
+    buckets.resize(owner + 1,
+                   std::vector<Bucket>(bucket_cols * bucket_rows));
+  }
+
+  buckets[owner][get_bucket_index(pos)].push_back({ index, pos });
+  locations[index] = { true, owner, pos };
+  count++;
+}
+
+void
+SpatialIndex::remove(unsigned int index) {
+  if (index >= locations.size() || !locations[index].present) {
+    return;
+  }
+
+  Location &location = locations[index];
+  Bucket &bucket = buckets[location.owner][get_bucket_index(location.pos)];
+  for (Entry &entry : bucket) {
+    if (entry.index == index) {
+      entry = bucket.back();
+      bucket.pop_back();
+      break;
+    }
+  }
+  location.present = false;
+  count--;
+}
+
+void
+SpatialIndex::find_near(MapPos pos, unsigned int owner, int radius,
+                        std::vector<Entry> *found) const {
+  if (owner >= buckets.size()) {
+    return;
+  }
+
+  const std::vector<Bucket> &owned = buckets[owner];
+  int col = static_cast<int>(geom.pos_col(pos) + geom.cols());
+  int row = static_cast<int>(geom.pos_row(pos) + geom.rows());
+  int first_col = (col - radius) >> BUCKET_SHIFT;
+  int first_row = (row - radius) >> BUCKET_SHIFT;
+  int col_count = std::min(static_cast<int>(bucket_cols),
+                           ((col + radius) >> BUCKET_SHIFT) - first_col + 1);
+  int row_count = std::min(static_cast<int>(bucket_rows),
+                           ((row + radius) >> BUCKET_SHIFT) - first_row + 1);
+
+  for (int r = 0; r < row_count; r++) {
+    size_t bucket_row = (first_row + r) % bucket_rows;
+    for (int c = 0; c < col_count; c++) {
+      size_t bucket_col = (first_col + c) % bucket_cols;
+      for (const Entry &entry : owned[bucket_row * bucket_cols + bucket_col]) {
+        if (abs(geom.dist_x(pos, entry.pos)) <= radius &&
+            abs(geom.dist_y(pos, entry.pos)) <= radius) {
+          found->push_back(entry);
+        }
+      }
+    }
+  }
+}
+
+bool
+SpatialIndex::collect(const Map *map, MapPos pos, unsigned int owner,
+                      unsigned int first, unsigned int last, bool reverse) {
+  const SpiralTable &table = get_spiral_table();
+  candidates.clear();
+
+  if (last >= SPIRAL_SIZE) {
+    return false;
+  }
+  // Every offset must stand for a different position of the map.
+  int radius = table.radius[last];
+  if (2 * radius >= static_cast<int>(geom.cols()) ||
+      2 * radius >= static_cast<int>(geom.rows())) {
+    return false;
+  }
+  if (owner >= buckets.size()) {
+    return true;
+  }
+
+  const std::vector<Bucket> &owned = buckets[owner];
+  int cols = static_cast<int>(geom.cols());
+  int rows = static_cast<int>(geom.rows());
+  int col = map->pos_col(pos) + cols;
+  int row = map->pos_row(pos) + rows;
+  int first_col = (col - radius) >> BUCKET_SHIFT;
+  int first_row = (row - radius) >> BUCKET_SHIFT;
+  int col_count = std::min(static_cast<int>(bucket_cols),
+                           ((col + radius) >> BUCKET_SHIFT) - first_col + 1);
+  int row_count = std::min(static_cast<int>(bucket_rows),
+                           ((row + radius) >> BUCKET_SHIFT) - first_row + 1);
+
+  for (int r = 0; r < row_count; r++) {
+    size_t bucket_row = (first_row + r) % bucket_rows;
+    for (int c = 0; c < col_count; c++) {
+      size_t bucket_col = (first_col + c) % bucket_cols;
+      for (const Entry &entry : owned[bucket_row * bucket_cols + bucket_col]) {
+        int dist_col = geom.dist_x(pos, entry.pos);
+        int dist_row = geom.dist_y(pos, entry.pos);
+        if (abs(dist_col) > radius || abs(dist_row) > radius) {
+          continue;
+        }
+        int offset = table.offsets[(dist_row + SPIRAL_RADIUS) * SPIRAL_WIDTH +
+                                   dist_col + SPIRAL_RADIUS];
+        if (offset >= static_cast<int>(first) &&
+            offset <= static_cast<int>(last)) {
+          candidates.push_back({ static_cast<unsigned int>(offset),
+                                 entry.index });
+        }
+      }
+    }
+  }
+
+  if (reverse) {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) {
+                return a.offset > b.offset;
+              });
+  } else {
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) {
+                return a.offset < b.offset;
+              });
+  }
+
+  return true;
+}
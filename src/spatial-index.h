@@ -0,0 +1,118 @@
+/*
+ * spatial-index.h - Positions of game objects by owner
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_SPATIAL_INDEX_H_
+#define SRC_SPATIAL_INDEX_H_
+
+#include <vector>
+
+#include "src/map.h"
+
+// Objects of one kind, like flags, kept in square buckets of map positions
+// for each owner. Answers which of them a spiral scan around a position
+// would meet first, without probing every position of the spiral.
+class SpatialIndex {
+ public:
+  typedef struct Entry {
+    unsigned int index;
+    MapPos pos;
+  } Entry;
+
+  typedef std::vector<Entry> Bucket;
+
+ protected:
+  typedef struct Location {
+    bool present;
+    unsigned int owner;
+    MapPos pos;
+  } Location;
+
+  typedef struct Candidate {
+    unsigned int offset;
+    unsigned int index;
+  } Candidate;
+
+  MapGeometry geom;
+  unsigned int bucket_cols;
+  unsigned int bucket_rows;
+  std::vector<std::vector<Bucket>> buckets;  // by owner, then bucket
+  std::vector<Location> locations;  // by object index
+  std::vector<Candidate> candidates;
+  size_t count;
+
+ public:
+  SpatialIndex();
+
+  // Drop all objects and fit the buckets to the map.
+  void reset(const Map *map);
+  // Add the object, or move it to a new owner or position.
+  void update(unsigned int index, unsigned int owner, MapPos pos);
+  void remove(unsigned int index);
+
+  size_t get_count() const { return count; }
+  const Bucket *get_bucket(unsigned int owner, MapPos pos) const;
+
+  // Append the objects of owner that lie at most radius columns and rows
+  // away from pos, in no particular order.
+  void find_near(MapPos pos, unsigned int owner, int radius,
+                 std::vector<Entry> *found) const;
+
+  // Offset of the first object of owner, in the order of
+  // Map::pos_add_spirally() from first to last or from last to first, for
+  // which test(index) is true. Returns -1 if there is none.
+  template<typename Test>
+  int find_spirally(const Map *map, MapPos pos, unsigned int owner,
+                    unsigned int first, unsigned int last, bool reverse,
+                    Test test) {
+    if (collect(map, pos, owner, first, last, reverse)) {
+      for (const Candidate &candidate : candidates) {
+        if (test(candidate.index)) {
+          return candidate.offset;
+        }
+      }
+      return -1;
+    }
+
+    // Spiral wraps around the map, probe its positions instead.
+    for (unsigned int i = 0; i <= last - first; i++) {
+      unsigned int offset = reverse ? last - i : first + i;
+      MapPos dest = map->pos_add_spirally(pos, offset);
+      const Bucket *bucket = get_bucket(owner, dest);
+      if (bucket == nullptr) {
+        return -1;
+      }
+      for (const Entry &entry : *bucket) {
+        if (entry.pos == dest && test(entry.index)) {
+          return offset;
+        }
+      }
+    }
+    return -1;
+  }
+
+ protected:
+  size_t get_bucket_index(MapPos pos) const;
+  // Candidates in spiral order, false if the spiral does not fit the map.
+  bool collect(const Map *map, MapPos pos, unsigned int owner,
+               unsigned int first, unsigned int last, bool reverse);
+};
+
+#endif  // SRC_SPATIAL_INDEX_H_
@@ -0,0 +1,136 @@
+/*
+ * sprite-prefetcher.cc - Background decoding of sprites
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/sprite-prefetcher.h"
+
+#include <utility>
+
+SpritePrefetcher::SpritePrefetcher(Data::PSource _source,
+                                   unsigned int thread_count)
+  : source(_source)
+  , quit(false) {
+  for (unsigned int i = 0; i < thread_count; i++) {
+    workers.push_back(std::thread(&SpritePrefetcher::run, this));
+  }
+}
+
+SpritePrefetcher::~SpritePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+  }
+  wakeup.notify_all();
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
+
+uint64_t
+SpritePrefetcher::get_id(const Request &request) {
+  return Data::Sprite::create_id(request.resource, request.index, 0, 0,
+                                 request.color);
+}
+
+void
+SpritePrefetcher::request(const std::vector<Request> &requests) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Request &request : requests) {
+      uint64_t id = get_id(request);
+      if (requested.insert(id).second) {
+        queue.push_back(std::make_pair(id, request));
+      }
+    }
+  }
+  wakeup.notify_all();
+}
+
+Data::PSprite
+SpritePrefetcher::take(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = ready.find(id);
+  if (it == ready.end()) {
+    return nullptr;
+  }
+
+  Data::PSprite sprite = std::move(it->second);
+  ready.erase(it);
+  return sprite;
+}
+
+std::vector<SpritePrefetcher::Decoded>
+SpritePrefetcher::take_batch(size_t count) {
+  std::vector<Decoded> batch;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  while (!ready_order.empty() && (batch.size() < count)) {
+    uint64_t id = ready_order.front();
+    ready_order.pop_front();
+
+    // Already taken by take()
+    auto it = ready.find(id);
+    if (it == ready.end()) {
+      continue;
+    }
+
+    batch.push_back(std::make_pair(id, std::move(it->second)));
+    ready.erase(it);
+  }
+
+  return batch;
+}
+
+size_t
+SpritePrefetcher::get_queued() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return queue.size() + ready.size();
+}
+
+void
+SpritePrefetcher::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeup.wait(lock, [this]() { return quit || !queue.empty(); });
+    if (quit) {
+      return;
+    }
+
+    std::pair<uint64_t, Request> item = queue.front();
+    queue.pop_front();
+    lock.unlock();
+
+    // Failures are left to the render thread, which reports them on use.
+    Data::PSprite sprite;
+    try {
+      sprite = source->get_sprite(item.second.resource, item.second.index,
+                                  item.second.color);
+    } catch (...) {
+      sprite = nullptr;
+    }
+
+    lock.lock();
+    if (sprite) {
+      ready[item.first] = std::move(sprite);
+      ready_order.push_back(item.first);
+    }
+  }
+}
@@ -0,0 +1,80 @@
+/*
+ * sprite-prefetcher.h - Background decoding of sprites
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_SPRITE_PREFETCHER_H_
+#define SRC_SPRITE_PREFETCHER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "src/data.h"
+
+// Decodes sprites on a pool of worker threads before they are drawn for
+// the first time. Decoded sprites are collected until the render thread
+// takes them, since video images may only be created there.
+class SpritePrefetcher {
+ public:
+  typedef struct Request {
+    Data::Resource resource;
+    unsigned int index;
+    Data::Sprite::Color color;
+  } Request;
+
+  typedef std::pair<uint64_t, Data::PSprite> Decoded;
+
+ protected:
+  Data::PSource source;
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  bool quit;
+  std::deque<std::pair<uint64_t, Request>> queue;
+  std::unordered_map<uint64_t, Data::PSprite> ready;
+  std::deque<uint64_t> ready_order;
+  // Ids that were requested once, decoded or not.
+  std::unordered_set<uint64_t> requested;
+
+ public:
+  SpritePrefetcher(Data::PSource source, unsigned int thread_count);
+  virtual ~SpritePrefetcher();
+
+  static uint64_t get_id(const Request &request);
+
+  // Queue sprites for decoding, ids requested before are skipped.
+  void request(const std::vector<Request> &requests);
+  // Take the decoded sprite with id, nullptr if it is not ready yet.
+  Data::PSprite take(uint64_t id);
+  // Take up to count decoded sprites in the order they were requested.
+  std::vector<Decoded> take_batch(size_t count);
+  size_t get_queued();
+
+ protected:
+  void run();
+};
+
+#endif  // SRC_SPRITE_PREFETCHER_H_
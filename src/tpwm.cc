@@ -21,6 +21,7 @@
 
 #include "src/tpwm.h"
 
+#include <cstring>
 #include <string>
 #include <memory>
 
@@ -36,38 +37,89 @@ UnpackerTPWM::UnpackerTPWM(PBuffer _buffer) : Convertor(_buffer) {
   if ((std::string)*id.get() != "TPWM") {
     throw ExceptionFreeserf("Data is not TPWM archive");
   }
+
+  unpacked_size = buffer->pop<uint16_t>();
+  buffer = buffer->pop_tail();
 }
 
-PBuffer
-UnpackerTPWM::convert() {
-  size_t res_size = buffer->pop<uint16_t>();
-  PMutableBuffer result = std::make_shared<MutableBuffer>(Buffer::EndianessBig);
+// Copy a back reference. Source and destination overlap when the distance
+// is shorter than the length; the copied bytes then repeat with the period
+// of the distance, which is doubled by every chunk copied.
+static inline void
+copy_stamp(uint8_t *dst, size_t distance, size_t length) {
+  const uint8_t *src = dst - distance;
+  if (distance == 1) {
+    memset(dst, *src, length);
+    return;
+  }
+  while (length > distance) {
+    memcpy(dst, src, distance);
+    dst += distance;
+    length -= distance;
+    distance *= 2;
+  }
+  memcpy(dst, src, length);
+}
+
+size_t
+UnpackerTPWM::unpack(void *dst, size_t size) {
+  if (size < unpacked_size) {
+    throw ExceptionFreeserf("TPWM output buffer is too small");
+  }
 
-  try {
-    while (buffer->readable()) {
-      size_t flag = buffer->pop<uint8_t>();
-      for (int i = 0 ; i < 8 ; i++) {
-        flag <<= 1;
-        if (flag & ~0xFF) {
-          flag &= 0xFF;
-          size_t temp = buffer->pop<uint8_t>();
-          size_t stamp_size = (temp & 0x0F) + 3;
-          size_t stamp_offset = buffer->pop<uint8_t>();
-          stamp_offset |= ((temp << 4) & 0x0F00);
-          PBuffer stamp = result->get_subbuffer(result->get_size() -
-                                                stamp_offset, stamp_size);
-          result->push(stamp);
-        } else {
-          result->push<uint8_t>(buffer->pop<uint8_t>());
+  uint8_t *begin = reinterpret_cast<uint8_t*>(dst);
+  uint8_t *end = begin + unpacked_size;
+  uint8_t *out = begin;
+  const uint8_t *in = reinterpret_cast<const uint8_t*>(buffer->get_data());
+  const uint8_t *in_end = in + buffer->get_size();
+
+  while (out < end) {
+    if (in == in_end) {
+      throw ExceptionFreeserf("TPWM source data corrupted");
+    }
+    unsigned int flag = *in++;
+
+    // Eight literals in a row.
+    if (flag == 0 && in_end - in >= 8 && end - out >= 8) {
+      memcpy(out, in, 8);
+      in += 8;
+      out += 8;
+      continue;
+    }
+
+    for (int i = 0; i < 8 && out < end; i++, flag <<= 1) {
+      if (flag & 0x80) {
+        if (in_end - in < 2) {
+          throw ExceptionFreeserf("TPWM source data corrupted");
+        }
+        size_t stamp_size = (in[0] & 0x0F) + 3;
+        size_t stamp_offset = in[1] | ((in[0] << 4) & 0x0F00);
+        in += 2;
+        if (stamp_offset == 0 ||
+            stamp_offset > static_cast<size_t>(out - begin) ||
+            stamp_size > static_cast<size_t>(end - out)) {
+          throw ExceptionFreeserf("TPWM source data corrupted");
+        }
+        copy_stamp(out, stamp_offset, stamp_size);
+        out += stamp_size;
+      } else {
+        if (in == in_end) {
+          throw ExceptionFreeserf("TPWM source data corrupted");
         }
+        *out++ = *in++;
       }
     }
-  } catch (...) {
-    throw ExceptionFreeserf("TPWM source data corrupted");
   }
 
-  if (result->get_size() != res_size) {
-    throw ExceptionFreeserf("TPWM source data corrupted");
+  return unpacked_size;
+}
+
+PBuffer
+UnpackerTPWM::convert() {
+  PMutableBuffer result = std::make_shared<MutableBuffer>(unpacked_size,
+                                                          Buffer::EndianessBig);
+  if (unpacked_size > 0) {
+    unpack(result->extend(unpacked_size), unpacked_size);
   }
 
   return result;
@@ -25,11 +25,20 @@
 #include "src/convertor.h"
 
 class UnpackerTPWM : public Convertor {
+ protected:
+  size_t unpacked_size;
+
  public:
   explicit UnpackerTPWM(PBuffer buffer);
   virtual ~UnpackerTPWM() {}
 
   virtual PBuffer convert();
+
+  // Size of the unpacked data, as stored in the header.
+  size_t get_unpacked_size() const { return unpacked_size; }
+  // Unpack straight into caller memory of at least get_unpacked_size()
+  // bytes, without any allocation. Returns the number of bytes written.
+  size_t unpack(void *dst, size_t size);
 };
 
 #endif  // SRC_TPWM_H_
@@ -0,0 +1,298 @@
+/*
+ * video-headless.cc - Software rendering into memory buffers
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/video-headless.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+#include "src/log.h"
+
+VideoHeadless::VideoHeadless() {
+  screen = nullptr;
+  fullscreen = false;
+  zoom_factor = 1.f;
+  frames_swapped = 0;
+
+  Log::Info["video"] << "Initializing \"headless\".";
+
+  set_resolution(800, 600, fullscreen);
+}
+
+VideoHeadless::~VideoHeadless() {
+  if (screen != nullptr) {
+    delete screen;
+    screen = nullptr;
+  }
+}
+
+Video &
+Video::get_instance() {
+  static VideoHeadless instance;
+  return instance;
+}
+
+void
+VideoHeadless::set_resolution(unsigned int width, unsigned int height,
+                              bool fs) {
+  if (screen != nullptr) {
+    delete screen;
+  }
+  screen = new Video::Frame(width, height);
+  fullscreen = fs;
+}
+
+void
+VideoHeadless::get_resolution(unsigned int *width, unsigned int *height) {
+  if (width != nullptr) {
+    *width = screen->w;
+  }
+  if (height != nullptr) {
+    *height = screen->h;
+  }
+}
+
+void
+VideoHeadless::set_fullscreen(bool enable) {
+  fullscreen = enable;
+}
+
+bool
+VideoHeadless::is_fullscreen() {
+  return fullscreen;
+}
+
+Video::Frame *
+VideoHeadless::get_screen_frame() {
+  return screen;
+}
+
+Video::Frame *
+VideoHeadless::create_frame(unsigned int width, unsigned int height) {
+  return new Video::Frame(width, height);
+}
+
+void
+VideoHeadless::destroy_frame(Video::Frame *frame) {
+  delete frame;
+}
+
+Video::Image *
+VideoHeadless::create_image(void *data, unsigned int width,
+                            unsigned int height) {
+  Video::Image *image = new Video::Image();
+  image->w = width;
+  image->h = height;
+  image->pixels.resize(width * height);
+
+  /* Sprite data is stored as BGRA */
+  const uint8_t *src = reinterpret_cast<uint8_t*>(data);
+  for (Video::Color &pixel : image->pixels) {
+    pixel.b = *src++;
+    pixel.g = *src++;
+    pixel.r = *src++;
+    pixel.a = *src++;
+  }
+
+  return image;
+}
+
+void
+VideoHeadless::destroy_image(Video::Image *image) {
+  delete image;
+}
+
+/* Blend src over the destination pixel, the same way as
+   SDL_BLENDMODE_BLEND does. */
+void
+VideoHeadless::blend_pixel(Video::Frame *dest, int x, int y,
+                           const Video::Color &src) {
+  if (x < 0 || y < 0 ||
+      x >= static_cast<int>(dest->w) || y >= static_cast<int>(dest->h)) {
+    return;
+  }
+
+  if (src.a == 0x00) {
+    return;
+  }
+
+  Video::Color &dst = dest->pixels[y * dest->w + x];
+  if (src.a == 0xff) {
+    dst = src;
+    return;
+  }
+
+  unsigned int a = src.a;
+  unsigned int ia = 0xff - a;
+  dst.r = static_cast<unsigned char>((src.r * a + dst.r * ia + 0x7f) / 0xff);
+  dst.g = static_cast<unsigned char>((src.g * a + dst.g * ia + 0x7f) / 0xff);
+  dst.b = static_cast<unsigned char>((src.b * a + dst.b * ia + 0x7f) / 0xff);
+  dst.a = static_cast<unsigned char>(a + (dst.a * ia + 0x7f) / 0xff);
+}
+
+void
+VideoHeadless::put_pixel(Video::Frame *dest, int x, int y,
+                         const Video::Color &src) {
+  if (x < 0 || y < 0 ||
+      x >= static_cast<int>(dest->w) || y >= static_cast<int>(dest->h)) {
+    return;
+  }
+
+  dest->pixels[y * dest->w + x] = src;
+}
+
+void
+VideoHeadless::draw_image(const Video::Image *image, int x, int y,
+                          int y_offset, Video::Frame *dest) {
+  for (unsigned int iy = std::max(y_offset, 0); iy < image->h; iy++) {
+    int dy = y + static_cast<int>(iy);
+    if (dy < 0) continue;
+    if (dy >= static_cast<int>(dest->h)) break;
+
+    const Video::Color *src = &image->pixels[iy * image->w];
+    for (unsigned int ix = 0; ix < image->w; ix++) {
+      blend_pixel(dest, x + static_cast<int>(ix), dy, src[ix]);
+    }
+  }
+}
+
+void
+VideoHeadless::draw_frame(int dx, int dy, Video::Frame *dest, int sx, int sy,
+                          Video::Frame *src, int w, int h) {
+  for (int iy = 0; iy < h; iy++) {
+    int y = sy + iy;
+    if (y < 0 || y >= static_cast<int>(src->h)) continue;
+
+    for (int ix = 0; ix < w; ix++) {
+      int x = sx + ix;
+      if (x < 0 || x >= static_cast<int>(src->w)) continue;
+
+      blend_pixel(dest, dx + ix, dy + iy, src->pixels[y * src->w + x]);
+    }
+  }
+}
+
+void
+VideoHeadless::draw_rect(int x, int y, unsigned int width, unsigned int height,
+                         const Video::Color color, Video::Frame *dest) {
+  /* Draw rectangle. */
+  fill_rect(x, y, width, 1, color, dest);
+  fill_rect(x, y+height-1, width, 1, color, dest);
+  fill_rect(x, y, 1, height, color, dest);
+  fill_rect(x+width-1, y, 1, height, color, dest);
+}
+
+void
+VideoHeadless::fill_rect(int x, int y, unsigned int width, unsigned int height,
+                         const Video::Color color, Video::Frame *dest) {
+  Video::Color c = color;
+  c.a = 0xff;
+
+  int x0 = std::max(x, 0);
+  int y0 = std::max(y, 0);
+  int x1 = std::min(x + static_cast<int>(width), static_cast<int>(dest->w));
+  int y1 = std::min(y + static_cast<int>(height), static_cast<int>(dest->h));
+  for (int iy = y0; iy < y1; iy++) {
+    std::fill(dest->pixels.begin() + iy * dest->w + x0,
+              dest->pixels.begin() + iy * dest->w + x1, c);
+  }
+}
+
+void
+VideoHeadless::draw_line(int x, int y, int x1, int y1,
+                         const Video::Color color, Video::Frame *dest) {
+  Video::Color c = color;
+  c.a = 0xff;
+
+  /* Bresenham */
+  int dx = std::abs(x1 - x);
+  int dy = -std::abs(y1 - y);
+  int step_x = (x < x1) ? 1 : -1;
+  int step_y = (y < y1) ? 1 : -1;
+  int err = dx + dy;
+
+  while (true) {
+    put_pixel(dest, x, y, c);
+    if (x == x1 && y == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x += step_x;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y += step_y;
+    }
+  }
+}
+
+void
+VideoHeadless::swap_buffers() {
+  frames_swapped++;
+}
+
+bool
+VideoHeadless::set_zoom_factor(float factor) {
+  if ((factor < 0.2f) || (factor > 1.f)) {
+    return false;
+  }
+
+  unsigned int width = 0;
+  unsigned int height = 0;
+  get_resolution(&width, &height);
+  zoom_factor = factor;
+
+  width = (unsigned int)(static_cast<float>(width) * zoom_factor);
+  height = (unsigned int)(static_cast<float>(height) * zoom_factor);
+  set_resolution(width, height, is_fullscreen());
+
+  return true;
+}
+
+void
+VideoHeadless::get_screen_factor(float *fx, float *fy) {
+  if (fx != nullptr) {
+    *fx = 1.f;
+  }
+  if (fy != nullptr) {
+    *fy = 1.f;
+  }
+}
+
+bool
+VideoHeadless::write_ppm(const Video::Frame *frame,
+                         const std::string &path) const {
+  std::ofstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    Log::Warn["video"] << "Unable to open '" << path << "' for writing";
+    return false;
+  }
+
+  file << "P6\n" << frame->w << " " << frame->h << "\n255\n";
+  for (const Video::Color &pixel : frame->pixels) {
+    file.put(static_cast<char>(pixel.r));
+    file.put(static_cast<char>(pixel.g));
+    file.put(static_cast<char>(pixel.b));
+  }
+
+  return file.good();
+}
@@ -0,0 +1,111 @@
+/*
+ * video-headless.h - Software rendering into memory buffers
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_VIDEO_HEADLESS_H_
+#define SRC_VIDEO_HEADLESS_H_
+
+#include <string>
+#include <vector>
+
+#include "src/video.h"
+
+/* Frames and images are plain RGBA pixel buffers. */
+class Video::Frame {
+ public:
+  unsigned int w;
+  unsigned int h;
+  std::vector<Video::Color> pixels;
+
+  Frame() : w(0), h(0) {}
+  Frame(unsigned int width, unsigned int height)
+    : w(width), h(height), pixels(width * height, Video::Color{0, 0, 0, 0}) {}
+};
+
+class Video::Image {
+ public:
+  unsigned int w;
+  unsigned int h;
+  std::vector<Video::Color> pixels;
+
+  Image() : w(0), h(0) {}
+};
+
+/* Video implementation that needs neither a display nor a GPU. All drawing
+   is done in software with the same blending rules as the SDL renderer, so
+   the result can be compared between runs. */
+class VideoHeadless : public Video {
+ protected:
+  Video::Frame *screen;
+  bool fullscreen;
+  float zoom_factor;
+  unsigned int frames_swapped;
+
+ public:
+  VideoHeadless();
+  virtual ~VideoHeadless();
+
+  virtual void set_resolution(unsigned int width, unsigned int height,
+                              bool fullscreen);
+  virtual void get_resolution(unsigned int *width, unsigned int *height);
+  virtual void set_fullscreen(bool enable);
+  virtual bool is_fullscreen();
+
+  virtual Video::Frame *get_screen_frame();
+  virtual Video::Frame *create_frame(unsigned int width, unsigned int height);
+  virtual void destroy_frame(Video::Frame *frame);
+
+  virtual Video::Image *create_image(void *data, unsigned int width,
+                                     unsigned int height);
+  virtual void destroy_image(Video::Image *image);
+
+  virtual void warp_mouse(int x, int y) {}
+
+  virtual void draw_image(const Video::Image *image, int x, int y,
+                          int y_offset, Video::Frame *dest);
+  virtual void draw_frame(int dx, int dy, Video::Frame *dest, int sx, int sy,
+                          Video::Frame *src, int w, int h);
+  virtual void draw_rect(int x, int y, unsigned int width, unsigned int height,
+                         const Video::Color color, Video::Frame *dest);
+  virtual void fill_rect(int x, int y, unsigned int width, unsigned int height,
+                         const Video::Color color, Video::Frame *dest);
+  virtual void draw_line(int x, int y, int x1, int y1,
+                         const Video::Color color, Video::Frame *dest);
+
+  virtual void swap_buffers();
+
+  virtual void set_cursor(void *data, unsigned int width,
+                          unsigned int height) {}
+
+  virtual float get_zoom_factor() { return zoom_factor; }
+  virtual bool set_zoom_factor(float factor);
+  virtual void get_screen_factor(float *fx, float *fy);
+
+  unsigned int get_frames_swapped() const { return frames_swapped; }
+
+  /* Write frame content as binary PPM (alpha is dropped). */
+  bool write_ppm(const Video::Frame *frame, const std::string &path) const;
+
+ protected:
+  void blend_pixel(Video::Frame *dest, int x, int y, const Video::Color &src);
+  void put_pixel(Video::Frame *dest, int x, int y, const Video::Color &src);
+};
+
+#endif  // SRC_VIDEO_HEADLESS_H_
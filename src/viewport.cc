@@ -25,6 +25,7 @@
 #include <memory>
 #include <utility>
 #include <sstream>
+#include <vector>
 
 #include "src/misc.h"
 #include "src/game.h"
@@ -36,6 +37,7 @@
 #include "src/interface.h"
 #include "src/popup.h"
 #include "src/pathfinder.h"
+#include "src/game-thread.h"
 
 #define MAP_TILE_WIDTH   32
 #define MAP_TILE_HEIGHT  20
@@ -47,6 +49,22 @@
 #define MAP_TILE_COLS  16
 #define MAP_TILE_ROWS  16
 
+/* Whether the sound effect of the serf or building at index is playing.
+   Kept here, as drawing sees only a copy of the game. */
+static bool
+playing_sfx(const std::vector<bool> &sfx, unsigned int index) {
+  return (index < sfx.size()) && sfx[index];
+}
+
+static void
+set_playing_sfx(std::vector<bool> *sfx, unsigned int index, bool playing) {
+  if (index >= sfx->size()) {
+    if (!playing) return;
+    sfx->resize(index + 1, false);
+  }
+  (*sfx)[index] = playing;
+}
+
 static const uint8_t tri_spr[] = {
   32, 32, 32, 32, 32, 32, 32, 32,
   32, 32, 32, 32, 32, 32, 32, 32,
@@ -267,6 +285,7 @@ Viewport::draw_down_tile_col(MapPos pos, int x_base, int y_base,
 void
 Viewport::layout() {
   landscape_tiles.clear();
+  update_view();
 }
 
 void
@@ -661,51 +680,53 @@ static const int map_building_frame_sprite[] = {
 };
 
 void
-Viewport::draw_building_unfinished(Building *building, Building::Type bld_type,
-                                   int lx, int ly) {
-  if (building->get_progress() == 0) { /* Draw cross */
+Viewport::draw_building_unfinished(const BuildingState *building,
+                                   Building::Type bld_type, int lx, int ly) {
+  if (building->progress == 0) { /* Draw cross */
     draw_shadow_and_building_sprite(lx, ly, 0x90);
   } else {
     /* Stone waiting */
-    int stone = building->waiting_stone();
+    int stone = building->waiting_stone;
     for (int i = 0; i < stone; i++) {
       draw_game_sprite(lx+10 - i*3, ly-8 + i, 1 + Resource::TypeStone);
     }
 
     /* Planks waiting */
-    int planks = building->waiting_planks();
+    int planks = building->waiting_planks;
     for (int i = 0; i < planks; i++) {
       draw_game_sprite(lx+12 - i*3, ly-6 + i, 1 + Resource::TypePlank);
     }
 
-    if (BIT_TEST(building->get_progress(), 15)) { /* Frame finished */
+    if (BIT_TEST(building->progress, 15)) { /* Frame finished */
       draw_shadow_and_building_sprite(lx, ly,
                                       map_building_frame_sprite[bld_type]);
       draw_shadow_and_building_unfinished(lx, ly, map_building_sprite[bld_type],
-                                         2*(building->get_progress() & 0x7fff));
+                                         2*(building->progress & 0x7fff));
     } else {
       draw_shadow_and_building_sprite(lx, ly, 0x91); /* corner stone */
-      if (building->get_progress() > 1) {
+      if (building->progress > 1) {
         draw_shadow_and_building_unfinished(lx, ly,
                                             map_building_frame_sprite[bld_type],
-                                            2*building->get_progress());
+                                            2*building->progress);
       }
     }
   }
 }
 
 void
-Viewport::draw_ocupation_flag(Building *building, int lx, int ly, float mul) {
-  if (building->has_knight()) {
+Viewport::draw_ocupation_flag(const BuildingState *building, int lx, int ly,
+                              float mul) {
+  if (building->has_knight) {
     draw_game_sprite(lx, ly -
-                     static_cast<int>(mul * building->get_knight_count()),
-                     182 + ((interface->get_game()->get_tick() >> 3) & 3) +
-                     4 * static_cast<int>(building->get_threat_level()));
+                     static_cast<int>(mul * building->knight_count),
+                     182 + ((snapshot->get_tick() >> 3) & 3) +
+                     4 * static_cast<int>(building->threat_level));
   }
 }
 
 void
-Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
+Viewport::draw_unharmed_building(const BuildingState *building, int lx,
+                                 int ly) {
   Random random;
 
   static const int pigfarm_anim[] = {
@@ -733,8 +754,8 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
     0xa2, 0, 0xa2, 0
   };
 
-  if (building->is_done()) {
-    Building::Type type = building->get_type();
+  if (building->done) {
+    Building::Type type = building->type;
     switch (type) {
     case Building::TypeFisher:
     case Building::TypeLumberjack:
@@ -750,23 +771,23 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
       break;
     case Building::TypeBoatbuilder:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->get_res_count_in_stock(1) > 0) {
+      if (building->stock_1_count > 0) {
         /* TODO x might not be correct */
         draw_game_sprite(lx+3, ly + 13,
-                         174 + building->get_res_count_in_stock(1));
+                         174 + building->stock_1_count);
       }
       break;
     case Building::TypeStoneMine:
     case Building::TypeCoalMine:
     case Building::TypeIronMine:
     case Building::TypeGoldMine:
-      if (building->is_active()) { /* Draw elevator up */
+      if (building->active) { /* Draw elevator up */
         draw_game_sprite(lx-6, ly-39, 152);
       }
-      if (building->is_playing_sfx()) { /* Draw elevator down */
+      if (building->playing_sfx) { /* Draw elevator down */
         draw_game_sprite(lx-6, ly-39, 153);
-        MapPos pos = building->get_position();
-        if ((((interface->get_game()->get_tick() +
+        MapPos pos = building->pos;
+        if ((((snapshot->get_tick() +
                reinterpret_cast<uint8_t*>(&pos)[1]) >> 3) & 7) == 0
             && random.random() < 40000) {
           play_sound(Audio::TypeSfxElevator);
@@ -780,13 +801,13 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
       break;
     case Building::TypePigFarm:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->get_res_count_in_stock(1) > 0) {
+      if (building->stock_1_count > 0) {
         if ((random.random() & 0x7f) <
-            static_cast<int>(building->get_res_count_in_stock(1))) {
+            static_cast<int>(building->stock_1_count)) {
           play_sound(Audio::TypeSfxPigOink);
         }
 
-        int pigs_count = building->get_res_count_in_stock(1);
+        int pigs_count = building->stock_1_count;
 
         int pigs_layout[] = {
           0,   0,   0,  0,
@@ -803,7 +824,7 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
         for (int p = 1; p <= pigs_count; p++) {
           if (pigs_count >= pigs_layout[p * 4]) {
             int i = (pigs_layout[p * 4 + 1]
-                     + (interface->get_game()->get_tick() >> 3)) & 0xfe;
+                     + (snapshot->get_tick() >> 3)) & 0xfe;
             draw_game_sprite(lx + pigfarm_anim[i + 1] + pigs_layout[p * 4 + 2],
                              ly + pigs_layout[p * 4 + 3], pigfarm_anim[i]);
           }
@@ -811,35 +832,35 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
       }
       break;
     case Building::TypeMill:
-      if (building->is_active()) {
-        if ((interface->get_game()->get_tick() >> 4) & 3) {
-          building->stop_playing_sfx();
-        } else if (!building->is_playing_sfx()) {
-          building->start_playing_sfx();
+      if (building->active) {
+        if ((snapshot->get_tick() >> 4) & 3) {
+          set_playing_sfx(&building_sfx, building->index, false);
+        } else if (!playing_sfx(building_sfx, building->index)) {
+          set_playing_sfx(&building_sfx, building->index, true);
           play_sound(Audio::TypeSfxMillGrinding);
         }
         draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type] +
-                                ((interface->get_game()->get_tick() >> 4) & 3));
+                                ((snapshot->get_tick() >> 4) & 3));
       } else {
         draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
       }
       break;
     case Building::TypeBaker:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->is_active()) {
+      if (building->active) {
         draw_game_sprite(lx + 5, ly-21,
-                         154 + ((interface->get_game()->get_tick() >> 3) & 7));
+                         154 + ((snapshot->get_tick() >> 3) & 7));
       }
       break;
     case Building::TypeSteelSmelter:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->is_active()) {
-        int i = (interface->get_game()->get_tick() >> 3) & 7;
-        if (i == 0 || (i == 7 && !building->is_playing_sfx())) {
-          building->start_playing_sfx();
+      if (building->active) {
+        int i = (snapshot->get_tick() >> 3) & 7;
+        if (i == 0 || (i == 7 && !playing_sfx(building_sfx, building->index))) {
+          set_playing_sfx(&building_sfx, building->index, true);
           play_sound(Audio::TypeSfxGoldBoils);
         } else if (i != 7) {
-          building->stop_playing_sfx();
+          set_playing_sfx(&building_sfx, building->index, false);
         }
 
         draw_game_sprite(lx+6, ly-32, 128+i);
@@ -847,9 +868,9 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
       break;
     case Building::TypeWeaponSmith:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->is_active()) {
+      if (building->active) {
         draw_game_sprite(lx-16, ly-21,
-                         128 + ((interface->get_game()->get_tick() >> 3) & 7));
+                         128 + ((snapshot->get_tick() >> 3) & 7));
       }
       break;
     case Building::TypeTower:
@@ -859,21 +880,21 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
     case Building::TypeFortress:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
       draw_ocupation_flag(building, lx - 12, ly - 21, 0.5f);
-      if (building->has_knight()) {
-        draw_game_sprite(lx+22, ly - 34 - (building->get_knight_count()+1)/2,
-                    182 + (((interface->get_game()->get_tick() >> 3) + 2) & 3) +
-                         4 * static_cast<int>(building->get_threat_level()));
+      if (building->has_knight) {
+        draw_game_sprite(lx+22, ly - 34 - (building->knight_count+1)/2,
+                    182 + (((snapshot->get_tick() >> 3) + 2) & 3) +
+                         4 * static_cast<int>(building->threat_level));
       }
       break;
     case Building::TypeGoldSmelter:
       draw_shadow_and_building_sprite(lx, ly, map_building_sprite[type]);
-      if (building->is_active()) {
-        int i = (interface->get_game()->get_tick() >> 3) & 7;
-        if (i == 0 || (i == 7 && !building->is_playing_sfx())) {
-          building->start_playing_sfx();
+      if (building->active) {
+        int i = (snapshot->get_tick() >> 3) & 7;
+        if (i == 0 || (i == 7 && !playing_sfx(building_sfx, building->index))) {
+          set_playing_sfx(&building_sfx, building->index, true);
           play_sound(Audio::TypeSfxGoldBoils);
         } else if (i != 7) {
-          building->stop_playing_sfx();
+          set_playing_sfx(&building_sfx, building->index, false);
         }
 
         draw_game_sprite(lx-7, ly-33, 128+i);
@@ -884,17 +905,17 @@ Viewport::draw_unharmed_building(Building *building, int lx, int ly) {
       break;
     }
   } else { /* unfinished building */
-    if (building->get_type() != Building::TypeCastle) {
-      draw_building_unfinished(building, building->get_type(), lx, ly);
+    if (building->type != Building::TypeCastle) {
+      draw_building_unfinished(building, building->type, lx, ly);
     } else {
       draw_shadow_and_building_unfinished(lx, ly, 0xb2,
-                                          building->get_progress());
+                                          building->progress);
     }
   }
 }
 
 void
-Viewport::draw_burning_building(Building *building, int lx, int ly) {
+Viewport::draw_burning_building(const BuildingState *building, int lx, int ly) {
   const int building_anim_offset_from_type[] = {
     0, 10, 26, 39, 49, 62, 78, 97, 97, 116,
     129, 157, 167, 198, 211, 236, 255, 277, 305, 324,
@@ -1105,46 +1126,40 @@ Viewport::draw_burning_building(Building *building, int lx, int ly) {
   };
 
   /* Play sound effect. */
-  if (((building->get_burning_counter() >> 3) & 3) == 3 &&
-      !building->is_playing_sfx()) {
-    building->start_playing_sfx();
+  if (((building->burning_counter >> 3) & 3) == 3 &&
+      !playing_sfx(building_sfx, building->index)) {
+    set_playing_sfx(&building_sfx, building->index, true);
     play_sound(Audio::TypeSfxBurning);
   } else {
-    building->stop_playing_sfx();
+    set_playing_sfx(&building_sfx, building->index, false);
   }
 
-  uint16_t delta = interface->get_game()->get_tick() - building->get_tick();
-  building->set_tick(interface->get_game()->get_tick());
-
-  if (building->get_burning_counter() >= delta) {
-    building->decrease_burning_counter(delta);  // TODO(jonls): this is also
-                                                // done in update_buildings().
-    draw_unharmed_building(building, lx, ly);
+  draw_unharmed_building(building, lx, ly);
 
-    int type = 0;
-    if (building->is_done() ||
-        building->get_progress() >= 16000) {
-      type = building->get_type();
-    }
+  int type = 0;
+  if (building->done ||
+      building->progress >= 16000) {
+    type = building->type;
+  }
 
-    int offset = ((building->get_burning_counter() >> 3) & 7) ^ 7;
-    const int *anim = building_burn_animation +
-                      building_anim_offset_from_type[type];
-    while (anim[0] >= 0) {
-      draw_game_sprite(lx+anim[1], ly+anim[2], 136 + anim[0] + offset);
-      offset = (offset + 3) & 7;
-      anim += 3;
-    }
-  } else {
-    building->set_burning_counter(0);
+  int offset = ((building->burning_counter >> 3) & 7) ^ 7;
+  const int *anim = building_burn_animation +
+                    building_anim_offset_from_type[type];
+  while (anim[0] >= 0) {
+    draw_game_sprite(lx+anim[1], ly+anim[2], 136 + anim[0] + offset);
+    offset = (offset + 3) & 7;
+    anim += 3;
   }
 }
 
 void
 Viewport::draw_building(MapPos pos, int lx, int ly) {
-  Building *building = interface->get_game()->get_building_at_pos(pos);
+  const BuildingState *building = snapshot->get_building_at_pos(pos);
+  if (building == nullptr) {
+    return;
+  }
 
-  if (building->is_burning()) {
+  if (building->burning) {
     draw_burning_building(building, lx, ly);
   } else {
     draw_unharmed_building(building, lx, ly);
@@ -1153,7 +1168,7 @@ Viewport::draw_building(MapPos pos, int lx, int ly) {
 
 void
 Viewport::draw_water_waves(MapPos pos, int lx, int ly) {
-  int sprite = (((pos ^ 5) + (interface->get_game()->get_tick() >> 3)) & 0xf);
+  int sprite = (((pos ^ 5) + (snapshot->get_tick() >> 3)) & 0xf);
 
   if (map->type_down(pos) <= Map::TerrainWater3 &&
       map->type_up(pos) <= Map::TerrainWater3) {
@@ -1183,7 +1198,10 @@ Viewport::draw_water_waves_row(MapPos pos, int y_base, int cols,
 
 void
 Viewport::draw_flag_and_res(MapPos pos, int lx, int ly) {
-  Flag *flag = interface->get_game()->get_flag_at_pos(pos);
+  const RenderSnapshot::FlagState *flag = snapshot->get_flag_at_pos(pos);
+  if (flag == nullptr) {
+    return;
+  }
 
   int res_pos[] = {  6, -4,
                     10, -2,
@@ -1195,22 +1213,22 @@ Viewport::draw_flag_and_res(MapPos pos, int lx, int ly) {
                     -4,  4 };
 
   for (unsigned int i = 0; i < 3; i++) {
-    if (flag->get_resource_at_slot(i) != Resource::TypeNone) {
+    if (flag->resources[i] != Resource::TypeNone) {
       draw_game_sprite(lx + res_pos[i*2], ly + res_pos[i * 2 + 1],
-                       flag->get_resource_at_slot(i) + 1);
+                       flag->resources[i] + 1);
     }
   }
 
-  int pl_num = flag->get_owner();
+  int pl_num = flag->owner;
   Color player_color = interface->get_player_color(pl_num);
-  int spr = 0x80 + ((interface->get_game()->get_tick() >> 3) & 3);
+  int spr = 0x80 + ((snapshot->get_tick() >> 3) & 3);
 
   draw_shadow_and_building_sprite(lx, ly, spr, player_color);
 
   for (unsigned int i = 3; i < 8; i++) {
-    if (flag->get_resource_at_slot(i) != Resource::TypeNone) {
+    if (flag->resources[i] != Resource::TypeNone) {
       draw_game_sprite(lx + res_pos[i * 2], ly + res_pos[i * 2 + 1],
-        flag->get_resource_at_slot(i) + 1);
+        flag->resources[i] + 1);
     }
   }
 }
@@ -1237,7 +1255,7 @@ Viewport::draw_map_objects_row(MapPos pos, int y_base, int cols, int x_base) {
         /* Adding sprite number to animation ensures
            that the tree animation won't be synchronized
            for all trees on the map. */
-        int tree_anim = (interface->get_game()->get_tick() + sprite) >> 4;
+        int tree_anim = (snapshot->get_tick() + sprite) >> 4;
         if (sprite < 16) {
           sprite = (sprite & ~7) + (tree_anim & 7);
         } else {
@@ -1355,7 +1373,7 @@ Viewport::draw_row_serf(int lx, int ly, bool shadow, const Color &color,
 /* Extracted from obsolete update_map_serf_rows(). */
 /* Translate serf type into the corresponding sprite code. */
 int
-Viewport::serf_get_body(Serf *serf) {
+Viewport::serf_get_body(const SerfState *serf) {
   const int transporter_type[] = {
     0, 0x3000, 0x3500, 0x3b00, 0x4100, 0x4600, 0x4b00, 0x1400,
     0x700, 0x5100, 0x800, 0x1c00, 0x1d00, 0x1e00, 0x1a00, 0x1b00,
@@ -1370,48 +1388,48 @@ Viewport::serf_get_body(Serf *serf) {
     0x7600, 0x5f00, 0x6000, 0, 0, 0, 0, 0
   };
 
-  Data::Animation animation = data_source->get_animation(serf->get_animation(),
-                                                         serf->get_counter());
+  Data::Animation animation = data_source->get_animation(serf->animation,
+                                                         serf->counter);
   int t = animation.sprite;
 
-  switch (serf->get_type()) {
+  switch (serf->type) {
   case Serf::TypeTransporter:
   case Serf::TypeGeneric:
-    if (serf->get_state() == Serf::StateIdleOnPath) {
+    if (serf->state == Serf::StateIdleOnPath) {
       return -1;
-    } else if ((serf->get_state() == Serf::StateTransporting ||
-                serf->get_state() == Serf::StateDelivering) &&
-               serf->get_delivery() != 0) {
-      t += transporter_type[serf->get_delivery()];
+    } else if ((serf->state == Serf::StateTransporting ||
+                serf->state == Serf::StateDelivering) &&
+               serf->delivery != 0) {
+      t += transporter_type[serf->delivery];
     }
     break;
   case Serf::TypeSailor:
-    if (serf->get_state() == Serf::StateTransporting && t < 0x80) {
-      if (((t & 7) == 4 && !serf->playing_sfx()) ||
+    if (serf->state == Serf::StateTransporting && t < 0x80) {
+      if (((t & 7) == 4 && !playing_sfx(serf_sfx, serf->index)) ||
           (t & 7) == 3) {
-        serf->start_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxRowing);
       } else {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
       }
     }
 
-    if ((serf->get_state() == Serf::StateTransporting &&
-         serf->get_delivery() == 0) ||
-        serf->get_state() == Serf::StateLostSailor ||
-        serf->get_state() == Serf::StateFreeSailing) {
+    if ((serf->state == Serf::StateTransporting &&
+         serf->delivery == 0) ||
+        serf->state == Serf::StateLostSailor ||
+        serf->state == Serf::StateFreeSailing) {
       if (t < 0x80) {
-        if (((t & 7) == 4 && !serf->playing_sfx()) ||
+        if (((t & 7) == 4 && !playing_sfx(serf_sfx, serf->index)) ||
             (t & 7) == 3) {
-          serf->start_playing_sfx();
+          set_playing_sfx(&serf_sfx, serf->index, true);
           play_sound(Audio::TypeSfxRowing);
         } else {
-          serf->stop_playing_sfx();
+          set_playing_sfx(&serf_sfx, serf->index, false);
         }
       }
       t += 0x200;
-    } else if (serf->get_state() == Serf::StateTransporting) {
-      t += sailor_type[serf->get_delivery()];
+    } else if (serf->state == Serf::StateTransporting) {
+      t += sailor_type[serf->delivery];
     } else {
       t += 0x100;
     }
@@ -1420,13 +1438,13 @@ Viewport::serf_get_body(Serf *serf) {
     if (t < 0x80) {
       t += 0x300;
     } else if (t == 0x83 || t == 0x84) {
-      if (t == 0x83 || !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+      if (t == 0x83 || !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxDigging);
       }
       t += 0x380;
     } else {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x380;
     }
     break;
@@ -1434,53 +1452,53 @@ Viewport::serf_get_body(Serf *serf) {
     if (t < 0x80) {
       t += 0x500;
     } else if ((t & 7) == 4 || (t & 7) == 5) {
-      if ((t & 7) == 4 || !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+      if ((t & 7) == 4 || !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxHammerBlow);
       }
       t += 0x580;
     } else {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x580;
     }
     break;
   case Serf::TypeTransporterInventory:
-    if (serf->get_state() == Serf::StateBuildingCastle) {
+    if (serf->state == Serf::StateBuildingCastle) {
       return -1;
     } else {
-      int res = serf->get_delivery();
+      int res = serf->delivery;
       t += transporter_type[res];
     }
     break;
   case Serf::TypeLumberjack:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateFreeWalking &&
-          serf->get_free_walking_neg_dist1() == -128 &&
-          serf->get_free_walking_neg_dist2() == 1) {
+      if (serf->state == Serf::StateFreeWalking &&
+          serf->free_walking_neg_dist1 == -128 &&
+          serf->free_walking_neg_dist2 == 1) {
         t += 0x1000;
       } else {
         t += 0xb00;
       }
-    } else if ((t == 0x86 && !serf->playing_sfx()) ||
+    } else if ((t == 0x86 && !playing_sfx(serf_sfx, serf->index)) ||
          t == 0x85) {
-      serf->start_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, true);
       play_sound(Audio::TypeSfxAxBlow);
       /* TODO Dangerous reference to unknown state vars.
          It is probably free walking. */
-      if (serf->get_free_walking_neg_dist2() == 0 &&
-          serf->get_counter() < 64) {
+      if (serf->free_walking_neg_dist2 == 0 &&
+          serf->counter < 64) {
         play_sound(Audio::TypeSfxTreeFall);
       }
       t += 0xe80;
     } else if (t != 0x86) {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0xe80;
     }
     break;
   case Serf::TypeSawmiller:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x1700;
       } else {
@@ -1489,65 +1507,67 @@ Viewport::serf_get_body(Serf *serf) {
     } else {
       /* player_num += 4; ??? */
       if (t == 0xb3 || t == 0xbb || t == 0xc3 || t == 0xcb ||
-          (!serf->playing_sfx() && (t == 0xb7 || t == 0xbf ||
+          (!playing_sfx(serf_sfx, serf->index) && (t == 0xb7 || t == 0xbf ||
                 t == 0xc7 || t == 0xcf))) {
-        serf->start_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxSawing);
       } else if (t != 0xb7 && t != 0xbf && t != 0xc7 && t != 0xcf) {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
       }
       t += 0x1580;
     }
     break;
   case Serf::TypeStonecutter:
     if (t < 0x80) {
-      if ((serf->get_state() == Serf::StateFreeWalking &&
-           serf->get_free_walking_neg_dist1() == -128 &&
-           serf->get_free_walking_neg_dist2() == 1) ||
-          (serf->get_state() == Serf::StateStoneCutting &&
-           serf->get_free_walking_neg_dist1() == 2)) {
+      if ((serf->state == Serf::StateFreeWalking &&
+           serf->free_walking_neg_dist1 == -128 &&
+           serf->free_walking_neg_dist2 == 1) ||
+          (serf->state == Serf::StateStoneCutting &&
+           serf->free_walking_neg_dist1 == 2)) {
         t += 0x1200;
       } else {
         t += 0xd00;
       }
-    } else if (t == 0x85 || (t == 0x86 && !serf->playing_sfx())) {
-      serf->start_playing_sfx();
+    } else if (t == 0x85 ||
+               (t == 0x86 && !playing_sfx(serf_sfx, serf->index))) {
+      set_playing_sfx(&serf_sfx, serf->index, true);
       play_sound(Audio::TypeSfxPickBlow);
       t += 0x1280;
     } else if (t != 0x86) {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x1280;
     }
     break;
   case Serf::TypeForester:
     if (t < 0x80) {
       t += 0xe00;
-    } else if (t == 0x86 || (t == 0x87 && !serf->playing_sfx())) {
-      serf->start_playing_sfx();
+    } else if (t == 0x86 ||
+               (t == 0x87 && !playing_sfx(serf_sfx, serf->index))) {
+      set_playing_sfx(&serf_sfx, serf->index, true);
       play_sound(Audio::TypeSfxPlanting);
       t += 0x1080;
     } else if (t != 0x87) {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x1080;
     }
     break;
   case Serf::TypeMiner:
     if (t < 0x80) {
-      if ((serf->get_state() != Serf::StateMining ||
-           serf->get_mining_res() == 0) &&
-          (serf->get_state() != Serf::StateLeavingBuilding ||
-           serf->get_leaving_building_next_state() !=
+      if ((serf->state != Serf::StateMining ||
+           serf->mining_res == 0) &&
+          (serf->state != Serf::StateLeavingBuilding ||
+           serf->leaving_building_next_state !=
            Serf::StateDropResourceOut)) {
         t += 0x1800;
       } else {
         Resource::Type res = Resource::TypeNone;
 
-        switch (serf->get_state()) {
+        switch (serf->state) {
         case Serf::StateMining:
-          res = (Resource::Type)(serf->get_mining_res() - 1);
+          res = (Resource::Type)(serf->mining_res - 1);
           break;
         case Serf::StateLeavingBuilding:
-          res = (Resource::Type)(serf->get_leaving_building_field_B() - 1);
+          res = (Resource::Type)(serf->leaving_building_field_B - 1);
           break;
         default:
           NOT_REACHED();
@@ -1568,10 +1588,10 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypeSmelter:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
           Serf::StateDropResourceOut) {
-        if (serf->get_leaving_building_field_B() == 1 + Resource::TypeSteel) {
+        if (serf->leaving_building_field_B == 1 + Resource::TypeSteel) {
           t += 0x2900;
         } else {
           t += 0x2800;
@@ -1586,9 +1606,9 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypeFisher:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateFreeWalking &&
-          serf->get_free_walking_neg_dist1() == -128 &&
-          serf->get_free_walking_neg_dist2() == 1) {
+      if (serf->state == Serf::StateFreeWalking &&
+          serf->free_walking_neg_dist1 == -128 &&
+          serf->free_walking_neg_dist2 == 1) {
         t += 0x2f00;
       } else {
         t += 0x2c00;
@@ -1599,7 +1619,7 @@ Viewport::serf_get_body(Serf *serf) {
       }
 
       /* TODO no check for state */
-      if (serf->get_free_walking_neg_dist2() == 1) {
+      if (serf->free_walking_neg_dist2 == 1) {
         t += 0x2d80;
       } else {
         t += 0x2c80;
@@ -1608,8 +1628,8 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypePigFarmer:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x3400;
       } else {
@@ -1621,8 +1641,8 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypeButcher:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x3a00;
       } else {
@@ -1631,42 +1651,43 @@ Viewport::serf_get_body(Serf *serf) {
     } else {
       /* edi10 += 4; */
       if ((t == 0xb2 || t == 0xba || t == 0xc2 || t == 0xca) &&
-          !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+          !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxBackswordBlow);
       } else if (t != 0xb2 && t != 0xba && t != 0xc2 && t != 0xca) {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
       }
       t += 0x3780;
     }
     break;
   case Serf::TypeFarmer:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateFreeWalking &&
-          serf->get_free_walking_neg_dist1() == -128 &&
-          serf->get_free_walking_neg_dist2() == 1) {
+      if (serf->state == Serf::StateFreeWalking &&
+          serf->free_walking_neg_dist1 == -128 &&
+          serf->free_walking_neg_dist2 == 1) {
         t += 0x4000;
       } else {
         t += 0x3d00;
       }
     } else {
       /* TODO access to state without state check */
-      if (serf->get_free_walking_neg_dist1() == 0) {
+      if (serf->free_walking_neg_dist1 == 0) {
         t += 0x3d80;
-      } else if (t == 0x83 || (t == 0x84 && !serf->playing_sfx())) {
-        serf->start_playing_sfx();
+      } else if (t == 0x83 ||
+                 (t == 0x84 && !playing_sfx(serf_sfx, serf->index))) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxMowing);
         t += 0x3e80;
       } else if (t != 0x83 && t != 0x84) {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
         t += 0x3e80;
       }
     }
     break;
   case Serf::TypeMiller:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x4500;
       } else {
@@ -1679,8 +1700,8 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypeBaker:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x4a00;
       } else {
@@ -1693,30 +1714,30 @@ Viewport::serf_get_body(Serf *serf) {
     break;
   case Serf::TypeBoatBuilder:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
         t += 0x5000;
       } else {
         t += 0x4e00;
       }
     } else if (t == 0x84 || t == 0x85) {
-      if (t == 0x84 || !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+      if (t == 0x84 || !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxWoodHammering);
       }
       t += 0x4e80;
     } else {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x4e80;
     }
     break;
   case Serf::TypeToolmaker:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
-        switch (serf->get_leaving_building_field_B() - 1) {
+        switch (serf->leaving_building_field_B - 1) {
           case Resource::TypeShovel: t += 0x5a00; break;
           case Resource::TypeHammer: t += 0x5b00; break;
           case Resource::TypeRod: t += 0x5c00; break;
@@ -1733,24 +1754,25 @@ Viewport::serf_get_body(Serf *serf) {
       }
     } else {
       /* edi10 += 4; */
-      if (t == 0x83 || (t == 0xb2 && !serf->playing_sfx())) {
-        serf->start_playing_sfx();
+      if (t == 0x83 || (t == 0xb2 && !playing_sfx(serf_sfx, serf->index))) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxSawing);
-      } else if (t == 0x87 || (t == 0xb6 && !serf->playing_sfx())) {
-        serf->start_playing_sfx();
+      } else if (t == 0x87 ||
+                 (t == 0xb6 && !playing_sfx(serf_sfx, serf->index))) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxWoodHammering);
       } else if (t != 0xb2 && t != 0xb6) {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
       }
       t += 0x5880;
     }
     break;
   case Serf::TypeWeaponSmith:
     if (t < 0x80) {
-      if (serf->get_state() == Serf::StateLeavingBuilding &&
-          serf->get_leaving_building_next_state() ==
+      if (serf->state == Serf::StateLeavingBuilding &&
+          serf->leaving_building_next_state ==
             Serf::StateDropResourceOut) {
-        if (serf->get_leaving_building_field_B() == 1+Resource::TypeSword) {
+        if (serf->leaving_building_field_B == 1+Resource::TypeSword) {
           t += 0x5500;
         } else {
           t += 0x5400;
@@ -1760,11 +1782,11 @@ Viewport::serf_get_body(Serf *serf) {
       }
     } else {
       /* edi10 += 4; */
-      if (t == 0x83 || (t == 0x84 && !serf->playing_sfx())) {
-        serf->start_playing_sfx();
+      if (t == 0x83 || (t == 0x84 && !playing_sfx(serf_sfx, serf->index))) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxMetalHammering);
       } else if (t != 0x84) {
-        serf->stop_playing_sfx();
+        set_playing_sfx(&serf_sfx, serf->index, false);
       }
       t += 0x5280;
     }
@@ -1773,19 +1795,19 @@ Viewport::serf_get_body(Serf *serf) {
     if (t < 0x80) {
       t += 0x3900;
     } else if (t == 0x83 || t == 0x84 || t == 0x86) {
-      if (t == 0x83 || !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+      if (t == 0x83 || !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxGeologistSampling);
       }
       t += 0x4c80;
     } else if (t == 0x8c || t == 0x8d) {
-      if (t == 0x8c || !serf->playing_sfx()) {
-        serf->start_playing_sfx();
+      if (t == 0x8c || !playing_sfx(serf_sfx, serf->index)) {
+        set_playing_sfx(&serf_sfx, serf->index, true);
         play_sound(Audio::TypeSfxResourceFound);
       }
       t += 0x4c80;
     } else {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
       t += 0x4c80;
     }
     break;
@@ -1794,21 +1816,21 @@ Viewport::serf_get_body(Serf *serf) {
   case Serf::TypeKnight2:
   case Serf::TypeKnight3:
   case Serf::TypeKnight4: {
-    int k = serf->get_type() - Serf::TypeKnight0;
+    int k = serf->type - Serf::TypeKnight0;
 
     if (t < 0x80) {
       t += 0x7800 + 0x100*k;
     } else if (t < 0xc0) {
-      if (serf->get_state() == Serf::StateKnightAttacking ||
-          serf->get_state() == Serf::StateKnightAttackingFree) {
-        if (serf->get_counter() >= 24 || serf->get_counter() < 8) {
-          serf->stop_playing_sfx();
-        } else if (!serf->playing_sfx()) {
-          serf->start_playing_sfx();
-          if (serf->get_attacking_field_D() == 0 ||
-              serf->get_attacking_field_D() == 4) {
+      if (serf->state == Serf::StateKnightAttacking ||
+          serf->state == Serf::StateKnightAttackingFree) {
+        if (serf->counter >= 24 || serf->counter < 8) {
+          set_playing_sfx(&serf_sfx, serf->index, false);
+        } else if (!playing_sfx(serf_sfx, serf->index)) {
+          set_playing_sfx(&serf_sfx, serf->index, true);
+          if (serf->attacking_field_D == 0 ||
+              serf->attacking_field_D == 4) {
             play_sound(Audio::TypeSfxFight01);
-          } else if (serf->get_attacking_field_D() == 2) {
+          } else if (serf->attacking_field_D == 2) {
             /* TODO when is TypeSfxFight02 played? */
             play_sound(Audio::TypeSfxFight03);
           } else {
@@ -1824,13 +1846,13 @@ Viewport::serf_get_body(Serf *serf) {
   }
     break;
   case Serf::TypeDead:
-    if ((!serf->playing_sfx() &&
+    if ((!playing_sfx(serf_sfx, serf->index) &&
          (t == 2 || t == 5)) ||
         (t == 1 || t == 4)) {
-      serf->start_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, true);
       play_sound(Audio::TypeSfxSerfDying);
     } else {
-      serf->stop_playing_sfx();
+      set_playing_sfx(&serf_sfx, serf->index, false);
     }
     t += 0x8700;
     break;
@@ -1843,7 +1865,8 @@ Viewport::serf_get_body(Serf *serf) {
 }
 
 void
-Viewport::draw_active_serf(Serf *serf, MapPos pos, int x_base, int y_base) {
+Viewport::draw_active_serf(const SerfState *serf, MapPos pos, int x_base,
+                           int y_base) {
   const int arr_4[] = {
      9, 5,
     10, 7,
@@ -1867,79 +1890,80 @@ Viewport::draw_active_serf(Serf *serf, MapPos pos, int x_base, int y_base) {
      0, 0
   };
 
-  if ((serf->get_animation() < 0) || (serf->get_animation() > 199) ||
-      (serf->get_counter() < 0)) {
-    Log::Error["viewport"] << "bad animation for serf #" << serf->get_index()
-                           << " (" << Serf::get_state_name(serf->get_state())
-                           << "): " << serf->get_animation()
-                           << "," << serf->get_counter();
+  if ((serf->animation < 0) || (serf->animation > 199) ||
+      (serf->counter < 0)) {
+    Log::Error["viewport"] << "bad animation for serf #" << serf->index
+                           << " (" << Serf::get_state_name(serf->state)
+                           << "): " << serf->animation
+                           << "," << serf->counter;
     return;
   }
 
-  Data::Animation animation = data_source->get_animation(serf->get_animation(),
-                                                         serf->get_counter());
+  Data::Animation animation = data_source->get_animation(serf->animation,
+                                                         serf->counter);
 
   int lx = x_base + animation.x;
   int ly = y_base + animation.y - 4 * map->get_height(pos);
   int body = serf_get_body(serf);
 
   if (body > -1) {
-    Color color = interface->get_player_color(serf->get_owner());
+    Color color = interface->get_player_color(serf->owner);
     draw_row_serf(lx, ly, true, color, body);
     if (layers & Layer::LayerGrid) {
-      frame->draw_number(lx, ly, serf->get_index(), Color(0, 0, 128));
-      frame->draw_string(lx, ly + 8, serf->print_state(),  Color(0, 0, 128));
+      frame->draw_number(lx, ly, serf->index, Color(0, 0, 128));
+      frame->draw_string(lx, ly + 8, Serf::get_state_name(serf->state),
+                         Color(0, 0, 128));
     }
   }
 
   /* Draw additional serf */
-  if (serf->get_state() == Serf::StateKnightEngagingBuilding ||
-      serf->get_state() == Serf::StateKnightPrepareAttacking ||
-      serf->get_state() == Serf::StateKnightAttacking ||
-      serf->get_state() == Serf::StateKnightPrepareAttackingFree ||
-      serf->get_state() == Serf::StateKnightAttackingFree ||
-      serf->get_state() == Serf::StateKnightAttackingVictoryFree ||
-      serf->get_state() == Serf::StateKnightAttackingDefeatFree ||
-      serf->get_state() == Serf::StateKnightAttackingVictory) {
-    int index = serf->get_attacking_def_index();
-    if (index != 0) {
-      Serf *def_serf = interface->get_game()->get_serf(index);
-
+  if (serf->state == Serf::StateKnightEngagingBuilding ||
+      serf->state == Serf::StateKnightPrepareAttacking ||
+      serf->state == Serf::StateKnightAttacking ||
+      serf->state == Serf::StateKnightPrepareAttackingFree ||
+      serf->state == Serf::StateKnightAttackingFree ||
+      serf->state == Serf::StateKnightAttackingVictoryFree ||
+      serf->state == Serf::StateKnightAttackingDefeatFree ||
+      serf->state == Serf::StateKnightAttackingVictory) {
+    int index = serf->attacking_def_index;
+    const SerfState *def_serf = (index != 0) ? snapshot->get_serf(index) :
+                                               nullptr;
+    if (def_serf != nullptr) {
       Data::Animation animation =
-                           data_source->get_animation(def_serf->get_animation(),
-                                                      def_serf->get_counter());
+                           data_source->get_animation(def_serf->animation,
+                                                      def_serf->counter);
 
       int lx = x_base + animation.x;
       int ly = y_base + animation.y - 4 * map->get_height(pos);
       int body = serf_get_body(def_serf);
 
       if (body > -1) {
-        Color color = interface->get_player_color(def_serf->get_owner());
+        Color color = interface->get_player_color(def_serf->owner);
         draw_row_serf(lx, ly, true, color, body);
       }
     }
   }
 
   /* Draw extra objects for fight */
-  if ((serf->get_state() == Serf::StateKnightAttacking ||
-       serf->get_state() == Serf::StateKnightAttackingFree) &&
+  if ((serf->state == Serf::StateKnightAttacking ||
+       serf->state == Serf::StateKnightAttackingFree) &&
       animation.sprite >= 0x80 && animation.sprite < 0xc0) {
-    int index = serf->get_attacking_def_index();
-    if (index != 0) {
-      Serf *def_serf = interface->get_game()->get_serf(index);
-
-      if (serf->get_animation() >= 146 && serf->get_animation() < 156) {
-        if ((serf->get_attacking_field_D() == 0 ||
-             serf->get_attacking_field_D() == 4) &&
-            serf->get_counter() < 32) {
+    int index = serf->attacking_def_index;
+    const SerfState *def_serf = (index != 0) ? snapshot->get_serf(index) :
+                                               nullptr;
+    if (def_serf != nullptr) {
+      if (serf->animation >= 146 && serf->animation < 156) {
+        if ((serf->attacking_field_D == 0 ||
+             serf->attacking_field_D == 4) &&
+            serf->counter < 32) {
           int anim = -1;
-          if (serf->get_attacking_field_D() == 0) {
-            anim = serf->get_animation() - 147;
+          if (serf->attacking_field_D == 0) {
+            anim = serf->animation - 147;
           } else {
-            anim = def_serf->get_animation() - 147;
+            anim = def_serf->animation - 147;
           }
 
-          int sprite = 198 + ((serf->get_counter() >> 3) ^ 3);
+          int sprite = 198 + ((serf->counter >> 3) ^ 3);
           draw_game_sprite(lx + arr_4[2*anim], ly - arr_4[2*anim+1], sprite);
         }
       }
@@ -2001,13 +2025,14 @@ Viewport::draw_serf_row(MapPos pos, int y_base, int cols, int x_base) {
 
     /* Active serf */
     if (map->has_serf(pos)) {
-      Serf *serf = interface->get_game()->get_serf_at_pos(pos);
-
-      if (serf->get_state() != Serf::StateMining ||
-          (serf->get_mining_substate() != 3 &&
-           serf->get_mining_substate() != 4 &&
-           serf->get_mining_substate() != 9 &&
-           serf->get_mining_substate() != 10)) {
+      const SerfState *serf = snapshot->get_serf_at_pos(pos);
+
+      if (serf != nullptr &&
+          (serf->state != Serf::StateMining ||
+           (serf->mining_substate != 3 &&
+            serf->mining_substate != 4 &&
+            serf->mining_substate != 9 &&
+            serf->mining_substate != 10))) {
             draw_active_serf(serf, pos, x_base, y_base);
           }
     }
@@ -2023,7 +2048,7 @@ Viewport::draw_serf_row(MapPos pos, int y_base, int cols, int x_base) {
         lx = x_base + arr_3[2* map->paths(pos)];
         ly = y_base - 4 * map->get_height(pos) +
             arr_3[2 * map->paths(pos) + 1];
-        body = arr_2[((interface->get_game()->get_tick() +
+        body = arr_2[((snapshot->get_tick() +
                        arr_1[pos & 0xf]) >> 3) & 0x7f];
       }
 
@@ -2041,13 +2066,13 @@ Viewport::draw_serf_row_behind(MapPos pos, int y_base, int cols, int x_base) {
        i++, x_base += MAP_TILE_WIDTH, pos = map->move_right(pos)) {
     /* Active serf */
     if (map->has_serf(pos)) {
-      Serf *serf = interface->get_game()->get_serf_at_pos(pos);
+      const SerfState *serf = snapshot->get_serf_at_pos(pos);
 
-      if (serf->get_state() == Serf::StateMining &&
-          (serf->get_mining_substate() == 3 ||
-           serf->get_mining_substate() == 4 ||
-           serf->get_mining_substate() == 9 ||
-           serf->get_mining_substate() == 10)) {
+      if (serf != nullptr && serf->state == Serf::StateMining &&
+          (serf->mining_substate == 3 ||
+           serf->mining_substate == 4 ||
+           serf->mining_substate == 9 ||
+           serf->mining_substate == 10)) {
             draw_active_serf(serf, pos, x_base, y_base);
           }
     }
@@ -2129,7 +2154,11 @@ Viewport::draw_map_cursor_possible_build() {
   int y_off = 0;
   MapPos base_pos = get_offset(&x_off, &y_off);
 
+  // Which spots are free depends on the whole neighbourhood, so ask the
+  // game itself.
+  std::unique_lock<GameThread> lock = interface->lock_game();
   PGame game = interface->get_game();
+  Map *live = game->get_map();
 
   for (int x_base = x_off; x_base < width + MAP_TILE_WIDTH;
        x_base += MAP_TILE_WIDTH) {
@@ -2153,10 +2182,11 @@ Viewport::draw_map_cursor_possible_build() {
       if (game->can_build_castle(pos, interface->get_player())) {
         sprite = 50;
       } else if (game->can_player_build(pos, interface->get_player()) &&
-                 Map::map_space_from_obj[map->get_obj(pos)] == Map::SpaceOpen &&
+                 Map::map_space_from_obj[live->get_obj(pos)] ==
+                   Map::SpaceOpen &&
                  (game->can_build_flag(map->move_down_right(pos),
                                        interface->get_player()) ||
-                 map->has_flag(map->move_down_right(pos)))) {
+                 live->has_flag(map->move_down_right(pos)))) {
         if (game->can_build_mine(pos)) {
           sprite = 48;
         } else if (game->can_build_large(pos)) {
@@ -2348,8 +2378,6 @@ Viewport::handle_click_left(int lx, int ly) {
           play_sound(Audio::TypeSfxNotAccepted);
         } else if (r == 0) {
           play_sound(Audio::TypeSfxClick);
-        } else {
-          play_sound(Audio::TypeSfxAccepted);
         }
       }
     }
@@ -2368,78 +2396,86 @@ Viewport::handle_dbl_click(int lx, int ly, Event::Button button) {
   set_redraw();
 
   Player *player = interface->get_player();
+  unsigned int index = player->get_index();
+  Map *live = interface->get_game()->get_map();
 
   MapPos clk_pos = map_pos_from_screen_pix(lx, ly);
 
   if (interface->is_building_road()) {
     if (clk_pos != interface->get_map_cursor_pos()) {
-      MapPos pos = interface->get_building_road().get_end(map.get());
-      Road road = pathfinder_map(map.get(), pos, clk_pos,
+      MapPos pos = interface->get_building_road().get_end(live);
+      Road road = pathfinder_map(live, pos, clk_pos,
                                  &interface->get_building_road());
       if (road.get_length() != 0) {
         int r = interface->extend_road(road);
         if (r < 0) {
           play_sound(Audio::TypeSfxNotAccepted);
-        } else if (r == 1) {
-          play_sound(Audio::TypeSfxAccepted);
-        } else {
+        } else if (r == 0) {
           play_sound(Audio::TypeSfxClick);
         }
       } else {
         play_sound(Audio::TypeSfxNotAccepted);
       }
     } else {
-      bool r = interface->get_game()->build_flag(
-                                                interface->get_map_cursor_pos(),
-                                                 player);
-      if (r) {
-        interface->build_road();
-      } else {
-        play_sound(Audio::TypeSfxNotAccepted);
-      }
+      interface->build_road();
     }
   } else {
-    if (map->get_obj(clk_pos) == Map::ObjectNone ||
-        map->get_obj(clk_pos) > Map::ObjectCastle) {
+    if (live->get_obj(clk_pos) == Map::ObjectNone ||
+        live->get_obj(clk_pos) > Map::ObjectCastle) {
       return false;
     }
 
-    if (map->get_obj(clk_pos) == Map::ObjectFlag) {
-      if (map->get_owner(clk_pos) == player->get_index()) {
-        interface->open_popup(PopupBox::TypeTransportInfo);
-      }
-
-      player->temp_index = map->get_obj_index(clk_pos);
+    unsigned int obj_index = live->get_obj_index(clk_pos);
+    if (live->get_obj(clk_pos) == Map::ObjectFlag) {
+      bool own = (live->get_owner(clk_pos) == index);
+      interface->run_on_game([index, obj_index](Game *target) {
+        target->get_player(index)->temp_index = obj_index;
+        return (target->get_flag(obj_index) != nullptr);
+      }, [this, own](bool exists) {
+        if (own && exists) {
+          interface->open_popup(PopupBox::TypeTransportInfo);
+        }
+      });
     } else { /* Building */
       Building *building = interface->get_game()->get_building_at_pos(clk_pos);
       if ((building == nullptr) || building->is_burning()) {
         return false;
       }
-      if (map->get_owner(clk_pos) == player->get_index()) {
+      if (live->get_owner(clk_pos) == index) {
+        PopupBox::Type box;
         if (!building->is_done()) {
-          interface->open_popup(PopupBox::TypeOrderedBld);
+          box = PopupBox::TypeOrderedBld;
         } else if (building->get_type() == Building::TypeCastle) {
-          interface->open_popup(PopupBox::TypeCastleRes);
+          box = PopupBox::TypeCastleRes;
         } else if (building->get_type() == Building::TypeStock) {
           if (!building->is_active()) return 0;
-          interface->open_popup(PopupBox::TypeCastleRes);
+          box = PopupBox::TypeCastleRes;
         } else if (building->get_type() == Building::TypeHut ||
                    building->get_type() == Building::TypeTower ||
                    building->get_type() == Building::TypeFortress) {
-          interface->open_popup(PopupBox::TypeDefenders);
+          box = PopupBox::TypeDefenders;
         } else if (building->get_type() == Building::TypeStoneMine ||
                    building->get_type() == Building::TypeCoalMine ||
                    building->get_type() == Building::TypeIronMine ||
                    building->get_type() == Building::TypeGoldMine) {
-          interface->open_popup(PopupBox::TypeMineOutput);
+          box = PopupBox::TypeMineOutput;
         } else {
-          interface->open_popup(PopupBox::TypeBldStock);
+          box = PopupBox::TypeBldStock;
         }
 
-        player->temp_index = map->get_obj_index(clk_pos);
+        interface->run_on_game([index, obj_index](Game *target) {
+          target->get_player(index)->temp_index = obj_index;
+          return (target->get_building(obj_index) != nullptr);
+        }, [this, box](bool exists) {
+          if (exists) {
+            interface->open_popup(box);
+          }
+        });
       } else { /* Foreign building */
         /* TODO handle coop mode*/
-        player->building_attacked = building->get_index();
+        interface->run_on_game([index, obj_index](Game *target) {
+          target->get_player(index)->building_attacked = obj_index;
+        });
 
         if (building->is_done() &&
             building->is_military()) {
@@ -2454,10 +2490,9 @@ Viewport::handle_dbl_click(int lx, int ly, Event::Button button) {
 
           int found = 0;
           for (int i = 257; i >= 0; i--) {
-            MapPos pos = map->pos_add_spirally(building->get_position(),
-                                                       7+257-i);
-            if (map->has_owner(pos)
-                && map->get_owner(pos) == player->get_index()) {
+            MapPos pos = live->pos_add_spirally(building->get_position(),
+                                                7+257-i);
+            if (live->has_owner(pos) && live->get_owner(pos) == index) {
               found = 1;
               break;
             }
@@ -2480,10 +2515,15 @@ Viewport::handle_dbl_click(int lx, int ly, Event::Button button) {
             default: NOT_REACHED(); break;
           }
 
-          int knights =
-                 player->knights_available_for_attack(building->get_position());
-          player->knights_attacking = std::min(knights, max_knights);
-          interface->open_popup(PopupBox::TypeStartAttack);
+          MapPos pos = building->get_position();
+          interface->run_on_game([index, pos, max_knights](Game *target) {
+            Player *attacker = target->get_player(index);
+            int knights = attacker->knights_available_for_attack(pos);
+            attacker->knights_attacking = std::min(knights, max_knights);
+            return attacker->knights_attacking;
+          }, [this](int) {
+            interface->open_popup(PopupBox::TypeStartAttack);
+          });
         }
       }
     }
@@ -2501,10 +2541,11 @@ Viewport::handle_drag(int lx, int ly) {
   return true;
 }
 
-Viewport::Viewport(Interface *_interface, PMap _map)
+Viewport::Viewport(Interface *_interface, SnapshotPublisher::View _view)
   : interface(_interface)
-  , map(_map) {
-  map->add_change_handler(this);
+  , view(_view) {
+  snapshot = interface->get_snapshot();
+  map = snapshot->get_map();
   layers = LayerAll;
 
   offset_x = 0;
@@ -2516,18 +2557,12 @@ Viewport::Viewport(Interface *_interface, PMap _map)
 }
 
 Viewport::~Viewport() {
-  map->del_change_handler(this);
 }
 
 void
-Viewport::on_height_changed(MapPos pos) {
-  redraw_map_pos(pos);
-}
-
-void
-Viewport::on_object_changed(MapPos pos) {
-  if (interface->get_map_cursor_pos() == pos) {
-    interface->update_map_cursor_pos(pos);
+Viewport::play_sound(int sound) {
+  if (view == SnapshotPublisher::ViewMain) {
+    GuiObject::play_sound(sound);
   }
 }
 
@@ -2688,6 +2723,7 @@ Viewport::move_to_map_pos(MapPos pos) {
   offset_x = mx;
   offset_y = my;
 
+  update_view();
   set_redraw();
 }
 
@@ -2710,15 +2746,49 @@ Viewport::move_by_pixels(int lx, int ly) {
   if (offset_x >= lwidth) offset_x -= lwidth;
   else if (offset_x < 0) offset_x += lwidth;
 
+  update_view();
   set_redraw();
 }
 
 
-/* Called periodically when the game progresses. */
+/* Ask for the tiles that draw_game_objects() covers in later snapshots,
+   with a margin for high ground below the view and objects wider than a
+   tile. */
+void
+Viewport::update_view() {
+  SnapshotPublisher *snapshots = interface->get_snapshots();
+  if (snapshots == nullptr) {
+    return;
+  }
+
+  int col = 0;
+  int row = 0;
+  get_offset(nullptr, nullptr, &col, &row);
+
+  unsigned int rows = height / MAP_TILE_HEIGHT + 10;
+  unsigned int cols = width / MAP_TILE_WIDTH + rows / 2 + 4;
+  snapshots->set_view(view, map->pos_add(map->pos(col, row), -2, -2), cols,
+                      rows);
+}
+
+/* Called when the interface takes a new snapshot. */
 void
 Viewport::update() {
-  int tick_xor = interface->get_game()->get_tick() ^ last_tick;
-  last_tick = interface->get_game()->get_tick();
+  snapshot = interface->get_snapshot();
+  map = snapshot->get_map();
+
+  if (snapshot->are_changes_lost()) {
+    landscape_tiles.clear();
+  } else {
+    for (const RenderSnapshot::Change &change : snapshot->get_changes()) {
+      if (change.height) {
+        redraw_map_pos(change.pos);
+      }
+    }
+  }
+
+  int tick_xor = snapshot->get_tick() ^ last_tick;
+  last_tick = snapshot->get_tick();
 
   /* Viewport animation does not care about low bits in anim */
   if (tick_xor >= 1 << 3) {
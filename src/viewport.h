@@ -24,15 +24,19 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "src/gui.h"
 #include "src/map.h"
 #include "src/building.h"
+#include "src/render-snapshot.h"
 
 class Interface;
 class DataSource;
 
-class Viewport : public GuiObject, public Map::Handler {
+// Draws the map from the snapshot that Interface took last, never from the
+// game itself.
+class Viewport : public GuiObject {
  public:
   typedef enum Layer {
     LayerLandscape = 1<<0,
@@ -50,6 +54,9 @@ class Viewport : public GuiObject, public Map::Handler {
   } Layer;
 
  protected:
+  typedef RenderSnapshot::SerfState SerfState;
+  typedef RenderSnapshot::BuildingState BuildingState;
+
   /* Cache prerendered tiles of the landscape. */
   typedef std::map<unsigned int, std::unique_ptr<Frame>> TilesMap;
   TilesMap landscape_tiles;
@@ -60,13 +67,22 @@ class Viewport : public GuiObject, public Map::Handler {
   unsigned int last_tick;
   Data::PSource data_source;
 
-  PMap map;
+  const RenderSnapshot *snapshot;
+  const Map *map;
+  SnapshotPublisher::View view;
+
+  // Sound effects playing, by serf and building index.
+  std::vector<bool> serf_sfx;
+  std::vector<bool> building_sfx;
 
  public:
-  Viewport(Interface *interface, PMap map);
+  explicit Viewport(Interface *interface,
+                    SnapshotPublisher::View view = SnapshotPublisher::ViewMain);
   virtual ~Viewport();
 
   void switch_layer(Layer layer) { layers ^= layer; }
+  unsigned int get_layers() const { return layers; }
+  void set_layers(unsigned int _layers) { layers = _layers; set_redraw(); }
 
   void move_to_map_pos(MapPos pos);
   void move_by_pixels(int x, int y);
@@ -100,19 +116,21 @@ class Viewport : public GuiObject, public Map::Handler {
                                        const Color &color = Color::transparent);
   void draw_shadow_and_building_unfinished(int x, int y, int index,
                                            int progress);
-  void draw_building_unfinished(Building *building, Building::Type bld_type,
-                                int x, int y);
-  void draw_ocupation_flag(Building *building, int x, int y, float mul);
-  void draw_unharmed_building(Building *building, int x, int y);
-  void draw_burning_building(Building *building, int x, int y);
+  void draw_building_unfinished(const BuildingState *building,
+                                Building::Type bld_type, int x, int y);
+  void draw_ocupation_flag(const BuildingState *building, int x, int y,
+                           float mul);
+  void draw_unharmed_building(const BuildingState *building, int x, int y);
+  void draw_burning_building(const BuildingState *building, int x, int y);
   void draw_building(MapPos pos, int x, int y);
   void draw_water_waves(MapPos pos, int x, int y);
   void draw_water_waves_row(MapPos pos, int y_base, int cols, int x_base);
   void draw_flag_and_res(MapPos pos, int x, int y);
   void draw_map_objects_row(MapPos pos, int y_base, int cols, int x_base);
   void draw_row_serf(int x, int y, bool shadow, const Color &color, int body);
-  int serf_get_body(Serf *serf);
-  void draw_active_serf(Serf *serf, MapPos pos, int x_base, int y_base);
+  int serf_get_body(const SerfState *serf);
+  void draw_active_serf(const SerfState *serf, MapPos pos, int x_base,
+                        int y_base);
   void draw_serf_row(MapPos pos, int y_base, int cols, int x_base);
   void draw_serf_row_behind(MapPos pos, int y_base, int cols, int x_base);
   void draw_game_objects(int layers);
@@ -123,6 +141,7 @@ class Viewport : public GuiObject, public Map::Handler {
   void draw_height_grid_overlay(const Color &color);
   MapPos get_offset(int *x_off, int *y_off,
                     int *col = nullptr, int *row = nullptr);
+  void update_view();
 
   virtual void internal_draw();
   virtual void layout();
@@ -131,10 +150,9 @@ class Viewport : public GuiObject, public Map::Handler {
   virtual bool handle_drag(int x, int y);
 
   Frame *get_tile_frame(unsigned int tid, int tc, int tr);
-
- public:
-  virtual void on_height_changed(MapPos pos);
-  virtual void on_object_changed(MapPos pos);
+  // Silent unless this is the main view, as a popup view is drawn anew
+  // every time and would repeat sound effects.
+  void play_sound(int sound);
 };
 
 #endif  // SRC_VIEWPORT_H_
@@ -0,0 +1,247 @@
+/*
+ * test_bitplanes.cc - test table driven bitplane conversion
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "src/bitplanes.h"
+
+typedef Bitplanes::Color Color;
+typedef std::vector<uint8_t> Bytes;
+typedef std::vector<Color> Pixels;
+
+// Bit by bit conversions, as the Amiga data source did them before.
+
+static uint8_t
+invert5bit(uint8_t src) {
+  uint8_t res = 0;
+  for (int i = 0; i < 5; i++) {
+    res <<= 1;
+    res |= (src & 0x01);
+    src >>= 1;
+  }
+  return res;
+}
+
+static void
+set_color(Color *res, const uint8_t *palette, uint8_t color) {
+  res->red = palette[color*3+0];
+  res->green = palette[color*3+1];
+  res->blue = palette[color*3+2];
+  res->alpha = 0xFF;
+}
+
+static void
+reference_planar(Color *res, const uint8_t *src, size_t width, size_t height,
+                 uint8_t compression, uint8_t filling,
+                 const uint8_t *palette, bool invert) {
+  size_t bps = width * height;
+  for (size_t i = 0; i < bps; i++) {
+    for (int k = 7; k >= 0; k--) {
+      uint8_t color = 0;
+      int n = 0;
+      for (size_t b = 0; b < 5; b++) {
+        color = color << 1;
+        if ((compression >> b) & 0x01) {
+          if ((filling >> b) & 0x01) {
+            color |= 0x01;
+          }
+        } else {
+          color |= ((*(src+(n*bps)) >> k) & 0x01);
+          n++;
+        }
+      }
+      if (invert) {
+        color = invert5bit(color);
+      }
+      set_color(res++, palette, color);
+    }
+    src++;
+  }
+}
+
+static void
+reference_interlaced(Color *res, const uint8_t *src,
+                     size_t width, size_t height,
+                     uint8_t compression, uint8_t filling,
+                     const uint8_t *palette, size_t skip_lines) {
+  size_t bpp = Bitplanes::get_plane_count(compression);
+  for (size_t y = 0; y < height; y++) {
+    for (size_t i = 0; i < width; i++) {
+      for (int k = 7; k >= 0; k--) {
+        uint8_t color = 0;
+        int n = 0;
+        for (size_t b = 0; b < 5; b++) {
+          color = color << 1;
+          if ((compression >> b) & 0x01) {
+            if ((filling >> b) & 0x01) {
+              color |= 0x01;
+            }
+          } else {
+            color |= ((*(src+(n*width)+((skip_lines*width*y))) >> k) & 0x01);
+            n++;
+          }
+        }
+        set_color(res++, palette, invert5bit(color));
+      }
+      src++;
+    }
+    src += (bpp-1) * width;
+  }
+}
+
+static void
+reference_sprite(Color *res, const uint8_t *src_1, size_t width,
+                 size_t height, const uint8_t *palette) {
+  const uint8_t *src_2 = src_1 + width * 2 * height;
+  for (size_t y = 0; y < height; y++) {
+    for (size_t i = 0; i < width; i++) {
+      for (int k = 7; k >= 0; k--) {
+        uint8_t color = 0;
+        color |= (((*src_1) >> k) & 0x01) << 0;
+        color |= (((*(src_1 + width)) >> k) & 0x01) << 1;
+        color |= (((*src_2) >> k) & 0x01) << 2;
+        color |= (((*(src_2 + width)) >> k) & 0x01) << 3;
+        color |= 0x10;
+        set_color(res++, palette, color);
+      }
+      src_1++;
+      src_2++;
+    }
+    src_1 += width;
+    src_2 += width;
+  }
+}
+
+static void
+reference_mask(Color *res, const uint8_t *src, size_t size) {
+  uint32_t *pixel = reinterpret_cast<uint32_t*>(res);
+  for (size_t i = 0; i < size; i++) {
+    uint8_t byte = src[i];
+    for (unsigned int j = 0; j < 8; j++) {
+      *pixel++ = ((byte >> (7-j)) & 0x01) ? 0xFFFFFFFF : 0x00000000;
+    }
+  }
+}
+
+class BitplanesTest : public ::testing::Test {
+ protected:
+  std::mt19937 rng;
+  Bytes palette;
+
+  virtual void SetUp() {
+    rng.seed(42);
+    palette = random_bytes(32 * 3);
+  }
+
+  Bytes random_bytes(size_t size) {
+    Bytes bytes(size);
+    for (size_t i = 0; i < size; i++) {
+      bytes[i] = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+  }
+
+  static void expect_equal(const Pixels &expected, const Pixels &pixels) {
+    ASSERT_EQ(expected.size(), pixels.size());
+    EXPECT_EQ(0, memcmp(expected.data(), pixels.data(),
+                        expected.size() * sizeof(Color)));
+  }
+};
+
+TEST_F(BitplanesTest, Planar) {
+  for (unsigned int compression = 0; compression < 32; compression++) {
+    for (size_t width = 1; width < 6; width++) {
+      size_t height = 1 + (compression + width) % 7;
+      Bytes src = random_bytes(width * height * 5);
+      uint8_t filling = static_cast<uint8_t>(rng()) & 0x1F;
+      for (int invert = 0; invert < 2; invert++) {
+        Pixels expected(width * 8 * height);
+        Pixels pixels(width * 8 * height);
+        reference_planar(expected.data(), src.data(), width, height,
+                         compression, filling, palette.data(), invert != 0);
+        Bitplanes::decode_planar(pixels.data(), src.data(), width, height,
+                                 compression, filling, palette.data(),
+                                 invert != 0);
+        SCOPED_TRACE(compression);
+        expect_equal(expected, pixels);
+      }
+    }
+  }
+}
+
+TEST_F(BitplanesTest, Interlaced) {
+  for (unsigned int compression = 0; compression < 32; compression++) {
+    for (size_t skip_lines = 0; skip_lines < 3; skip_lines++) {
+      size_t width = 1 + compression % 5;
+      size_t height = 1 + skip_lines * 3 + compression % 4;
+      size_t line_size = (Bitplanes::get_plane_count(compression) +
+                          skip_lines) * width;
+      Bytes src = random_bytes(line_size * height + 5 * width);
+      uint8_t filling = static_cast<uint8_t>(rng()) & 0x1F;
+      Pixels expected(width * 8 * height);
+      Pixels pixels(width * 8 * height);
+      reference_interlaced(expected.data(), src.data(), width, height,
+                           compression, filling, palette.data(), skip_lines);
+      Bitplanes::decode_interlaced(pixels.data(), src.data(), width, height,
+                                   compression, filling, palette.data(),
+                                   skip_lines);
+      SCOPED_TRACE(compression);
+      expect_equal(expected, pixels);
+    }
+  }
+}
+
+TEST_F(BitplanesTest, Sprite) {
+  for (size_t width = 1; width < 12; width++) {
+    size_t height = 1 + width % 8;
+    Bytes src = random_bytes(width * 4 * height);
+    Pixels expected(width * 8 * height);
+    Pixels pixels(width * 8 * height);
+    reference_sprite(expected.data(), src.data(), width, height,
+                     palette.data());
+    Bitplanes::decode_sprite(pixels.data(), src.data(), width, height,
+                             palette.data());
+    expect_equal(expected, pixels);
+  }
+}
+
+TEST_F(BitplanesTest, Mask) {
+  Bytes src(256);
+  for (size_t value = 0; value < 256; value++) {
+    src[value] = static_cast<uint8_t>(value);
+  }
+  Pixels expected(src.size() * 8);
+  Pixels pixels(src.size() * 8);
+  reference_mask(expected.data(), src.data(), src.size());
+  Bitplanes::decode_mask(pixels.data(), src.data(), src.size());
+  expect_equal(expected, pixels);
+}
+
+TEST_F(BitplanesTest, PlaneCount) {
+  EXPECT_EQ(5u, Bitplanes::get_plane_count(0x00));
+  EXPECT_EQ(3u, Bitplanes::get_plane_count(0x18));
+  EXPECT_EQ(0u, Bitplanes::get_plane_count(0x1F));
+  EXPECT_EQ(4u, Bitplanes::get_plane_count(0xE0 | 0x01));
+}
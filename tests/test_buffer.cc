@@ -0,0 +1,88 @@
+/*
+ * test_buffer.cc - test buffers of mapped files
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "src/buffer.h"
+#include "src/debug.h"
+
+class MappedBufferTest : public ::testing::Test {
+ protected:
+  std::string path;
+  std::string content;
+
+  virtual void SetUp() {
+    path = "test_buffer.bin";
+    for (int i = 0; i < 10000; i++) {
+      content.push_back(static_cast<char>(i * 7));
+    }
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write(content.data(), content.size());
+  }
+
+  virtual void TearDown() {
+    MappedBuffer::set_mapping_enabled(true);
+    std::remove(path.c_str());
+  }
+};
+
+TEST_F(MappedBufferTest, SameContentAsRead) {
+  for (int mapped = 0; mapped < 2; mapped++) {
+    MappedBuffer::set_mapping_enabled(mapped != 0);
+    PBuffer buffer = std::make_shared<MappedBuffer>(path,
+                                                    Buffer::EndianessBig);
+    ASSERT_EQ(content, static_cast<std::string>(*buffer));
+    EXPECT_EQ(0x0007u, buffer->pop<uint16_t>());
+  }
+}
+
+TEST_F(MappedBufferTest, SubbuffersAreViews) {
+  std::shared_ptr<MappedBuffer> buffer = std::make_shared<MappedBuffer>(path);
+  const char *data = reinterpret_cast<const char*>(buffer->get_data());
+
+  PBuffer head = buffer->pop(100);
+  PBuffer middle = buffer->get_subbuffer(5000, 10);
+  EXPECT_EQ(data, head->get_data());
+  EXPECT_EQ(data + 5000, middle->get_data());
+
+  // Views keep the file mapped.
+  buffer.reset();
+  EXPECT_EQ(content.substr(5000, 10), static_cast<std::string>(*middle));
+}
+
+TEST_F(MappedBufferTest, WritesStayPrivate) {
+  {
+    MappedBuffer buffer(path);
+    memset(buffer.get_data(), 0, buffer.get_size());
+  }
+  MappedBuffer buffer(path);
+  EXPECT_EQ(content, static_cast<std::string>(buffer));
+}
+
+TEST_F(MappedBufferTest, MissingFile) {
+  EXPECT_THROW(MappedBuffer("test_buffer.missing"), ExceptionFreeserf);
+}
@@ -0,0 +1,271 @@
+/*
+ * test_data_cache.cc - test cache of decoded game resources
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/buffer.h"
+#include "src/data-source-cache.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#define mkdir(path, mode)  _mkdir(path)
+#endif
+
+// Data source producing synthetic resources derived from a small file.
+class DataSourceTest : public DataSourceBase {
+ protected:
+  class SpriteTest : public SpriteBase {
+   public:
+    SpriteTest(unsigned int w, unsigned int h, uint32_t seed)
+      : SpriteBase(w, h) {
+      delta_x = seed % 5;
+      delta_y = -static_cast<int>(seed % 3);
+      offset_x = -static_cast<int>(seed % 7);
+      offset_y = seed % 11;
+      uint32_t *pixels = reinterpret_cast<uint32_t*>(data);
+      for (size_t i = 0; i < width * height; i++) {
+        pixels[i] = (seed + static_cast<uint32_t>(i)) * 2654435761u;
+      }
+    }
+  };
+
+  PBuffer music;
+
+ public:
+  explicit DataSourceTest(const std::string &path) : DataSourceBase(path) {
+    music = std::make_shared<Buffer>(path);
+  }
+
+  virtual std::string get_name() const { return "Test"; }
+  virtual unsigned int get_scale() const { return 1; }
+  virtual unsigned int get_bpp() const { return 32; }
+
+  virtual bool check() { return check_file(path); }
+  virtual bool load() {
+    for (size_t i = 0; i < 200; i++) {
+      std::vector<Data::Animation> animations;
+      for (size_t j = 0; j < i % 13; j++) {
+        animations.push_back({static_cast<uint8_t>(i + j),
+                              static_cast<int>(j) - 5, static_cast<int>(i)});
+      }
+      animation_table.push_back(animations);
+    }
+    loaded = true;
+    return true;
+  }
+
+  virtual Data::MaskImage get_sprite_parts(Data::Resource res, size_t index) {
+    uint32_t seed = static_cast<uint32_t>(res * 1000 + index);
+    Data::PSprite mask;
+    Data::PSprite image;
+    if (index % 2 == 0) {
+      mask = std::make_shared<SpriteTest>(1 + index % 7, 1 + res % 5, seed);
+    }
+    if (index % 3 != 0) {
+      image = std::make_shared<SpriteTest>(1 + index % 7, 1 + res % 5, ~seed);
+    }
+    return std::make_tuple(mask, image);
+  }
+
+  virtual PBuffer get_sound(size_t index) {
+    if (index == 0) {
+      return nullptr;
+    }
+    PMutableBuffer sound = std::make_shared<MutableBuffer>(
+                                                      Buffer::EndianessLittle);
+    sound->push<uint8_t>(static_cast<uint8_t>(index), index);
+    return sound;
+  }
+
+  virtual PBuffer get_music(size_t index) { return music; }
+
+  virtual std::list<std::string> get_files() const { return { path }; }
+};
+
+class DataCacheTest : public ::testing::Test {
+ protected:
+  std::string source_path;
+  std::string cache_path;
+  Data::PSource source;
+
+  virtual void SetUp() {
+    source_path = "test_data_cache_source.bin";
+    cache_path = "test_data_cache.cache";
+    write_source("original data file contents");
+    source = std::make_shared<DataSourceTest>(source_path);
+    ASSERT_TRUE(source->check());
+    ASSERT_TRUE(source->load());
+  }
+
+  virtual void TearDown() {
+    std::remove(source_path.c_str());
+    std::remove(cache_path.c_str());
+    std::remove((cache_path + ".failed").c_str());
+  }
+
+  void write_source(const std::string &contents) {
+    std::ofstream file(source_path.c_str(), std::ios::binary);
+    file << contents;
+  }
+
+  static void expect_equal(Data::PSprite expected, Data::PSprite sprite) {
+    ASSERT_EQ(expected == nullptr, sprite == nullptr);
+    if (!expected) {
+      return;
+    }
+    ASSERT_EQ(expected->get_width(), sprite->get_width());
+    ASSERT_EQ(expected->get_height(), sprite->get_height());
+    EXPECT_EQ(expected->get_delta_x(), sprite->get_delta_x());
+    EXPECT_EQ(expected->get_delta_y(), sprite->get_delta_y());
+    EXPECT_EQ(expected->get_offset_x(), sprite->get_offset_x());
+    EXPECT_EQ(expected->get_offset_y(), sprite->get_offset_y());
+    EXPECT_EQ(0, memcmp(expected->get_data(), sprite->get_data(),
+                        expected->get_width() * expected->get_height() * 4));
+  }
+
+  static void expect_equal(PBuffer expected, PBuffer buffer) {
+    ASSERT_EQ(expected == nullptr, buffer == nullptr);
+    if (!expected) {
+      return;
+    }
+    EXPECT_EQ(static_cast<std::string>(*expected),
+              static_cast<std::string>(*buffer));
+  }
+};
+
+TEST_F(DataCacheTest, RoundTrip) {
+  ASSERT_TRUE(DataSourceCache::build(source, cache_path));
+
+  DataSourceCache cache(source, cache_path);
+  ASSERT_TRUE(cache.check());
+  ASSERT_TRUE(cache.load());
+
+  for (int r = Data::AssetNone; r <= Data::AssetCursor; r++) {
+    Data::Resource res = static_cast<Data::Resource>(r);
+    for (unsigned int i = 0; i < Data::get_resource_count(res); i++) {
+      switch (Data::get_resource_type(res)) {
+        case Data::TypeSprite: {
+          Data::MaskImage expected = source->get_sprite_parts(res, i);
+          Data::MaskImage parts = cache.get_sprite_parts(res, i);
+          expect_equal(std::get<0>(expected), std::get<0>(parts));
+          expect_equal(std::get<1>(expected), std::get<1>(parts));
+          break;
+        }
+        case Data::TypeAnimation: {
+          size_t count = source->get_animation_phase_count(i);
+          ASSERT_EQ(count, cache.get_animation_phase_count(i));
+          for (size_t j = 0; j < count; j++) {
+            Data::Animation expected = source->get_animation(i, j << 3);
+            Data::Animation animation = cache.get_animation(i, j << 3);
+            EXPECT_EQ(expected.sprite, animation.sprite);
+            EXPECT_EQ(expected.x, animation.x);
+            EXPECT_EQ(expected.y, animation.y);
+          }
+          break;
+        }
+        case Data::TypeSound:
+          expect_equal(source->get_sound(i), cache.get_sound(i));
+          break;
+        case Data::TypeMusic:
+          expect_equal(source->get_music(i), cache.get_music(i));
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+TEST_F(DataCacheTest, SpritesAreWritable) {
+  ASSERT_TRUE(DataSourceCache::build(source, cache_path));
+
+  DataSourceCache cache(source, cache_path);
+  ASSERT_TRUE(cache.check());
+  ASSERT_TRUE(cache.load());
+
+  Data::Sprite::Color color = {0x10, 0x20, 0x30, 0xff};
+  Data::PSprite first = cache.get_sprite(Data::AssetIcon, 2, color);
+  Data::PSprite expected = source->get_sprite(Data::AssetIcon, 2, color);
+  expect_equal(expected, first);
+
+  // Changes to a returned sprite must not leak into the next one.
+  first->fill({0, 0, 0, 0});
+  expect_equal(expected, cache.get_sprite(Data::AssetIcon, 2, color));
+}
+
+TEST_F(DataCacheTest, OutdatedSource) {
+  ASSERT_TRUE(DataSourceCache::build(source, cache_path));
+  // Files are compared by size and modification time, and the time may not
+  // change within this test.
+  write_source("modified and extended data file contents");
+
+  DataSourceCache cache(source, cache_path);
+  EXPECT_FALSE(cache.check());
+}
+
+TEST_F(DataCacheTest, FailedBuildIsRemembered) {
+  // A folder in place of the temporary file keeps the cache from being
+  // written.
+  std::string tmp_path = cache_path + ".tmp";
+  ASSERT_EQ(0, mkdir(tmp_path.c_str(), 0700));
+  EXPECT_FALSE(DataSourceCache::build(source, cache_path));
+  EXPECT_TRUE(DataSourceCache::is_build_failed(source, cache_path));
+
+  write_source("modified and extended data file contents");
+  EXPECT_FALSE(DataSourceCache::is_build_failed(source, cache_path));
+
+  ASSERT_EQ(0, std::remove(tmp_path.c_str()));
+  EXPECT_TRUE(DataSourceCache::build(source, cache_path));
+  EXPECT_FALSE(DataSourceCache::is_build_failed(source, cache_path));
+  DataSourceCache cache(source, cache_path);
+  EXPECT_TRUE(cache.check());
+}
+
+TEST_F(DataCacheTest, DamagedCache) {
+  DataSourceCache missing(source, cache_path);
+  EXPECT_FALSE(missing.check());
+
+  ASSERT_TRUE(DataSourceCache::build(source, cache_path));
+  {
+    std::fstream file(cache_path.c_str(),
+                      std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(sizeof(DataSourceCache::Header) +
+               offsetof(DataSourceCache::Entry, size));
+    uint64_t size = ~0ull;
+    file.write(reinterpret_cast<char*>(&size), sizeof(size));
+  }
+
+  DataSourceCache cache(source, cache_path);
+  EXPECT_TRUE(cache.check());
+  EXPECT_FALSE(cache.load());
+}
@@ -0,0 +1,158 @@
+/*
+ * test_log.cc - test logging macros and asynchronous log writing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/log.h"
+
+static const Log::Subsystem log_test("test");
+
+class LogTest : public ::testing::Test {
+ protected:
+  std::stringstream output;
+
+  virtual void SetUp() {
+    Log::set_file(&output);
+    Log::set_level(Log::LevelInfo);
+  }
+
+  virtual void TearDown() {
+    Log::set_async(false);
+    Log::set_file(&std::cout);
+    Log::set_level(Log::LevelDebug);
+  }
+
+  std::vector<std::string> get_lines() {
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(output, line)) {
+      lines.push_back(line);
+    }
+    output.clear();
+    return lines;
+  }
+};
+
+static int
+count_call(int *calls) {
+  (*calls)++;
+  return *calls;
+}
+
+TEST_F(LogTest, DisabledLevelSkipsArguments) {
+  int calls = 0;
+  LOG_VERBOSE(log_test) << "value " << count_call(&calls);
+  LOG_DEBUG(log_test) << "value " << count_call(&calls);
+  EXPECT_EQ(0, calls);
+  EXPECT_TRUE(get_lines().empty());
+
+  LOG_INFO(log_test) << "value " << count_call(&calls);
+  EXPECT_EQ(1, calls);
+
+  Log::set_level(Log::LevelVerbose);
+  LOG_VERBOSE(log_test) << "value " << count_call(&calls);
+  EXPECT_EQ(2, calls);
+
+  std::vector<std::string> lines = get_lines();
+  ASSERT_EQ(2u, lines.size());
+  EXPECT_EQ("Info: [test] value 1", lines[0]);
+  EXPECT_EQ("Verbose: [test] value 2", lines[1]);
+}
+
+TEST_F(LogTest, MacroInUnbracedIf) {
+  bool first = false;
+  if (first)
+    LOG_INFO(log_test) << "not written";
+  else
+    first = true;
+  EXPECT_TRUE(first);
+  EXPECT_TRUE(get_lines().empty());
+}
+
+TEST_F(LogTest, LegacySubsystemNames) {
+  Log::Warn["legacy"] << "code " << 42;
+  Log::Debug["legacy"] << "hidden";
+
+  std::vector<std::string> lines = get_lines();
+  ASSERT_EQ(1u, lines.size());
+  EXPECT_EQ("Warning: [legacy] code 42", lines[0]);
+}
+
+TEST_F(LogTest, AsyncWritesAllMessages) {
+  const int threads = 4;
+  const int messages = 200;
+
+  Log::set_async(true);
+  EXPECT_TRUE(Log::is_async());
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < threads; t++) {
+    writers.push_back(std::thread([t]() {
+      for (int i = 0; i < messages; i++) {
+        LOG_INFO(log_test) << t << " " << i;
+      }
+    }));
+  }
+  for (std::thread &writer : writers) {
+    writer.join();
+  }
+
+  Log::set_async(false);
+  EXPECT_FALSE(Log::is_async());
+
+  std::set<std::string> expected;
+  for (int t = 0; t < threads; t++) {
+    for (int i = 0; i < messages; i++) {
+      std::stringstream line;
+      line << "Info: [test] " << t << " " << i;
+      expected.insert(line.str());
+    }
+  }
+
+  std::vector<std::string> lines = get_lines();
+  EXPECT_EQ(expected.size(), lines.size());
+  EXPECT_EQ(expected, std::set<std::string>(lines.begin(), lines.end()));
+}
+
+TEST_F(LogTest, AsyncKeepsOrderAndLongMessages) {
+  std::string text(2000, 'x');
+
+  Log::set_async(true);
+  LOG_INFO(log_test) << "queued";
+  LOG_WARN(log_test) << "written now";
+  LOG_INFO(log_test) << text;
+  LOG_INFO(log_test) << "last";
+  Log::set_async(false);
+
+  std::vector<std::string> lines = get_lines();
+  ASSERT_EQ(4u, lines.size());
+  EXPECT_EQ("Info: [test] queued", lines[0]);
+  EXPECT_EQ("Warning: [test] written now", lines[1]);
+  EXPECT_EQ("Info: [test] " + text, lines[2]);
+  EXPECT_EQ("Info: [test] last", lines[3]);
+}
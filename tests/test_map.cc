@@ -21,6 +21,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -126,3 +128,274 @@ TEST(Map, ClassicMissionMapGenerator) {
     }
   }
 }
+
+// Exposes both implementations of the terrain seeding passes.
+class SeedTerrainGenerator : public ClassicMapGenerator {
+ public:
+  SeedTerrainGenerator(const Map &map, const Random &random)
+    : ClassicMapGenerator(map, random) {}
+
+  using ClassicMapGenerator::seed_terrain_type;
+  using ClassicMapGenerator::seed_terrain_type_sequential;
+
+  void randomize_types(Random *random, int type_count) {
+    for (Map::LandscapeTile &tile : tiles) {
+      tile.type_up = static_cast<Map::Terrain>(random->random() % type_count);
+      tile.type_down =
+        static_cast<Map::Terrain>(random->random() % type_count);
+    }
+  }
+};
+
+TEST(Map, SeedTerrainTypeSameAsSequential) {
+  const int type_count = 4;
+  Random random = Random("8667715887436237");
+
+  for (unsigned int size = 3; size <= 5; size++) {
+    Map map{MapGeometry(size)};
+    for (int seed = 0; seed < 16; seed++) {
+      SeedTerrainGenerator fast(map, random);
+      fast.randomize_types(&random, type_count);
+      SeedTerrainGenerator sequential = fast;
+
+      // Apply every pass, including those where old or new_ is the seed
+      // type, one after another on the same types.
+      int changed = 0;
+      for (int old = 0; old < type_count; old++) {
+        for (int seed_type = 0; seed_type < type_count; seed_type++) {
+          for (int new_ = 0; new_ < type_count; new_++) {
+            if (old == new_) continue;
+            std::vector<Map::LandscapeTile> before = fast.get_landscape();
+            fast.seed_terrain_type(static_cast<Map::Terrain>(old),
+                                   static_cast<Map::Terrain>(seed_type),
+                                   static_cast<Map::Terrain>(new_));
+            sequential.seed_terrain_type_sequential(
+              static_cast<Map::Terrain>(old),
+              static_cast<Map::Terrain>(seed_type),
+              static_cast<Map::Terrain>(new_));
+            ASSERT_TRUE(fast.get_landscape() == sequential.get_landscape())
+              << "size " << size << ", seed " << seed << ", pass " << old
+              << " " << seed_type << " " << new_;
+            if (!(before == fast.get_landscape())) changed += 1;
+          }
+        }
+      }
+      EXPECT_LT(type_count, changed);
+    }
+  }
+}
+
+TEST(Map, ObjectClassCounts) {
+  Map map(MapGeometry(3));
+  Random random = Random("8667715887436237");
+  ClassicMissionMapGenerator generator(map, random);
+  generator.init();
+  generator.generate();
+  map.init_tiles(generator);
+
+  // Clear trees and stones from a corner and fill it with fields.
+  for (MapPos pos : map.geom()) {
+    Map::Object obj = map.get_obj(pos);
+    if (map.pos_col(pos) < 40 && map.pos_row(pos) < 40) {
+      if (Map::get_object_class(obj) != Map::ObjectClassCount) {
+        map.set_object(pos, (map.pos_col(pos) + map.pos_row(pos)) % 5 ?
+                       Map::ObjectField3 : Map::ObjectStub, -1);
+      }
+    } else if (random.random() % 3 == 0) {
+      map.set_object(pos, Map::ObjectNone, -1);
+    }
+  }
+
+  for (int cls = 0; cls < Map::ObjectClassCount; cls++) {
+    for (int i = 0; i < 500; i++) {
+      MapPos pos = map.pos(random.random() & map.get_col_mask(),
+                           random.random() & map.get_row_mask());
+      int radius = random.random() % 20;
+      bool found = false;
+      for (int y = -radius; y <= radius && !found; y++) {
+        for (int x = -radius; x <= radius; x++) {
+          if (Map::get_object_class(map.get_obj(map.pos_add(pos, x, y))) ==
+              cls) {
+            found = true;
+            break;
+          }
+        }
+      }
+      // Blocks are coarser than the radius, they may only report more.
+      if (found) {
+        ASSERT_TRUE(map.has_object_class(pos, radius,
+                                         static_cast<Map::ObjectClass>(cls)));
+      }
+    }
+  }
+
+  // Within the corner only fields remain.
+  MapPos corner = map.pos(20, 20);
+  EXPECT_TRUE(map.has_object_class(corner, 11, Map::ObjectClassField));
+  EXPECT_FALSE(map.has_object_class(corner, 11, Map::ObjectClassTree));
+  EXPECT_FALSE(map.has_object_class(corner, 11, Map::ObjectClassStone));
+  EXPECT_FALSE(map.has_object_class(corner, 11, Map::ObjectClassFree));
+
+  EXPECT_EQ(0, Map::get_spiral_radius(0));
+  EXPECT_EQ(1, Map::get_spiral_radius(6));
+  EXPECT_EQ(24, Map::get_spiral_radius(294));
+}
+
+static void
+check_attributes(const Map &map) {
+  for (MapPos pos : map.geom()) {
+    Map::Terrain types[] = {
+      map.type_up(pos),
+      map.type_down(pos),
+      map.type_down(map.move_left(pos)),
+      map.type_up(map.move_up_left(pos)),
+      map.type_down(map.move_up_left(pos)),
+      map.type_up(map.move_up(pos))
+    };
+    int water = 0;
+    int grass = 0;
+    int mountain = 0;
+    for (Map::Terrain type : types) {
+      if (type <= Map::TerrainWater3) water++;
+      if (type >= Map::TerrainGrass0 && type <= Map::TerrainGrass3) grass++;
+      if (type >= Map::TerrainTundra0 && type <= Map::TerrainSnow0) {
+        mountain++;
+      }
+    }
+
+    ASSERT_EQ(types[0] <= Map::TerrainWater3 &&
+              types[1] <= Map::TerrainWater3, map.is_water_tile(pos));
+    ASSERT_EQ(water == 6, map.is_in_water(pos));
+    ASSERT_EQ(grass == 6, map.has_attribute(pos, Map::AttributeGrass));
+    ASSERT_EQ(mountain > 0 && mountain + grass == 6,
+              map.has_attribute(pos, Map::AttributeMine));
+    ASSERT_EQ((types[1] <= Map::TerrainWater3 &&
+               types[3] >= Map::TerrainGrass0) ||
+              (types[2] <= Map::TerrainWater3 &&
+               types[5] >= Map::TerrainGrass0),
+              map.has_attribute(pos, Map::AttributeShore));
+    ASSERT_EQ(Map::map_space_from_obj[map.get_obj(pos)] <=
+              Map::SpaceSemipassable,
+              map.has_attribute(pos, Map::AttributePassable));
+    for (Direction d : cycle_directions_cw()) {
+      ASSERT_EQ(std::abs(static_cast<int>(map.get_height(pos)) -
+                         static_cast<int>(map.get_height(map.move(pos, d)))),
+                map.get_height_diff(pos, d));
+    }
+  }
+}
+
+TEST(Map, TileAttributes) {
+  Map map(MapGeometry(3));
+  Random random = Random("8667715887436237");
+  ClassicMissionMapGenerator generator(map, random);
+  generator.init();
+  generator.generate();
+  map.init_tiles(generator);
+  check_attributes(map);
+
+  for (int i = 0; i < 2000; i++) {
+    MapPos pos = map.pos(random.random() & map.get_col_mask(),
+                         random.random() & map.get_row_mask());
+    if (i % 2 == 0) {
+      map.set_height(pos, random.random() & 0x1f);
+    } else {
+      map.set_object(pos, static_cast<Map::Object>(random.random() & 0x7f),
+                     -1);
+    }
+  }
+  check_attributes(map);
+}
+
+TEST(Road, SameAsWalkingTheRoad) {
+  Map map(MapGeometry(3));
+  Random random = Random("8667715887436237");
+
+  for (int round = 0; round < 20; round++) {
+    Road road;
+    std::vector<MapPos> walked;
+    MapPos source = map.pos(random.random() & map.get_col_mask(),
+                            random.random() & map.get_row_mask());
+    road.start(source);
+    walked.push_back(source);
+
+    // Long walks wrap around the map and pass positions repeatedly.
+    int steps = 50 + random.random() % 400;
+    for (int i = 0; i < steps; i++) {
+      if (road.get_length() > 0 && random.random() % 4 == 0) {
+        ASSERT_TRUE(road.undo());
+        walked.pop_back();
+        if (walked.size() == 1) {
+          road.start(source);
+        }
+      } else {
+        Direction dir = static_cast<Direction>(random.random() % 6);
+        ASSERT_TRUE(road.extend(dir));
+        walked.push_back(map.move(walked.back(), dir));
+      }
+
+      ASSERT_EQ(walked.size() - 1, road.get_length());
+      ASSERT_EQ(walked.back(), road.get_end(&map));
+      size_t index = 0;
+      for (Direction dir : road.get_dirs()) {
+        ASSERT_EQ(walked[index + 1], map.move(walked[index], dir));
+        index++;
+      }
+
+      for (int j = 0; j < 20; j++) {
+        MapPos pos = (j < 10) ? walked[random.random() % walked.size()] :
+                     map.pos_add(walked.back(), random.random() % 9 - 4,
+                                 random.random() % 9 - 4);
+        bool on_road = std::find(walked.begin(), walked.end(), pos) !=
+                       walked.end();
+        ASSERT_EQ(on_road, road.has_pos(&map, pos));
+      }
+
+      for (Direction dir : cycle_directions_cw()) {
+        MapPos next = map.move(walked.back(), dir);
+        bool crossing = std::find(walked.begin() + 1, walked.end(), next) !=
+                        walked.end();
+        bool undo = walked.size() > 1 && next == walked[walked.size() - 2];
+        ASSERT_EQ(!undo && !crossing, road.is_valid_extension(&map, dir));
+      }
+    }
+  }
+}
+
+TEST(Road, UndoAfterGrowing) {
+  Map map(MapGeometry(5));
+  Random random = Random("8667715887436237");
+
+  for (int round = 0; round < 20; round++) {
+    Road road;
+    std::vector<MapPos> walked;
+    MapPos source = map.pos(random.random() & map.get_col_mask(),
+                            random.random() & map.get_row_mask());
+    road.start(source);
+    walked.push_back(source);
+
+    // Enough positions to grow the table of positions a few times.
+    while (road.is_extendable()) {
+      Direction dir = static_cast<Direction>(random.random() % 6);
+      if (road.is_undo(dir)) {
+        continue;
+      }
+      ASSERT_TRUE(road.extend(dir));
+      walked.push_back(map.move(walked.back(), dir));
+    }
+
+    while (walked.size() > 2) {
+      ASSERT_TRUE(road.undo());
+      MapPos removed = walked.back();
+      walked.pop_back();
+      for (MapPos pos : walked) {
+        ASSERT_TRUE(road.has_pos(&map, pos));
+      }
+      bool on_road = std::find(walked.begin(), walked.end(), removed) !=
+                     walked.end();
+      ASSERT_EQ(on_road, road.has_pos(&map, removed));
+    }
+    ASSERT_TRUE(road.undo());
+    ASSERT_FALSE(road.is_valid());
+  }
+}
@@ -0,0 +1,162 @@
+/*
+ * test_map_cache.cc - test for the cache of generated maps
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "src/map.h"
+#include "src/map-cache.h"
+#include "src/map-generator.h"
+#include "src/map-geometry.h"
+#include "src/random.h"
+
+class MapCacheTest : public ::testing::Test {
+ protected:
+  std::vector<std::string> paths;
+
+  virtual void SetUp() {
+    MapCache::get_instance().set_folder(".");
+    MapCache::get_instance().set_enabled(true);
+  }
+
+  virtual void TearDown() {
+    MapCache::get_instance().set_enabled(false);
+    for (const std::string &path : paths) {
+      std::remove(path.c_str());
+    }
+  }
+
+  // Landscape for the parameters, through the cache or not.
+  std::vector<Map::LandscapeTile>
+  generate(unsigned int size, const std::string &seed,
+           MapGenerator::HeightGenerator heights, bool preserve_bugs,
+           bool cached) {
+    Map map{MapGeometry(size)};
+    ClassicMapGenerator generator(map, Random(seed));
+    generator.init(heights, preserve_bugs);
+    paths.push_back(MapCache::get_instance().get_path(generator.get_key()));
+    if (cached) {
+      MapCache::get_instance().generate(&generator);
+    } else {
+      generator.generate();
+    }
+    return generator.get_landscape();
+  }
+
+  bool exists(const std::string &path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    return file.good();
+  }
+};
+
+TEST_F(MapCacheTest, SameAsGenerated) {
+  const char *seeds[] = { "8667715887436237", "3762530443727213" };
+  for (unsigned int size = 3; size <= 5; size++) {
+    for (const char *seed : seeds) {
+      for (int bugs = 0; bugs < 2; bugs++) {
+        for (MapGenerator::HeightGenerator heights :
+             { MapGenerator::HeightGeneratorMidpoints,
+               MapGenerator::HeightGeneratorDiamondSquare }) {
+          std::vector<Map::LandscapeTile> expected =
+            generate(size, seed, heights, bugs != 0, false);
+          EXPECT_FALSE(exists(paths.back()));
+
+          // Generated and stored first, then loaded.
+          EXPECT_TRUE(generate(size, seed, heights, bugs != 0, true) ==
+                      expected);
+          EXPECT_TRUE(exists(paths.back()));
+          EXPECT_TRUE(generate(size, seed, heights, bugs != 0, true) ==
+                      expected);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(MapCacheTest, KeyIncludesParameters) {
+  Map map{MapGeometry(3)};
+  ClassicMapGenerator generator(map, Random("8667715887436237"));
+  generator.init(MapGenerator::HeightGeneratorMidpoints, true);
+  std::string key = generator.get_key();
+
+  generator.init(MapGenerator::HeightGeneratorMidpoints, false);
+  EXPECT_NE(key, generator.get_key());
+  generator.init(MapGenerator::HeightGeneratorDiamondSquare, true);
+  EXPECT_NE(key, generator.get_key());
+  generator.init(MapGenerator::HeightGeneratorMidpoints, true, 10);
+  EXPECT_NE(key, generator.get_key());
+
+  Map other_map{MapGeometry(4)};
+  ClassicMapGenerator other_size(other_map, Random("8667715887436237"));
+  other_size.init(MapGenerator::HeightGeneratorMidpoints, true);
+  EXPECT_NE(key, other_size.get_key());
+
+  ClassicMapGenerator other_seed(map, Random("8667715887436238"));
+  other_seed.init(MapGenerator::HeightGeneratorMidpoints, true);
+  EXPECT_NE(key, other_seed.get_key());
+}
+
+TEST_F(MapCacheTest, DamagedCache) {
+  std::vector<Map::LandscapeTile> expected =
+    generate(3, "8667715887436237", MapGenerator::HeightGeneratorMidpoints,
+             true, true);
+  std::string path = paths.back();
+  ASSERT_TRUE(exists(path));
+
+  Map map{MapGeometry(3)};
+  ClassicMapGenerator generator(map, Random("8667715887436237"));
+  generator.init(MapGenerator::HeightGeneratorMidpoints, true);
+  std::string key = generator.get_key();
+  std::vector<Map::LandscapeTile> landscape;
+  EXPECT_TRUE(MapCache::get_instance().load(key, expected.size(),
+                                            &landscape));
+  EXPECT_FALSE(MapCache::get_instance().load(key, expected.size() * 2,
+                                             &landscape));
+  EXPECT_FALSE(MapCache::get_instance().load(key + "-other", expected.size(),
+                                             &landscape));
+
+  {
+    std::fstream file(path.c_str(),
+                      std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(-7, std::ios::end);
+    file.put('\x7f');
+  }
+  EXPECT_FALSE(MapCache::get_instance().load(key, expected.size(),
+                                             &landscape));
+
+  // The damaged map is generated and stored again.
+  EXPECT_TRUE(generate(3, "8667715887436237",
+                       MapGenerator::HeightGeneratorMidpoints, true, true) ==
+              expected);
+  EXPECT_TRUE(MapCache::get_instance().load(key, expected.size(),
+                                            &landscape));
+}
+
+TEST_F(MapCacheTest, Disabled) {
+  MapCache::get_instance().set_enabled(false);
+  generate(3, "8667715887436237", MapGenerator::HeightGeneratorMidpoints,
+           true, true);
+  EXPECT_FALSE(exists(paths.back()));
+}
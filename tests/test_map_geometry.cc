@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "src/map-geometry.h"
+#include "src/map-components.h"
 
 
 TEST(MapGeometry, StandardDirectionCycle) {
@@ -85,3 +86,35 @@ TEST(MapGeometry, LongerCCWDirectionCycle) {
 
   EXPECT_EQ(expected, dirs);
 }
+
+TEST(MapComponents, FillsLinkedPositions) {
+  MapGeometry geom(3);
+  MapComponents components(geom);
+
+  // Rows are only linked within themselves, and not at column 5.
+  auto along_rows = [&geom](MapPos pos) {
+    int col = geom.pos_col(pos);
+    int dirs = 0;
+    if (col != 5) dirs |= 1 << DirectionRight;
+    if (col != 6) dirs |= 1 << DirectionLeft;
+    return dirs;
+  };
+
+  EXPECT_EQ(geom.cols(), components.fill(geom.pos(3, 2), 1, along_rows));
+  EXPECT_EQ(1u, components.get_label(geom.pos(40, 2)));
+  EXPECT_FALSE(components.is_labelled(geom.pos(3, 3)));
+
+  // Cut at column 5 and at the wrap-around of the row.
+  auto cut = [&geom, &along_rows](MapPos pos) {
+    int col = geom.pos_col(pos);
+    int dirs = along_rows(pos);
+    if (col == static_cast<int>(geom.cols()) - 1) {
+      dirs &= ~(1 << DirectionRight);
+    }
+    if (col == 0) dirs &= ~(1 << DirectionLeft);
+    return dirs;
+  };
+  EXPECT_EQ(6u, components.fill(geom.pos(0, 7), 2, cut));
+  EXPECT_EQ(geom.cols() - 6, components.fill(geom.pos(6, 7), 3, cut));
+  EXPECT_EQ(3u, components.get_label(geom.pos(geom.cols() - 1, 7)));
+}
@@ -0,0 +1,172 @@
+/*
+ * test_pixel_kernels.cc - test vector pixel kernels against scalar ones
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <random>
+
+#include "src/pixel-kernels.h"
+
+typedef std::vector<uint32_t> Pixels;
+
+// Random pixels with long runs of fully transparent and fully opaque ones,
+// like in real sprites.
+static Pixels
+random_pixels(std::mt19937 *rng, size_t count) {
+  Pixels pixels(count);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t value = (*rng)();
+    switch ((i / 5 + (value >> 29)) % 4) {
+      case 0: value &= 0x00FFFFFF; break;
+      case 1: value |= 0xFF000000; break;
+      case 2: value = 0xFFFFFFFF; break;
+      default: break;
+    }
+    pixels[i] = value;
+  }
+  return pixels;
+}
+
+class PixelKernelsTest : public ::testing::Test {
+ protected:
+  std::mt19937 rng;
+
+  virtual void TearDown() {
+    PixelKernels::set_level(PixelKernels::get_supported_level());
+  }
+
+  template <typename F>
+  void compare(F kernel) {
+    for (int level = PixelKernels::LevelSSE2;
+         level <= PixelKernels::get_supported_level(); level++) {
+      for (size_t count = 0; count < 70; count++) {
+        rng.seed(static_cast<unsigned int>(count));
+        Pixels a = random_pixels(&rng, count);
+        Pixels b = random_pixels(&rng, count);
+        for (size_t i = 0; i < count; i += 3) {
+          b[i] = a[i];
+        }
+
+        Pixels expected_a = a;
+        Pixels expected_b = b;
+        PixelKernels::set_level(PixelKernels::LevelScalar);
+        uint32_t expected = kernel(PixelKernels::get(), &expected_a,
+                                   &expected_b);
+
+        PixelKernels::set_level(static_cast<PixelKernels::Level>(level));
+        uint32_t result = kernel(PixelKernels::get(), &a, &b);
+
+        const char *name =
+          PixelKernels::get_level_name(static_cast<PixelKernels::Level>(level));
+        EXPECT_EQ(expected, result) << name << ", count " << count;
+        EXPECT_EQ(expected_a, a) << name << ", count " << count;
+        EXPECT_EQ(expected_b, b) << name << ", count " << count;
+      }
+    }
+  }
+};
+
+TEST_F(PixelKernelsTest, Mask) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    Pixels dst(a->size());
+    k.mask(dst.data(), a->data(), b->data(), a->size());
+    *a = dst;
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, CreateMask) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    Pixels dst(a->size());
+    k.create_mask(dst.data(), a->data(), b->data(), a->size());
+    *a = dst;
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, FillMasked) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    k.fill_masked(a->data(), 0x80402010, a->size());
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, Add) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    k.add(a->data(), b->data(), a->size());
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, Del) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    k.del(a->data(), b->data(), a->size());
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, Blend) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    k.blend(a->data(), b->data(), a->size());
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, AlphaMask) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    uint8_t min = k.alpha_from_luminance(a->data(), a->size());
+    k.sub_alpha(a->data(), min, a->size());
+    return min;
+  });
+}
+
+TEST_F(PixelKernelsTest, Stick) {
+  compare([](const PixelKernels::Table &k, Pixels *a, Pixels *b) {
+    k.stick(a->data(), b->data(), a->size());
+    return 0;
+  });
+}
+
+TEST_F(PixelKernelsTest, LuminanceAllColors) {
+  // Every possible color once, the rounding of the luminance must match
+  Pixels colors(1 << 24);
+  for (uint32_t i = 0; i < colors.size(); i++) {
+    colors[i] = 0xFF000000 | i;
+  }
+
+  PixelKernels::set_level(PixelKernels::LevelScalar);
+  Pixels expected = colors;
+  uint8_t expected_min = PixelKernels::get().alpha_from_luminance(
+                                                              expected.data(),
+                                                              expected.size());
+
+  for (int level = PixelKernels::LevelSSE2;
+       level <= PixelKernels::get_supported_level(); level++) {
+    PixelKernels::set_level(static_cast<PixelKernels::Level>(level));
+    Pixels result = colors;
+    uint8_t min = PixelKernels::get().alpha_from_luminance(result.data(),
+                                                           result.size());
+    EXPECT_EQ(expected_min, min);
+    EXPECT_TRUE(expected == result) << "Mismatch at level "
+      << PixelKernels::get_level_name(static_cast<PixelKernels::Level>(level));
+  }
+}
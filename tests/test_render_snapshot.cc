@@ -0,0 +1,148 @@
+/*
+ * test_render_snapshot.cc - test game state copied for drawing
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "src/render-snapshot.h"
+#include "src/game.h"
+#include "src/random.h"
+
+static PGame
+create_game(MapPos *castle_pos) {
+  PGame game = std::make_shared<Game>();
+  game->init(3, Random("8667715887436237"));
+  game->add_player(35, 30, 40);
+  *castle_pos = game->get_map()->pos(6, 6);
+  game->build_castle(*castle_pos, game->get_player(0));
+  return game;
+}
+
+// A place near pos where player may put a flag, or bad_map_pos.
+static MapPos
+find_flag_pos(Game *game, MapPos pos, Player *player) {
+  for (int i = 1; i < 100; i++) {
+    MapPos p = game->get_map()->pos_add_spirally(pos, i);
+    if (game->can_build_flag(p, player)) {
+      return p;
+    }
+  }
+  return bad_map_pos;
+}
+
+// Whether the snapshot lists a change of the object at pos. Map handlers
+// hear of the neighbours of the position.
+static bool
+changed(const RenderSnapshot *snapshot, MapPos pos) {
+  MapPos right = snapshot->get_map()->move_right(pos);
+  for (const RenderSnapshot::Change &change : snapshot->get_changes()) {
+    if (!change.height && change.pos == right) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST(RenderSnapshot, SwapsOnlyNewSnapshots) {
+  MapPos castle_pos;
+  PGame game = create_game(&castle_pos);
+  SnapshotPublisher publisher(game);
+
+  const RenderSnapshot *first = publisher.get_snapshot();
+  EXPECT_EQ(first, publisher.get_snapshot());
+
+  game->update();
+  publisher.publish(2);
+  const RenderSnapshot *second = publisher.get_snapshot();
+  EXPECT_NE(first, second);
+  EXPECT_EQ(game->get_tick(), second->get_tick());
+  EXPECT_EQ(2u, second->get_ticks_behind());
+  EXPECT_EQ(second, publisher.get_snapshot());
+
+  // The snapshot being drawn is never filled while it is held.
+  for (int i = 0; i < 4; i++) {
+    game->update();
+    publisher.publish(0);
+    EXPECT_NE(second, publisher.get_snapshot());
+    second = publisher.get_snapshot();
+    EXPECT_EQ(game->get_tick(), second->get_tick());
+  }
+}
+
+TEST(RenderSnapshot, CopiesObjectsInView) {
+  MapPos castle_pos;
+  PGame game = create_game(&castle_pos);
+  Map *map = game->get_map();
+  SnapshotPublisher publisher(game);
+
+  publisher.publish(0);
+  const RenderSnapshot *snapshot = publisher.get_snapshot();
+  EXPECT_EQ(nullptr, snapshot->get_building_at_pos(castle_pos));
+  EXPECT_EQ(map->get_obj(castle_pos),
+            snapshot->get_map()->get_obj(castle_pos));
+
+  publisher.set_view(SnapshotPublisher::ViewMain,
+                     map->pos_add(castle_pos, -2, -2), 5, 5);
+  publisher.publish(0);
+  snapshot = publisher.get_snapshot();
+  const RenderSnapshot::BuildingState *castle =
+    snapshot->get_building_at_pos(castle_pos);
+  ASSERT_NE(nullptr, castle);
+  EXPECT_EQ(Building::TypeCastle, castle->type);
+  EXPECT_EQ(castle_pos, castle->pos);
+
+  MapPos flag_pos = map->move_down_right(castle_pos);
+  const RenderSnapshot::FlagState *flag = snapshot->get_flag_at_pos(flag_pos);
+  ASSERT_NE(nullptr, flag);
+  EXPECT_EQ(0u, flag->owner);
+}
+
+TEST(RenderSnapshot, KeepsChangesOfSkippedSnapshots) {
+  MapPos castle_pos;
+  PGame game = create_game(&castle_pos);
+  Player *player = game->get_player(0);
+  SnapshotPublisher publisher(game);
+
+  MapPos first = find_flag_pos(game.get(), castle_pos, player);
+  ASSERT_NE(bad_map_pos, first);
+  ASSERT_TRUE(game->build_flag(first, player));
+  publisher.publish(0);
+  MapPos second = find_flag_pos(game.get(), castle_pos, player);
+  ASSERT_NE(bad_map_pos, second);
+  ASSERT_TRUE(game->build_flag(second, player));
+  publisher.publish(0);
+
+  // Both batches reach the interface, though it took neither snapshot.
+  const RenderSnapshot *snapshot = publisher.get_snapshot();
+  EXPECT_FALSE(snapshot->are_changes_lost());
+  EXPECT_TRUE(changed(snapshot, first));
+  EXPECT_TRUE(changed(snapshot, second));
+  EXPECT_EQ(Map::ObjectFlag, snapshot->get_map()->get_obj(first));
+  EXPECT_EQ(Map::ObjectFlag, snapshot->get_map()->get_obj(second));
+
+  // And only once.
+  publisher.publish(0);
+  snapshot = publisher.get_snapshot();
+  EXPECT_FALSE(changed(snapshot, first));
+  EXPECT_FALSE(changed(snapshot, second));
+  EXPECT_EQ(Map::ObjectFlag, snapshot->get_map()->get_obj(first));
+}
@@ -76,4 +76,12 @@ TEST(SaveGame, RandomMapSaveGame) {
 
   // Check player land area
   EXPECT_EQ(player_0->get_land_area(), loaded_player_0->get_land_area());
+
+  // Check statistics kept while running against those counted on load
+  EXPECT_EQ(player_0->get_stats_resources(),
+            loaded_player_0->get_stats_resources());
+  EXPECT_EQ(player_0->get_stats_serfs_idle(),
+            loaded_player_0->get_stats_serfs_idle());
+  EXPECT_EQ(player_0->get_stats_serfs_potential(),
+            loaded_player_0->get_stats_serfs_potential());
 }
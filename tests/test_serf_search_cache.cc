@@ -0,0 +1,110 @@
+/*
+ * test_serf_search_cache.cc - test failed searches for serfs
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/serf-search-cache.h"
+
+TEST(SerfSearchCache, FailureIsRemembered) {
+  SerfSearchCache cache;
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+  EXPECT_TRUE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                              Resource::TypeNone));
+  EXPECT_TRUE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                              Resource::TypeNone));
+  EXPECT_EQ(2u, cache.get_avoided_count());
+
+  // Other flags and other serfs are searched for.
+  EXPECT_FALSE(cache.is_futile(13, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeFisher, Resource::TypeRod,
+                               Resource::TypeNone));
+  EXPECT_EQ(2u, cache.get_avoided_count());
+}
+
+TEST(SerfSearchCache, GainsOfOtherSerfsAndResources) {
+  SerfSearchCache cache;
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+
+  cache.serf_added(Serf::TypeFisher);
+  cache.resource_added(Resource::TypeRod);
+  EXPECT_TRUE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                              Resource::TypeNone));
+}
+
+TEST(SerfSearchCache, GainsInvalidate) {
+  SerfSearchCache cache;
+
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+  cache.serf_added(Serf::TypeLumberjack);
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+  cache.resource_added(Resource::TypeAxe);
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+  cache.serf_added(Serf::TypeGeneric);
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+
+  cache.add_failure(12, Serf::TypeToolmaker, Resource::TypeHammer,
+                    Resource::TypeSaw);
+  cache.resource_added(Resource::TypeSaw);
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeToolmaker, Resource::TypeHammer,
+                               Resource::TypeSaw));
+
+  cache.add_failure(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                    Resource::TypeNone);
+  cache.network_changed();
+  EXPECT_FALSE(cache.is_futile(12, Serf::TypeLumberjack, Resource::TypeAxe,
+                               Resource::TypeNone));
+  EXPECT_EQ(0u, cache.get_avoided_count());
+}
+
+TEST(SerfSearchCache, Knights) {
+  SerfSearchCache cache;
+  Serf::Type knight = static_cast<Serf::Type>(-3);
+
+  cache.add_failure(12, knight, Resource::TypeNone, Resource::TypeNone);
+  cache.serf_added(Serf::TypeTransporter);
+  EXPECT_TRUE(cache.is_futile(12, knight, Resource::TypeNone,
+                              Resource::TypeNone));
+
+  cache.serf_added(Serf::TypeKnight4);
+  EXPECT_FALSE(cache.is_futile(12, knight, Resource::TypeNone,
+                               Resource::TypeNone));
+
+  cache.add_failure(12, knight, Resource::TypeNone, Resource::TypeNone);
+  cache.resource_added(Resource::TypeShield);
+  EXPECT_FALSE(cache.is_futile(12, knight, Resource::TypeNone,
+                               Resource::TypeNone));
+}
@@ -0,0 +1,189 @@
+/*
+ * test_spatial_index.cc - test positions of game objects by owner
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "src/spatial-index.h"
+#include "src/game.h"
+#include "src/savegame.h"
+
+typedef std::map<MapPos, unsigned int> Objects;
+
+// Probe every position of the spiral, like the game did.
+template<typename Test>
+static int
+scan_spirally(const Map &map, const Objects &objects, MapPos pos,
+              unsigned int first, unsigned int last, bool reverse,
+              Test test) {
+  for (unsigned int i = 0; i <= last - first; i++) {
+    unsigned int offset = reverse ? last - i : first + i;
+    Objects::const_iterator it = objects.find(map.pos_add_spirally(pos,
+                                                                   offset));
+    if (it != objects.end() && test(it->second)) {
+      return offset;
+    }
+  }
+  return -1;
+}
+
+static void
+check_index(unsigned int map_size, unsigned int seed) {
+  Map map(MapGeometry{map_size});
+  std::mt19937 rng(seed);
+  SpatialIndex index;
+  index.reset(&map);
+
+  // Objects of four owners; 0 stays unused to test empty owners.
+  Objects objects[4];
+  std::map<unsigned int, std::pair<unsigned int, MapPos>> placed;
+  for (unsigned int i = 1; i < 600; i++) {
+    unsigned int owner = 1 + rng() % 3;
+    MapPos pos = map.pos(rng() & map.get_col_mask(),
+                         rng() & map.get_row_mask());
+    if (objects[1].count(pos) || objects[2].count(pos) ||
+        objects[3].count(pos)) {
+      continue;
+    }
+    objects[owner][pos] = i;
+    placed[i] = { owner, pos };
+    index.update(i, owner, pos);
+  }
+
+  // Remove some and move some to another owner.
+  for (auto it = placed.begin(); it != placed.end(); ++it) {
+    if (it->first % 7 == 0) {
+      objects[it->second.first].erase(it->second.second);
+      index.remove(it->first);
+    } else if (it->first % 11 == 0) {
+      objects[it->second.first].erase(it->second.second);
+      unsigned int owner = 1 + (it->second.first % 3);
+      objects[owner][it->second.second] = it->first;
+      index.update(it->first, owner, it->second.second);
+    }
+  }
+
+  const unsigned int ranges[][2] = { { 1, 258 }, { 0, 257 }, { 0, 18 },
+                                     { 7, 18 }, { 0, 294 } };
+  for (int i = 0; i < 300; i++) {
+    MapPos pos = map.pos(rng() & map.get_col_mask(),
+                         rng() & map.get_row_mask());
+    unsigned int owner = rng() % 4;
+    unsigned int skip = rng() % 4;
+    auto test = [skip](unsigned int object) { return object % 4 != skip; };
+    for (const auto &range : ranges) {
+      for (int reverse = 0; reverse < 2; reverse++) {
+        int expected = scan_spirally(map, objects[owner], pos, range[0],
+                                     range[1], reverse != 0, test);
+        int found = index.find_spirally(&map, pos, owner, range[0], range[1],
+                                        reverse != 0, test);
+        ASSERT_EQ(expected, found) << "map size " << map_size
+                                   << ", range " << range[0] << "-"
+                                   << range[1] << ", reverse " << reverse;
+      }
+    }
+
+    for (int radius : { 3, 16, 32 }) {
+      std::set<unsigned int> expected;
+      for (const auto &object : objects[owner]) {
+        if (abs(map.dist_x(pos, object.first)) <= radius &&
+            abs(map.dist_y(pos, object.first)) <= radius) {
+          expected.insert(object.second);
+        }
+      }
+      std::vector<SpatialIndex::Entry> near;
+      index.find_near(pos, owner, radius, &near);
+      std::set<unsigned int> found;
+      for (const SpatialIndex::Entry &entry : near) {
+        EXPECT_EQ(objects[owner].at(entry.pos), entry.index);
+        found.insert(entry.index);
+      }
+      ASSERT_EQ(near.size(), found.size());
+      ASSERT_EQ(expected, found) << "map size " << map_size << ", radius "
+                                 << radius;
+    }
+  }
+}
+
+TEST(SpatialIndex, SameOrderAsSpiralScan) {
+  check_index(3, 1);
+  check_index(4, 2);
+  check_index(5, 3);
+}
+
+TEST(SpatialIndex, FollowsGame) {
+  std::unique_ptr<Game> game(new Game());
+  game->init(3, Random("8667715887436237"));
+  game->add_player(35, 30, 40);
+  Player *player = game->get_player(0);
+  Map *map = game->get_map();
+  ASSERT_TRUE(game->build_castle(map->pos(6, 6), player));
+  for (int i = 0; i < 200; i++) {
+    game->update();
+  }
+
+  unsigned int built = 0;
+  for (int row = 0; row < 16; row += 2) {
+    for (int col = 0; col < 16; col += 3) {
+      if (game->build_flag(map->pos(col, row), player)) {
+        built++;
+      }
+    }
+  }
+  ASSERT_LT(0u, built);
+  // Castle flag and the new flags.
+  EXPECT_EQ(built + 1, game->get_flag_positions().get_count());
+  EXPECT_EQ(1u, game->get_building_positions().get_count());
+
+  ASSERT_TRUE(game->demolish_flag(map->pos(3, 2), player) ||
+              game->demolish_flag(map->pos(6, 2), player));
+
+  Objects flags;
+  for (MapPos pos : map->geom()) {
+    if (map->has_flag(pos)) {
+      flags[pos] = map->get_obj_index(pos);
+    }
+  }
+  EXPECT_EQ(flags.size(), game->get_flag_positions().get_count());
+
+  for (MapPos pos : map->geom()) {
+    auto test = [](unsigned int) { return true; };
+    ASSERT_EQ(scan_spirally(*map, flags, pos, 1, 258, true, test),
+              game->get_flag_positions().find_spirally(map, pos, 0, 1, 258,
+                                                       true, test));
+  }
+
+  // Loaded games index their flags and buildings again.
+  std::stringstream str;
+  ASSERT_TRUE(GameStore::get_instance().write(&str, game.get()));
+  str.seekg(0, std::ios::beg);
+  std::unique_ptr<Game> loaded(new Game());
+  ASSERT_TRUE(GameStore::get_instance().read(&str, loaded.get()));
+  EXPECT_EQ(flags.size(), loaded->get_flag_positions().get_count());
+  EXPECT_EQ(1u, loaded->get_building_positions().get_count());
+}
@@ -0,0 +1,98 @@
+/*
+ * test_step_clock.cc - test fixed timestep accounting of the event loop
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/event_loop.h"
+
+TEST(StepClock, OneStepPerInterval) {
+  StepClock clock(20, 5, 50, 4);
+  EXPECT_EQ(1u, clock.advance(1000));
+  for (uint32_t now = 1020; now < 2000; now += 20) {
+    EXPECT_EQ(1u, clock.advance(now));
+    EXPECT_EQ(0u, clock.get_ticks_behind());
+    EXPECT_TRUE(clock.frame_ready());
+  }
+  EXPECT_EQ(0u, clock.get_dropped_frames());
+  EXPECT_EQ(0u, clock.get_dropped_ticks());
+}
+
+TEST(StepClock, KeepsRemainder) {
+  StepClock clock(20, 5, 50, 4);
+  clock.advance(0);
+  EXPECT_EQ(0u, clock.advance(15));
+  EXPECT_EQ(1u, clock.advance(30));
+  EXPECT_EQ(1u, clock.advance(45));
+  EXPECT_EQ(0u, clock.advance(55));
+  EXPECT_EQ(1u, clock.advance(60));
+}
+
+TEST(StepClock, CatchesUpOverFrames) {
+  StepClock clock(20, 5, 50, 4);
+  clock.advance(0);
+
+  // A long frame of 12 steps is caught up over the next frames.
+  EXPECT_EQ(5u, clock.advance(240));
+  EXPECT_EQ(7u, clock.get_ticks_behind());
+  EXPECT_FALSE(clock.frame_ready());
+  EXPECT_EQ(5u, clock.advance(240));
+  EXPECT_EQ(2u, clock.get_ticks_behind());
+  EXPECT_FALSE(clock.frame_ready());
+  EXPECT_EQ(2u, clock.advance(240));
+  EXPECT_EQ(0u, clock.get_ticks_behind());
+  EXPECT_TRUE(clock.frame_ready());
+
+  EXPECT_EQ(2u, clock.get_dropped_frames());
+  EXPECT_EQ(0u, clock.get_dropped_ticks());
+  EXPECT_EQ(7u, clock.get_max_ticks_behind());
+}
+
+TEST(StepClock, DropsLargeBacklog) {
+  StepClock clock(20, 5, 50, 4);
+  clock.advance(0);
+
+  // Ten seconds without a frame, e.g. a stopped debugger.
+  EXPECT_EQ(5u, clock.advance(10000));
+  EXPECT_EQ(45u, clock.get_ticks_behind());
+  EXPECT_EQ(450u, clock.get_dropped_ticks());
+}
+
+TEST(StepClock, DrawsWhileFallingBehind) {
+  StepClock clock(20, 1, 50, 4);
+  clock.advance(0);
+
+  unsigned int drawn = 0;
+  for (uint32_t now = 40; now <= 400; now += 40) {
+    clock.advance(now);
+    if (clock.frame_ready()) {
+      drawn++;
+    }
+  }
+  EXPECT_EQ(2u, drawn);
+  EXPECT_EQ(8u, clock.get_dropped_frames());
+}
+
+TEST(StepClock, WrapsAround) {
+  StepClock clock(20, 5, 50, 4);
+  clock.advance(0xFFFFFFF0u);
+  EXPECT_EQ(1u, clock.advance(0x00000004u));
+  EXPECT_EQ(0u, clock.get_ticks_behind());
+}
@@ -0,0 +1,191 @@
+/*
+ * test_tpwm.cc - test TPWM unpacker
+ *
+ * Copyright (C) 2026  The freeserf developers
+ *
+ * This file is part of freeserf.
+ *
+ * freeserf is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * freeserf is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with freeserf.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "src/tpwm.h"
+#include "src/debug.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Builds an archive token by token and keeps the unpacked data next to it.
+class ArchiveWriter {
+ protected:
+  Bytes tokens;
+  size_t flag_pos;
+  unsigned int token_count;
+
+ public:
+  Bytes unpacked;
+
+  ArchiveWriter() : flag_pos(0), token_count(0) {}
+
+  void literal(uint8_t value) {
+    next_token(false);
+    tokens.push_back(value);
+    unpacked.push_back(value);
+  }
+
+  void stamp(size_t offset, size_t size) {
+    next_token(true);
+    tokens.push_back(static_cast<uint8_t>(((offset >> 4) & 0xF0) |
+                                          (size - 3)));
+    tokens.push_back(static_cast<uint8_t>(offset & 0xFF));
+    // Byte by byte, so overlapping stamps repeat their period.
+    for (size_t i = 0; i < size; i++) {
+      unpacked.push_back(unpacked[unpacked.size() - offset]);
+    }
+  }
+
+  Bytes archive() const {
+    Bytes result = { 'T', 'P', 'W', 'M',
+                     static_cast<uint8_t>(unpacked.size() & 0xFF),
+                     static_cast<uint8_t>(unpacked.size() >> 8) };
+    result.insert(result.end(), tokens.begin(), tokens.end());
+    return result;
+  }
+
+ protected:
+  void next_token(bool is_stamp) {
+    if (token_count % 8 == 0) {
+      flag_pos = tokens.size();
+      tokens.push_back(0);
+    }
+    if (is_stamp) {
+      tokens[flag_pos] |= 0x80 >> (token_count % 8);
+    }
+    token_count++;
+  }
+};
+
+static PBuffer
+make_buffer(const Bytes &bytes) {
+  return std::make_shared<Buffer>(const_cast<uint8_t*>(bytes.data()),
+                                  bytes.size(), Buffer::EndianessLittle);
+}
+
+static Bytes
+unpack(const Bytes &archive) {
+  UnpackerTPWM unpacker(make_buffer(archive));
+  PBuffer result = unpacker.convert();
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(result->get_data());
+  return Bytes(data, data + result->get_size());
+}
+
+static ArchiveWriter
+random_archive(std::mt19937 *rng, size_t size) {
+  ArchiveWriter writer;
+  while (writer.unpacked.size() < size) {
+    size_t left = size - writer.unpacked.size();
+    if (writer.unpacked.empty() || left < 3 || (*rng)() % 3 == 0) {
+      writer.literal(static_cast<uint8_t>((*rng)() % 16));
+    } else {
+      size_t max_offset = std::min<size_t>(writer.unpacked.size(), 0xFFF);
+      // Favor short offsets, they overlap the stamp.
+      size_t offset = 1 + (*rng)() % (((*rng)() % 2) ? 20 : max_offset);
+      offset = std::min(offset, max_offset);
+      size_t stamp_size = 3 + (*rng)() % std::min<size_t>(16, left - 2);
+      writer.stamp(offset, stamp_size);
+    }
+  }
+  return writer;
+}
+
+TEST(TPWM, RandomArchives) {
+  std::mt19937 rng(34);
+  for (int i = 0; i < 300; i++) {
+    size_t size = (i < 100) ? i + 1 : 1 + rng() % 0xFFFF;
+    ArchiveWriter writer = random_archive(&rng, size);
+    Bytes archive = writer.archive();
+    SCOPED_TRACE(i);
+    ASSERT_EQ(writer.unpacked, unpack(archive));
+  }
+}
+
+TEST(TPWM, OverlappingStamps) {
+  for (size_t offset = 1; offset <= 18; offset++) {
+    for (size_t stamp_size = 3; stamp_size <= 18; stamp_size++) {
+      ArchiveWriter writer;
+      for (size_t i = 0; i < offset; i++) {
+        writer.literal(static_cast<uint8_t>(i + 1));
+      }
+      writer.stamp(offset, stamp_size);
+      writer.literal(0xAA);
+      ASSERT_EQ(writer.unpacked, unpack(writer.archive()));
+    }
+  }
+}
+
+TEST(TPWM, UnpackToCallerMemory) {
+  std::mt19937 rng(1);
+  ArchiveWriter writer = random_archive(&rng, 5000);
+  Bytes archive = writer.archive();
+  UnpackerTPWM unpacker(make_buffer(archive));
+  ASSERT_EQ(writer.unpacked.size(), unpacker.get_unpacked_size());
+
+  Bytes small(unpacker.get_unpacked_size() - 1);
+  EXPECT_THROW(unpacker.unpack(small.data(), small.size()), ExceptionFreeserf);
+
+  Bytes output(unpacker.get_unpacked_size() + 4, 0x55);
+  EXPECT_EQ(writer.unpacked.size(),
+            unpacker.unpack(output.data(), output.size()));
+  EXPECT_TRUE(std::equal(writer.unpacked.begin(), writer.unpacked.end(),
+                         output.begin()));
+  EXPECT_EQ(0x55, output.back());
+}
+
+TEST(TPWM, RejectsBadArchives) {
+  Bytes not_archive = { 'T', 'P', 'W', 'X', 4, 0, 0, 'a', 'b', 'c', 'd' };
+  EXPECT_THROW(UnpackerTPWM(make_buffer(not_archive)), ExceptionFreeserf);
+
+  // Stamp pointing before the start of the data.
+  Bytes before_start = { 'T', 'P', 'W', 'M', 5, 0, 0x40, 'a', 0x00, 0x02 };
+  EXPECT_THROW(unpack(before_start), ExceptionFreeserf);
+
+  // Stamp running past the unpacked size.
+  Bytes past_end = { 'T', 'P', 'W', 'M', 4, 0, 0x40, 'a', 0x0F, 0x01 };
+  EXPECT_THROW(unpack(past_end), ExceptionFreeserf);
+
+  // Fewer tokens than the header promises.
+  Bytes truncated = { 'T', 'P', 'W', 'M', 9, 0, 0x00, 'a', 'b', 'c' };
+  EXPECT_THROW(unpack(truncated), ExceptionFreeserf);
+}
+
+TEST(TPWM, CorruptedArchives) {
+  std::mt19937 rng(7);
+  for (int i = 0; i < 2000; i++) {
+    Bytes archive = random_archive(&rng, rng() % 300).archive();
+    archive.resize(6 + rng() % (archive.size() - 5));
+    for (int j = 0; j < 4; j++) {
+      archive[4 + rng() % (archive.size() - 4)] ^= static_cast<uint8_t>(rng());
+    }
+    try {
+      Bytes result = unpack(archive);
+      EXPECT_EQ(static_cast<size_t>(archive[4] | (archive[5] << 8)),
+                result.size());
+    } catch (ExceptionFreeserf &) {
+    }
+  }
+}